@@ -0,0 +1,120 @@
+#include "batch.h"
+#include "parallel.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+
+namespace Dakota {
+
+size_t BatchReport::failed() const {
+    size_t count = 0;
+    for (const auto& result : results) {
+        if (!result.ok) ++count;
+    }
+    return count;
+}
+
+double BatchReport::jobs_per_second() const {
+    return wall_ms > 0.0 ? static_cast<double>(results.size()) * 1000.0 / wall_ms : 0.0;
+}
+
+std::vector<BatchJob> load_batch(const std::string& jobs_path) {
+    std::ifstream file(jobs_path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open jobs file: " + jobs_path);
+    }
+
+    size_t slash = jobs_path.find_last_of('/');
+    std::string base = slash == std::string::npos ? "" : jobs_path.substr(0, slash + 1);
+
+    std::vector<BatchJob> jobs;
+    std::unordered_map<std::string, std::string> scripts;   // Resolved path -> text
+    std::string line;
+    size_t line_number = 0;
+
+    while (std::getline(file, line)) {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string path;
+        if (!(fields >> path) || path[0] == '#') continue;
+
+        BatchJob job;
+        job.path = path;
+        std::string resolved = path[0] == '/' ? path : base + path;
+
+        auto script = scripts.find(resolved);
+        if (script == scripts.end()) {
+            std::ifstream source(resolved);
+            if (!source.is_open()) {
+                throw std::runtime_error(jobs_path + ":" + std::to_string(line_number) +
+                                         ": Cannot open script: " + resolved);
+            }
+            std::ostringstream content;
+            content << source.rdbuf();
+            script = scripts.emplace(resolved, content.str()).first;
+        }
+        job.request.script = script->second;
+
+        std::string parameter;
+        while (fields >> parameter) {
+            size_t equals = parameter.find('=');
+            if (equals == std::string::npos || equals == 0) {
+                throw std::runtime_error(jobs_path + ":" + std::to_string(line_number) +
+                                         ": Expected name=value, got '" + parameter + "'");
+            }
+            job.request.parameters.emplace_back(parameter.substr(0, equals), parameter.substr(equals + 1));
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+BatchReport run_batch(const std::vector<BatchJob>& jobs, unsigned threads, bool optimize) {
+    BatchReport report;
+    report.threads = threads == 0 ? hardware_threads() : threads;
+    report.results.resize(jobs.size());
+
+    ProgramCache programs(optimize);
+    auto start = std::chrono::steady_clock::now();
+    parallel_for(jobs.size(), [&](size_t k) {
+        report.results[k] = run_job(programs, jobs[k].request);
+    }, report.threads);
+    report.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    report.programs = programs.stats();
+    return report;
+}
+
+void print_batch_summary(std::ostream& out, const std::vector<BatchJob>& jobs, const BatchReport& report) {
+    size_t path_width = 6;
+    for (const auto& job : jobs) {
+        path_width = std::max(path_width, job.path.size());
+    }
+
+    out << "=== Batch Summary ===\n";
+    out << std::left << std::setw(6) << "job" << std::setw(static_cast<int>(path_width) + 2) << "script"
+        << std::setw(8) << "status" << std::right << std::setw(12) << "wall ms" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (size_t k = 0; k < jobs.size(); ++k) {
+        out << std::left << std::setw(6) << k + 1 << std::setw(static_cast<int>(path_width) + 2) << jobs[k].path
+            << std::setw(8) << (report.results[k].ok ? "ok" : "FAILED") << std::right << std::setw(12)
+            << report.results[k].wall_ms << "\n";
+    }
+
+    double busy_ms = 0.0;
+    for (const auto& result : report.results) {
+        busy_ms += result.wall_ms;
+    }
+    out << jobs.size() << " jobs (" << report.failed() << " failed) on " << report.threads << " threads in "
+        << report.wall_ms << " ms: " << report.jobs_per_second() << " jobs/s, "
+        << (report.wall_ms > 0.0 ? busy_ms / report.wall_ms : 0.0) << "x concurrency\n";
+    out << "Scripts compiled: " << report.programs.compiled << ", reused: " << report.programs.reused << "\n";
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
+
+} // namespace Dakota
@@ -0,0 +1,47 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "jobs.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace Dakota {
+
+// One line of a jobs file: a script path followed by name=value parameters
+struct BatchJob {
+    std::string path;       // As written in the jobs file
+    JobRequest request;
+};
+
+struct BatchReport {
+    std::vector<JobResult> results;   // In job order
+    double wall_ms = 0.0;             // Whole batch, first job start to last job end
+    unsigned threads = 0;
+    ProgramCacheStats programs;
+
+    size_t failed() const;
+    double jobs_per_second() const;
+};
+
+// Read a jobs file. Each non-blank line not starting with '#' names a script
+// and optional parameters:
+//
+//   scripts/fit.dk  alpha=0.5 n=1000
+//   scripts/fit.dk  alpha=0.7 n=1000
+//
+// Relative script paths resolve against the jobs file's directory and every
+// distinct script is read once. Throws std::runtime_error naming the line.
+std::vector<BatchJob> load_batch(const std::string& jobs_path);
+
+// `dakota --batch jobs.txt -j N`: run every job on up to N threads (0 for
+// hardware threads), each with its own Interpreter and captured output.
+// Identical scripts are lexed, parsed and optimized once for the whole batch.
+BatchReport run_batch(const std::vector<BatchJob>& jobs, unsigned threads = 0, bool optimize = true);
+
+// Per-job status and wall time, then totals and throughput
+void print_batch_summary(std::ostream& out, const std::vector<BatchJob>& jobs, const BatchReport& report);
+
+} // namespace Dakota
+
+#endif // BATCH_H
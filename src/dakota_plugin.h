@@ -0,0 +1,101 @@
+/*
+ * Dakota plugin ABI
+ *
+ * A plugin is a shared library exporting one C function,
+ *
+ *     const dakota_plugin* dakota_plugin_init(const dakota_host_api* host);
+ *
+ * that returns a static table of native functions. The interpreter loads it
+ * with `dakota --plugin libfoo.so`, or every library in `--plugin-dir` and
+ * $DAKOTA_PLUGIN_DIR, and its functions become builtins in every script.
+ * A plugin function with the same name as a builtin replaces it, and should
+ * keep its meaning: the optimizer treats math builtins such as sqrt and abs
+ * as pure.
+ *
+ * Plugin functions may be called concurrently: sweep() runs its workers on
+ * several threads, and the daemon serves requests from a thread pool. A
+ * function must not keep mutable state outside its dakota_call without
+ * its own locking.
+ *
+ * This header is plain C and is all a plugin needs; it does not depend on
+ * the interpreter's C++ types, which may change between releases. Plugins
+ * built against one DAKOTA_PLUGIN_ABI_VERSION load into any interpreter with
+ * the same version.
+ */
+#ifndef DAKOTA_PLUGIN_H
+#define DAKOTA_PLUGIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DAKOTA_PLUGIN_ABI_VERSION 1
+#define DAKOTA_PLUGIN_ENTRY "dakota_plugin_init"
+
+typedef enum dakota_type {
+    DAKOTA_TYPE_NONE = 0,     /* Results only: the function returns nothing */
+    DAKOTA_TYPE_INT = 1,
+    DAKOTA_TYPE_FLOAT = 2,    /* Ints are accepted and converted */
+    DAKOTA_TYPE_MATRIX = 3,
+    DAKOTA_TYPE_ANY = 4       /* An int, float or matrix, passed as it is */
+} dakota_type;
+
+/* An argument or result. Matrices are row-major and contiguous; argument
+ * data is read-only and valid until the function returns. */
+typedef struct dakota_value {
+    int32_t type;             /* dakota_type */
+    int64_t integer;
+    double real;
+    const double* data;
+    int64_t rows;
+    int64_t cols;
+} dakota_value;
+
+/* Per-call state owned by the interpreter */
+typedef struct dakota_call dakota_call;
+
+/* Services the interpreter provides to plugin functions */
+typedef struct dakota_host_api {
+    uint32_t abi_version;
+
+    /* A zeroed rows x cols result buffer owned by the interpreter, valid until
+     * the function returns. Returning it as the result avoids a copy. Returns
+     * NULL if a dimension is negative or the buffer cannot be allocated. */
+    double* (*new_matrix)(dakota_call* call, int64_t rows, int64_t cols);
+
+    /* Message for the runtime error raised when the function returns nonzero */
+    void (*set_error)(dakota_call* call, const char* message);
+} dakota_host_api;
+
+/* Fill *result and return 0, or return nonzero to raise a runtime error.
+ * *result starts as DAKOTA_TYPE_NONE. */
+typedef int (*dakota_native_function)(dakota_call* call, const dakota_value* args, int32_t argc,
+                                      dakota_value* result);
+
+typedef struct dakota_function {
+    const char* name;
+    dakota_native_function function;
+    int32_t min_arity;
+    int32_t max_arity;                /* -1 for no limit */
+    const int32_t* parameter_types;   /* max_arity dakota_types, or NULL to accept anything */
+    int32_t result_type;              /* dakota_type, checked against what the function returns */
+    const char* doc;                  /* One-line description; may be NULL */
+} dakota_function;
+
+typedef struct dakota_plugin {
+    uint32_t abi_version;             /* DAKOTA_PLUGIN_ABI_VERSION */
+    const char* name;
+    const dakota_function* functions;
+    size_t function_count;
+} dakota_plugin;
+
+typedef const dakota_plugin* (*dakota_plugin_init_function)(const dakota_host_api* host);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAKOTA_PLUGIN_H */
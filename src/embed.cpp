@@ -0,0 +1,69 @@
+#include "embed.h"
+#include <algorithm>
+
+namespace Dakota {
+
+ExternalArray::ExternalArray(const double* data, ArrayLayout layout, ReleaseCallback release)
+    : data_(data), layout_(layout), release_(std::move(release)) {
+    if (!data_ && layout_.rows * layout_.cols != 0) {
+        throw RuntimeError("Cannot wrap a null array");
+    }
+}
+
+ExternalArray::~ExternalArray() {
+    if (release_) {
+        release_();
+    }
+}
+
+const std::shared_ptr<const Matrix>& ExternalArray::matrix() const {
+    std::call_once(gathered_, [this]() {
+        auto matrix = std::allocate_shared<Matrix>(PoolAllocator<Matrix>());
+        matrix->reserve(layout_.rows);
+        for (size_t i = 0; i < layout_.rows; ++i) {
+            const double* source = data_ + static_cast<ptrdiff_t>(i) * layout_.row_stride;
+            MatrixRow row(layout_.cols);
+            if (layout_.col_stride == 1) {
+                std::copy(source, source + layout_.cols, row.begin());
+            } else {
+                for (size_t j = 0; j < layout_.cols; ++j) {
+                    row[j] = source[static_cast<ptrdiff_t>(j) * layout_.col_stride];
+                }
+            }
+            matrix->push_back(std::move(row));
+        }
+        matrix_ = std::move(matrix);
+        materialized_.store(true, std::memory_order_release);
+    });
+    return matrix_;
+}
+
+Value wrap_array(const double* data, ArrayLayout layout, ReleaseCallback release) {
+    return Value(std::shared_ptr<Object>(std::make_shared<ExternalArray>(data, layout, std::move(release))));
+}
+
+MatrixView view(const Value& value) {
+    MatrixView result;
+    if (value.is_matrix()) {
+        const Matrix& matrix = value.as_matrix();
+        result.owner_ = value.matrix_pointer();
+        result.matrix_ = &matrix;
+        result.rows_ = matrix.size();
+        result.cols_ = matrix.empty() ? 0 : matrix[0].size();
+        return result;
+    }
+    if (value.is_object()) {
+        if (auto* array = dynamic_cast<const ExternalArray*>(&value.as_object())) {
+            result.owner_ = value.object_pointer();
+            result.data_ = array->data();
+            result.rows_ = array->layout().rows;
+            result.cols_ = array->layout().cols;
+            result.row_stride_ = array->layout().row_stride;
+            result.col_stride_ = array->layout().col_stride;
+            return result;
+        }
+    }
+    throw RuntimeError("Cannot view a value that is not a matrix");
+}
+
+} // namespace Dakota
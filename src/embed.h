@@ -0,0 +1,102 @@
+#ifndef EMBED_H
+#define EMBED_H
+
+#include "interpreter.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+namespace Dakota {
+
+// Shape and strides of a host array, in elements: (i, j) is at
+// data[i * row_stride + j * col_stride]. Negative strides are allowed.
+struct ArrayLayout {
+    size_t rows = 0;
+    size_t cols = 0;
+    ptrdiff_t row_stride = 0;
+    ptrdiff_t col_stride = 1;
+
+    static ArrayLayout row_major(size_t rows, size_t cols) { return {rows, cols, static_cast<ptrdiff_t>(cols), 1}; }
+    static ArrayLayout column_major(size_t rows, size_t cols) { return {rows, cols, 1, static_cast<ptrdiff_t>(rows)}; }
+};
+
+// Called once when the interpreter no longer refers to a wrapped buffer
+using ReleaseCallback = std::function<void()>;
+
+// A host buffer bound into the interpreter without copying. Scripts read it
+// as an ordinary matrix: the first read gathers it into the interpreter's
+// row storage and every later read, on any thread, shares that copy. A
+// binding that is never read is never copied.
+//
+// The host must keep the buffer alive and unchanged until release is called.
+class ExternalArray : public Object {
+public:
+    ExternalArray(const double* data, ArrayLayout layout, ReleaseCallback release);
+    ~ExternalArray() override;
+
+    ExternalArray(const ExternalArray&) = delete;
+    ExternalArray& operator=(const ExternalArray&) = delete;
+
+    std::string type_name() const override { return "external matrix"; }
+
+    const double* data() const { return data_; }
+    const ArrayLayout& layout() const { return layout_; }
+    double at(size_t i, size_t j) const {
+        return data_[static_cast<ptrdiff_t>(i) * layout_.row_stride + static_cast<ptrdiff_t>(j) * layout_.col_stride];
+    }
+
+    // The matrix scripts see, gathered on first call
+    const std::shared_ptr<const Matrix>& matrix() const;
+    bool materialized() const { return materialized_.load(std::memory_order_acquire); }
+
+private:
+    const double* data_;
+    ArrayLayout layout_;
+    ReleaseCallback release_;
+    mutable std::once_flag gathered_;
+    mutable std::shared_ptr<const Matrix> matrix_;
+    mutable std::atomic<bool> materialized_{false};
+};
+
+// Wrap a host array as a value to define in an Environment, e.g.
+//
+//   env->define("A", wrap_array(eigen.data(), ArrayLayout::column_major(n, m)));
+Value wrap_array(const double* data, ArrayLayout layout, ReleaseCallback release = nullptr);
+
+// Read-only view of a matrix value for the host, sharing the value's storage.
+// Rows are contiguous for interpreter matrices; a view of a wrapped host
+// array reads the host buffer with its own strides. The view keeps the
+// storage alive, so it stays valid after the value or interpreter is gone.
+class MatrixView {
+public:
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+
+    // Row i's first element; successive elements are col_stride() apart
+    const double* row(size_t i) const {
+        return matrix_ ? (*matrix_)[i].data() : data_ + static_cast<ptrdiff_t>(i) * row_stride_;
+    }
+    ptrdiff_t col_stride() const { return matrix_ ? 1 : col_stride_; }
+
+    double operator()(size_t i, size_t j) const { return row(i)[static_cast<ptrdiff_t>(j) * col_stride()]; }
+
+private:
+    friend MatrixView view(const Value& value);
+
+    std::shared_ptr<const void> owner_;
+    const Matrix* matrix_ = nullptr;
+    const double* data_ = nullptr;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    ptrdiff_t row_stride_ = 0;
+    ptrdiff_t col_stride_ = 1;
+};
+
+// View a matrix or wrapped host array. Throws RuntimeError for other values.
+MatrixView view(const Value& value);
+
+} // namespace Dakota
+
+#endif // EMBED_H
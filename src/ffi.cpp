@@ -0,0 +1,233 @@
+#include "ffi.h"
+#include <dlfcn.h>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+
+namespace Dakota {
+namespace FFI {
+
+namespace {
+
+// One argument or result as it is passed to C
+union Slot {
+    int64_t integer;
+    double real;
+    double* pointer;           // The matrix result, written in place
+    const double* input;       // Any other matrix
+};
+
+template <typename T> T unpack(const Slot& slot);
+template <> int64_t unpack<int64_t>(const Slot& slot) { return slot.integer; }
+template <> double unpack<double>(const Slot& slot) { return slot.real; }
+template <> double* unpack<double*>(const Slot& slot) { return slot.pointer; }
+template <> const double* unpack<const double*>(const Slot& slot) { return slot.input; }
+
+using Stub = Slot (*)(void* symbol, const Slot* args);
+
+// Calls symbol as R(A...), so the compiler applies the platform calling
+// convention; no libffi needed
+template <typename R, typename... A>
+struct Call {
+    template <size_t... I>
+    static Slot invoke(void* symbol, [[maybe_unused]] const Slot* args, std::index_sequence<I...>) {
+        auto function = reinterpret_cast<R (*)(A...)>(symbol);
+        Slot result{};
+        if constexpr (std::is_same_v<R, void>) {
+            function(unpack<A>(args[I])...);
+        } else if constexpr (std::is_same_v<R, int64_t>) {
+            result.integer = function(unpack<A>(args[I])...);
+        } else {
+            result.real = function(unpack<A>(args[I])...);
+        }
+        return result;
+    }
+
+    static Slot stub(void* symbol, const Slot* args) {
+        return invoke(symbol, args, std::index_sequence_for<A...>{});
+    }
+};
+
+// The stub for a list of parameter types, one template instance per mix.
+// Only the matrix at result_arg is passed writable.
+template <typename R, typename... A>
+Stub select_stub(const Type* types, size_t count, size_t result_arg) {
+    if (count == 0) {
+        return &Call<R, A...>::stub;
+    }
+    if constexpr (sizeof...(A) < MAX_EXTERN_ARGS) {
+        switch (types[0]) {
+            case Type::INT:
+                return select_stub<R, A..., int64_t>(types + 1, count - 1, result_arg);
+            case Type::FLOAT:
+                return select_stub<R, A..., double>(types + 1, count - 1, result_arg);
+            default:
+                if (sizeof...(A) == result_arg) {
+                    return select_stub<R, A..., double*>(types + 1, count - 1, result_arg);
+                }
+                return select_stub<R, A..., const double*>(types + 1, count - 1, result_arg);
+        }
+    }
+    return nullptr;
+}
+
+void* open_library(const std::string& path) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, void*> libraries;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto known = libraries.find(path);
+    if (known != libraries.end()) {
+        return known->second;
+    }
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* reason = dlerror();
+        throw RuntimeError("Cannot load library '" + path + "': " + (reason ? reason : "unknown error"));
+    }
+    libraries.emplace(path, handle);
+    return handle;
+}
+
+} // anonymous namespace
+
+const double* contiguous(const Matrix& matrix, MatrixRow& scratch, const std::string& function) {
+    if (matrix.empty()) {
+        return nullptr;
+    }
+    if (matrix.size() == 1) {
+        return matrix[0].data();
+    }
+    size_t cols = matrix[0].size();
+    scratch.resize(matrix.size() * cols);
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        if (matrix[i].size() != cols) {
+            throw RuntimeError("Function '" + function + "' needs rectangular matrix arguments");
+        }
+        std::copy(matrix[i].begin(), matrix[i].end(), scratch.begin() + i * cols);
+    }
+    return scratch.data();
+}
+
+Signature Signature::parse(std::string_view codes) {
+    Signature signature;
+    if (codes.empty()) {
+        return signature;
+    }
+    for (size_t k = 0; k + 1 < codes.size(); ++k) {
+        signature.parameters.push_back(static_cast<Type>(codes[k]));
+    }
+    signature.result = static_cast<Type>(codes.back());
+    return signature;
+}
+
+NativeFunction bind(const std::string& library, const std::string& name, const Signature& signature) {
+    const std::vector<Type>& parameters = signature.parameters;
+    if (parameters.size() > MAX_EXTERN_ARGS) {
+        throw RuntimeError("extern function '" + name + "' has more than " + std::to_string(MAX_EXTERN_ARGS) +
+                           " parameters");
+    }
+    size_t result_arg = parameters.size();
+    if (signature.result == Type::MATRIX) {
+        result_arg = std::find(parameters.begin(), parameters.end(), Type::MATRIX) - parameters.begin();
+        if (result_arg == parameters.size()) {
+            throw RuntimeError("extern function '" + name + "' returns a matrix but takes none to write");
+        }
+    }
+
+    void* handle = open_library(library);
+    void* symbol = dlsym(handle, name.c_str());
+    if (!symbol) {
+        throw RuntimeError("Symbol '" + name + "' not found in '" + library + "'");
+    }
+
+    Stub stub;
+    switch (signature.result) {
+        case Type::INT:
+            stub = select_stub<int64_t>(parameters.data(), parameters.size(), result_arg);
+            break;
+        case Type::FLOAT:
+            stub = select_stub<double>(parameters.data(), parameters.size(), result_arg);
+            break;
+        default:
+            stub = select_stub<void>(parameters.data(), parameters.size(), result_arg);
+            break;
+    }
+
+    Type result = signature.result;
+    return [name, parameters, result, result_arg, stub, symbol](const std::vector<Value>& args) -> Value {
+        if (args.size() != parameters.size()) {
+            throw RuntimeError("Function '" + name + "' expects " + std::to_string(parameters.size()) +
+                               " arguments, got " + std::to_string(args.size()));
+        }
+
+        Slot slots[MAX_EXTERN_ARGS + 1];
+        MatrixRow buffers[MAX_EXTERN_ARGS];   // Gathered arguments and the written copy
+        for (size_t k = 0; k < parameters.size(); ++k) {
+            const Value& arg = args[k];
+            switch (parameters[k]) {
+                case Type::INT:
+                    if (!arg.is_integer()) {
+                        throw RuntimeError("Function '" + name + "' expects an int for argument " + std::to_string(k + 1));
+                    }
+                    slots[k].integer = arg.as_integer();
+                    break;
+                case Type::FLOAT:
+                    if (!arg.is_numeric()) {
+                        throw RuntimeError("Function '" + name + "' expects a number for argument " + std::to_string(k + 1));
+                    }
+                    slots[k].real = arg.to_double();
+                    break;
+                default: {
+                    if (!arg.is_matrix()) {
+                        throw RuntimeError("Function '" + name + "' expects a matrix for argument " + std::to_string(k + 1));
+                    }
+                    const Matrix& matrix = arg.as_matrix();
+                    if (k == result_arg) {
+                        // Written by C, so never the argument's own row
+                        if (matrix.size() == 1) {
+                            buffers[k] = matrix[0];
+                        } else {
+                            contiguous(matrix, buffers[k], name);
+                        }
+                        slots[k].pointer = buffers[k].data();
+                    } else {
+                        // Read in place: a single row may be shared by aliases and cached literals
+                        slots[k].input = contiguous(matrix, buffers[k], name);
+                    }
+                    break;
+                }
+            }
+        }
+
+        Slot returned = stub(symbol, slots);
+        switch (result) {
+            case Type::INT:
+                return Value(returned.integer);
+            case Type::FLOAT:
+                return Value(returned.real);
+            case Type::MATRIX: {
+                const Matrix& shape = args[result_arg].as_matrix();
+                Matrix written;
+                if (shape.size() == 1) {
+                    written.push_back(std::move(buffers[result_arg]));
+                } else if (!shape.empty()) {
+                    size_t cols = shape[0].size();
+                    written.reserve(shape.size());
+                    for (size_t i = 0; i < shape.size(); ++i) {
+                        const double* row = buffers[result_arg].data() + i * cols;
+                        written.emplace_back(row, row + cols);
+                    }
+                }
+                return Value(std::move(written));
+            }
+            default:
+                return Value();
+        }
+    };
+}
+
+} // namespace FFI
+} // namespace Dakota
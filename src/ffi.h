@@ -0,0 +1,52 @@
+#ifndef FFI_H
+#define FFI_H
+
+#include "interpreter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Dakota {
+namespace FFI {
+
+// Constants for extern functions
+constexpr size_t MAX_EXTERN_ARGS = 5;   // Every mix of argument types up to this many has a call stub
+
+// How a value crosses into C:
+//   int     int64_t
+//   float   double
+//   matrix  const double*, row-major and contiguous; the C side is told
+//           the shape through int arguments of its own. A single-row
+//           matrix is passed in place and may be shared with other values,
+//           so C must not write to it; only the result matrix below is
+//           passed as a writable double*.
+enum class Type : char { INT = 'i', FLOAT = 'f', MATRIX = 'm', NONE = 'v' };
+
+// Parameter and result types of an extern declaration. A matrix result is
+// the function's first matrix argument after the call: the C function gets
+// a private copy of it to write in place, like LAPACK's in/out arrays, and
+// returns void.
+struct Signature {
+    std::vector<Type> parameters;
+    Type result = Type::NONE;
+
+    // From the parser's codes, parameters then result, e.g. "mif" + "m"
+    static Signature parse(std::string_view codes);
+};
+
+// Open library (once per process; libraries are never closed), look up
+// name and choose the call stub for the signature. The returned function
+// checks and converts its arguments and calls straight through, so it costs
+// about what a builtin does. Throws RuntimeError if the library or symbol
+// cannot be found or the signature has too many arguments.
+NativeFunction bind(const std::string& library, const std::string& name, const Signature& signature);
+
+// Row-major contiguous data of a matrix for C: a single row in place,
+// anything larger gathered into scratch. Throws RuntimeError, naming
+// function, if the rows differ in length.
+const double* contiguous(const Matrix& matrix, MatrixRow& scratch, const std::string& function);
+
+} // namespace FFI
+} // namespace Dakota
+
+#endif // FFI_H
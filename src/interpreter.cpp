@@ -1,13 +1,65 @@
 #include "interpreter.h"
+#include "linalg.h"
+#include "sparse.h"
+#include "matfun.h"
+#include "quadrature.h"
+#include "stats.h"
+#include "kernels.h"
+#include "sweep.h"
+#include "modules.h"
+#include "embed.h"
+#include "ffi.h"
+#include "plugins.h"
+#include "snapshot.h"
+#include "parallel.h"
 #include <iostream>
 #include <sstream>
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
 #include <unordered_set>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <cstdio>
+#include <cstring>
 
 namespace Dakota {
 
+namespace {
+
+// Applies op to every element
+template <typename Op>
+Matrix map_elements(const Matrix& matrix, Op op) {
+    Matrix result(matrix.size());
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        result[i].resize(matrix[i].size());
+        for (size_t j = 0; j < matrix[i].size(); ++j) {
+            result[i][j] = op(matrix[i][j]);
+        }
+    }
+    return result;
+}
+
+// Combines two same-shape matrices element by element
+template <typename Op>
+Matrix zip_elements(const Matrix& a, const Matrix& b, Op op, const char* operation) {
+    if (a.size() != b.size() || (a.size() > 0 && a[0].size() != b[0].size())) {
+        throw RuntimeError(std::string("Matrix dimensions don't match for ") + operation);
+    }
+    Matrix result(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        result[i].resize(a[i].size());
+        for (size_t j = 0; j < a[i].size(); ++j) {
+            result[i][j] = op(a[i][j], b[i][j]);
+        }
+    }
+    return result;
+}
+
+} // anonymous namespace
+
 // Value class implementation
 
 int64_t Value::as_integer() const {
@@ -28,7 +80,16 @@ const std::string& Value::as_string() const {
     if (!is_string()) {
         throw RuntimeError("Value is not a string");
     }
-    return std::get<std::string>(value_);
+    return *std::get<std::shared_ptr<std::string>>(value_);
+}
+
+// The buffer is mutable only for `s = s + t` in the interpreter, which
+// appends when the variable holds the sole reference
+const std::shared_ptr<std::string>& Value::string_buffer() const {
+    if (!is_string()) {
+        throw RuntimeError("Value is not a string");
+    }
+    return std::get<std::shared_ptr<std::string>>(value_);
 }
 
 bool Value::as_boolean() const {
@@ -38,11 +99,67 @@ bool Value::as_boolean() const {
     return std::get<bool>(value_);
 }
 
-const std::vector<std::vector<double>>& Value::as_matrix() const {
+const Matrix& Value::as_matrix() const {
     if (!is_matrix()) {
         throw RuntimeError("Value is not a matrix");
     }
-    return std::get<std::vector<std::vector<double>>>(value_);
+    return *std::get<std::shared_ptr<const Matrix>>(value_);
+}
+
+const LinAlg::SparseMatrix& Value::as_sparse() const {
+    if (!is_sparse()) {
+        throw RuntimeError("Value is not a sparse matrix");
+    }
+    return *std::get<std::shared_ptr<const LinAlg::SparseMatrix>>(value_);
+}
+
+const Function& Value::as_function() const {
+    if (!is_function()) {
+        throw RuntimeError("Value is not a function");
+    }
+    return *std::get<std::shared_ptr<const Function>>(value_);
+}
+
+const std::shared_ptr<const Function>& Value::function_pointer() const {
+    if (!is_function()) {
+        throw RuntimeError("Value is not a function");
+    }
+    return std::get<std::shared_ptr<const Function>>(value_);
+}
+
+const std::shared_ptr<const Matrix>& Value::matrix_pointer() const {
+    if (!is_matrix()) {
+        throw RuntimeError("Value is not a matrix");
+    }
+    return std::get<std::shared_ptr<const Matrix>>(value_);
+}
+
+List& Value::as_list() const {
+    if (!is_list()) {
+        throw RuntimeError("Value is not a list");
+    }
+    return *std::get<std::shared_ptr<List>>(value_);
+}
+
+Dict& Value::as_dict() const {
+    if (!is_dict()) {
+        throw RuntimeError("Value is not a dictionary");
+    }
+    return *std::get<std::shared_ptr<Dict>>(value_);
+}
+
+Object& Value::as_object() const {
+    if (!is_object()) {
+        throw RuntimeError("Value is not an object");
+    }
+    return *std::get<std::shared_ptr<Object>>(value_);
+}
+
+const std::shared_ptr<Object>& Value::object_pointer() const {
+    if (!is_object()) {
+        throw RuntimeError("Value is not an object");
+    }
+    return std::get<std::shared_ptr<Object>>(value_);
 }
 
 double Value::to_double() const {
@@ -86,6 +203,35 @@ std::string Value::to_string() const {
             oss << "]";
             return oss.str();
         }
+        case Type::SPARSE: {
+            const auto& sparse = as_sparse();
+            return "sparse(" + std::to_string(sparse.rows) + "x" + std::to_string(sparse.cols) +
+                   ", nnz=" + std::to_string(sparse.nnz()) + ")";
+        }
+        case Type::FUNCTION:
+            return "<function " + as_function().name + ">";
+        case Type::LIST: {
+            const List& list = as_list();
+            std::string result = "list(";
+            for (size_t i = 0; i < list.size(); ++i) {
+                if (i > 0) result += ", ";
+                result += list.get(i).to_string();
+            }
+            return result + ")";
+        }
+        case Type::DICT: {
+            std::string result = "{";
+            bool first = true;
+            for (const auto& entry : as_dict().entries()) {
+                if (!entry.live) continue;
+                if (!first) result += ", ";
+                result += entry.key.to_string() + ": " + entry.value.to_string();
+                first = false;
+            }
+            return result + "}";
+        }
+        case Type::OBJECT:
+            return "<" + as_object().type_name() + ">";
         case Type::NONE:
             return "none";
         default:
@@ -109,7 +255,7 @@ Value Value::operator+(const Value& other) const {
             throw RuntimeError("Matrix dimensions don't match for addition");
         }
         
-        std::vector<std::vector<double>> result(a.size());
+        Matrix result(a.size());
         for (size_t i = 0; i < a.size(); ++i) {
             result[i].resize(a[i].size());
             for (size_t j = 0; j < a[i].size(); ++j) {
@@ -117,6 +263,11 @@ Value Value::operator+(const Value& other) const {
             }
         }
         return Value(result);
+    } else if (is_matrix() && other.is_numeric()) {
+        double scalar = other.to_double();
+        return Value(map_elements(as_matrix(), [scalar](double x) { return x + scalar; }));
+    } else if (is_numeric() && other.is_matrix()) {
+        return other + (*this); // Commutative
     }
     throw RuntimeError("Cannot add values of these types");
 }
@@ -135,7 +286,7 @@ Value Value::operator-(const Value& other) const {
             throw RuntimeError("Matrix dimensions don't match for subtraction");
         }
         
-        std::vector<std::vector<double>> result(a.size());
+        Matrix result(a.size());
         for (size_t i = 0; i < a.size(); ++i) {
             result[i].resize(a[i].size());
             for (size_t j = 0; j < a[i].size(); ++j) {
@@ -143,6 +294,12 @@ Value Value::operator-(const Value& other) const {
             }
         }
         return Value(result);
+    } else if (is_matrix() && other.is_numeric()) {
+        double scalar = other.to_double();
+        return Value(map_elements(as_matrix(), [scalar](double x) { return x - scalar; }));
+    } else if (is_numeric() && other.is_matrix()) {
+        double scalar = to_double();
+        return Value(map_elements(other.as_matrix(), [scalar](double x) { return scalar - x; }));
     }
     throw RuntimeError("Cannot subtract values of these types");
 }
@@ -158,7 +315,7 @@ Value Value::operator*(const Value& other) const {
         const auto& matrix = as_matrix();
         double scalar = other.to_double();
         
-        std::vector<std::vector<double>> result(matrix.size());
+        Matrix result(matrix.size());
         for (size_t i = 0; i < matrix.size(); ++i) {
             result[i].resize(matrix[i].size());
             for (size_t j = 0; j < matrix[i].size(); ++j) {
@@ -168,6 +325,10 @@ Value Value::operator*(const Value& other) const {
         return Value(result);
     } else if (is_numeric() && other.is_matrix()) {
         return other * (*this); // Commutative
+    } else if (is_matrix() && other.is_matrix()) {
+        // Elementwise; matrix products use 'mult'
+        return Value(zip_elements(as_matrix(), other.as_matrix(),
+                                  [](double x, double y) { return x * y; }, "elementwise multiplication"));
     }
     throw RuntimeError("Cannot multiply values of these types");
 }
@@ -186,7 +347,7 @@ Value Value::operator/(const Value& other) const {
             throw RuntimeError("Division by zero");
         }
         
-        std::vector<std::vector<double>> result(matrix.size());
+        Matrix result(matrix.size());
         for (size_t i = 0; i < matrix.size(); ++i) {
             result[i].resize(matrix[i].size());
             for (size_t j = 0; j < matrix[i].size(); ++j) {
@@ -194,6 +355,16 @@ Value Value::operator/(const Value& other) const {
             }
         }
         return Value(result);
+    } else if (other.is_matrix() && (is_matrix() || is_numeric())) {
+        // Elementwise, with a scalar numerator broadcast
+        Matrix numerator = is_matrix() ? as_matrix()
+            : map_elements(other.as_matrix(), [this](double) { return to_double(); });
+        return Value(zip_elements(numerator, other.as_matrix(), [](double x, double y) {
+            if (y == 0.0) {
+                throw RuntimeError("Division by zero");
+            }
+            return x / y;
+        }, "elementwise division"));
     }
     throw RuntimeError("Cannot divide values of these types");
 }
@@ -212,11 +383,32 @@ Value Value::operator%(const Value& other) const {
 Value Value::power(const Value& other) const {
     if (is_numeric() && other.is_numeric()) {
         return Value(std::pow(to_double(), other.to_double()));
+    } else if (is_matrix() && other.is_integer()) {
+        try {
+            LinAlg::DenseMatrix a = LinAlg::from_nested(as_matrix());
+            return Value(LinAlg::to_nested(LinAlg::matrix_power(a, other.as_integer())));
+        } catch (const std::invalid_argument& e) {
+            throw RuntimeError(e.what());
+        } catch (const std::domain_error&) {
+            throw RuntimeError("Cannot raise a singular matrix to a negative power");
+        } catch (const std::overflow_error& e) {
+            throw RuntimeError(e.what());
+        }
+    } else if (is_matrix()) {
+        throw RuntimeError("Matrix power requires an integer exponent");
     }
     throw RuntimeError("Power operation requires numeric operands");
 }
 
 Value Value::matrix_multiply(const Value& other) const {
+    if (is_sparse() && other.is_matrix()) {
+        try {
+            return Value(LinAlg::to_nested(as_sparse().multiply(LinAlg::from_nested(other.as_matrix()))));
+        } catch (const std::invalid_argument& e) {
+            throw RuntimeError(e.what());
+        }
+    }
+    
     if (!is_matrix() || !other.is_matrix()) {
         throw RuntimeError("Matrix multiplication requires matrix operands");
     }
@@ -232,7 +424,7 @@ Value Value::matrix_multiply(const Value& other) const {
     size_t cols = b[0].size();
     size_t inner = a[0].size();
     
-    std::vector<std::vector<double>> result(rows, std::vector<double>(cols, 0.0));
+    Matrix result(rows, MatrixRow(cols, 0.0));
     
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
@@ -252,13 +444,13 @@ Value Value::transpose() const {
     
     const auto& matrix = as_matrix();
     if (matrix.empty()) {
-        return Value(std::vector<std::vector<double>>());
+        return Value(Matrix());
     }
     
     size_t rows = matrix.size();
     size_t cols = matrix[0].size();
     
-    std::vector<std::vector<double>> result(cols, std::vector<double>(rows));
+    Matrix result(cols, MatrixRow(rows));
     
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
@@ -291,7 +483,7 @@ Value Value::determinant() const {
     double det = 0.0;
     for (size_t j = 0; j < n; ++j) {
         // Create minor matrix
-        std::vector<std::vector<double>> minor(n - 1, std::vector<double>(n - 1));
+        Matrix minor(n - 1, MatrixRow(n - 1));
         for (size_t i = 1; i < n; ++i) {
             size_t col_idx = 0;
             for (size_t k = 0; k < n; ++k) {
@@ -321,7 +513,7 @@ Value Value::inverse() const {
     size_t n = matrix.size();
     
     // Create augmented matrix [A|I] where I is the identity matrix
-    std::vector<std::vector<double>> augmented(n, std::vector<double>(2 * n));
+    Matrix augmented(n, MatrixRow(2 * n));
     
     // Fill the augmented matrix
     for (size_t i = 0; i < n; ++i) {
@@ -369,7 +561,7 @@ Value Value::inverse() const {
     }
     
     // Extract the inverse matrix from the right half
-    std::vector<std::vector<double>> result(n, std::vector<double>(n));
+    Matrix result(n, MatrixRow(n));
     for (size_t i = 0; i < n; ++i) {
         for (size_t j = 0; j < n; ++j) {
             result[i][j] = augmented[i][j + n];
@@ -388,6 +580,33 @@ Value Value::operator==(const Value& other) const {
         case Type::STRING: return Value(as_string() == other.as_string());
         case Type::BOOLEAN: return Value(as_boolean() == other.as_boolean());
         case Type::MATRIX: return Value(as_matrix() == other.as_matrix());
+        case Type::SPARSE: {
+            const auto& a = as_sparse();
+            const auto& b = other.as_sparse();
+            return Value(a.same_pattern(b) && a.values == b.values);
+        }
+        case Type::FUNCTION: return Value(&as_function() == &other.as_function());
+        case Type::LIST: {
+            const List& a = as_list();
+            const List& b = other.as_list();
+            if (a.size() != b.size()) return Value(false);
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (!(a.get(i) == b.get(i)).as_boolean()) return Value(false);
+            }
+            return Value(true);
+        }
+        case Type::DICT: {
+            const Dict& a = as_dict();
+            const Dict& b = other.as_dict();
+            if (a.size() != b.size()) return Value(false);
+            for (const auto& entry : a.entries()) {
+                if (!entry.live) continue;
+                const Value* match = b.find(entry.key);
+                if (!match || !(entry.value == *match).as_boolean()) return Value(false);
+            }
+            return Value(true);
+        }
+        case Type::OBJECT: return Value(&as_object() == &other.as_object());
         case Type::NONE: return Value(true);
         default: return Value(false);
     }
@@ -418,6 +637,21 @@ Value Value::operator>=(const Value& other) const {
     return Value(!(*this < other).as_boolean());
 }
 
+Value Value::contains(const Value& item) const {
+    if (is_dict()) {
+        return Value(as_dict().find(item) != nullptr);
+    } else if (is_list()) {
+        const List& list = as_list();
+        for (size_t i = 0; i < list.size(); ++i) {
+            if ((list.get(i) == item).as_boolean()) return Value(true);
+        }
+        return Value(false);
+    } else if (is_string() && item.is_string()) {
+        return Value(as_string().find(item.as_string()) != std::string::npos);
+    }
+    throw RuntimeError("Right operand of 'in' must be a dictionary, list or string");
+}
+
 Value Value::logical_and(const Value& other) const {
     return Value(is_truthy() && other.is_truthy());
 }
@@ -437,7 +671,7 @@ Value Value::negate() const {
         return Value(-as_float());
     } else if (is_matrix()) {
         const auto& matrix = as_matrix();
-        std::vector<std::vector<double>> result(matrix.size());
+        Matrix result(matrix.size());
         for (size_t i = 0; i < matrix.size(); ++i) {
             result[i].resize(matrix[i].size());
             for (size_t j = 0; j < matrix[i].size(); ++j) {
@@ -456,21 +690,349 @@ bool Value::is_truthy() const {
         case Type::STRING: return !as_string().empty();
         case Type::BOOLEAN: return as_boolean();
         case Type::MATRIX: return !as_matrix().empty();
+        case Type::SPARSE: return as_sparse().rows > 0;
+        case Type::FUNCTION: return true;
+        case Type::LIST: return as_list().size() > 0;
+        case Type::DICT: return as_dict().size() > 0;
+        case Type::OBJECT: return true;
         case Type::NONE: return false;
         default: return false;
     }
 }
 
+// List implementation
+
+namespace {
+
+bool is_row_vector(const Value& value) {
+    return value.is_matrix() && value.as_matrix().size() == 1;
+}
+
+} // anonymous namespace
+
+size_t List::size() const {
+    switch (storage_) {
+        case Storage::EMPTY: return 0;
+        case Storage::INTEGER: return integers_.size();
+        case Storage::FLOAT: return floats_.size();
+        case Storage::ROWS: return rows_.size();
+        case Storage::BOXED: return boxed_.size();
+    }
+    return 0;
+}
+
+void List::box() {
+    if (storage_ == Storage::BOXED) return;
+    std::vector<Value> values;
+    values.reserve(size() + 1);
+    for (size_t i = 0; i < size(); ++i) {
+        values.push_back(get(i));
+    }
+    integers_ = std::vector<int64_t>();
+    floats_ = MatrixRow();
+    rows_ = Matrix();
+    boxed_ = std::move(values);
+    storage_ = Storage::BOXED;
+}
+
+void List::append(const Value& value) {
+    switch (storage_) {
+        case Storage::EMPTY:
+            if (value.is_integer()) {
+                storage_ = Storage::INTEGER;
+            } else if (value.is_float()) {
+                storage_ = Storage::FLOAT;
+            } else if (is_row_vector(value)) {
+                storage_ = Storage::ROWS;
+            } else {
+                storage_ = Storage::BOXED;
+            }
+            append(value);
+            return;
+        case Storage::INTEGER:
+            if (value.is_integer()) {
+                integers_.push_back(value.as_integer());
+                return;
+            }
+            break;
+        case Storage::FLOAT:
+            if (value.is_float()) {
+                floats_.push_back(value.as_float());
+                return;
+            }
+            break;
+        case Storage::ROWS:
+            if (is_row_vector(value) && (rows_.empty() || value.as_matrix()[0].size() == rows_[0].size())) {
+                rows_.push_back(value.as_matrix()[0]);
+                return;
+            }
+            break;
+        case Storage::BOXED:
+            boxed_.push_back(value);
+            return;
+    }
+    box();
+    boxed_.push_back(value);
+}
+
+Value List::pop() {
+    if (size() == 0) {
+        throw RuntimeError("pop() from an empty list");
+    }
+    Value result = get(size() - 1);
+    switch (storage_) {
+        case Storage::INTEGER: integers_.pop_back(); break;
+        case Storage::FLOAT: floats_.pop_back(); break;
+        case Storage::ROWS: rows_.pop_back(); break;
+        case Storage::BOXED: boxed_.pop_back(); break;
+        case Storage::EMPTY: break;
+    }
+    // An emptied list may take any element type again
+    if (size() == 0) {
+        storage_ = Storage::EMPTY;
+    }
+    return result;
+}
+
+Value List::get(size_t index) const {
+    if (index >= size()) {
+        throw RuntimeError("List index out of bounds");
+    }
+    return get_unchecked(index);
+}
+
+Value List::get_unchecked(size_t index) const {
+    switch (storage_) {
+        case Storage::INTEGER: return Value(integers_[index]);
+        case Storage::FLOAT: return Value(floats_[index]);
+        case Storage::ROWS: return Value(Matrix{rows_[index]});
+        case Storage::BOXED: return boxed_[index];
+        case Storage::EMPTY: break;
+    }
+    return Value();
+}
+
+void List::set(size_t index, const Value& value) {
+    if (index >= size()) {
+        throw RuntimeError("List index out of bounds");
+    }
+    set_unchecked(index, value);
+}
+
+void List::set_unchecked(size_t index, const Value& value) {
+    switch (storage_) {
+        case Storage::INTEGER:
+            if (value.is_integer()) {
+                integers_[index] = value.as_integer();
+                return;
+            }
+            break;
+        case Storage::FLOAT:
+            if (value.is_float()) {
+                floats_[index] = value.as_float();
+                return;
+            }
+            break;
+        case Storage::ROWS:
+            if (is_row_vector(value) && value.as_matrix()[0].size() == rows_[0].size()) {
+                rows_[index] = value.as_matrix()[0];
+                return;
+            }
+            break;
+        case Storage::BOXED:
+            boxed_[index] = value;
+            return;
+        case Storage::EMPTY:
+            break;
+    }
+    box();
+    boxed_[index] = value;
+}
+
+void List::reserve(size_t count) {
+    switch (storage_) {
+        case Storage::INTEGER: integers_.reserve(count); break;
+        case Storage::FLOAT: floats_.reserve(count); break;
+        case Storage::ROWS: rows_.reserve(count); break;
+        case Storage::BOXED: boxed_.reserve(count); break;
+        case Storage::EMPTY: break;
+    }
+}
+
+Value List::take_matrix() {
+    Matrix result;
+    switch (storage_) {
+        case Storage::EMPTY:
+            break;
+        case Storage::INTEGER:
+            result.emplace_back(integers_.begin(), integers_.end());
+            break;
+        case Storage::FLOAT:
+            result.push_back(std::move(floats_));
+            break;
+        case Storage::ROWS:
+            result = std::move(rows_);
+            break;
+        case Storage::BOXED: {
+            // Boxed lists convert when they hold only numbers (mixed integers
+            // and floats) or only row vectors of one width
+            bool numbers = std::all_of(boxed_.begin(), boxed_.end(),
+                                       [](const Value& value) { return value.is_numeric(); });
+            if (numbers) {
+                MatrixRow entries;
+                entries.reserve(boxed_.size());
+                for (const Value& value : boxed_) {
+                    entries.push_back(value.to_double());
+                }
+                result.push_back(std::move(entries));
+                break;
+            }
+            for (const Value& value : boxed_) {
+                if (!is_row_vector(value) ||
+                    (!result.empty() && value.as_matrix()[0].size() != result[0].size())) {
+                    throw RuntimeError("to_matrix() requires a list of numbers or equal-width row vectors");
+                }
+                result.push_back(value.as_matrix()[0]);
+            }
+            break;
+        }
+    }
+    
+    integers_ = std::vector<int64_t>();
+    floats_ = MatrixRow();
+    rows_ = Matrix();
+    boxed_ = std::vector<Value>();
+    storage_ = Storage::EMPTY;
+    return Value(std::move(result));
+}
+
+// Dict implementation
+
+Value Dict::normalize_key(const Value& key) {
+    if (key.is_integer() || key.is_string()) {
+        return key;
+    }
+    if (key.is_float() && key.as_float() == std::floor(key.as_float()) &&
+        std::abs(key.as_float()) < 9.2e18) {
+        return Value(static_cast<int64_t>(key.as_float()));
+    }
+    throw RuntimeError("Dictionary keys must be strings or integers");
+}
+
+uint64_t Dict::hash_key(const Value& normalized_key) {
+    if (normalized_key.is_string()) {
+        return std::hash<std::string>{}(normalized_key.as_string());
+    }
+    // splitmix64 finalizer - sequential IDs would otherwise cluster in linear probing
+    uint64_t x = static_cast<uint64_t>(normalized_key.as_integer()) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+namespace {
+
+bool same_key(const Value& a, const Value& b) {
+    if (a.is_string()) {
+        return b.is_string() && a.as_string() == b.as_string();
+    }
+    return b.is_integer() && a.as_integer() == b.as_integer();
+}
+
+} // anonymous namespace
+
+size_t Dict::probe(const Value& key, uint64_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = static_cast<size_t>(hash) & mask;
+    while (slots_[slot] != EMPTY_SLOT) {
+        const Entry& entry = entries_[slots_[slot]];
+        // Erased entries keep their slot as a tombstone so later keys stay reachable
+        if (entry.live && entry.hash == hash && same_key(entry.key, key)) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void Dict::rebuild(size_t capacity) {
+    if (live_ != entries_.size()) {
+        std::vector<Entry> compacted;
+        compacted.reserve(live_);
+        for (auto& entry : entries_) {
+            if (entry.live) compacted.push_back(std::move(entry));
+        }
+        entries_ = std::move(compacted);
+    }
+    
+    slots_.assign(capacity, EMPTY_SLOT);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        size_t slot = static_cast<size_t>(entries_[i].hash) & mask;
+        while (slots_[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = static_cast<int32_t>(i);
+    }
+}
+
+const Value* Dict::find(const Value& key) const {
+    if (live_ == 0) return nullptr;
+    Value normalized = normalize_key(key);
+    size_t slot = probe(normalized, hash_key(normalized));
+    return slots_[slot] == EMPTY_SLOT ? nullptr : &entries_[slots_[slot]].value;
+}
+
+void Dict::set(const Value& key, const Value& value) {
+    Value normalized = normalize_key(key);
+    uint64_t hash = hash_key(normalized);
+    
+    // Keep the table at most two thirds full, counting tombstones
+    if ((entries_.size() + 1) * 3 > slots_.size() * 2) {
+        size_t capacity = 8;
+        while (capacity * 2 < (live_ + 1) * 3) capacity *= 2;
+        rebuild(capacity);
+    }
+    
+    size_t slot = probe(normalized, hash);
+    if (slots_[slot] != EMPTY_SLOT) {
+        entries_[slots_[slot]].value = value;
+        return;
+    }
+    slots_[slot] = static_cast<int32_t>(entries_.size());
+    entries_.push_back(Entry{hash, std::move(normalized), value, true});
+    ++live_;
+}
+
+bool Dict::erase(const Value& key) {
+    if (live_ == 0) return false;
+    Value normalized = normalize_key(key);
+    size_t slot = probe(normalized, hash_key(normalized));
+    if (slots_[slot] == EMPTY_SLOT) return false;
+    
+    Entry& entry = entries_[slots_[slot]];
+    entry.live = false;
+    entry.key = Value();
+    entry.value = Value();
+    --live_;
+    return true;
+}
+
 // Environment implementation
 
 void Environment::define(const std::string& name, const Value& value) {
-    variables_[name] = value;
+    Slot& slot = variables_[name];
+    if (slot) {
+        *slot = value;
+    } else {
+        slot = std::allocate_shared<Value>(PoolAllocator<Value>(), value);
+    }
 }
 
 Value Environment::get(const std::string& name) const {
     auto it = variables_.find(name);
     if (it != variables_.end()) {
-        return it->second;
+        return *it->second;
     }
     
     if (parent_) {
@@ -481,23 +1043,28 @@ Value Environment::get(const std::string& name) const {
 }
 
 void Environment::assign(const std::string& name, const Value& value) {
-    auto it = variables_.find(name);
-    if (it != variables_.end()) {
-        it->second = value;
+    Value* slot = lookup(name);
+    if (slot) {
+        *slot = value;
         return;
     }
     
-    if (parent_) {
-        try {
-            parent_->assign(name, value);
-            return;
-        } catch (const RuntimeError&) {
-            // Fall through to define in current scope
+    // Variable doesn't exist, create it in the outermost scope
+    Environment* root = this;
+    while (root->parent_) {
+        root = root->parent_.get();
+    }
+    root->variables_[name] = std::allocate_shared<Value>(PoolAllocator<Value>(), value);
+}
+
+Value* Environment::lookup(const std::string& name) {
+    for (Environment* env = this; env; env = env->parent_.get()) {
+        auto it = env->variables_.find(name);
+        if (it != env->variables_.end()) {
+            return it->second.get();
         }
     }
-    
-    // Variable doesn't exist, create it in current scope
-    variables_[name] = value;
+    return nullptr;
 }
 
 bool Environment::exists(const std::string& name) const {
@@ -511,6 +1078,121 @@ bool Environment::exists_in_current_scope(const std::string& name) const {
     return variables_.find(name) != variables_.end();
 }
 
+Environment::Slot Environment::find_slot(const std::string& name, const Environment* stop) const {
+    for (const Environment* env = this; env && env != stop; env = env->parent_.get()) {
+        auto it = env->variables_.find(name);
+        if (it != env->variables_.end()) {
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+void Environment::bind(const std::string& name, Slot slot) {
+    variables_[name] = std::move(slot);
+}
+
+// Copies environments, lists, dicts and the closures of user functions so a
+// worker thread owns everything it can write. Shared slots, aliased
+// containers and cycles keep their shape. Matrices and strings are never
+// modified in place and stay shared. Modules are forked, unloaded, for the
+// importer being built.
+class EnvironmentCopier {
+public:
+    Interpreter* importer = nullptr;
+    
+    std::shared_ptr<Module> copy(const std::shared_ptr<Module>& module) {
+        auto known = modules_.find(module.get());
+        if (known != modules_.end()) return known->second;
+        return modules_[module.get()] = module->fork(*importer);
+    }
+    
+    std::shared_ptr<Environment> copy(const std::shared_ptr<Environment>& env) {
+        if (!env) return nullptr;
+        auto known = environments_.find(env.get());
+        if (known != environments_.end()) return known->second;
+        
+        auto result = std::make_shared<Environment>(copy(env->parent_));
+        environments_[env.get()] = result;
+        for (const auto& variable : env->variables_) {
+            result->variables_[variable.first] = copy_slot(variable.second);
+        }
+        return result;
+    }
+    
+    std::shared_ptr<const Function> copy(const std::shared_ptr<const Function>& function) {
+        if (function->native) {
+            // A builtin acts on the interpreter that registered it, so the
+            // importer gets its own
+            if (importer) {
+                auto builtin = importer->builtin_functions_.find(function->name);
+                if (builtin != importer->builtin_functions_.end()) {
+                    return std::make_shared<Function>(function->name, builtin->second);
+                }
+            }
+            return function;
+        }
+        auto known = functions_.find(function.get());
+        if (known != functions_.end()) return known->second;
+        
+        auto result = std::make_shared<Function>(function->name, function->parameters, function->body_node_index, nullptr);
+        functions_[function.get()] = result;
+        result->closure = copy(function->closure);
+        return result;
+    }
+    
+    Value copy(const Value& value) {
+        if (value.is_function()) {
+            return Value(copy(value.function_pointer()));
+        }
+        if (value.is_object() && importer) {
+            if (auto* module = dynamic_cast<Module*>(&value.as_object())) {
+                return Value(std::shared_ptr<Object>(copy(module->shared_from_this())));
+            }
+        }
+        if (!value.is_list() && !value.is_dict()) return value;
+        
+        const void* key = value.is_list() ? static_cast<const void*>(&value.as_list())
+                                          : static_cast<const void*>(&value.as_dict());
+        auto known = containers_.find(key);
+        if (known != containers_.end()) return known->second;
+        
+        if (value.is_list()) {
+            auto list = std::make_shared<List>(value.as_list());
+            containers_[key] = Value(list);
+            if (list->storage() == List::Storage::BOXED) {
+                for (size_t i = 0; i < list->size(); ++i) {
+                    list->set_unchecked(i, copy(list->get_unchecked(i)));
+                }
+            }
+            return containers_[key];
+        }
+        auto dict = std::make_shared<Dict>(value.as_dict());
+        containers_[key] = Value(dict);
+        for (const auto& entry : value.as_dict().entries()) {
+            if (entry.live) dict->set(entry.key, copy(entry.value));
+        }
+        return containers_[key];
+    }
+    
+private:
+    std::unordered_map<const Environment*, std::shared_ptr<Environment>> environments_;
+    std::unordered_map<const Function*, std::shared_ptr<const Function>> functions_;
+    std::unordered_map<const Value*, Environment::Slot> slots_;
+    std::unordered_map<const void*, Value> containers_;
+    std::unordered_map<const Module*, std::shared_ptr<Module>> modules_;
+    
+    Environment::Slot copy_slot(const Environment::Slot& slot) {
+        auto known = slots_.find(slot.get());
+        if (known != slots_.end()) return known->second;
+        
+        auto result = std::allocate_shared<Value>(PoolAllocator<Value>());
+        slots_[slot.get()] = result;
+        *result = copy(*slot);
+        return result;
+    }
+};
+
 // Built-in functions implementation
 
 Value BuiltinFunctions::print(const std::vector<Value>& args) {
@@ -542,9 +1224,15 @@ Value BuiltinFunctions::len(const std::vector<Value>& args) {
         return Value(static_cast<int64_t>(val.as_string().length()));
     } else if (val.is_matrix()) {
         return Value(static_cast<int64_t>(val.as_matrix().size()));
+    } else if (val.is_sparse()) {
+        return Value(static_cast<int64_t>(val.as_sparse().rows));
+    } else if (val.is_list()) {
+        return Value(static_cast<int64_t>(val.as_list().size()));
+    } else if (val.is_dict()) {
+        return Value(static_cast<int64_t>(val.as_dict().size()));
     }
     
-    throw RuntimeError("len() argument must be a string or matrix");
+    throw RuntimeError("len() argument must be a string, matrix, list or dictionary");
 }
 
 Value BuiltinFunctions::abs(const std::vector<Value>& args) {
@@ -557,61 +1245,57 @@ Value BuiltinFunctions::abs(const std::vector<Value>& args) {
         return Value(std::abs(val.as_integer()));
     } else if (val.is_float()) {
         return Value(std::abs(val.as_float()));
+    } else if (val.is_matrix()) {
+        return Value(map_elements(val.as_matrix(), [](double x) { return std::abs(x); }));
     }
     
-    throw RuntimeError("abs() argument must be numeric");
+    throw RuntimeError("abs() argument must be numeric or a matrix");
 }
 
-Value BuiltinFunctions::sqrt(const std::vector<Value>& args) {
+namespace {
+
+// Shared body of the one-argument math builtins; matrices are mapped elementwise
+template <typename Op>
+Value elementwise_math(const std::vector<Value>& args, const char* name, Op op) {
     if (args.size() != 1) {
-        throw RuntimeError("sqrt() takes exactly one argument");
+        throw RuntimeError(std::string(name) + "() takes exactly one argument");
     }
     
     const Value& val = args[0];
+    if (val.is_matrix()) {
+        return Value(map_elements(val.as_matrix(), op));
+    }
     if (!val.is_numeric()) {
-        throw RuntimeError("sqrt() argument must be numeric");
+        throw RuntimeError(std::string(name) + "() argument must be numeric or a matrix");
     }
     
-    return Value(std::sqrt(val.to_double()));
+    return Value(op(val.to_double()));
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::sqrt(const std::vector<Value>& args) {
+    return elementwise_math(args, "sqrt", [](double x) { return std::sqrt(x); });
 }
 
 Value BuiltinFunctions::sin(const std::vector<Value>& args) {
-    if (args.size() != 1) {
-        throw RuntimeError("sin() takes exactly one argument");
-    }
-    
-    const Value& val = args[0];
-    if (!val.is_numeric()) {
-        throw RuntimeError("sin() argument must be numeric");
-    }
-    
-    return Value(std::sin(val.to_double()));
+    return elementwise_math(args, "sin", [](double x) { return std::sin(x); });
 }
 
 Value BuiltinFunctions::cos(const std::vector<Value>& args) {
-    if (args.size() != 1) {
-        throw RuntimeError("cos() takes exactly one argument");
-    }
-    
-    const Value& val = args[0];
-    if (!val.is_numeric()) {
-        throw RuntimeError("cos() argument must be numeric");
-    }
-    
-    return Value(std::cos(val.to_double()));
+    return elementwise_math(args, "cos", [](double x) { return std::cos(x); });
 }
 
 Value BuiltinFunctions::tan(const std::vector<Value>& args) {
-    if (args.size() != 1) {
-        throw RuntimeError("tan() takes exactly one argument");
-    }
-    
-    const Value& val = args[0];
-    if (!val.is_numeric()) {
-        throw RuntimeError("tan() argument must be numeric");
-    }
-    
-    return Value(std::tan(val.to_double()));
+    return elementwise_math(args, "tan", [](double x) { return std::tan(x); });
+}
+
+Value BuiltinFunctions::exp(const std::vector<Value>& args) {
+    return elementwise_math(args, "exp", [](double x) { return std::exp(x); });
+}
+
+Value BuiltinFunctions::log(const std::vector<Value>& args) {
+    return elementwise_math(args, "log", [](double x) { return std::log(x); });
 }
 
 Value BuiltinFunctions::pow(const std::vector<Value>& args) {
@@ -622,6 +1306,11 @@ Value BuiltinFunctions::pow(const std::vector<Value>& args) {
     const Value& base = args[0];
     const Value& exponent = args[1];
     
+    if (base.is_matrix() && exponent.is_numeric()) {
+        double power = exponent.to_double();
+        return Value(map_elements(base.as_matrix(), [power](double x) { return std::pow(x, power); }));
+    }
+    
     if (!base.is_numeric() || !exponent.is_numeric()) {
         throw RuntimeError("pow() arguments must be numeric");
     }
@@ -684,7 +1373,7 @@ Value BuiltinFunctions::zeros(const std::vector<Value>& args) {
         throw RuntimeError("Matrix dimensions must be non-negative");
     }
     
-    std::vector<std::vector<double>> matrix(rows, std::vector<double>(cols, 0.0));
+    Matrix matrix(rows, MatrixRow(cols, 0.0));
     return Value(matrix);
 }
 
@@ -704,7 +1393,7 @@ Value BuiltinFunctions::ones(const std::vector<Value>& args) {
         throw RuntimeError("Matrix dimensions must be non-negative");
     }
     
-    std::vector<std::vector<double>> matrix(rows, std::vector<double>(cols, 1.0));
+    Matrix matrix(rows, MatrixRow(cols, 1.0));
     return Value(matrix);
 }
 
@@ -723,7 +1412,7 @@ Value BuiltinFunctions::eye(const std::vector<Value>& args) {
         throw RuntimeError("Matrix size must be non-negative");
     }
     
-    std::vector<std::vector<double>> matrix(size, std::vector<double>(size, 0.0));
+    Matrix matrix(size, MatrixRow(size, 0.0));
     for (int64_t i = 0; i < size; ++i) {
         matrix[i][i] = 1.0;
     }
@@ -755,9 +1444,517 @@ Value BuiltinFunctions::inverse(const std::vector<Value>& args) {
     return args[0].inverse();
 }
 
-Value BuiltinFunctions::range(const std::vector<Value>& args) {
-    if (args.size() == 1) {
-        // range(n) -> 0 to n-1
+Value BuiltinFunctions::solve(const std::vector<Value>& args) {
+    if (args.size() != 2 && args.size() != 3) {
+        throw RuntimeError("solve() takes two or three arguments (A, b, mode)");
+    }
+    
+    if (!args[0].is_matrix() || !args[1].is_matrix()) {
+        throw RuntimeError("solve() arguments must be matrices");
+    }
+    
+    LinAlg::SolveMode mode = LinAlg::SolveMode::DOUBLE;
+    if (args.size() == 3) {
+        if (!args[2].is_string()) {
+            throw RuntimeError("solve() mode must be a string (\"double\" or \"mixed\")");
+        }
+        const std::string& mode_name = args[2].as_string();
+        if (mode_name == "mixed") {
+            mode = LinAlg::SolveMode::MIXED;
+        } else if (mode_name != "double") {
+            throw RuntimeError("Unknown solve() mode '" + mode_name + "'");
+        }
+    }
+    
+    try {
+        LinAlg::DenseMatrix a = LinAlg::from_nested(args[0].as_matrix());
+        LinAlg::DenseMatrix b = LinAlg::from_nested(args[1].as_matrix());
+        return Value(LinAlg::to_nested(LinAlg::solve(a, b, mode)));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    } catch (const std::domain_error& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+namespace {
+
+// Flattens a row or column vector into a list of values
+std::vector<double> vector_entries(const Value& value, const char* function) {
+    if (!value.is_matrix()) {
+        throw RuntimeError(std::string(function) + "() expects vector arguments");
+    }
+    std::vector<double> entries;
+    for (const auto& row : value.as_matrix()) {
+        entries.insert(entries.end(), row.begin(), row.end());
+    }
+    return entries;
+}
+
+std::vector<int64_t> index_entries(const Value& value, const char* function) {
+    std::vector<int64_t> indices;
+    for (double entry : vector_entries(value, function)) {
+        if (entry != std::floor(entry)) {
+            throw RuntimeError(std::string(function) + "() indices must be integers");
+        }
+        indices.push_back(static_cast<int64_t>(entry));
+    }
+    return indices;
+}
+
+LinAlg::Ordering parse_ordering(const std::vector<Value>& args, size_t position, const char* function) {
+    if (args.size() <= position) {
+        return LinAlg::Ordering::AMD;
+    }
+    if (!args[position].is_string()) {
+        throw RuntimeError(std::string(function) + "() ordering must be a string (\"amd\", \"nd\" or \"natural\")");
+    }
+    const std::string& name = args[position].as_string();
+    if (name == "amd") return LinAlg::Ordering::AMD;
+    if (name == "nd") return LinAlg::Ordering::NESTED_DISSECTION;
+    if (name == "natural") return LinAlg::Ordering::NATURAL;
+    throw RuntimeError("Unknown " + std::string(function) + "() ordering '" + name + "'");
+}
+
+// Shared body of spsolve() and cholsolve()
+template <typename Solver>
+Value sparse_solve(const std::vector<Value>& args, const char* function, Solver solver) {
+    if (args.size() != 2 && args.size() != 3) {
+        throw RuntimeError(std::string(function) + "() takes two or three arguments (S, b, ordering)");
+    }
+    if (!args[0].is_sparse() || !args[1].is_matrix()) {
+        throw RuntimeError(std::string(function) + "() expects a sparse matrix and a dense right-hand side");
+    }
+    LinAlg::Ordering ordering = parse_ordering(args, 2, function);
+    
+    try {
+        LinAlg::DenseMatrix b = LinAlg::from_nested(args[1].as_matrix());
+        return Value(LinAlg::to_nested(solver(args[0].as_sparse(), b, ordering)));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    } catch (const std::domain_error& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::sparse(const std::vector<Value>& args) {
+    try {
+        if (args.size() == 1) {
+            // sparse(A) -> compress a dense matrix
+            if (!args[0].is_matrix()) {
+                throw RuntimeError("sparse() argument must be a matrix");
+            }
+            auto result = std::make_shared<LinAlg::SparseMatrix>(
+                LinAlg::SparseMatrix::from_dense(LinAlg::from_nested(args[0].as_matrix())));
+            return Value(std::shared_ptr<const LinAlg::SparseMatrix>(std::move(result)));
+        } else if (args.size() == 5) {
+            // sparse(i, j, v, m, n) -> triplet form, duplicates are summed
+            if (!args[3].is_integer() || !args[4].is_integer() ||
+                args[3].as_integer() < 0 || args[4].as_integer() < 0) {
+                throw RuntimeError("sparse() dimensions must be non-negative integers");
+            }
+            auto result = std::make_shared<LinAlg::SparseMatrix>(LinAlg::SparseMatrix::from_triplets(
+                static_cast<size_t>(args[3].as_integer()), static_cast<size_t>(args[4].as_integer()),
+                index_entries(args[0], "sparse"), index_entries(args[1], "sparse"),
+                vector_entries(args[2], "sparse")));
+            return Value(std::shared_ptr<const LinAlg::SparseMatrix>(std::move(result)));
+        }
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+    
+    throw RuntimeError("sparse() takes 1 or 5 arguments");
+}
+
+Value BuiltinFunctions::dense(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_sparse()) {
+        throw RuntimeError("dense() takes exactly one sparse matrix");
+    }
+    return Value(LinAlg::to_nested(args[0].as_sparse().to_dense()));
+}
+
+Value BuiltinFunctions::nnz(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_sparse()) {
+        throw RuntimeError("nnz() takes exactly one sparse matrix");
+    }
+    return Value(static_cast<int64_t>(args[0].as_sparse().nnz()));
+}
+
+Value BuiltinFunctions::spsolve(const std::vector<Value>& args) {
+    return sparse_solve(args, "spsolve",
+        [](const LinAlg::SparseMatrix& a, const LinAlg::DenseMatrix& b, LinAlg::Ordering ordering) {
+            return LinAlg::sparse_lu_solve(a, b, ordering);
+        });
+}
+
+Value BuiltinFunctions::cholsolve(const std::vector<Value>& args) {
+    return sparse_solve(args, "cholsolve",
+        [](const LinAlg::SparseMatrix& a, const LinAlg::DenseMatrix& b, LinAlg::Ordering ordering) {
+            return LinAlg::cholesky_solve(a, b, ordering);
+        });
+}
+
+namespace {
+
+// Shared body of the single-argument matrix functions
+template <typename Function>
+Value matrix_function(const std::vector<Value>& args, const char* name, Function function) {
+    if (args.size() != 1 || !args[0].is_matrix()) {
+        throw RuntimeError(std::string(name) + "() takes exactly one matrix argument");
+    }
+    
+    try {
+        return Value(LinAlg::to_nested(function(LinAlg::from_nested(args[0].as_matrix()))));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    } catch (const std::domain_error& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::expm(const std::vector<Value>& args) {
+    return matrix_function(args, "expm", LinAlg::expm);
+}
+
+Value BuiltinFunctions::sqrtm(const std::vector<Value>& args) {
+    return matrix_function(args, "sqrtm", LinAlg::sqrtm);
+}
+
+Value BuiltinFunctions::logm(const std::vector<Value>& args) {
+    return matrix_function(args, "logm", LinAlg::logm);
+}
+
+namespace {
+
+// Shared body of trapz() and simpson(): f(y) or f(x, y)
+template <typename Rule>
+Value sampled_integral(const std::vector<Value>& args, const char* function, Rule rule) {
+    if (args.size() != 1 && args.size() != 2) {
+        throw RuntimeError(std::string(function) + "() takes one or two arguments (x, y)");
+    }
+    
+    std::vector<double> x;
+    std::vector<double> y = vector_entries(args.back(), function);
+    if (args.size() == 2) {
+        x = vector_entries(args[0], function);
+    }
+    
+    try {
+        return Value(rule(x, y));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::trapz(const std::vector<Value>& args) {
+    return sampled_integral(args, "trapz", Quadrature::trapezoid);
+}
+
+Value BuiltinFunctions::simpson(const std::vector<Value>& args) {
+    return sampled_integral(args, "simpson", Quadrature::simpson);
+}
+
+namespace {
+
+// Accumulators are fed batch by batch with accumulate() and read out by the
+// builtin that computes the same statistic in one shot
+class Accumulator : public Object {
+public:
+    // function names the builtin that errors are reported against
+    virtual void add(const LinAlg::DenseMatrix& batch, const char* function) = 0;
+};
+
+class StatsAccumulator : public Accumulator {
+public:
+    Stats::MomentAccumulator moments;
+    
+    explicit StatsAccumulator(Stats::Axis axis) : moments(axis) {}
+    std::string type_name() const override { return "stats accumulator"; }
+    void add(const LinAlg::DenseMatrix& batch, const char* function) override { moments.add(batch, function); }
+};
+
+class HistogramAccumulator : public Accumulator {
+public:
+    Stats::Histogram histogram;
+    
+    HistogramAccumulator(size_t bins, double lo, double hi) : histogram(bins, lo, hi) {}
+    std::string type_name() const override { return "histogram accumulator"; }
+    void add(const LinAlg::DenseMatrix& batch, const char*) override {
+        histogram.add(batch.data.data(), batch.data.size());
+    }
+};
+
+class CovarianceAccumulator : public Accumulator {
+public:
+    Stats::CovarianceAccumulator covariance;
+    
+    std::string type_name() const override { return "cov accumulator"; }
+    void add(const LinAlg::DenseMatrix& batch, const char* function) override { covariance.add(batch, function); }
+};
+
+template <typename T>
+T* accumulator_argument(const Value& value) {
+    return value.is_object() ? dynamic_cast<T*>(&value.as_object()) : nullptr;
+}
+
+// Numbers are accepted as 1x1 batches so scalar results can be streamed in
+LinAlg::DenseMatrix batch_argument(const Value& value, const char* function) {
+    if (value.is_numeric()) {
+        return LinAlg::DenseMatrix(1, 1, value.to_double());
+    }
+    if (!value.is_matrix()) {
+        throw RuntimeError(std::string(function) + "() expects a matrix");
+    }
+    return LinAlg::from_nested(value.as_matrix());
+}
+
+// axis 0 reduces over rows (one result per column), axis 1 over columns
+Stats::Axis axis_argument(const Value& value, const char* function) {
+    if (!value.is_integer() || (value.as_integer() != 0 && value.as_integer() != 1)) {
+        throw RuntimeError(std::string(function) + "() axis must be 0 or 1");
+    }
+    return value.as_integer() == 0 ? Stats::Axis::COLUMNS : Stats::Axis::ROWS;
+}
+
+size_t bins_argument(const Value& value, const char* function) {
+    if (!value.is_integer() || value.as_integer() <= 0) {
+        throw RuntimeError(std::string(function) + "() bins must be a positive integer");
+    }
+    return static_cast<size_t>(value.as_integer());
+}
+
+// Shared body of cov() and corrcoef()
+template <typename OneShot, typename Readout>
+Value covariance_function(const std::vector<Value>& args, const char* function,
+                          OneShot one_shot, Readout readout) {
+    if (args.size() != 1) {
+        throw RuntimeError(std::string(function) + "() takes exactly one argument");
+    }
+    try {
+        if (auto* accumulator = accumulator_argument<CovarianceAccumulator>(args[0])) {
+            return Value(LinAlg::to_nested(readout(accumulator->covariance)));
+        }
+        return Value(LinAlg::to_nested(one_shot(batch_argument(args[0], function))));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::stats(const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2) {
+        throw RuntimeError("stats() takes one or two arguments (A, axis)");
+    }
+    if (auto* accumulator = accumulator_argument<StatsAccumulator>(args[0])) {
+        if (args.size() != 1) {
+            throw RuntimeError("stats() of an accumulator takes no axis");
+        }
+        return Value(LinAlg::to_nested(accumulator->moments.summary()));
+    }
+    
+    Stats::Axis axis = args.size() == 2 ? axis_argument(args[1], "stats") : Stats::Axis::ALL;
+    return Value(LinAlg::to_nested(Stats::stats(batch_argument(args[0], "stats"), axis)));
+}
+
+Value BuiltinFunctions::histogram(const std::vector<Value>& args) {
+    if (args.size() == 1) {
+        if (auto* accumulator = accumulator_argument<HistogramAccumulator>(args[0])) {
+            return Value(LinAlg::to_nested(accumulator->histogram.table()));
+        }
+    }
+    if (args.size() != 2 && args.size() != 4) {
+        throw RuntimeError("histogram() takes (A, bins) or (A, bins, lo, hi)");
+    }
+    
+    LinAlg::DenseMatrix data = batch_argument(args[0], "histogram");
+    size_t bins = bins_argument(args[1], "histogram");
+    try {
+        if (args.size() == 2) {
+            return Value(LinAlg::to_nested(Stats::histogram(data, bins)));
+        }
+        if (!args[2].is_numeric() || !args[3].is_numeric()) {
+            throw RuntimeError("histogram() range must be numeric");
+        }
+        Stats::Histogram result(bins, args[2].to_double(), args[3].to_double());
+        result.add(data.data.data(), data.data.size());
+        return Value(LinAlg::to_nested(result.table()));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+Value BuiltinFunctions::cov(const std::vector<Value>& args) {
+    return covariance_function(args, "cov", Stats::covariance,
+        [](const Stats::CovarianceAccumulator& accumulator) { return accumulator.covariance(); });
+}
+
+Value BuiltinFunctions::corrcoef(const std::vector<Value>& args) {
+    return covariance_function(args, "corrcoef", Stats::correlation,
+        [](const Stats::CovarianceAccumulator& accumulator) { return accumulator.correlation(); });
+}
+
+Value BuiltinFunctions::stats_accumulator(const std::vector<Value>& args) {
+    if (args.size() > 1) {
+        throw RuntimeError("stats_accumulator() takes an optional axis");
+    }
+    Stats::Axis axis = args.empty() ? Stats::Axis::ALL : axis_argument(args[0], "stats_accumulator");
+    return Value(std::shared_ptr<Object>(std::make_shared<StatsAccumulator>(axis)));
+}
+
+Value BuiltinFunctions::histogram_accumulator(const std::vector<Value>& args) {
+    // The range cannot be taken from data that has not arrived yet
+    if (args.size() != 3 || !args[1].is_numeric() || !args[2].is_numeric()) {
+        throw RuntimeError("histogram_accumulator() takes (bins, lo, hi)");
+    }
+    try {
+        return Value(std::shared_ptr<Object>(std::make_shared<HistogramAccumulator>(
+            bins_argument(args[0], "histogram_accumulator"), args[1].to_double(), args[2].to_double())));
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+Value BuiltinFunctions::cov_accumulator(const std::vector<Value>& args) {
+    if (!args.empty()) {
+        throw RuntimeError("cov_accumulator() takes no arguments");
+    }
+    return Value(std::shared_ptr<Object>(std::make_shared<CovarianceAccumulator>()));
+}
+
+Value BuiltinFunctions::accumulate(const std::vector<Value>& args) {
+    if (args.size() != 2) {
+        throw RuntimeError("accumulate() takes two arguments (accumulator, batch)");
+    }
+    auto* accumulator = accumulator_argument<Accumulator>(args[0]);
+    if (!accumulator) {
+        throw RuntimeError("accumulate() first argument must be an accumulator");
+    }
+    try {
+        accumulator->add(batch_argument(args[1], "accumulate"), "accumulate");
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    }
+    return args[0];
+}
+
+Value BuiltinFunctions::list(const std::vector<Value>& args) {
+    auto result = std::allocate_shared<List>(PoolAllocator<List>());
+    for (const Value& arg : args) {
+        result->append(arg);
+    }
+    return Value(std::move(result));
+}
+
+Value BuiltinFunctions::append(const std::vector<Value>& args) {
+    if (args.size() != 2 || !args[0].is_list()) {
+        throw RuntimeError("append() takes a list and a value");
+    }
+    args[0].as_list().append(args[1]);
+    return Value();
+}
+
+Value BuiltinFunctions::pop(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_list()) {
+        throw RuntimeError("pop() takes exactly one list");
+    }
+    return args[0].as_list().pop();
+}
+
+Value BuiltinFunctions::to_matrix(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_list()) {
+        throw RuntimeError("to_matrix() takes exactly one list");
+    }
+    return args[0].as_list().take_matrix();
+}
+
+Value BuiltinFunctions::dict(const std::vector<Value>& args) {
+    if (!args.empty()) {
+        throw RuntimeError("dict() takes no arguments");
+    }
+    return Value(std::allocate_shared<Dict>(PoolAllocator<Dict>()));
+}
+
+Value BuiltinFunctions::keys(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_dict()) {
+        throw RuntimeError("keys() takes exactly one dictionary");
+    }
+    auto result = std::allocate_shared<List>(PoolAllocator<List>());
+    for (const auto& entry : args[0].as_dict().entries()) {
+        if (entry.live) result->append(entry.key);
+    }
+    return Value(std::move(result));
+}
+
+Value BuiltinFunctions::values(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_dict()) {
+        throw RuntimeError("values() takes exactly one dictionary");
+    }
+    auto result = std::allocate_shared<List>(PoolAllocator<List>());
+    for (const auto& entry : args[0].as_dict().entries()) {
+        if (entry.live) result->append(entry.value);
+    }
+    return Value(std::move(result));
+}
+
+Value BuiltinFunctions::remove(const std::vector<Value>& args) {
+    if (args.size() != 2 || !args[0].is_dict()) {
+        throw RuntimeError("remove() takes a dictionary and a key");
+    }
+    return Value(args[0].as_dict().erase(args[1]));
+}
+
+Value BuiltinFunctions::pool_stats(const std::vector<Value>& args) {
+    if (!args.empty()) {
+        throw RuntimeError("pool_stats() takes no arguments");
+    }
+    Pool::Stats stats = Pool::stats();
+    auto result = std::allocate_shared<Dict>(PoolAllocator<Dict>());
+    result->set(Value(std::string("hits")), Value(static_cast<int64_t>(stats.hits)));
+    result->set(Value(std::string("misses")), Value(static_cast<int64_t>(stats.misses)));
+    result->set(Value(std::string("hit_rate")), Value(stats.hit_rate()));
+    result->set(Value(std::string("releases")), Value(static_cast<int64_t>(stats.releases)));
+    result->set(Value(std::string("retained_bytes")), Value(static_cast<int64_t>(stats.retained_bytes)));
+    result->set(Value(std::string("cap_bytes")), Value(static_cast<int64_t>(stats.cap_bytes)));
+    return Value(std::move(result));
+}
+
+namespace {
+
+size_t byte_count(const Value& value, const char* function) {
+    if (!value.is_integer() || value.as_integer() < 0) {
+        throw RuntimeError(std::string(function) + "() takes a non-negative integer byte count");
+    }
+    return static_cast<size_t>(value.as_integer());
+}
+
+} // anonymous namespace
+
+Value BuiltinFunctions::pool_trim(const std::vector<Value>& args) {
+    if (args.size() > 1) {
+        throw RuntimeError("pool_trim() takes at most one argument");
+    }
+    size_t keep = args.empty() ? 0 : byte_count(args[0], "pool_trim");
+    return Value(static_cast<int64_t>(Pool::trim(keep)));
+}
+
+Value BuiltinFunctions::pool_cap(const std::vector<Value>& args) {
+    if (args.size() != 1) {
+        throw RuntimeError("pool_cap() takes exactly one argument");
+    }
+    Pool::set_retained_cap(byte_count(args[0], "pool_cap"));
+    return Value();
+}
+
+Value BuiltinFunctions::range(const std::vector<Value>& args) {
+    if (args.size() == 1) {
+        // range(n) -> 0 to n-1
         if (!args[0].is_integer()) {
             throw RuntimeError("range() argument must be integer");
         }
@@ -767,7 +1964,7 @@ Value BuiltinFunctions::range(const std::vector<Value>& args) {
         }
         
         // Create a matrix where each row contains one integer
-        std::vector<std::vector<double>> result;
+        Matrix result;
         for (int64_t i = 0; i < end; ++i) {
             result.push_back({static_cast<double>(i)});
         }
@@ -780,7 +1977,7 @@ Value BuiltinFunctions::range(const std::vector<Value>& args) {
         int64_t start = args[0].as_integer();
         int64_t end = args[1].as_integer();
         
-        std::vector<std::vector<double>> result;
+        Matrix result;
         if (start <= end) {
             for (int64_t i = start; i < end; ++i) {
                 result.push_back({static_cast<double>(i)});
@@ -800,7 +1997,7 @@ Value BuiltinFunctions::range(const std::vector<Value>& args) {
             throw RuntimeError("range() step argument cannot be zero");
         }
         
-        std::vector<std::vector<double>> result;
+        Matrix result;
         if (step > 0 && start < end) {
             for (int64_t i = start; i < end; i += step) {
                 result.push_back({static_cast<double>(i)});
@@ -819,12 +2016,48 @@ Value BuiltinFunctions::range(const std::vector<Value>& args) {
 // Interpreter implementation
 
 Interpreter::Interpreter(const Parser& parser) 
-    : parser_(parser), global_env_(std::make_shared<Environment>()), current_env_(global_env_) {
+    : parser_(parser), global_env_(std::make_shared<Environment>()), current_env_(global_env_),
+      loop_idioms_enabled_(true), range_analysis_enabled_(true), fuel_(INT64_MAX), slice_(INT64_MAX),
+      spent_(std::make_shared<std::atomic<uint64_t>>(0)), frames_(0), call_depth_(&frames_), statement_(0),
+      resume_statement_(0), builtin_call_(0), output_(&std::cout), errors_(&std::cerr) {
+    register_builtin_functions();
+}
+
+Interpreter::Interpreter(const Interpreter& parent, EnvironmentCopier& copier, std::ostream& output)
+    : parser_(parent.parser_), loop_idioms_(parent.loop_idioms_),
+      loop_idioms_enabled_(parent.loop_idioms_enabled_), bounds_plans_(parent.bounds_plans_),
+      range_analysis_enabled_(parent.range_analysis_enabled_), constant_matrices_(parent.constant_matrices_),
+      fuel_(INT64_MAX), slice_(INT64_MAX), frames_(0), call_depth_(&frames_),
+      statement_(parent.statement_), resume_statement_(0), builtin_call_(0), output_(&output), errors_(parent.errors_) {
+    // Workers run on their own stack but spend the parent's budget
+    share_budget(parent);
+    // Builtins first, so function values naming them are rebound while
+    // copying; modules found while copying are forked for this interpreter
     register_builtin_functions();
+    extern_functions_ = parent.extern_functions_;
+    for (const auto& function : extern_functions_) {
+        builtin_functions_[function.first] = function.second;
+    }
+    copier.importer = this;
+    global_env_ = copier.copy(parent.global_env_);
+    current_env_ = copier.copy(parent.current_env_);
+    for (const auto& function : parent.user_functions_) {
+        user_functions_[function.first] = copier.copy(function.second);
+    }
+    for (const auto& module : parent.modules_) {
+        modules_[module.first] = copier.copy(module.second);
+    }
 }
 
 void Interpreter::register_builtin_functions() {
-    builtin_functions_["print"] = BuiltinFunctions::print;
+    // Builtins that resize or empty a list argument, or run user code that
+    // may; loops calling them keep their bounds checks
+    auto register_mutator = [this](const std::string& name, NativeFunction function) {
+        builtin_functions_[name] = std::move(function);
+        list_mutators_.insert(name);
+    };
+    
+    builtin_functions_["print"] = [this](const std::vector<Value>& args) { return builtin_print(args); };
     builtin_functions_["input"] = BuiltinFunctions::input;
     builtin_functions_["len"] = BuiltinFunctions::len;
     builtin_functions_["abs"] = BuiltinFunctions::abs;
@@ -842,23 +2075,113 @@ void Interpreter::register_builtin_functions() {
     builtin_functions_["transpose"] = BuiltinFunctions::transpose;
     builtin_functions_["determinant"] = BuiltinFunctions::determinant;
     builtin_functions_["inverse"] = BuiltinFunctions::inverse;
+    builtin_functions_["solve"] = BuiltinFunctions::solve;
+    builtin_functions_["sparse"] = BuiltinFunctions::sparse;
+    builtin_functions_["dense"] = BuiltinFunctions::dense;
+    builtin_functions_["nnz"] = BuiltinFunctions::nnz;
+    builtin_functions_["spsolve"] = BuiltinFunctions::spsolve;
+    builtin_functions_["cholsolve"] = BuiltinFunctions::cholsolve;
+    builtin_functions_["expm"] = BuiltinFunctions::expm;
+    builtin_functions_["sqrtm"] = BuiltinFunctions::sqrtm;
+    builtin_functions_["logm"] = BuiltinFunctions::logm;
+    builtin_functions_["exp"] = BuiltinFunctions::exp;
+    builtin_functions_["log"] = BuiltinFunctions::log;
+    builtin_functions_["trapz"] = BuiltinFunctions::trapz;
+    builtin_functions_["simpson"] = BuiltinFunctions::simpson;
+    builtin_functions_["stats"] = BuiltinFunctions::stats;
+    builtin_functions_["histogram"] = BuiltinFunctions::histogram;
+    builtin_functions_["cov"] = BuiltinFunctions::cov;
+    builtin_functions_["corrcoef"] = BuiltinFunctions::corrcoef;
+    builtin_functions_["stats_accumulator"] = BuiltinFunctions::stats_accumulator;
+    builtin_functions_["histogram_accumulator"] = BuiltinFunctions::histogram_accumulator;
+    builtin_functions_["cov_accumulator"] = BuiltinFunctions::cov_accumulator;
+    builtin_functions_["accumulate"] = BuiltinFunctions::accumulate;
+    builtin_functions_["list"] = BuiltinFunctions::list;
+    register_mutator("append", BuiltinFunctions::append);
+    register_mutator("pop", BuiltinFunctions::pop);
+    register_mutator("to_matrix", BuiltinFunctions::to_matrix);
+    builtin_functions_["dict"] = BuiltinFunctions::dict;
+    builtin_functions_["keys"] = BuiltinFunctions::keys;
+    builtin_functions_["values"] = BuiltinFunctions::values;
+    register_mutator("remove", BuiltinFunctions::remove);
+    builtin_functions_["pool_stats"] = BuiltinFunctions::pool_stats;
+    builtin_functions_["pool_trim"] = BuiltinFunctions::pool_trim;
+    builtin_functions_["pool_cap"] = BuiltinFunctions::pool_cap;
+    register_mutator("integrate", [this](const std::vector<Value>& args) { return builtin_integrate(args); });
+    register_mutator("integrate2", [this](const std::vector<Value>& args) { return builtin_integrate2(args); });
+    register_mutator("sweep", [this](const std::vector<Value>& args) { return builtin_sweep(args); });
+    builtin_functions_["checkpoint"] = [this](const std::vector<Value>& args) { return builtin_checkpoint(args); };
     builtin_functions_["range"] = BuiltinFunctions::range;
+    
+    // Plugin functions come last, so they replace builtins of the same name.
+    // Fused loop kernels inline the originals, so a replacement turns them off.
+    for (auto& function : PluginRegistry::instance().functions()) {
+        if (builtin_functions_.count(function.first)) {
+            loop_idioms_enabled_ = false;
+        }
+        builtin_functions_[function.first] = std::move(function.second);
+    }
 }
 
 void Interpreter::interpret() {
     try {
-        // Execute the root program node
-        if (!parser_.get_nodes().empty()) {
-            // Start from node 0 which should be the root
-            execute_statement(0);
-        }
+        execute();
     } catch (const RuntimeError& error) {
         print_runtime_error(error);
+    }
+}
+
+void Interpreter::execute() {
+    const auto& nodes = parser_.get_nodes();
+    link_externs();
+    
+    // Compile everything the program imports up front, a level of the
+    // import graph at a time, rather than one module per import statement
+    std::vector<std::string> imports;
+    for (const auto& node : nodes) {
+        if (node.type != NodeType::IMPORT_STATEMENT) continue;
+        for (uint32_t index : get_child_indices(node.first_child_index)) {
+            imports.push_back(get_node_string(nodes[index].identifier.name_index));
+        }
+    }
+    if (imports.size() > 1) {
+        ModuleCache::instance().prefetch(imports);
+    }
+    
+    try {
+        // Execute the root program node a statement at a time, so a
+        // checkpoint knows where it was taken
+        if (!nodes.empty() && nodes[0].type == NodeType::PROGRAM) {
+            std::vector<uint32_t> statements = get_child_indices(nodes[0].first_child_index);
+            size_t start = resume_statement_;
+            resume_statement_ = 0;
+            for (statement_ = start; statement_ < statements.size(); ++statement_) {
+                execute_statement(statements[statement_]);
+            }
+        } else if (!nodes.empty()) {
+            execute_statement(0);
+        }
     } catch (const ReturnException&) {
         // Return at top level - just ignore
     }
 }
 
+// Bind every extern declaration before the program runs, so a missing
+// library or symbol is reported up front and calls find a ready builtin
+void Interpreter::link_externs() {
+    for (const auto& node : parser_.get_nodes()) {
+        if (node.type != NodeType::EXTERN_DECL) continue;
+        std::string name = get_node_string(node.extern_decl.name_index);
+        NativeFunction function = FFI::bind(get_node_string(node.extern_decl.library_index), name,
+                                            FFI::Signature::parse(parser_.get_strings().get_string(node.extern_decl.signature_index)));
+        extern_functions_[name] = function;
+        if (builtin_functions_.count(name)) {
+            loop_idioms_enabled_ = false;   // As for plugins replacing a builtin
+        }
+        builtin_functions_[name] = std::move(function);
+    }
+}
+
 Value Interpreter::interpret_expression(uint32_t node_index) {
     try {
         return evaluate_node(node_index);
@@ -872,10 +2195,13 @@ Value Interpreter::evaluate_node(uint32_t node_index) {
     if (node_index == 0 || node_index >= parser_.get_nodes().size()) {
         throw RuntimeError("Invalid node index");
     }
+    --fuel_;
     
     const ASTNode& node = parser_.get_nodes()[node_index];
     
+#ifdef DAKOTA_DEBUG_TRACE
     std::cerr << "DEBUG: evaluate_node called on type " << static_cast<int>(node.type) << " at index " << node_index << std::endl;
+#endif
     
     switch (node.type) {
         case NodeType::INTEGER_LITERAL:
@@ -883,6 +2209,10 @@ Value Interpreter::evaluate_node(uint32_t node_index) {
         case NodeType::FLOAT_LITERAL:
             return Value(node.float_literal.value);
         case NodeType::STRING_LITERAL:
+            // The string table does not store empty strings, index 0 is a real entry
+            if (node.string_literal.length == 0) {
+                return Value(std::string());
+            }
             return Value(get_node_string(node.string_literal.string_index));
         case NodeType::BOOLEAN_LITERAL:
             return Value(node.boolean_literal.value);
@@ -898,10 +2228,18 @@ Value Interpreter::evaluate_node(uint32_t node_index) {
             return evaluate_function_call(node);
         case NodeType::MATRIX_LITERAL:
             return evaluate_matrix_literal(node);
+        case NodeType::DICT_LITERAL:
+            return evaluate_dict_literal(node);
         case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS:
+            if (node_index < proven_containers_.size() && proven_containers_[node_index]) {
+                return evaluate_proven_access(node, *proven_containers_[node_index]);
+            }
             return evaluate_matrix_access(node);
         case NodeType::MEMBER_ACCESS:
             return evaluate_member_access(node);
+        case NodeType::METHOD_CALL:
+            return evaluate_method_call(node);
         default:
             throw RuntimeError("Cannot evaluate node type");
     }
@@ -910,8 +2248,11 @@ Value Interpreter::evaluate_node(uint32_t node_index) {
 Value Interpreter::evaluate_binary_op(const ASTNode& node) {
     Value left = evaluate_node(node.binary_op.left_index);
     Value right = evaluate_node(node.binary_op.right_index);
-    
-    switch (node.binary_op.op_type) {
+    return apply_binary_op(node.binary_op.op_type, left, right);
+}
+
+Value Interpreter::apply_binary_op(BinaryOpType op, const Value& left, const Value& right) {
+    switch (op) {
         case BinaryOpType::ADD:
             return left + right;
         case BinaryOpType::SUB:
@@ -940,15 +2281,19 @@ Value Interpreter::evaluate_binary_op(const ASTNode& node) {
             return left.logical_and(right);
         case BinaryOpType::OR:
             return left.logical_or(right);
+        case BinaryOpType::IN:
+            return right.contains(left);
         default:
             throw RuntimeError("Unknown binary operator");
     }
 }
 
 Value Interpreter::evaluate_unary_op(const ASTNode& node) {
-    Value operand = evaluate_node(node.unary_op.operand_index);
-    
-    switch (node.unary_op.op_type) {
+    return apply_unary_op(node.unary_op.op_type, evaluate_node(node.unary_op.operand_index));
+}
+
+Value Interpreter::apply_unary_op(UnaryOpType op, const Value& operand) {
+    switch (op) {
         case UnaryOpType::NEGATE:
             return operand.negate();
         case UnaryOpType::NOT:
@@ -959,79 +2304,852 @@ Value Interpreter::evaluate_unary_op(const ASTNode& node) {
 }
 
 Value Interpreter::evaluate_assignment(const ASTNode& node) {
-    Value value = evaluate_node(node.assignment.value_index);
-    
     const ASTNode& target = parser_.get_nodes()[node.assignment.target_index];
-    if (target.type != NodeType::IDENTIFIER) {
-        throw RuntimeError("Invalid assignment target");
+    if (target.type == NodeType::IDENTIFIER) {
+        std::string name = get_node_string(target.identifier.name_index);
+        Value result;
+        if (append_in_place(node, name, result)) {
+            return result;
+        }
+        result = evaluate_node(node.assignment.value_index);
+        current_env_->assign(name, result);
+        return result;
     }
     
-    std::string name = get_node_string(target.identifier.name_index);
-    current_env_->assign(name, value);
-    
-    return value;
-}
-
-Value Interpreter::evaluate_identifier(const ASTNode& node) {
-    std::string name = get_node_string(node.identifier.name_index);
-    return current_env_->get(name);
+    Value value = evaluate_node(node.assignment.value_index);
+    if (target.type == NodeType::ARRAY_ACCESS) {
+        assign_element(target, value);
+        return value;
+    }
+    throw RuntimeError("Invalid assignment target");
 }
 
-Value Interpreter::evaluate_function_call(const ASTNode& node) {
-    std::string function_name = get_node_string(node.function_call.name_index);
+// s = s + a + b ... on a string appends to the variable's buffer instead of
+// copying it, so building text in a loop is linear rather than quadratic.
+// Anything that could observe the difference takes the ordinary path.
+bool Interpreter::append_in_place(const ASTNode& node, const std::string& name, Value& result) {
+    const auto& nodes = parser_.get_nodes();
     
-    // Collect arguments
-    std::vector<Value> args;
-    std::vector<uint32_t> arg_indices = get_child_indices(node.function_call.args_start_index);
+    // Right operands of the left-leaning '+' chain, whose leftmost leaf must be `name`
+    std::vector<uint32_t> pieces;
+    const ASTNode* current = &nodes[node.assignment.value_index];
+    while (current->type == NodeType::BINARY_OP && current->binary_op.op_type == BinaryOpType::ADD) {
+        pieces.push_back(current->binary_op.right_index);
+        current = &nodes[current->binary_op.left_index];
+    }
+    if (pieces.empty() || current->type != NodeType::IDENTIFIER ||
+        get_node_string(current->identifier.name_index) != name) {
+        return false;
+    }
     
-    for (uint32_t arg_index : arg_indices) {
-        args.push_back(evaluate_node(arg_index));
+    Value* slot = current_env_->lookup(name);
+    if (!slot || !slot->is_string()) {
+        return false;
     }
     
-    // Check for built-in functions first
-    auto builtin_it = builtin_functions_.find(function_name);
-    if (builtin_it != builtin_functions_.end()) {
-        return builtin_it->second(args);
+    // Holding the buffer keeps the original text alive even if a piece rebinds `name`
+    std::shared_ptr<std::string> buffer = slot->string_buffer();
+    const size_t original_length = buffer->size();
+    
+    std::vector<Value> values;
+    values.reserve(pieces.size());
+    for (auto it = pieces.rbegin(); it != pieces.rend(); ++it) {
+        values.push_back(evaluate_node(*it));
+    }
+    
+    // Append only if the variable and this function are the sole owners and
+    // nothing appended to the buffer while the pieces were evaluated
+    slot = current_env_->lookup(name);
+    bool all_strings = std::all_of(values.begin(), values.end(),
+                                   [](const Value& value) { return value.is_string(); });
+    if (all_strings && slot && slot->is_string() && slot->string_buffer() == buffer &&
+        buffer.use_count() == 2 && buffer->size() == original_length) {
+        for (const Value& value : values) {
+            buffer->append(value.as_string());
+        }
+        result = *slot;
+        return true;
+    }
+    
+    // Same left-to-right evaluation as the generic path, on the original text
+    result = Value(buffer->substr(0, original_length));
+    for (const Value& value : values) {
+        result = result + value;
+    }
+    current_env_->assign(name, result);
+    return true;
+}
+
+// xs[i] = value or d[key] = value - lists and dictionaries are shared by
+// reference, so updating in place is visible through every name bound to them
+void Interpreter::assign_element(const ASTNode& target, const Value& value) {
+    size_t target_index = static_cast<size_t>(&target - parser_.get_nodes().data());
+    if (target_index < proven_containers_.size() && proven_containers_[target_index]) {
+        size_t index = static_cast<size_t>(evaluate_node(target.array_access.index_index).as_integer());
+        proven_containers_[target_index]->as_list().set_unchecked(index, value);
+        return;
+    }
+    
+    Value container = evaluate_node(target.array_access.object_index);
+    Value index_value = evaluate_node(target.array_access.index_index);
+    
+    if (container.is_dict()) {
+        container.as_dict().set(index_value, value);
+        return;
+    }
+    if (!container.is_list()) {
+        throw RuntimeError("Indexed assignment is only supported on lists and dictionaries");
+    }
+    if (!index_value.is_integer() || index_value.as_integer() < 0) {
+        throw RuntimeError("List index must be a non-negative integer");
+    }
+    container.as_list().set(static_cast<size_t>(index_value.as_integer()), value);
+}
+
+Value Interpreter::evaluate_identifier(const ASTNode& node) {
+    std::string name = get_node_string(node.identifier.name_index);
+    if (current_env_->exists(name)) {
+        Value value = current_env_->get(name);
+        // Host arrays bound with wrap_array() read as matrices
+        if (value.is_object()) {
+            if (auto* array = dynamic_cast<const ExternalArray*>(&value.as_object())) {
+                return Value(array->matrix());
+            }
+        }
+        return value;
+    }
+    
+    // Functions can be passed by name, e.g. integrate(f, 0, 1)
+    auto user_it = user_functions_.find(name);
+    if (user_it != user_functions_.end()) {
+        return Value(user_it->second);
+    }
+    auto builtin_it = builtin_functions_.find(name);
+    if (builtin_it != builtin_functions_.end()) {
+        return Value(std::shared_ptr<const Function>(std::make_shared<Function>(name, builtin_it->second)));
+    }
+    
+    return current_env_->get(name); // Reports the undefined variable
+}
+
+Value Interpreter::evaluate_function_call(const ASTNode& node) {
+    std::string function_name = get_node_string(node.function_call.name_index);
+    
+    // Collect arguments
+    std::vector<Value> args;
+    std::vector<uint32_t> arg_indices = get_child_indices(node.function_call.args_start_index);
+    
+    for (uint32_t arg_index : arg_indices) {
+        args.push_back(evaluate_node(arg_index));
+    }
+    
+    // Check for built-in functions first
+    auto builtin_it = builtin_functions_.find(function_name);
+    if (builtin_it != builtin_functions_.end()) {
+        builtin_call_ = static_cast<uint32_t>(&node - parser_.get_nodes().data());
+        return builtin_it->second(args);
     }
     
     // Check for user-defined functions
     auto user_it = user_functions_.find(function_name);
     if (user_it != user_functions_.end()) {
-        const Function& func = user_it->second;
-        
-        if (args.size() != func.parameters.size()) {
-            throw RuntimeError("Function '" + function_name + "' expects " + 
-                             std::to_string(func.parameters.size()) + " arguments, got " +
-                             std::to_string(args.size()));
+        return call_function(Value(user_it->second), args);
+    }
+    
+    // Finally, a variable holding a function value
+    if (current_env_->exists(function_name)) {
+        Value callee = current_env_->get(function_name);
+        if (callee.is_function()) {
+            return call_function(callee, args);
         }
-        
-        // Create new environment for function execution
-        auto func_env = std::make_shared<Environment>(func.closure);
-        
-        // Bind parameters to arguments
-        for (size_t i = 0; i < func.parameters.size(); ++i) {
-            func_env->define(func.parameters[i], args[i]);
+    }
+    
+    throw RuntimeError("Undefined function '" + function_name + "'");
+}
+
+Value Interpreter::call_function(const Value& function, const std::vector<Value>& args) {
+    const Function& func = function.as_function();
+    if (func.native) {
+        builtin_call_ = 0;
+        return func.native(args);
+    }
+    
+    if (args.size() != func.parameters.size()) {
+        throw RuntimeError("Function '" + func.name + "' expects " + 
+                         std::to_string(func.parameters.size()) + " arguments, got " +
+                         std::to_string(args.size()));
+    }
+    check_budget();
+    if (*call_depth_ >= MAX_CALL_DEPTH) {
+        throw RuntimeError("Maximum call depth of " + std::to_string(MAX_CALL_DEPTH) + " exceeded");
+    }
+    
+    // Create new environment for function execution
+    auto func_env = std::make_shared<Environment>(func.closure);
+    
+    // Bind parameters to arguments
+    for (size_t i = 0; i < func.parameters.size(); ++i) {
+        func_env->define(func.parameters[i], args[i]);
+    }
+    
+    // Execute function body
+    auto previous_env = current_env_;
+    current_env_ = func_env;
+    ++*call_depth_;
+    
+    try {
+        // A body that is just `return expr` needs no ReturnException
+        const ASTNode& body = parser_.get_nodes()[func.body_node_index];
+        if (body.type == NodeType::BLOCK && body.first_child_index < parser_.get_nodes().size()) {
+            const ASTNode& statement = parser_.get_nodes()[body.first_child_index];
+            if (statement.type == NodeType::RETURN_STATEMENT && statement.return_statement.value_index != 0 &&
+                (statement.next_sibling_index == 0 || statement.next_sibling_index >= parser_.get_nodes().size())) {
+                Value result = evaluate_node(statement.return_statement.value_index);
+                current_env_ = previous_env;
+                --*call_depth_;
+                return result;
+            }
         }
-        
-        // Execute function body
-        auto previous_env = current_env_;
-        current_env_ = func_env;
-        
+        execute_statement(func.body_node_index);
+        current_env_ = previous_env;
+        --*call_depth_;
+        return Value(); // No explicit return
+    } catch (const ReturnException& ret) {
+        current_env_ = previous_env;
+        --*call_depth_;
+        return ret.get_value();
+    } catch (...) {
+        // Callers such as integrate() may recover from errors, so the scope must be restored
+        current_env_ = previous_env;
+        --*call_depth_;
+        throw;
+    }
+}
+
+namespace {
+
+void append_numeric(const Value& value, std::vector<double>& results) {
+    if (value.is_numeric()) {
+        results.push_back(value.to_double());
+    } else if (value.is_matrix() && value.as_matrix().size() == 1 && value.as_matrix()[0].size() == 1) {
+        results.push_back(value.as_matrix()[0][0]);
+    } else {
+        throw RuntimeError("Integrand must return a number");
+    }
+}
+
+// Column vector holding one coordinate of every point in a batch
+Value column_vector(const std::vector<double>& values) {
+    Matrix column(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        column[i].assign(1, values[i]);
+    }
+    return Value(column);
+}
+
+double tolerance_argument(const std::vector<Value>& args, size_t position, const char* function) {
+    if (args.size() <= position) {
+        return Quadrature::DEFAULT_ABS_TOLERANCE;
+    }
+    if (!args[position].is_numeric() || args[position].to_double() <= 0.0) {
+        throw RuntimeError(std::string(function) + "() tolerance must be a positive number");
+    }
+    return args[position].to_double();
+}
+
+} // anonymous namespace
+
+void Interpreter::evaluate_batch(const Value& function, const std::vector<const std::vector<double>*>& arguments,
+                                 std::vector<double>& results, BatchMode& mode) {
+    const size_t count = arguments[0]->size();
+    results.clear();
+    results.reserve(count);
+    
+    // Decided once, before the integrand first runs, so no point is
+    // evaluated twice and its own errors surface unchanged
+    if (mode == BatchMode::UNKNOWN) {
+        mode = elementwise_function(function.as_function()) ? BatchMode::VECTOR : BatchMode::SCALAR;
+    }
+    
+    // One call with every point as a column vector, which an elementwise
+    // integrand returns a column of the same length for
+    if (mode == BatchMode::VECTOR) {
+        std::vector<Value> vector_args;
+        for (const auto* column : arguments) {
+            vector_args.push_back(column_vector(*column));
+        }
+        Value output = call_function(function, vector_args);
+        if (count == 1 && output.is_numeric()) {
+            results.push_back(output.to_double());
+            return;
+        }
+        if (!output.is_matrix() || output.as_matrix().size() != count) {
+            throw RuntimeError("Integrand returned the wrong shape for vector input");
+        }
+        for (const auto& row : output.as_matrix()) {
+            if (row.size() != 1) {
+                throw RuntimeError("Integrand returned the wrong shape for vector input");
+            }
+            results.push_back(row[0]);
+        }
+        return;
+    }
+    
+    std::vector<Value> point_args(arguments.size());
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t a = 0; a < arguments.size(); ++a) {
+            point_args[a] = Value((*arguments[a])[i]);
+        }
+        append_numeric(call_function(function, point_args), results);
+    }
+}
+
+Value Interpreter::builtin_print(const std::vector<Value>& args) {
+    std::ostream& out = *output_;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i > 0) out << " ";
+        out << args[i].to_string();
+    }
+    out << std::endl;
+    return Value(); // None
+}
+
+Value Interpreter::builtin_integrate(const std::vector<Value>& args) {
+    if (args.size() != 3 && args.size() != 4) {
+        throw RuntimeError("integrate() takes three or four arguments (f, a, b, tolerance)");
+    }
+    if (!args[0].is_function()) {
+        throw RuntimeError("integrate() first argument must be a function");
+    }
+    if (!args[1].is_numeric() || !args[2].is_numeric()) {
+        throw RuntimeError("integrate() limits must be numeric");
+    }
+    double tolerance = tolerance_argument(args, 3, "integrate");
+    
+    BatchMode mode = BatchMode::UNKNOWN;
+    Quadrature::BatchIntegrand integrand = [&](const std::vector<double>& x, std::vector<double>& fx) {
+        evaluate_batch(args[0], {&x}, fx, mode);
+    };
+    
+    try {
+        Quadrature::Result result = Quadrature::gauss_kronrod(integrand, args[1].to_double(), args[2].to_double(),
+                                                              tolerance, tolerance);
+        if (!result.converged) {
+            throw RuntimeError("integrate() did not reach the requested tolerance (error estimate " +
+                               std::to_string(result.error) + ")");
+        }
+        return Value(result.value);
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    } catch (const std::domain_error& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+Value Interpreter::builtin_integrate2(const std::vector<Value>& args) {
+    if (args.size() != 5 && args.size() != 6) {
+        throw RuntimeError("integrate2() takes five or six arguments (f, ax, bx, ay, by, tolerance)");
+    }
+    if (!args[0].is_function()) {
+        throw RuntimeError("integrate2() first argument must be a function");
+    }
+    for (size_t i = 1; i < 5; ++i) {
+        if (!args[i].is_numeric()) {
+            throw RuntimeError("integrate2() limits must be numeric");
+        }
+    }
+    double tolerance = tolerance_argument(args, 5, "integrate2");
+    
+    BatchMode mode = BatchMode::UNKNOWN;
+    Quadrature::BatchIntegrand2D integrand = [&](const std::vector<double>& x, const std::vector<double>& y,
+                                                 std::vector<double>& fxy) {
+        evaluate_batch(args[0], {&x, &y}, fxy, mode);
+    };
+    
+    try {
+        Quadrature::Result result = Quadrature::cubature(integrand, args[1].to_double(), args[2].to_double(),
+                                                         args[3].to_double(), args[4].to_double(),
+                                                         tolerance, tolerance);
+        if (!result.converged) {
+            throw RuntimeError("integrate2() did not reach the requested tolerance (error estimate " +
+                               std::to_string(result.error) + ")");
+        }
+        return Value(result.value);
+    } catch (const std::invalid_argument& e) {
+        throw RuntimeError(e.what());
+    } catch (const std::domain_error& e) {
+        throw RuntimeError(e.what());
+    }
+}
+
+namespace {
+
+// Points of one sweep() axis: a number, or the elements of a matrix or numeric list
+std::vector<double> sweep_grid(const Value& grid, size_t position) {
+    std::vector<double> points;
+    if (grid.is_numeric()) {
+        points.push_back(grid.to_double());
+    } else if (grid.is_matrix()) {
+        for (const auto& row : grid.as_matrix()) {
+            points.insert(points.end(), row.begin(), row.end());
+        }
+    } else if (grid.is_list()) {
+        const List& list = grid.as_list();
+        points.reserve(list.size());
+        for (size_t i = 0; i < list.size(); ++i) {
+            Value point = list.get_unchecked(i);
+            if (!point.is_numeric()) {
+                throw RuntimeError("sweep() grid " + std::to_string(position) + " must hold only numbers");
+            }
+            points.push_back(point.to_double());
+        }
+    } else {
+        throw RuntimeError("sweep() grid " + std::to_string(position) + " must be a number, matrix or list");
+    }
+    if (points.empty()) {
+        throw RuntimeError("sweep() grid " + std::to_string(position) + " is empty");
+    }
+    return points;
+}
+
+// Results for axes level.. of a row-major block: a matrix for the last two
+// axes (a row vector for a single axis), nested lists above that
+Value sweep_result(const std::vector<double>& values, const std::vector<size_t>& sizes,
+                   const std::vector<size_t>& strides, size_t level, size_t offset) {
+    if (sizes.size() - level <= 2) {
+        size_t rows = sizes.size() - level == 2 ? sizes[level] : 1;
+        size_t cols = sizes.back();
+        Matrix matrix;
+        matrix.reserve(rows);
+        for (size_t row = 0; row < rows; ++row) {
+            const double* start = values.data() + offset + row * cols;
+            matrix.emplace_back(start, start + cols);
+        }
+        return Value(std::move(matrix));
+    }
+    auto list = std::make_shared<List>();
+    list->reserve(sizes[level]);
+    for (size_t k = 0; k < sizes[level]; ++k) {
+        list->append(sweep_result(values, sizes, strides, level + 1, offset + k * strides[level]));
+    }
+    return Value(list);
+}
+
+} // anonymous namespace
+
+Value Interpreter::builtin_sweep(const std::vector<Value>& args) {
+    // sweep(f, grid1, ..., gridN) or sweep(f, grid1, ..., gridN, "checkpoint path")
+    std::string checkpoint;
+    size_t grid_end = args.size();
+    if (grid_end > 0 && args.back().is_string()) {
+        checkpoint = args.back().as_string();
+        --grid_end;
+    }
+    if (grid_end < 2) {
+        throw RuntimeError("sweep() takes a function, one or more grids and an optional checkpoint path");
+    }
+    if (!args[0].is_function()) {
+        throw RuntimeError("sweep() first argument must be a function");
+    }
+    const Function& function = args[0].as_function();
+    if (function.native && !is_builtin(function.name)) {
+        // Module functions and the like run in another interpreter, shared with this thread
+        throw RuntimeError("sweep() function '" + function.name + "' must be a user function or a builtin");
+    }
+    const size_t axes = grid_end - 1;
+    if (!function.native && function.parameters.size() != axes) {
+        throw RuntimeError("sweep() function '" + function.name + "' takes " +
+                           std::to_string(function.parameters.size()) + " arguments, got " +
+                           std::to_string(axes) + " grids");
+    }
+    
+    std::vector<std::vector<double>> grids;
+    std::vector<size_t> sizes;
+    size_t total = 1;
+    for (size_t k = 1; k < grid_end; ++k) {
+        grids.push_back(sweep_grid(args[k], k));
+        sizes.push_back(grids.back().size());
+        if (total > std::numeric_limits<size_t>::max() / sizes.back()) {
+            throw RuntimeError("sweep() grid is too large");
+        }
+        total *= sizes.back();
+    }
+    std::vector<size_t> strides(axes, 1);
+    for (size_t k = axes - 1; k > 0; --k) {
+        strides[k - 1] = strides[k] * sizes[k];
+    }
+    
+    Sweep::Progress progress(total, Sweep::fingerprint(function.name, function.native ? 0 : function_fingerprint(function),
+                                                       grids));
+    std::mutex checkpoint_mutex;
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    auto save_checkpoint = [&]() {
+        try {
+            progress.save(checkpoint);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(std::string("sweep(): ") + e.what());
+        }
+    };
+    if (!checkpoint.empty()) {
         try {
-            execute_statement(func.body_node_index);
-            current_env_ = previous_env;
-            return Value(); // No explicit return
-        } catch (const ReturnException& ret) {
-            current_env_ = previous_env;
-            return ret.get_value();
+            progress.load(checkpoint);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(std::string("sweep(): ") + e.what());
         }
     }
     
-    throw RuntimeError("Undefined function '" + function_name + "'");
+    // Each worker evaluates whole chunks in its own interpreter; print()
+    // output is buffered per worker and written out in worker order
+    unsigned threads = static_cast<unsigned>(std::min<size_t>(hardware_threads(), progress.chunk_count()));
+    std::vector<std::ostringstream> outputs(threads);
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> failed(false);
+    
+    auto worker = [&](size_t index) {
+        EnvironmentCopier copier;
+        Interpreter isolated(*this, copier, outputs[index]);
+        Value callee = copier.copy(args[0]);
+        std::vector<Value> point(axes);
+        try {
+            for (size_t chunk = next_chunk++; chunk < progress.chunk_count() && !failed.load(); chunk = next_chunk++) {
+                if (progress.is_done(chunk)) continue;
+                for (size_t i = progress.chunk_begin(chunk); i < progress.chunk_end(chunk); ++i) {
+                    for (size_t k = 0, rest = i; k < axes; ++k) {
+                        point[k] = Value(grids[k][rest / strides[k]]);
+                        rest %= strides[k];
+                    }
+                    Value result = isolated.call_function(callee, point);
+                    if (result.is_numeric()) {
+                        progress.values()[i] = result.to_double();
+                    } else if (result.is_matrix() && result.as_matrix().size() == 1 && result.as_matrix()[0].size() == 1) {
+                        progress.values()[i] = result.as_matrix()[0][0];
+                    } else {
+                        throw RuntimeError("sweep() function must return a number");
+                    }
+                }
+                progress.mark_done(chunk);
+                
+                if (!checkpoint.empty()) {
+                    std::unique_lock<std::mutex> lock(checkpoint_mutex, std::try_to_lock);
+                    auto now = std::chrono::steady_clock::now();
+                    if (lock.owns_lock() &&
+                        std::chrono::duration<double>(now - last_checkpoint).count() >= Sweep::CHECKPOINT_SECONDS) {
+                        save_checkpoint();
+                        last_checkpoint = now;
+                    }
+                }
+            }
+        } catch (...) {
+            failed.store(true);
+            throw;
+        }
+    };
+    
+    try {
+        parallel_for(threads, worker, threads);
+    } catch (...) {
+        for (const auto& output : outputs) {
+            *output_ << output.str();
+        }
+        // Keep what finished so a rerun resumes after the failure
+        if (!checkpoint.empty()) {
+            try {
+                progress.save(checkpoint);
+            } catch (const std::runtime_error&) {
+                // The error that stopped the sweep is the one to report
+            }
+        }
+        throw;
+    }
+    for (const auto& output : outputs) {
+        *output_ << output.str();
+    }
+    if (!checkpoint.empty()) {
+        std::remove(checkpoint.c_str());
+    }
+    
+    return sweep_result(progress.results(), sizes, strides, 0, 0);
+}
+
+namespace {
+
+// Whether the statement at index runs call last: as the statement itself, the
+// last statement of a block, or the last one of either branch of an if
+bool ends_with_call(const Parser& parser, uint32_t index, uint32_t call) {
+    const auto& nodes = parser.get_nodes();
+    if (index == 0 || index >= nodes.size()) {
+        return false;
+    }
+    const ASTNode& node = nodes[index];
+    switch (node.type) {
+        case NodeType::EXPRESSION_STATEMENT:
+            return node.first_child_index == call;
+        case NodeType::BLOCK: {
+            uint32_t last = 0;
+            for (uint32_t child = node.first_child_index; child != 0 && child < nodes.size();
+                 child = nodes[child].next_sibling_index) {
+                last = child;
+            }
+            return ends_with_call(parser, last, call);
+        }
+        case NodeType::IF_STATEMENT:
+            return ends_with_call(parser, node.if_statement.then_block_index, call) ||
+                   ends_with_call(parser, node.if_statement.else_block_index, call);
+        default:
+            return false;
+    }
+}
+
+} // anonymous namespace
+
+// A restored run starts over at the top-level statement that was running, so
+// checkpoint() is only allowed where nothing of that statement is left to do or
+// would be done twice: as a top-level statement of its own, or last in the body
+// of a top-level while loop, which then goes on with its next iteration
+Value Interpreter::builtin_checkpoint(const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].is_string()) {
+        throw RuntimeError("checkpoint() takes a snapshot path");
+    }
+    if (*call_depth_ > 0) {
+        throw RuntimeError("checkpoint() cannot be called inside a function");
+    }
+    const auto& nodes = parser_.get_nodes();
+    bool resumable = false;
+    if (builtin_call_ != 0 && !nodes.empty() && nodes[0].type == NodeType::PROGRAM) {
+        std::vector<uint32_t> statements = get_child_indices(nodes[0].first_child_index);
+        if (statement_ < statements.size()) {
+            const ASTNode& top = nodes[statements[statement_]];
+            resumable = top.type == NodeType::WHILE_STATEMENT
+                ? ends_with_call(parser_, top.while_statement.body_index, builtin_call_)
+                : top.type == NodeType::EXPRESSION_STATEMENT && top.first_child_index == builtin_call_;
+        }
+    }
+    if (!resumable) {
+        throw RuntimeError("checkpoint() must be a top-level statement or the last statement of a top-level while loop");
+    }
+    Snapshot::State state;
+    state.program = program_fingerprint();
+    state.statement = statement_;
+    state.globals = global_env_;
+    state.functions.assign(user_functions_.begin(), user_functions_.end());
+    Snapshot::save(args[0].as_string(), state, [this](const std::string& name) { return is_builtin(name); });
+    return Value();
+}
+
+uint64_t Interpreter::program_fingerprint() const {
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+    uint64_t hash = FNV_OFFSET;
+    auto mix = [&hash](uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            hash = (hash ^ ((value >> shift) & 0xff)) * FNV_PRIME;
+        }
+    };
+    for (const auto& node : parser_.get_nodes()) {
+        mix(static_cast<uint64_t>(node.type));
+        mix(node.first_child_index);
+        mix(node.next_sibling_index);
+    }
+    const StringTable& strings = parser_.get_strings();
+    for (size_t k = 0; k < strings.get_string_count(); ++k) {
+        for (char c : strings.get_string(static_cast<uint32_t>(k))) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+        }
+        mix(k);
+    }
+    return hash;
+}
+
+uint64_t Interpreter::function_fingerprint(const Function& function) const {
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+    uint64_t hash = FNV_OFFSET;
+    auto mix = [&hash](uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            hash = (hash ^ ((value >> shift) & 0xff)) * FNV_PRIME;
+        }
+    };
+    auto mix_string = [&hash, &mix](std::string_view text) {
+        for (char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+        }
+        mix(text.size());
+    };
+    for (const auto& parameter : function.parameters) {
+        mix_string(parameter);
+    }
+    
+    // Preorder, with each node's child count, so the walk determines the shape
+    const auto& nodes = parser_.get_nodes();
+    const StringTable& strings = parser_.get_strings();
+    std::vector<uint32_t> pending = {function.body_node_index};
+    while (!pending.empty()) {
+        uint32_t index = pending.back();
+        pending.pop_back();
+        if (index == 0 || index >= nodes.size()) continue;
+        const ASTNode& node = nodes[index];
+        mix(static_cast<uint64_t>(node.type));
+        switch (node.type) {
+            case NodeType::INTEGER_LITERAL:
+                mix(static_cast<uint64_t>(node.integer_literal.value));
+                break;
+            case NodeType::FLOAT_LITERAL: {
+                uint64_t bits;
+                std::memcpy(&bits, &node.float_literal.value, sizeof(bits));
+                mix(bits);
+                break;
+            }
+            case NodeType::BOOLEAN_LITERAL:
+                mix(node.boolean_literal.value);
+                break;
+            case NodeType::STRING_LITERAL:
+                mix_string(strings.get_string(node.string_literal.string_index));
+                break;
+            case NodeType::IDENTIFIER:
+                mix_string(strings.get_string(node.identifier.name_index));
+                break;
+            case NodeType::BINARY_OP:
+                mix(static_cast<uint64_t>(node.binary_op.op_type));
+                break;
+            case NodeType::UNARY_OP:
+                mix(static_cast<uint64_t>(node.unary_op.op_type));
+                break;
+            case NodeType::FUNCTION_CALL:
+                mix_string(strings.get_string(node.function_call.name_index));
+                break;
+            case NodeType::METHOD_CALL:
+                mix_string(strings.get_string(node.method_call.name_index));
+                break;
+            case NodeType::MEMBER_ACCESS:
+                mix_string(strings.get_string(node.member_access.member_name_index));
+                break;
+            case NodeType::MATRIX_LITERAL: {
+                mix(node.matrix_literal.rows);
+                mix(node.matrix_literal.cols);
+                const double* values = parser_.get_constants().get_matrix(index);
+                if (node.matrix_literal.is_constant && values) {
+                    for (size_t k = 0; k < static_cast<size_t>(node.matrix_literal.rows) * node.matrix_literal.cols; ++k) {
+                        uint64_t bits;
+                        std::memcpy(&bits, &values[k], sizeof(bits));
+                        mix(bits);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        std::vector<uint32_t> children = parser_.get_child_nodes(index);
+        mix(children.size());
+        pending.insert(pending.end(), children.rbegin(), children.rend());
+    }
+    return hash;
+}
+
+void Interpreter::restore(const std::string& path) {
+    Snapshot::Resolver resolver;
+    resolver.builtin = [this](const std::string& name) {
+        auto builtin = builtin_functions_.find(name);
+        if (builtin == builtin_functions_.end()) {
+            throw RuntimeError("Snapshot refers to unknown builtin '" + name + "'");
+        }
+        return builtin->second;
+    };
+    resolver.module = [this](const std::string& name) {
+        auto known = modules_.find(name);
+        if (known == modules_.end()) {
+            known = modules_.emplace(name, std::make_shared<Module>(name, ModuleCache::instance().load(name), *this)).first;
+        }
+        return known->second;
+    };
+    resolver.node_count = parser_.get_nodes().size();
+    
+    link_externs();   // Extern functions saved as values resolve like builtins
+    Snapshot::State state = Snapshot::load(path, program_fingerprint(), resolver);
+    global_env_ = current_env_ = state.globals;
+    user_functions_.clear();
+    for (auto& function : state.functions) {
+        user_functions_[function.first] = std::move(function.second);
+    }
+    resume_statement_ = state.statement;
+}
+
+void Interpreter::set_budget(const ExecutionBudget& budget) {
+    budget_ = budget;
+    spent_->store(0);
+    exhausted_.clear();
+    deadline_ = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(budget.max_seconds));
+    start_slice();
+}
+
+void Interpreter::share_budget(const Interpreter& owner) {
+    budget_ = owner.budget_;
+    spent_ = owner.spent_;
+    deadline_ = owner.deadline_;
+    exhausted_.clear();
+    start_slice();
+}
+
+void Interpreter::run_for(Interpreter& importer) {
+    share_budget(importer);
+    call_depth_ = importer.call_depth_;
+}
+
+void Interpreter::start_slice() {
+    if (budget_.unlimited()) {
+        fuel_ = slice_ = INT64_MAX;
+        return;
+    }
+    // Others sharing the budget may already have spent it all
+    uint64_t slice = budget_.slice_steps ? budget_.slice_steps : BUDGET_SLICE_STEPS;
+    if (budget_.max_steps) slice = std::min(slice, budget_.max_steps - std::min(budget_.max_steps, spent_->load()));
+    fuel_ = slice_ = static_cast<int64_t>(slice);
+}
+
+void Interpreter::refuel() {
+    uint64_t spent = *spent_ += static_cast<uint64_t>(slice_ - fuel_);
+    fuel_ = slice_ = 0;
+    if (exhausted_.empty()) {
+        if (budget_.max_steps && spent >= budget_.max_steps) {
+            exhausted_ = "Execution budget of " + std::to_string(budget_.max_steps) + " steps exceeded";
+        } else if (budget_.max_seconds > 0.0 && std::chrono::steady_clock::now() >= deadline_) {
+            std::ostringstream message;
+            message << "Execution time limit of " << budget_.max_seconds << " s exceeded";
+            exhausted_ = message.str();
+        } else if (budget_.on_slice && !budget_.on_slice()) {
+            exhausted_ = "Execution cancelled";
+        }
+    }
+    if (!exhausted_.empty()) {
+        throw BudgetExceeded(exhausted_);
+    }
+    start_slice();
 }
 
 Value Interpreter::evaluate_matrix_literal(const ASTNode& node) {
-    std::vector<std::vector<double>> matrix;
+    if (node.matrix_literal.is_constant) {
+        uint32_t node_index = static_cast<uint32_t>(&node - parser_.get_nodes().data());
+        auto cached = constant_matrices_.find(node_index);
+        if (cached != constant_matrices_.end()) {
+            return cached->second;
+        }
+        
+        const double* values = parser_.get_constants().get_matrix(node_index);
+        if (!values) {
+            throw RuntimeError("Missing constant data for matrix literal");
+        }
+        Matrix matrix;
+        matrix.reserve(node.matrix_literal.rows);
+        for (uint32_t row = 0; row < node.matrix_literal.rows; ++row) {
+            const double* start = values + static_cast<size_t>(row) * node.matrix_literal.cols;
+            matrix.emplace_back(start, start + node.matrix_literal.cols);
+        }
+        return constant_matrices_.emplace(node_index, Value(std::move(matrix))).first->second;
+    }
+    
+    Matrix matrix;
     
     // Use elements_start_index instead of first_child_index for matrix literals
     std::vector<uint32_t> element_indices = get_child_indices(node.matrix_literal.elements_start_index);
@@ -1046,7 +3164,7 @@ Value Interpreter::evaluate_matrix_literal(const ASTNode& node) {
     // Process elements row by row
     size_t element_idx = 0;
     for (uint32_t row = 0; row < node.matrix_literal.rows; ++row) {
-        std::vector<double> matrix_row;
+        MatrixRow matrix_row;
         for (uint32_t col = 0; col < node.matrix_literal.cols; ++col) {
             if (element_idx >= element_indices.size()) {
                 throw RuntimeError("Not enough elements for matrix");
@@ -1059,119 +3177,1087 @@ Value Interpreter::evaluate_matrix_literal(const ASTNode& node) {
             matrix_row.push_back(element_value.to_double());
             element_idx++;
         }
-        matrix.push_back(matrix_row);
+        matrix.push_back(matrix_row);
+    }
+    
+    return Value(matrix);
+}
+
+Value Interpreter::evaluate_dict_literal(const ASTNode& node) {
+    std::vector<uint32_t> element_indices = get_child_indices(node.dict_literal.entries_start_index);
+    if (element_indices.size() != 2 * static_cast<size_t>(node.dict_literal.entry_count)) {
+        throw RuntimeError("Dictionary literal size mismatch");
+    }
+    
+    auto result = std::allocate_shared<Dict>(PoolAllocator<Dict>());
+    for (size_t i = 0; i < element_indices.size(); i += 2) {
+        Value key = evaluate_node(element_indices[i]);
+        result->set(key, evaluate_node(element_indices[i + 1]));
+    }
+    return Value(std::move(result));
+}
+
+Value Interpreter::evaluate_matrix_access(const ASTNode& node) {
+    Value matrix_value = evaluate_node(node.array_access.object_index);
+    Value index_value = evaluate_node(node.array_access.index_index);
+    
+    if (matrix_value.is_dict()) {
+        const Value* found = matrix_value.as_dict().find(index_value);
+        if (!found) {
+            throw RuntimeError("Key not found in dictionary: " + index_value.to_string());
+        }
+        return *found;
+    }
+    
+    if (matrix_value.is_list()) {
+        if (!index_value.is_integer() || index_value.as_integer() < 0) {
+            throw RuntimeError("List index must be a non-negative integer");
+        }
+        return matrix_value.as_list().get(static_cast<size_t>(index_value.as_integer()));
+    }
+    
+    if (!matrix_value.is_matrix()) {
+        throw RuntimeError("Cannot index non-matrix value");
+    }
+    
+    if (!index_value.is_integer()) {
+        throw RuntimeError("Matrix index must be integer");
+    }
+    
+    const auto& matrix = matrix_value.as_matrix();
+    int64_t index = index_value.as_integer();
+    
+    if (index < 0 || static_cast<size_t>(index) >= matrix.size()) {
+        throw RuntimeError("Matrix index out of bounds");
+    }
+    
+    // Return the row as a new matrix
+    Matrix result = {matrix[index]};
+    return Value(result);
+}
+
+// The loop guarding this access proved the index in range for a container
+// it cannot rebind or resize, so neither needs checking
+Value Interpreter::evaluate_proven_access(const ASTNode& node, const Value& container) {
+    size_t index = static_cast<size_t>(evaluate_node(node.array_access.index_index).as_integer());
+    if (container.is_list()) {
+        return container.as_list().get_unchecked(index);
+    }
+    return Value(Matrix{container.as_matrix()[index]});
+}
+
+Value Interpreter::evaluate_member_access(const ASTNode& node) {
+    Value object_value = evaluate_node(node.member_access.object_index);
+    std::string member_name = get_node_string(node.member_access.member_name_index);
+    
+    if (object_value.is_object()) {
+        if (auto* module = dynamic_cast<Module*>(&object_value.as_object())) {
+            return module->member(member_name);
+        }
+    }
+    if (!object_value.is_matrix()) {
+        throw RuntimeError("Member access only supported on matrices");
+    }
+    
+    if (member_name == "T") {
+        return object_value.transpose();
+    } else if (member_name == "d") {
+        return object_value.determinant();
+    } else if (member_name == "I") {
+        return object_value.inverse();
+    }
+    
+    throw RuntimeError("Unknown matrix member: " + member_name);
+}
+
+Value Interpreter::evaluate_method_call(const ASTNode& node) {
+    Value object_value = evaluate_node(node.method_call.object_index);
+    std::string method_name = get_node_string(node.method_call.name_index);
+    
+    std::vector<Value> args;
+    for (uint32_t arg_index : get_child_indices(node.method_call.args_start_index)) {
+        args.push_back(evaluate_node(arg_index));
+    }
+    
+    if (object_value.is_object()) {
+        if (auto* module = dynamic_cast<Module*>(&object_value.as_object())) {
+            return module->call(method_name, args);
+        }
+    }
+    
+    // Only modules have callable members
+    throw RuntimeError("Cannot call method '" + method_name + "' on a " +
+                       (object_value.is_object() ? object_value.as_object().type_name() : std::string("value")));
+}
+
+void Interpreter::execute_import(const ASTNode& node) {
+    for (uint32_t index : get_child_indices(node.first_child_index)) {
+        std::string name = get_node_string(parser_.get_nodes()[index].identifier.name_index);
+        auto known = modules_.find(name);
+        if (known == modules_.end()) {
+            known = modules_.emplace(name, std::make_shared<Module>(name, ModuleCache::instance().load(name), *this)).first;
+        }
+        current_env_->define(name, Value(std::shared_ptr<Object>(known->second)));
+    }
+}
+
+void Interpreter::execute_statement(uint32_t node_index) {
+    if (node_index >= parser_.get_nodes().size()) {
+        return;
+    }
+    
+    const ASTNode& node = parser_.get_nodes()[node_index];
+    --fuel_;
+    
+#ifdef DAKOTA_DEBUG_TRACE
+    std::cerr << "DEBUG: execute_statement called on type " << static_cast<int>(node.type) << " at index " << node_index << std::endl;
+#endif
+    
+    switch (node.type) {
+        case NodeType::EXPRESSION_STATEMENT:
+            // Use first_child_index instead of expression_index field
+            if (node.first_child_index != INVALID_INDEX && 
+                node.first_child_index < parser_.get_nodes().size()) {
+                evaluate_node(node.first_child_index);
+            }
+            break;
+        case NodeType::ASSIGNMENT:
+            evaluate_assignment(node);
+            break;
+        case NodeType::IF_STATEMENT:
+            execute_if_statement(node);
+            break;
+        case NodeType::WHILE_STATEMENT:
+            execute_while_statement(node);
+            break;
+        case NodeType::FOR_STATEMENT:
+            execute_for_statement(node);
+            break;
+        case NodeType::FUNCTION_DEF:
+            execute_function_def(node);
+            break;
+        case NodeType::RETURN_STATEMENT:
+            execute_return_statement(node);
+            break;
+        case NodeType::IMPORT_STATEMENT:
+            execute_import(node);
+            break;
+        case NodeType::EXTERN_DECL:
+            // Bound by link_externs() before the program started
+            break;
+        case NodeType::BLOCK:
+        case NodeType::PROGRAM:
+            execute_block(node_index);
+            break;
+        default:
+            // For other types, try to evaluate as expression
+            evaluate_node(node_index);
+            break;
+    }
+}
+
+void Interpreter::execute_if_statement(const ASTNode& node) {
+    Value condition = evaluate_node(node.if_statement.condition_index);
+    
+    if (condition.is_truthy()) {
+        execute_statement(node.if_statement.then_block_index);
+    } else if (node.if_statement.else_block_index != 0) {
+        execute_statement(node.if_statement.else_block_index);
+    }
+}
+
+// Element loop recognized by match_loop_idiom:
+//
+//     while i < n:              (or i <= n; n a literal, a variable or len(xs))
+//         <statement>
+//         i = i + 1
+//
+// where <statement> is ys[i] = expr (fill, copy, axpy, map), ys[i] = ys[i - 1] + expr
+// (prefix sum) or s = s + expr (sum, dot, reduction). expr reads lists at [i] and
+// loop-invariant numbers, combined with + - * / and the one-argument math builtins.
+struct LoopIdiom {
+    enum class Kind : uint8_t { FILL, COPY, AXPY, MAP, PREFIX_SUM, SUM, DOT, REDUCE };
+    
+    Kind kind;
+    std::string counter;
+    uint32_t bound_index;
+    bool inclusive;
+    std::string target;               // List written, or the accumulator of a reduction
+    std::vector<std::string> arrays;  // Lists read at [i], by program operand
+    std::vector<uint32_t> scalars;    // Loop-invariant expression nodes, by program operand
+    Kernels::Program program;         // Operands are bound on every run
+    uint32_t x_operand;               // COPY, AXPY, SUM, DOT: first list read
+    uint32_t y_operand;               // DOT: second list read; AXPY: the scalar
+    double axpy_sign;                 // AXPY: -1 for ys[i] - a * xs[i]
+};
+
+namespace {
+
+const ASTNode* node_at(const Parser& parser, uint32_t index) {
+    if (index == 0 || index >= parser.get_nodes().size()) {
+        return nullptr;
+    }
+    return &parser.get_nodes()[index];
+}
+
+// Name of an identifier node, empty for anything else
+std::string identifier_name(const Parser& parser, uint32_t index) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node || node->type != NodeType::IDENTIFIER) {
+        return std::string();
+    }
+    return std::string(parser.get_strings().get_string(node->identifier.name_index));
+}
+
+// Statements inside blocks are either assignments or wrap one
+const ASTNode* statement_assignment(const Parser& parser, uint32_t index) {
+    const ASTNode* node = node_at(parser, index);
+    if (node && node->type == NodeType::EXPRESSION_STATEMENT) {
+        node = node_at(parser, node->first_child_index);
+    }
+    return node && node->type == NodeType::ASSIGNMENT ? node : nullptr;
+}
+
+bool is_integer_literal(const Parser& parser, uint32_t index, int64_t value) {
+    const ASTNode* node = node_at(parser, index);
+    return node && node->type == NodeType::INTEGER_LITERAL && node->integer_literal.value == value;
+}
+
+bool math_op(const std::string& name, Kernels::Op& op) {
+    static const std::unordered_map<std::string, Kernels::Op> functions = {
+        {"sqrt", Kernels::Op::SQRT}, {"exp", Kernels::Op::EXP}, {"log", Kernels::Op::LOG},
+        {"sin", Kernels::Op::SIN}, {"cos", Kernels::Op::COS}, {"tan", Kernels::Op::TAN},
+        {"abs", Kernels::Op::ABS}
+    };
+    auto it = functions.find(name);
+    if (it == functions.end()) return false;
+    op = it->second;
+    return true;
+}
+
+// ys[i - 1] for the given list and counter
+bool is_previous_element(const Parser& parser, uint32_t index, const LoopIdiom& idiom) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node || node->type != NodeType::ARRAY_ACCESS ||
+        identifier_name(parser, node->array_access.object_index) != idiom.target) {
+        return false;
+    }
+    const ASTNode* offset = node_at(parser, node->array_access.index_index);
+    return offset && offset->type == NodeType::BINARY_OP && offset->binary_op.op_type == BinaryOpType::SUB &&
+           identifier_name(parser, offset->binary_op.left_index) == idiom.counter &&
+           is_integer_literal(parser, offset->binary_op.right_index, 1);
+}
+
+// Pure numeric expression that does not depend on the iteration
+bool is_invariant(const Parser& parser, uint32_t index, const LoopIdiom& idiom) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node) return false;
+    
+    switch (node->type) {
+        case NodeType::INTEGER_LITERAL:
+        case NodeType::FLOAT_LITERAL:
+            return true;
+        case NodeType::IDENTIFIER: {
+            std::string name = identifier_name(parser, index);
+            return name != idiom.counter && name != idiom.target;
+        }
+        case NodeType::BINARY_OP:
+            switch (node->binary_op.op_type) {
+                case BinaryOpType::ADD: case BinaryOpType::SUB: case BinaryOpType::MUL:
+                case BinaryOpType::DIV: case BinaryOpType::POW:
+                    return is_invariant(parser, node->binary_op.left_index, idiom) &&
+                           is_invariant(parser, node->binary_op.right_index, idiom);
+                default:
+                    return false;
+            }
+        case NodeType::UNARY_OP:
+            return node->unary_op.op_type == UnaryOpType::NEGATE &&
+                   is_invariant(parser, node->unary_op.operand_index, idiom);
+        case NodeType::FUNCTION_CALL: {
+            if (node->function_call.arg_count != 1) return false;
+            std::string name(parser.get_strings().get_string(node->function_call.name_index));
+            uint32_t arg = node->function_call.args_start_index;
+            Kernels::Op op;
+            if (name == "len") {
+                std::string list = identifier_name(parser, arg);
+                return !list.empty() && list != idiom.counter;
+            }
+            return math_op(name, op) && is_invariant(parser, arg, idiom);
+        }
+        default:
+            return false;
+    }
+}
+
+// Appends the postfix program for one element of expr. With reads_target
+// false the written list may not appear at all.
+bool compile_element(const Parser& parser, uint32_t index, LoopIdiom& idiom, bool reads_target) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node) return false;
+    Kernels::Program& program = idiom.program;
+    
+    if (is_invariant(parser, index, idiom)) {
+        idiom.scalars.push_back(index);
+        program.code.push_back({Kernels::Op::LOAD_SCALAR, static_cast<uint32_t>(idiom.scalars.size() - 1)});
+        return true;
+    }
+    
+    switch (node->type) {
+        case NodeType::ARRAY_ACCESS: {
+            std::string list = identifier_name(parser, node->array_access.object_index);
+            if (list.empty() || list == idiom.counter ||
+                identifier_name(parser, node->array_access.index_index) != idiom.counter) {
+                return false;
+            }
+            if (list == idiom.target && !reads_target) {
+                return false;
+            }
+            auto it = std::find(idiom.arrays.begin(), idiom.arrays.end(), list);
+            if (it == idiom.arrays.end()) {
+                it = idiom.arrays.insert(it, list);
+            }
+            program.code.push_back({Kernels::Op::LOAD_ARRAY, static_cast<uint32_t>(it - idiom.arrays.begin())});
+            return true;
+        }
+        case NodeType::BINARY_OP: {
+            Kernels::Op op;
+            switch (node->binary_op.op_type) {
+                case BinaryOpType::ADD: op = Kernels::Op::ADD; break;
+                case BinaryOpType::SUB: op = Kernels::Op::SUB; break;
+                case BinaryOpType::MUL: op = Kernels::Op::MUL; break;
+                case BinaryOpType::DIV: op = Kernels::Op::DIV; break;
+                default: return false;
+            }
+            if (!compile_element(parser, node->binary_op.left_index, idiom, reads_target) ||
+                !compile_element(parser, node->binary_op.right_index, idiom, reads_target)) {
+                return false;
+            }
+            program.code.push_back({op, 0});
+            return true;
+        }
+        case NodeType::UNARY_OP:
+            if (node->unary_op.op_type != UnaryOpType::NEGATE ||
+                !compile_element(parser, node->unary_op.operand_index, idiom, reads_target)) {
+                return false;
+            }
+            program.code.push_back({Kernels::Op::NEG, 0});
+            return true;
+        case NodeType::FUNCTION_CALL: {
+            Kernels::Op op;
+            if (node->function_call.arg_count != 1 ||
+                !math_op(std::string(parser.get_strings().get_string(node->function_call.name_index)), op) ||
+                !compile_element(parser, node->function_call.args_start_index, idiom, reads_target)) {
+                return false;
+            }
+            program.code.push_back({op, 0});
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool code_is(const Kernels::Program& program, std::initializer_list<Kernels::Op> ops) {
+    return program.code.size() == ops.size() &&
+           std::equal(ops.begin(), ops.end(), program.code.begin(),
+                      [](Kernels::Op op, const Kernels::Instruction& instruction) { return op == instruction.op; });
+}
+
+// ys[i] +- a * xs[i] in any operand order
+bool match_axpy(LoopIdiom& idiom) {
+    using Op = Kernels::Op;
+    const auto& code = idiom.program.code;
+    auto target = std::find(idiom.arrays.begin(), idiom.arrays.end(), idiom.target);
+    if (target == idiom.arrays.end()) return false;
+    uint32_t y = static_cast<uint32_t>(target - idiom.arrays.begin());
+    
+    size_t product;
+    if ((code_is(idiom.program, {Op::LOAD_ARRAY, Op::LOAD_SCALAR, Op::LOAD_ARRAY, Op::MUL, Op::ADD}) ||
+         code_is(idiom.program, {Op::LOAD_ARRAY, Op::LOAD_ARRAY, Op::LOAD_SCALAR, Op::MUL, Op::ADD}) ||
+         code_is(idiom.program, {Op::LOAD_ARRAY, Op::LOAD_SCALAR, Op::LOAD_ARRAY, Op::MUL, Op::SUB}) ||
+         code_is(idiom.program, {Op::LOAD_ARRAY, Op::LOAD_ARRAY, Op::LOAD_SCALAR, Op::MUL, Op::SUB})) &&
+        code[0].operand == y) {
+        product = 1;
+        idiom.axpy_sign = code[4].op == Op::SUB ? -1.0 : 1.0;
+    } else if ((code_is(idiom.program, {Op::LOAD_SCALAR, Op::LOAD_ARRAY, Op::MUL, Op::LOAD_ARRAY, Op::ADD}) ||
+                code_is(idiom.program, {Op::LOAD_ARRAY, Op::LOAD_SCALAR, Op::MUL, Op::LOAD_ARRAY, Op::ADD})) &&
+               code[3].operand == y) {
+        product = 0;
+        idiom.axpy_sign = 1.0;
+    } else {
+        return false;
+    }
+    
+    bool scalar_first = code[product].op == Op::LOAD_SCALAR;
+    idiom.y_operand = code[scalar_first ? product : product + 1].operand;
+    idiom.x_operand = code[scalar_first ? product + 1 : product].operand;
+    return true;
+}
+
+} // anonymous namespace
+
+bool Interpreter::elementwise_function(const Function& function) const {
+    Kernels::Op op;
+    if (function.native) {
+        return math_op(function.name, op);
+    }
+    
+    // Names holding a column of values, and names assigned one number
+    std::unordered_set<std::string> columns(function.parameters.begin(), function.parameters.end());
+    std::unordered_set<std::string> numbers;
+    std::function<bool(uint32_t, bool&)> elementwise = [&](uint32_t index, bool& column) {
+        const ASTNode* node = node_at(parser_, index);
+        if (!node) return false;
+        switch (node->type) {
+            case NodeType::INTEGER_LITERAL:
+            case NodeType::FLOAT_LITERAL:
+                return true;
+            case NodeType::IDENTIFIER: {
+                std::string name = identifier_name(parser_, index);
+                if (columns.count(name)) {
+                    column = true;
+                    return true;
+                }
+                Value value;
+                return numbers.count(name) || (find_global(name, value) && value.is_numeric());
+            }
+            case NodeType::BINARY_OP:
+                switch (node->binary_op.op_type) {
+                    case BinaryOpType::ADD: case BinaryOpType::SUB:
+                    case BinaryOpType::MUL: case BinaryOpType::DIV:
+                        return elementwise(node->binary_op.left_index, column) &&
+                               elementwise(node->binary_op.right_index, column);
+                    default:
+                        return false;
+                }
+            case NodeType::UNARY_OP:
+                return node->unary_op.op_type == UnaryOpType::NEGATE && elementwise(node->unary_op.operand_index, column);
+            case NodeType::FUNCTION_CALL:
+                return node->function_call.arg_count == 1 &&
+                       math_op(get_node_string(node->function_call.name_index), op) &&
+                       elementwise(node->function_call.args_start_index, column);
+            default:
+                return false;
+        }
+    };
+    
+    const ASTNode* body = node_at(parser_, function.body_node_index);
+    if (!body || body->type != NodeType::BLOCK) return false;
+    for (uint32_t index : get_child_indices(body->first_child_index)) {
+        const ASTNode* node = node_at(parser_, index);
+        if (node && node->type == NodeType::EXPRESSION_STATEMENT) {
+            node = node_at(parser_, node->first_child_index);
+        }
+        if (!node) return false;
+        bool column = false;
+        if (node->type == NodeType::RETURN_STATEMENT) {
+            // A result that does not depend on the point would come back as one number
+            return elementwise(node->return_statement.value_index, column) && column;
+        }
+        if (node->type != NodeType::ASSIGNMENT) return false;
+        std::string target = identifier_name(parser_, node->assignment.target_index);
+        if (target.empty() || !elementwise(node->assignment.value_index, column)) return false;
+        // Other names are globals, which would be left holding a column
+        if (column) {
+            if (std::find(function.parameters.begin(), function.parameters.end(), target) ==
+                function.parameters.end()) {
+                return false;
+            }
+        } else {
+            columns.erase(target);
+            numbers.insert(target);
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const LoopIdiom> Interpreter::match_loop_idiom(const ASTNode& node) const {
+    const ASTNode* condition = node_at(parser_, node.while_statement.condition_index);
+    if (!condition || condition->type != NodeType::BINARY_OP ||
+        (condition->binary_op.op_type != BinaryOpType::LT && condition->binary_op.op_type != BinaryOpType::LE)) {
+        return nullptr;
+    }
+    
+    auto idiom = std::make_shared<LoopIdiom>();
+    idiom->counter = identifier_name(parser_, condition->binary_op.left_index);
+    idiom->bound_index = condition->binary_op.right_index;
+    idiom->inclusive = condition->binary_op.op_type == BinaryOpType::LE;
+    idiom->x_operand = idiom->y_operand = 0;
+    idiom->axpy_sign = 1.0;
+    if (idiom->counter.empty()) {
+        return nullptr;
+    }
+    
+    // Body is exactly the work statement followed by i = i + 1
+    const ASTNode* body = node_at(parser_, node.while_statement.body_index);
+    if (!body || body->type != NodeType::BLOCK) {
+        return nullptr;
+    }
+    std::vector<uint32_t> statements = get_child_indices(body->first_child_index);
+    if (statements.size() != 2) {
+        return nullptr;
+    }
+    const ASTNode* step = statement_assignment(parser_, statements[1]);
+    const ASTNode* increment = step ? node_at(parser_, step->assignment.value_index) : nullptr;
+    if (!step || identifier_name(parser_, step->assignment.target_index) != idiom->counter ||
+        !increment || increment->type != NodeType::BINARY_OP || increment->binary_op.op_type != BinaryOpType::ADD ||
+        identifier_name(parser_, increment->binary_op.left_index) != idiom->counter ||
+        !is_integer_literal(parser_, increment->binary_op.right_index, 1)) {
+        return nullptr;
+    }
+    
+    const ASTNode* work = statement_assignment(parser_, statements[0]);
+    const ASTNode* target = work ? node_at(parser_, work->assignment.target_index) : nullptr;
+    const ASTNode* value = work ? node_at(parser_, work->assignment.value_index) : nullptr;
+    if (!target || !value) {
+        return nullptr;
+    }
+    
+    using Op = Kernels::Op;
+    if (target->type == NodeType::ARRAY_ACCESS) {
+        idiom->target = identifier_name(parser_, target->array_access.object_index);
+        if (idiom->target.empty() || idiom->target == idiom->counter ||
+            identifier_name(parser_, target->array_access.index_index) != idiom->counter) {
+            return nullptr;
+        }
+        
+        if (value->type == NodeType::BINARY_OP && value->binary_op.op_type == BinaryOpType::ADD &&
+            (is_previous_element(parser_, value->binary_op.left_index, *idiom) ||
+             is_previous_element(parser_, value->binary_op.right_index, *idiom))) {
+            uint32_t increment_index = is_previous_element(parser_, value->binary_op.left_index, *idiom)
+                ? value->binary_op.right_index : value->binary_op.left_index;
+            idiom->kind = LoopIdiom::Kind::PREFIX_SUM;
+            if (!compile_element(parser_, increment_index, *idiom, false)) {
+                return nullptr;
+            }
+        } else {
+            if (!compile_element(parser_, work->assignment.value_index, *idiom, true)) {
+                return nullptr;
+            }
+            if (code_is(idiom->program, {Op::LOAD_SCALAR})) {
+                idiom->kind = LoopIdiom::Kind::FILL;
+            } else if (code_is(idiom->program, {Op::LOAD_ARRAY})) {
+                idiom->kind = LoopIdiom::Kind::COPY;
+                idiom->x_operand = idiom->program.code[0].operand;
+            } else if (match_axpy(*idiom)) {
+                idiom->kind = LoopIdiom::Kind::AXPY;
+            } else {
+                idiom->kind = LoopIdiom::Kind::MAP;
+            }
+        }
+    } else if (target->type == NodeType::IDENTIFIER) {
+        // s = s + expr, with expr reading at least one list
+        idiom->target = identifier_name(parser_, work->assignment.target_index);
+        if (idiom->target == idiom->counter || value->type != NodeType::BINARY_OP ||
+            value->binary_op.op_type != BinaryOpType::ADD) {
+            return nullptr;
+        }
+        uint32_t term_index;
+        if (identifier_name(parser_, value->binary_op.left_index) == idiom->target) {
+            term_index = value->binary_op.right_index;
+        } else if (identifier_name(parser_, value->binary_op.right_index) == idiom->target) {
+            term_index = value->binary_op.left_index;
+        } else {
+            return nullptr;
+        }
+        if (!compile_element(parser_, term_index, *idiom, false) || idiom->arrays.empty()) {
+            return nullptr;
+        }
+        if (code_is(idiom->program, {Op::LOAD_ARRAY})) {
+            idiom->kind = LoopIdiom::Kind::SUM;
+            idiom->x_operand = idiom->program.code[0].operand;
+        } else if (code_is(idiom->program, {Op::LOAD_ARRAY, Op::LOAD_ARRAY, Op::MUL})) {
+            idiom->kind = LoopIdiom::Kind::DOT;
+            idiom->x_operand = idiom->program.code[0].operand;
+            idiom->y_operand = idiom->program.code[1].operand;
+        } else {
+            idiom->kind = LoopIdiom::Kind::REDUCE;
+        }
+    } else {
+        return nullptr;
     }
     
-    return Value(matrix);
+    // The bound is re-read every iteration, so it must not change inside the loop
+    const ASTNode* bound = node_at(parser_, idiom->bound_index);
+    if (!bound || !(bound->type == NodeType::INTEGER_LITERAL ||
+                    (bound->type == NodeType::IDENTIFIER &&
+                     identifier_name(parser_, idiom->bound_index) != idiom->counter &&
+                     identifier_name(parser_, idiom->bound_index) != idiom->target) ||
+                    (bound->type == NodeType::FUNCTION_CALL && is_invariant(parser_, idiom->bound_index, *idiom)))) {
+        return nullptr;
+    }
+    idiom->program.arrays.assign(idiom->arrays.size(), nullptr);
+    idiom->program.scalars.assign(idiom->scalars.size(), 0.0);
+    if (idiom->program.stack_depth() == 0) {
+        return nullptr;
+    }
+    return idiom;
 }
 
-Value Interpreter::evaluate_matrix_access(const ASTNode& node) {
-    Value matrix_value = evaluate_node(node.array_access.object_index);
-    Value index_value = evaluate_node(node.array_access.index_index);
+bool Interpreter::run_loop_idiom(const ASTNode& node) {
+    uint32_t node_index = static_cast<uint32_t>(&node - parser_.get_nodes().data());
+    auto cached = loop_idioms_.find(node_index);
+    if (cached == loop_idioms_.end()) {
+        cached = loop_idioms_.emplace(node_index, match_loop_idiom(node)).first;
+    }
+    const LoopIdiom* idiom = cached->second.get();
+    if (!idiom) {
+        return false;
+    }
     
-    if (!matrix_value.is_matrix()) {
-        throw RuntimeError("Cannot index non-matrix value");
+    // Anything the interpreter would treat differently falls back to it,
+    // including every loop that would raise an error part way through
+    Value* counter = current_env_->lookup(idiom->counter);
+    if (!counter || !counter->is_integer()) {
+        return false;
+    }
+    Value bound;
+    try {
+        bound = evaluate_node(idiom->bound_index);
+    } catch (const RuntimeError&) {
+        return false;
+    }
+    if (!bound.is_integer() || (idiom->inclusive && bound.as_integer() == INT64_MAX)) {
+        return false;
     }
+    int64_t start = counter->as_integer();
+    int64_t end = bound.as_integer() + (idiom->inclusive ? 1 : 0);
+    int64_t first = idiom->kind == LoopIdiom::Kind::PREFIX_SUM ? 1 : 0;
+    if (start < first || start >= end) {
+        return false;
+    }
+    size_t begin = static_cast<size_t>(start);
+    size_t count = static_cast<size_t>(end - start);
     
-    if (!index_value.is_integer()) {
-        throw RuntimeError("Matrix index must be integer");
+    auto float_list = [&](const std::string& name) -> double* {
+        Value* value = current_env_->lookup(name);
+        if (!value || !value->is_list() || value->as_list().size() < static_cast<size_t>(end)) {
+            return nullptr;
+        }
+        return value->as_list().float_data();
+    };
+    
+    Kernels::Program program = idiom->program;
+    for (size_t k = 0; k < idiom->arrays.size(); ++k) {
+        program.arrays[k] = float_list(idiom->arrays[k]);
+        if (!program.arrays[k]) return false;
+    }
+    for (size_t k = 0; k < idiom->scalars.size(); ++k) {
+        Value scalar;
+        try {
+            scalar = evaluate_node(idiom->scalars[k]);
+        } catch (const RuntimeError&) {
+            return false;
+        }
+        // Storing an integer would change the list's storage, only floats fill in place
+        if (!scalar.is_numeric() || (idiom->kind == LoopIdiom::Kind::FILL && !scalar.is_float())) {
+            return false;
+        }
+        program.scalars[k] = scalar.to_double();
     }
     
-    const auto& matrix = matrix_value.as_matrix();
-    int64_t index = index_value.as_integer();
+    bool reduction = idiom->kind == LoopIdiom::Kind::SUM || idiom->kind == LoopIdiom::Kind::DOT ||
+                     idiom->kind == LoopIdiom::Kind::REDUCE;
+    double* y = nullptr;
+    double total = 0.0;
+    if (reduction) {
+        Value* accumulator = current_env_->lookup(idiom->target);
+        if (!accumulator || !accumulator->is_numeric()) {
+            return false;
+        }
+        total = accumulator->to_double();
+    } else {
+        y = float_list(idiom->target);
+        if (!y) return false;
+    }
     
-    if (index < 0 || static_cast<size_t>(index) >= matrix.size()) {
-        throw RuntimeError("Matrix index out of bounds");
+    const double* x = idiom->arrays.empty() ? nullptr : program.arrays[idiom->x_operand] + begin;
+    switch (idiom->kind) {
+        case LoopIdiom::Kind::FILL:
+            Kernels::fill(y + begin, count, program.scalars[0]);
+            break;
+        case LoopIdiom::Kind::COPY:
+            Kernels::copy(y + begin, x, count);
+            break;
+        case LoopIdiom::Kind::AXPY:
+            Kernels::axpy(y + begin, x, count, idiom->axpy_sign * program.scalars[idiom->y_operand]);
+            break;
+        case LoopIdiom::Kind::MAP:
+            if (program.has_division()) {
+                // A zero divisor part way through must leave the list untouched
+                MatrixRow values(count);
+                if (!Kernels::evaluate(program, begin, count, values.data())) return false;
+                Kernels::copy(y + begin, values.data(), count);
+            } else {
+                Kernels::evaluate(program, begin, count, y + begin);
+            }
+            break;
+        case LoopIdiom::Kind::PREFIX_SUM: {
+            MatrixRow increments(count);
+            if (!Kernels::evaluate(program, begin, count, increments.data())) return false;
+            Kernels::prefix_sum(y + begin, increments.data(), count, y[begin - 1]);
+            break;
+        }
+        case LoopIdiom::Kind::SUM:
+            total = Kernels::sum(x, count, total);
+            break;
+        case LoopIdiom::Kind::DOT:
+            total = Kernels::dot(x, program.arrays[idiom->y_operand] + begin, count, total);
+            break;
+        case LoopIdiom::Kind::REDUCE: {
+            MatrixRow terms(count);
+            if (!Kernels::evaluate(program, begin, count, terms.data())) return false;
+            total = Kernels::sum(terms.data(), count, total);
+            break;
+        }
     }
     
-    // Return the row as a new matrix
-    std::vector<std::vector<double>> result = {matrix[index]};
-    return Value(result);
+    if (reduction) {
+        current_env_->assign(idiom->target, Value(total));
+    }
+    current_env_->assign(idiom->counter, Value(end));
+    return true;
 }
 
-Value Interpreter::evaluate_member_access(const ASTNode& node) {
-    Value object_value = evaluate_node(node.member_access.object_index);
-    std::string member_name = get_node_string(node.member_access.member_name_index);
+// Counted loop whose indexed accesses can be checked once, before it runs:
+//
+//     while i < n:              (or i <= n; n a literal, a variable or len(xs))
+//         ... xs[i + c] ...     (reads, and stores into lists, at any depth)
+//         i = i + 1
+//
+// Nothing in the body may assign i, n or the containers, call user code, or
+// call a builtin that resizes lists (or runs user code), so i takes exactly the
+// values start .. n - 1 and every container keeps its size while the loop runs.
+struct BoundsPlan {
+    struct Access {
+        uint32_t node;           // ARRAY_ACCESS or MATRIX_ACCESS node
+        std::string container;
+        int64_t offset;          // Index is counter + offset
+        bool store;              // Target of an indexed assignment
+    };
     
-    if (!object_value.is_matrix()) {
-        throw RuntimeError("Member access only supported on matrices");
+    std::string counter;
+    uint32_t bound_index;
+    bool inclusive;
+    std::vector<Access> accesses;
+};
+
+namespace {
+
+// Largest constant offset tracked, so counter + offset cannot overflow in a proof
+constexpr int64_t MAX_PROVEN_OFFSET = int64_t(1) << 31;
+
+// counter, counter + c, counter - c or c + counter for an integer literal c
+bool counter_offset(const Parser& parser, uint32_t index, const std::string& counter, int64_t& offset) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node) return false;
+    if (identifier_name(parser, index) == counter) {
+        offset = 0;
+        return true;
     }
+    if (node->type != NodeType::BINARY_OP ||
+        (node->binary_op.op_type != BinaryOpType::ADD && node->binary_op.op_type != BinaryOpType::SUB)) {
+        return false;
+    }
+    const ASTNode* left = node_at(parser, node->binary_op.left_index);
+    const ASTNode* right = node_at(parser, node->binary_op.right_index);
+    if (!left || !right) return false;
     
-    if (member_name == "T") {
-        return object_value.transpose();
-    } else if (member_name == "d") {
-        return object_value.determinant();
-    } else if (member_name == "I") {
-        return object_value.inverse();
+    const ASTNode* literal = nullptr;
+    if (identifier_name(parser, node->binary_op.left_index) == counter) {
+        literal = right;
+    } else if (identifier_name(parser, node->binary_op.right_index) == counter &&
+               node->binary_op.op_type == BinaryOpType::ADD) {
+        literal = left;
+    }
+    if (!literal || literal->type != NodeType::INTEGER_LITERAL ||
+        literal->integer_literal.value >= MAX_PROVEN_OFFSET || literal->integer_literal.value <= -MAX_PROVEN_OFFSET) {
+        return false;
     }
+    offset = node->binary_op.op_type == BinaryOpType::SUB ? -literal->integer_literal.value
+                                                          : literal->integer_literal.value;
+    return true;
+}
+
+// Integer expression of literals, len() and names the loop body leaves alone
+bool is_invariant_bound(const Parser& parser, uint32_t index, const std::string& counter,
+                        const std::unordered_set<std::string>& assigned) {
+    const ASTNode* node = node_at(parser, index);
+    if (!node) return false;
     
-    throw RuntimeError("Unknown matrix member: " + member_name);
+    switch (node->type) {
+        case NodeType::INTEGER_LITERAL:
+            return true;
+        case NodeType::IDENTIFIER: {
+            std::string name = identifier_name(parser, index);
+            return name != counter && !assigned.count(name);
+        }
+        case NodeType::BINARY_OP:
+            return (node->binary_op.op_type == BinaryOpType::ADD || node->binary_op.op_type == BinaryOpType::SUB ||
+                    node->binary_op.op_type == BinaryOpType::MUL) &&
+                   is_invariant_bound(parser, node->binary_op.left_index, counter, assigned) &&
+                   is_invariant_bound(parser, node->binary_op.right_index, counter, assigned);
+        case NodeType::FUNCTION_CALL:
+            return node->function_call.arg_count == 1 &&
+                   parser.get_strings().get_string(node->function_call.name_index) == "len" &&
+                   node_at(parser, node->function_call.args_start_index) &&
+                   node_at(parser, node->function_call.args_start_index)->type == NodeType::IDENTIFIER &&
+                   is_invariant_bound(parser, node->function_call.args_start_index, counter, assigned);
+        default:
+            return false;
+    }
 }
 
-void Interpreter::execute_statement(uint32_t node_index) {
-    if (node_index >= parser_.get_nodes().size()) {
-        return;
+} // anonymous namespace
+
+// Collects the names assigned below node_index and the accesses indexed by the
+// counter. Returns false for anything that invalidates the plan as a whole.
+bool Interpreter::scan_bounds_body(uint32_t node_index, BoundsPlan& plan,
+                                   std::unordered_set<std::string>& assigned) const {
+    const ASTNode* node = node_at(parser_, node_index);
+    if (!node) {
+        return true;
     }
     
-    const ASTNode& node = parser_.get_nodes()[node_index];
-    
-    std::cerr << "DEBUG: execute_statement called on type " << static_cast<int>(node.type) << " at index " << node_index << std::endl;
-    
-    switch (node.type) {
-        case NodeType::EXPRESSION_STATEMENT:
-            // Use first_child_index instead of expression_index field
-            if (node.first_child_index != INVALID_INDEX && 
-                node.first_child_index < parser_.get_nodes().size()) {
-                evaluate_node(node.first_child_index);
+    switch (node->type) {
+        case NodeType::ASSIGNMENT: {
+            const ASTNode* target = node_at(parser_, node->assignment.target_index);
+            if (target && target->type == NodeType::IDENTIFIER) {
+                assigned.insert(get_node_string(target->identifier.name_index));
+            } else if (target && target->type == NodeType::ARRAY_ACCESS) {
+                int64_t offset;
+                std::string container = identifier_name(parser_, target->array_access.object_index);
+                if (!container.empty() && counter_offset(parser_, target->array_access.index_index, plan.counter, offset)) {
+                    plan.accesses.push_back({node->assignment.target_index, container, offset, true});
+                }
+                if (!scan_bounds_body(target->array_access.object_index, plan, assigned) ||
+                    !scan_bounds_body(target->array_access.index_index, plan, assigned)) {
+                    return false;
+                }
             }
-            break;
-        case NodeType::ASSIGNMENT:
-            evaluate_assignment(node);
-            break;
+            return scan_bounds_body(node->assignment.value_index, plan, assigned);
+        }
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS: {
+            int64_t offset;
+            std::string container = identifier_name(parser_, node->array_access.object_index);
+            if (!container.empty() && counter_offset(parser_, node->array_access.index_index, plan.counter, offset)) {
+                plan.accesses.push_back({node_index, container, offset, false});
+            }
+            return scan_bounds_body(node->array_access.object_index, plan, assigned) &&
+                   scan_bounds_body(node->array_access.index_index, plan, assigned);
+        }
+        case NodeType::FUNCTION_CALL: {
+            std::string name = get_node_string(node->function_call.name_index);
+            if (!builtin_functions_.count(name) || list_mutators_.count(name)) {
+                return false;
+            }
+            for (uint32_t arg_index : get_child_indices(node->function_call.args_start_index)) {
+                if (!scan_bounds_body(arg_index, plan, assigned)) return false;
+            }
+            return true;
+        }
+        case NodeType::FOR_STATEMENT: {
+            std::string variable = identifier_name(parser_, node->for_statement.variable_index);
+            assigned.insert(variable);
+            return scan_bounds_body(node->for_statement.iterable_index, plan, assigned) &&
+                   scan_bounds_body(node->for_statement.body_index, plan, assigned);
+        }
+        case NodeType::FUNCTION_DEF:
+            // Not called while the loop runs, since the body calls no user code
+            return true;
+        case NodeType::BINARY_OP:
+            return scan_bounds_body(node->binary_op.left_index, plan, assigned) &&
+                   scan_bounds_body(node->binary_op.right_index, plan, assigned);
+        case NodeType::UNARY_OP:
+            return scan_bounds_body(node->unary_op.operand_index, plan, assigned);
+        case NodeType::MATRIX_LITERAL:
+        case NodeType::DICT_LITERAL: {
+            uint32_t start = node->type == NodeType::MATRIX_LITERAL ? node->matrix_literal.elements_start_index
+                                                                    : node->dict_literal.entries_start_index;
+            for (uint32_t element_index : get_child_indices(start)) {
+                if (!scan_bounds_body(element_index, plan, assigned)) return false;
+            }
+            return true;
+        }
+        case NodeType::MEMBER_ACCESS:
+            return scan_bounds_body(node->member_access.object_index, plan, assigned);
+        case NodeType::METHOD_CALL:
+        case NodeType::IMPORT_STATEMENT:
+            // Module code may call back into user code
+            return false;
         case NodeType::IF_STATEMENT:
-            execute_if_statement(node);
-            break;
+            return scan_bounds_body(node->if_statement.condition_index, plan, assigned) &&
+                   scan_bounds_body(node->if_statement.then_block_index, plan, assigned) &&
+                   scan_bounds_body(node->if_statement.else_block_index, plan, assigned);
         case NodeType::WHILE_STATEMENT:
-            execute_while_statement(node);
-            break;
-        case NodeType::FOR_STATEMENT:
-            execute_for_statement(node);
-            break;
-        case NodeType::FUNCTION_DEF:
-            execute_function_def(node);
-            break;
+            return scan_bounds_body(node->while_statement.condition_index, plan, assigned) &&
+                   scan_bounds_body(node->while_statement.body_index, plan, assigned);
         case NodeType::RETURN_STATEMENT:
-            execute_return_statement(node);
-            break;
+            return scan_bounds_body(node->return_statement.value_index, plan, assigned);
+        case NodeType::EXPRESSION_STATEMENT:
+            return scan_bounds_body(node->first_child_index, plan, assigned);
         case NodeType::BLOCK:
-        case NodeType::PROGRAM:
-            execute_block(node_index);
-            break;
+            for (uint32_t stmt_index : get_child_indices(node->first_child_index)) {
+                if (!scan_bounds_body(stmt_index, plan, assigned)) return false;
+            }
+            return true;
         default:
-            // For other types, try to evaluate as expression
-            evaluate_node(node_index);
-            break;
+            return true;
     }
 }
 
-void Interpreter::execute_if_statement(const ASTNode& node) {
-    Value condition = evaluate_node(node.if_statement.condition_index);
+std::shared_ptr<const BoundsPlan> Interpreter::match_bounds_plan(const ASTNode& node) const {
+    const ASTNode* condition = node_at(parser_, node.while_statement.condition_index);
+    if (!condition || condition->type != NodeType::BINARY_OP ||
+        (condition->binary_op.op_type != BinaryOpType::LT && condition->binary_op.op_type != BinaryOpType::LE)) {
+        return nullptr;
+    }
     
-    if (condition.is_truthy()) {
-        execute_statement(node.if_statement.then_block_index);
-    } else if (node.if_statement.else_block_index != 0) {
-        execute_statement(node.if_statement.else_block_index);
+    auto plan = std::make_shared<BoundsPlan>();
+    plan->counter = identifier_name(parser_, condition->binary_op.left_index);
+    plan->bound_index = condition->binary_op.right_index;
+    plan->inclusive = condition->binary_op.op_type == BinaryOpType::LE;
+    if (plan->counter.empty()) {
+        return nullptr;
+    }
+    
+    // The last statement is i = i + 1, and the only assignment to i
+    const ASTNode* body = node_at(parser_, node.while_statement.body_index);
+    if (!body || body->type != NodeType::BLOCK) {
+        return nullptr;
+    }
+    std::vector<uint32_t> statements = get_child_indices(body->first_child_index);
+    if (statements.size() < 2) {
+        return nullptr;
+    }
+    const ASTNode* step = statement_assignment(parser_, statements.back());
+    const ASTNode* increment = step ? node_at(parser_, step->assignment.value_index) : nullptr;
+    if (!step || identifier_name(parser_, step->assignment.target_index) != plan->counter ||
+        !increment || increment->type != NodeType::BINARY_OP || increment->binary_op.op_type != BinaryOpType::ADD ||
+        identifier_name(parser_, increment->binary_op.left_index) != plan->counter ||
+        !is_integer_literal(parser_, increment->binary_op.right_index, 1)) {
+        return nullptr;
+    }
+    
+    std::unordered_set<std::string> assigned;
+    statements.pop_back();
+    for (uint32_t stmt_index : statements) {
+        if (!scan_bounds_body(stmt_index, *plan, assigned)) {
+            return nullptr;
+        }
+    }
+    if (assigned.count(plan->counter)) {
+        return nullptr;
+    }
+    
+    // Evaluated once before the loop instead of on every iteration
+    if (!is_invariant_bound(parser_, plan->bound_index, plan->counter, assigned)) {
+        return nullptr;
+    }
+    
+    auto rebound = [&](const BoundsPlan::Access& access) {
+        return access.container == plan->counter || assigned.count(access.container) != 0;
+    };
+    plan->accesses.erase(std::remove_if(plan->accesses.begin(), plan->accesses.end(), rebound), plan->accesses.end());
+    if (plan->accesses.empty()) {
+        return nullptr;
+    }
+    return plan;
+}
+
+// The one check hoisted out of the loop: every access whose index range
+// start + offset .. last + offset fits its container runs unchecked. Sets end
+// to the first counter value that fails the loop condition.
+const BoundsPlan* Interpreter::prove_accesses(const ASTNode& node, int64_t& end) {
+    uint32_t node_index = static_cast<uint32_t>(&node - parser_.get_nodes().data());
+    auto cached = bounds_plans_.find(node_index);
+    if (cached == bounds_plans_.end()) {
+        cached = bounds_plans_.emplace(node_index, match_bounds_plan(node)).first;
+    }
+    const BoundsPlan* plan = cached->second.get();
+    if (!plan) {
+        return nullptr;
+    }
+    
+    Value* counter = current_env_->lookup(plan->counter);
+    if (!counter || !counter->is_integer()) {
+        return nullptr;
+    }
+    Value bound;
+    try {
+        bound = evaluate_node(plan->bound_index);
+    } catch (const RuntimeError&) {
+        return nullptr;
+    }
+    if (!bound.is_integer() || (!plan->inclusive && bound.as_integer() == INT64_MIN)) {
+        return nullptr;
+    }
+    int64_t first = counter->as_integer();
+    int64_t last = plan->inclusive ? bound.as_integer() : bound.as_integer() - 1;
+    if (first > last || first <= -MAX_PROVEN_OFFSET || last >= INT64_MAX - MAX_PROVEN_OFFSET) {
+        return nullptr;
+    }
+    end = last + 1;
+    
+    if (proven_containers_.size() < parser_.get_nodes().size()) {
+        proven_containers_.resize(parser_.get_nodes().size(), nullptr);
+    }
+    bool proven = false;
+    for (const BoundsPlan::Access& access : plan->accesses) {
+        const Value* container = current_env_->lookup(access.container);
+        size_t size;
+        if (container && container->is_list()) {
+            size = container->as_list().size();
+        } else if (container && container->is_matrix() && !access.store) {
+            size = container->as_matrix().size();
+        } else {
+            continue;
+        }
+        if (first + access.offset >= 0 && last + access.offset < static_cast<int64_t>(size)) {
+            proven_containers_[access.node] = container;
+            proven = true;
+        }
+    }
+    return proven ? plan : nullptr;
+}
+
+void Interpreter::release_accesses(const BoundsPlan& plan) {
+    for (const BoundsPlan::Access& access : plan.accesses) {
+        proven_containers_[access.node] = nullptr;
     }
 }
 
 void Interpreter::execute_while_statement(const ASTNode& node) {
-    while (true) {
-        Value condition = evaluate_node(node.while_statement.condition_index);
-        if (!condition.is_truthy()) {
-            break;
+    if (loop_idioms_enabled_ && run_loop_idiom(node)) {
+        return;
+    }
+    
+    int64_t end = 0;
+    const BoundsPlan* plan = range_analysis_enabled_ ? prove_accesses(node, end) : nullptr;
+    try {
+        if (plan) {
+            // Only the final increment moves the counter, and it stays in its slot
+            const Value* counter = current_env_->lookup(plan->counter);
+            while (counter->as_integer() < end) {
+                execute_statement(node.while_statement.body_index);
+                check_budget();
+            }
+        } else {
+            while (true) {
+                Value condition = evaluate_node(node.while_statement.condition_index);
+                if (!condition.is_truthy()) {
+                    break;
+                }
+                execute_statement(node.while_statement.body_index);
+                check_budget();
+            }
         }
-        execute_statement(node.while_statement.body_index);
+    } catch (...) {
+        if (plan) release_accesses(*plan);
+        throw;
     }
+    if (plan) release_accesses(*plan);
 }
 
 void Interpreter::execute_for_statement(const ASTNode& node) {
@@ -1196,12 +4282,33 @@ void Interpreter::execute_for_statement(const ASTNode& node) {
             const auto& matrix = iterable.as_matrix();
             for (const auto& row : matrix) {
                 // Create a matrix with just this row
-                std::vector<std::vector<double>> single_row = {row};
+                Matrix single_row = {row};
                 current_env_->assign(var_name, Value(single_row));
                 execute_statement(node.for_statement.body_index);
+                check_budget();
+            }
+        } else if (iterable.is_list()) {
+            // The size is re-read each pass so the body may append to the list
+            const List& list = iterable.as_list();
+            for (size_t i = 0; i < list.size(); ++i) {
+                current_env_->assign(var_name, list.get(i));
+                execute_statement(node.for_statement.body_index);
+                check_budget();
+            }
+        } else if (iterable.is_dict()) {
+            // Keys in insertion order, snapshotted so the body may modify the dictionary
+            std::vector<Value> keys;
+            keys.reserve(iterable.as_dict().size());
+            for (const auto& entry : iterable.as_dict().entries()) {
+                if (entry.live) keys.push_back(entry.key);
+            }
+            for (const Value& key : keys) {
+                current_env_->assign(var_name, key);
+                execute_statement(node.for_statement.body_index);
+                check_budget();
             }
         } else {
-            throw RuntimeError("For loop iterable must be a matrix or range");
+            throw RuntimeError("For loop iterable must be a matrix, list, dictionary or range");
         }
         current_env_ = previous_env;
     } catch (...) {
@@ -1226,8 +4333,158 @@ void Interpreter::execute_function_def(const ASTNode& node) {
     }
     
     // Create function object
-    Function func(function_name, parameters, node.function_def.body_index, current_env_);
-    user_functions_[function_name] = func;
+    user_functions_[function_name] = std::make_shared<Function>(function_name, parameters,
+                                                                node.function_def.body_index,
+                                                                make_closure(parameters, node.function_def.body_index));
+}
+
+void Interpreter::collect_names(uint32_t node_index, std::unordered_set<std::string>& referenced,
+                                std::unordered_set<std::string>& assigned) const {
+    if (node_index == 0 || node_index >= parser_.get_nodes().size()) {
+        return;
+    }
+    const ASTNode& node = parser_.get_nodes()[node_index];
+    
+    switch (node.type) {
+        case NodeType::IDENTIFIER:
+            referenced.insert(get_node_string(node.identifier.name_index));
+            break;
+        case NodeType::BINARY_OP:
+            collect_names(node.binary_op.left_index, referenced, assigned);
+            collect_names(node.binary_op.right_index, referenced, assigned);
+            break;
+        case NodeType::UNARY_OP:
+            collect_names(node.unary_op.operand_index, referenced, assigned);
+            break;
+        case NodeType::ASSIGNMENT: {
+            const ASTNode& target = parser_.get_nodes()[node.assignment.target_index];
+            if (target.type == NodeType::IDENTIFIER) {
+                assigned.insert(get_node_string(target.identifier.name_index));
+            }
+            collect_names(node.assignment.target_index, referenced, assigned);
+            collect_names(node.assignment.value_index, referenced, assigned);
+            break;
+        }
+        case NodeType::FUNCTION_CALL:
+            // The callee may be a variable holding a function value
+            referenced.insert(get_node_string(node.function_call.name_index));
+            for (uint32_t arg_index : get_child_indices(node.function_call.args_start_index)) {
+                collect_names(arg_index, referenced, assigned);
+            }
+            break;
+        case NodeType::MATRIX_LITERAL:
+            for (uint32_t element_index : get_child_indices(node.matrix_literal.elements_start_index)) {
+                collect_names(element_index, referenced, assigned);
+            }
+            break;
+        case NodeType::DICT_LITERAL:
+            for (uint32_t element_index : get_child_indices(node.dict_literal.entries_start_index)) {
+                collect_names(element_index, referenced, assigned);
+            }
+            break;
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS:
+            collect_names(node.array_access.object_index, referenced, assigned);
+            collect_names(node.array_access.index_index, referenced, assigned);
+            break;
+        case NodeType::MEMBER_ACCESS:
+            collect_names(node.member_access.object_index, referenced, assigned);
+            break;
+        case NodeType::METHOD_CALL:
+            collect_names(node.method_call.object_index, referenced, assigned);
+            for (uint32_t arg_index : get_child_indices(node.method_call.args_start_index)) {
+                collect_names(arg_index, referenced, assigned);
+            }
+            break;
+        case NodeType::IMPORT_STATEMENT:
+            for (uint32_t name_index : get_child_indices(node.first_child_index)) {
+                std::string name = get_node_string(parser_.get_nodes()[name_index].identifier.name_index);
+                assigned.insert(name);
+                referenced.insert(name);
+            }
+            break;
+        case NodeType::IF_STATEMENT:
+            collect_names(node.if_statement.condition_index, referenced, assigned);
+            collect_names(node.if_statement.then_block_index, referenced, assigned);
+            collect_names(node.if_statement.else_block_index, referenced, assigned);
+            break;
+        case NodeType::WHILE_STATEMENT:
+            collect_names(node.while_statement.condition_index, referenced, assigned);
+            collect_names(node.while_statement.body_index, referenced, assigned);
+            break;
+        case NodeType::FOR_STATEMENT: {
+            const ASTNode& variable = parser_.get_nodes()[node.for_statement.variable_index];
+            if (variable.type == NodeType::IDENTIFIER) {
+                std::string name = get_node_string(variable.identifier.name_index);
+                assigned.insert(name);
+                referenced.insert(name);
+            }
+            collect_names(node.for_statement.iterable_index, referenced, assigned);
+            collect_names(node.for_statement.body_index, referenced, assigned);
+            break;
+        }
+        case NodeType::FUNCTION_DEF: {
+            // A nested function's free names are free here too, minus its own parameters
+            std::unordered_set<std::string> inner_referenced, inner_assigned;
+            collect_names(node.function_def.body_index, inner_referenced, inner_assigned);
+            for (uint32_t param_index : get_child_indices(node.function_def.params_start_index)) {
+                const ASTNode& param = parser_.get_nodes()[param_index];
+                if (param.type == NodeType::IDENTIFIER) {
+                    std::string name = get_node_string(param.identifier.name_index);
+                    inner_referenced.erase(name);
+                    inner_assigned.erase(name);
+                }
+            }
+            referenced.insert(inner_referenced.begin(), inner_referenced.end());
+            assigned.insert(inner_assigned.begin(), inner_assigned.end());
+            break;
+        }
+        case NodeType::RETURN_STATEMENT:
+            collect_names(node.return_statement.value_index, referenced, assigned);
+            break;
+        case NodeType::EXPRESSION_STATEMENT:
+            collect_names(node.first_child_index, referenced, assigned);
+            break;
+        case NodeType::BLOCK:
+        case NodeType::PROGRAM:
+            for (uint32_t stmt_index : get_child_indices(node.first_child_index)) {
+                collect_names(stmt_index, referenced, assigned);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+std::shared_ptr<Environment> Interpreter::make_closure(const std::vector<std::string>& parameters,
+                                                       uint32_t body_index) {
+    // Globals are reached through the parent link, so top-level definitions need no record
+    if (current_env_ == global_env_) {
+        return global_env_;
+    }
+    
+    std::unordered_set<std::string> referenced, assigned;
+    collect_names(body_index, referenced, assigned);
+    for (const std::string& parameter : parameters) {
+        referenced.erase(parameter);
+    }
+    
+    auto record = std::make_shared<Environment>(global_env_);
+    for (const std::string& name : referenced) {
+        Environment::Slot slot = current_env_->find_slot(name, global_env_.get());
+        if (slot) {
+            record->bind(name, std::move(slot));
+            continue;
+        }
+        if (global_env_->exists(name) || assigned.count(name) ||
+            user_functions_.count(name) || builtin_functions_.count(name)) {
+            continue;
+        }
+        // Read before anything binds it, so it may yet be defined in an enclosing
+        // scope - keep the whole chain to preserve late binding
+        return current_env_;
+    }
+    return record;
 }
 
 void Interpreter::execute_return_statement(const ASTNode& node) {
@@ -1245,17 +4502,32 @@ void Interpreter::execute_block(uint32_t node_index) {
     // Get all child statements
     std::vector<uint32_t> statement_indices = get_child_indices(node.first_child_index);
     
+#ifdef DAKOTA_DEBUG_TRACE
     std::cerr << "DEBUG: execute_block at index " << node_index << " found " << statement_indices.size() << " children: ";
     for (uint32_t idx : statement_indices) {
         std::cerr << idx << " ";
     }
     std::cerr << std::endl;
+#endif
     
     for (uint32_t stmt_index : statement_indices) {
         execute_statement(stmt_index);
     }
 }
 
+bool Interpreter::find_global(const std::string& name, Value& value) const {
+    if (global_env_->exists(name)) {
+        value = global_env_->get(name);
+        return true;
+    }
+    auto function = user_functions_.find(name);
+    if (function != user_functions_.end()) {
+        value = Value(function->second);
+        return true;
+    }
+    return false;
+}
+
 std::string Interpreter::get_node_string(uint32_t string_index) const {
     return std::string(parser_.get_strings().get_string(string_index));
 }
@@ -1277,26 +4549,20 @@ std::vector<uint32_t> Interpreter::get_child_indices(uint32_t start_index) const
         
         indices.push_back(current);
         current = parser_.get_nodes()[current].next_sibling_index;
-        
-        // Safety limit to prevent infinite loops
-        if (indices.size() > 1000) {
-            std::cerr << "Warning: Too many sibling nodes, possible infinite loop" << std::endl;
-            break;
-        }
     }
     
     return indices;
 }
 
 void Interpreter::print_runtime_error(const RuntimeError& error) const {
-    std::cerr << "Runtime Error";
+    *errors_ << "Runtime Error";
     if (error.get_line() > 0) {
-        std::cerr << " at line " << error.get_line();
+        *errors_ << " at line " << error.get_line();
         if (error.get_column() > 0) {
-            std::cerr << ", column " << error.get_column();
+            *errors_ << ", column " << error.get_column();
         }
     }
-    std::cerr << ": " << error.what() << std::endl;
+    *errors_ << ": " << error.what() << std::endl;
 }
 
 } // namespace Dakota
@@ -2,16 +2,39 @@
 #define INTERPRETER_H
 
 #include "parser.h"
+#include "pool.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 #include <string>
 #include <memory>
 #include <stdexcept>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
 
 namespace Dakota {
 
+namespace LinAlg {
+struct SparseMatrix;
+}
+
+struct Function;
+class List;
+class Dict;
+class EnvironmentCopier;
+class Module;
+
+// Mutable runtime state shared by reference, such as streaming accumulators.
+// Copies of a Value holding an Object all see the same instance.
+class Object {
+public:
+    virtual ~Object() = default;
+    virtual std::string type_name() const = 0;
+};
+
 // Value types that can be stored and manipulated
 class Value {
 public:
@@ -21,21 +44,40 @@ public:
         STRING,
         BOOLEAN,
         MATRIX,
+        SPARSE,
+        FUNCTION,
+        LIST,
+        DICT,
+        OBJECT,
         NONE
     };
 
 private:
     Type type_;
-    std::variant<int64_t, double, std::string, bool, std::vector<std::vector<double>>> value_;
+    // Strings are refcounted builders: copies share one buffer, and a uniquely
+    // owned buffer can be appended to in place (see string_buffer())
+    // Matrices are immutable once built, so copies share one buffer too
+    std::variant<int64_t, double, std::shared_ptr<std::string>, bool, std::shared_ptr<const Matrix>,
+                 std::shared_ptr<const LinAlg::SparseMatrix>,
+                 std::shared_ptr<const Function>, std::shared_ptr<List>,
+                 std::shared_ptr<Dict>, std::shared_ptr<Object>> value_;
 
 public:
     // Constructors
     Value() : type_(Type::NONE), value_(0) {}
     Value(int64_t val) : type_(Type::INTEGER), value_(val) {}
     Value(double val) : type_(Type::FLOAT), value_(val) {}
-    Value(const std::string& val) : type_(Type::STRING), value_(val) {}
+    Value(const std::string& val) : type_(Type::STRING), value_(std::allocate_shared<std::string>(PoolAllocator<std::string>(), val)) {}
+    Value(std::string&& val) : type_(Type::STRING), value_(std::allocate_shared<std::string>(PoolAllocator<std::string>(), std::move(val))) {}
     Value(bool val) : type_(Type::BOOLEAN), value_(val) {}
-    Value(const std::vector<std::vector<double>>& val) : type_(Type::MATRIX), value_(val) {}
+    Value(const Matrix& val) : type_(Type::MATRIX), value_(std::allocate_shared<Matrix>(PoolAllocator<Matrix>(), val)) {}
+    Value(Matrix&& val) : type_(Type::MATRIX), value_(std::allocate_shared<Matrix>(PoolAllocator<Matrix>(), std::move(val))) {}
+    Value(std::shared_ptr<const Matrix> val) : type_(Type::MATRIX), value_(std::move(val)) {}
+    Value(std::shared_ptr<const LinAlg::SparseMatrix> val) : type_(Type::SPARSE), value_(std::move(val)) {}
+    Value(std::shared_ptr<const Function> val) : type_(Type::FUNCTION), value_(std::move(val)) {}
+    Value(std::shared_ptr<List> val) : type_(Type::LIST), value_(std::move(val)) {}
+    Value(std::shared_ptr<Dict> val) : type_(Type::DICT), value_(std::move(val)) {}
+    Value(std::shared_ptr<Object> val) : type_(Type::OBJECT), value_(std::move(val)) {}
 
     // Type checking
     Type get_type() const { return type_; }
@@ -44,6 +86,11 @@ public:
     bool is_string() const { return type_ == Type::STRING; }
     bool is_boolean() const { return type_ == Type::BOOLEAN; }
     bool is_matrix() const { return type_ == Type::MATRIX; }
+    bool is_sparse() const { return type_ == Type::SPARSE; }
+    bool is_function() const { return type_ == Type::FUNCTION; }
+    bool is_list() const { return type_ == Type::LIST; }
+    bool is_dict() const { return type_ == Type::DICT; }
+    bool is_object() const { return type_ == Type::OBJECT; }
     bool is_none() const { return type_ == Type::NONE; }
     bool is_numeric() const { return is_integer() || is_float(); }
 
@@ -51,8 +98,17 @@ public:
     int64_t as_integer() const;
     double as_float() const;
     const std::string& as_string() const;
+    const std::shared_ptr<std::string>& string_buffer() const;
     bool as_boolean() const;
-    const std::vector<std::vector<double>>& as_matrix() const;
+    const Matrix& as_matrix() const;
+    const LinAlg::SparseMatrix& as_sparse() const;
+    const Function& as_function() const;
+    const std::shared_ptr<const Function>& function_pointer() const;
+    const std::shared_ptr<const Matrix>& matrix_pointer() const;
+    const std::shared_ptr<Object>& object_pointer() const;
+    List& as_list() const;
+    Dict& as_dict() const;
+    Object& as_object() const;
 
     // Numeric conversion
     double to_double() const;
@@ -82,6 +138,9 @@ public:
     Value operator>(const Value& other) const;
     Value operator>=(const Value& other) const;
     
+    // Membership test for `item in container` (dict keys, list elements, substrings)
+    Value contains(const Value& item) const;
+    
     // Logical operations
     Value logical_and(const Value& other) const;
     Value logical_or(const Value& other) const;
@@ -108,11 +167,106 @@ public:
     size_t get_column() const { return column_; }
 };
 
+// Growable list with reference semantics and amortized O(1) append/pop.
+// While every element has the same shape the list keeps a typed contiguous
+// buffer; the first mismatched append boxes the contents once.
+class List {
+public:
+    enum class Storage {
+        EMPTY,
+        INTEGER,   // int64 buffer
+        FLOAT,     // double buffer
+        ROWS,      // 1 x k row vectors of one width, the rows of a future matrix
+        BOXED      // Arbitrary values
+    };
+
+private:
+    Storage storage_;
+    std::vector<int64_t> integers_;
+    MatrixRow floats_;
+    Matrix rows_;
+    std::vector<Value> boxed_;
+
+    void box();
+
+public:
+    List() : storage_(Storage::EMPTY) {}
+
+    Storage storage() const { return storage_; }
+    size_t size() const;
+    
+    // Element buffer while storage is FLOAT, nullptr otherwise
+    double* float_data() { return storage_ == Storage::FLOAT ? floats_.data() : nullptr; }
+
+    void append(const Value& value);
+    Value pop();
+    Value get(size_t index) const;
+    void set(size_t index, const Value& value);
+    void reserve(size_t count);
+    
+    // No bounds check, for indices already proven in range
+    Value get_unchecked(size_t index) const;
+    void set_unchecked(size_t index, const Value& value);
+
+    // Moves typed buffers straight into a matrix value and leaves the list
+    // empty. Numbers become a 1 x n row vector, row vectors are stacked.
+    Value take_matrix();
+};
+
+// Insertion-ordered hash map with string and integer keys, shared by
+// reference. Entries live in a dense array; an open-addressing table of
+// entry indices is probed linearly. Each entry keeps its key's hash, so a
+// string key is hashed once on insertion and never again on resize.
+class Dict {
+public:
+    struct Entry {
+        uint64_t hash;
+        Value key;
+        Value value;
+        bool live;
+    };
+
+private:
+    std::vector<Entry> entries_;   // Erased entries stay as holes until the next rebuild
+    std::vector<int32_t> slots_;   // Power-of-two table, EMPTY_SLOT when unused
+    size_t live_;
+
+    static constexpr int32_t EMPTY_SLOT = -1;
+
+    // Slot holding key, or the empty slot that ends its probe sequence
+    size_t probe(const Value& key, uint64_t hash) const;
+    void rebuild(size_t capacity);
+
+public:
+    Dict() : live_(0) {}
+
+    // Integral floats are stored as integers so d[M[i]] finds integer keys
+    static Value normalize_key(const Value& key);
+    static uint64_t hash_key(const Value& normalized_key);
+
+    size_t size() const { return live_; }
+    const Value* find(const Value& key) const;
+    void set(const Value& key, const Value& value);
+    bool erase(const Value& key);
+
+    // Entries in insertion order, skip those with live == false
+    const std::vector<Entry>& entries() const { return entries_; }
+};
+
 // Environment for variable storage
+// Each variable lives in its own shared slot so a closure can hold on to the
+// few slots it uses without keeping the rest of the scope alive
 class Environment {
+public:
+    using Slot = std::shared_ptr<Value>;
+
 private:
-    std::unordered_map<std::string, Value> variables_;
+    std::unordered_map<std::string, Slot> variables_;
     std::shared_ptr<Environment> parent_;
+    
+    friend class EnvironmentCopier;
+    friend class SnapshotWriter;
+    friend class SnapshotReader;
 
 public:
     Environment(std::shared_ptr<Environment> parent = nullptr) : parent_(parent) {}
@@ -120,18 +274,34 @@ public:
     void define(const std::string& name, const Value& value);
     Value get(const std::string& name) const;
     void assign(const std::string& name, const Value& value);
+    Value* lookup(const std::string& name);  // Stored slot in this or an enclosing scope, or nullptr
     bool exists(const std::string& name) const;
     bool exists_in_current_scope(const std::string& name) const;
+    
+    // Slot for name in this scope or an enclosing one below stop, or nullptr
+    Slot find_slot(const std::string& name, const Environment* stop) const;
+    // Makes name in this scope share an existing slot
+    void bind(const std::string& name, Slot slot);
+    size_t size() const { return variables_.size(); }
 };
 
+// Signature shared by built-in functions
+using NativeFunction = std::function<Value(const std::vector<Value>&)>;
+
 // Function representation
+// User functions run body_node_index in closure; built-ins passed as values set native.
+// A function defined inside another scope gets a closure record holding only
+// the slots its body refers to, with the global scope as parent.
 struct Function {
     std::string name;
     std::vector<std::string> parameters;
     uint32_t body_node_index;
     std::shared_ptr<Environment> closure;
+    NativeFunction native;
     
     Function() : body_node_index(0) {}
+    Function(const std::string& n, NativeFunction fn)
+        : name(n), body_node_index(0), native(std::move(fn)) {}
     Function(const std::string& n, const std::vector<std::string>& params, 
              uint32_t body, std::shared_ptr<Environment> env)
         : name(n), parameters(params), body_node_index(body), closure(env) {}
@@ -160,6 +330,54 @@ public:
     static Value transpose(const std::vector<Value>& args);
     static Value determinant(const std::vector<Value>& args);
     static Value inverse(const std::vector<Value>& args);
+    static Value solve(const std::vector<Value>& args);
+    
+    // Sparse matrix functions
+    static Value sparse(const std::vector<Value>& args);
+    static Value dense(const std::vector<Value>& args);
+    static Value nnz(const std::vector<Value>& args);
+    static Value spsolve(const std::vector<Value>& args);
+    static Value cholsolve(const std::vector<Value>& args);
+    
+    // Matrix functions (principal branches)
+    static Value expm(const std::vector<Value>& args);
+    static Value sqrtm(const std::vector<Value>& args);
+    static Value logm(const std::vector<Value>& args);
+    
+    // Elementwise math (also accept matrices)
+    static Value exp(const std::vector<Value>& args);
+    static Value log(const std::vector<Value>& args);
+    
+    // Integration of sampled data
+    static Value trapz(const std::vector<Value>& args);
+    static Value simpson(const std::vector<Value>& args);
+    
+    // Statistics - each also reads out an accumulator fed with accumulate()
+    static Value stats(const std::vector<Value>& args);
+    static Value histogram(const std::vector<Value>& args);
+    static Value cov(const std::vector<Value>& args);
+    static Value corrcoef(const std::vector<Value>& args);
+    static Value stats_accumulator(const std::vector<Value>& args);
+    static Value histogram_accumulator(const std::vector<Value>& args);
+    static Value cov_accumulator(const std::vector<Value>& args);
+    static Value accumulate(const std::vector<Value>& args);
+    
+    // List functions
+    static Value list(const std::vector<Value>& args);
+    static Value append(const std::vector<Value>& args);
+    static Value pop(const std::vector<Value>& args);
+    static Value to_matrix(const std::vector<Value>& args);
+    
+    // Dictionary functions
+    static Value dict(const std::vector<Value>& args);
+    static Value keys(const std::vector<Value>& args);
+    static Value values(const std::vector<Value>& args);
+    static Value remove(const std::vector<Value>& args);
+    
+    // Buffer pool functions
+    static Value pool_stats(const std::vector<Value>& args);
+    static Value pool_trim(const std::vector<Value>& args);
+    static Value pool_cap(const std::vector<Value>& args);
     
     // Range function for iteration
     static Value range(const std::vector<Value>& args);
@@ -175,14 +393,106 @@ public:
     const Value& get_value() const { return value_; }
 };
 
+// Element loop replaced by a native kernel, see match_loop_idiom
+struct LoopIdiom;
+
+// Indexed accesses a counted loop keeps in range, see match_bounds_plan
+struct BoundsPlan;
+
+// Steps between budget checks when the budget sets no slice of its own
+constexpr uint64_t BUDGET_SLICE_STEPS = 16384;
+constexpr size_t MAX_CALL_DEPTH = 1000;   // Nested user function calls; deeper recursion would overflow the native stack
+
+// Limits on running a program, for hosts that run scripts they do not
+// trust to finish. Steps count AST nodes evaluated. Both limits are checked
+// at loop back-edges and user function calls, so one long builtin call, such
+// as a large solve, runs to completion. Zero means no limit.
+struct ExecutionBudget {
+    uint64_t max_steps = 0;
+    double max_seconds = 0.0;   // Wall time from set_budget()
+    
+    // Called every slice_steps steps (BUDGET_SLICE_STEPS if zero); returning
+    // false aborts the run. A scheduler can block in it to let other scripts
+    // have a thread, time-slicing them cooperatively. sweep() workers call it
+    // from their own threads.
+    uint64_t slice_steps = 0;
+    std::function<bool()> on_slice;
+    
+    bool unlimited() const { return max_steps == 0 && max_seconds <= 0.0 && !on_slice; }
+};
+
+// Raised when a run's budget is spent or on_slice cancels it. Every later
+// check in the same run raises it again, so builtins that recover from errors
+// in user code cannot swallow it.
+class BudgetExceeded : public RuntimeError {
+public:
+    using RuntimeError::RuntimeError;
+};
+
 // Main interpreter class
 class Interpreter {
 private:
+    friend class EnvironmentCopier;
+    
     const Parser& parser_;
     std::shared_ptr<Environment> global_env_;
     std::shared_ptr<Environment> current_env_;
-    std::unordered_map<std::string, Function> user_functions_;
-    std::unordered_map<std::string, std::function<Value(const std::vector<Value>&)>> builtin_functions_;
+    std::unordered_map<std::string, std::shared_ptr<const Function>> user_functions_;
+    std::unordered_map<std::string, NativeFunction> builtin_functions_;
+    std::unordered_set<std::string> list_mutators_;   // Builtins registered as resizing or emptying lists
+    
+    // C functions bound by extern declarations, also entered as builtins
+    std::unordered_map<std::string, NativeFunction> extern_functions_;
+    
+    // While loops analyzed so far, nullptr for loops that match no idiom
+    std::unordered_map<uint32_t, std::shared_ptr<const LoopIdiom>> loop_idioms_;
+    bool loop_idioms_enabled_;
+    
+    // While loops analyzed for bounds checks, and the container each access node
+    // reads while its loop runs with the access proven in range (else nullptr)
+    std::unordered_map<uint32_t, std::shared_ptr<const BoundsPlan>> bounds_plans_;
+    std::vector<const Value*> proven_containers_;
+    bool range_analysis_enabled_;
+    
+    // Constant matrix literals built so far, shared by every later evaluation
+    std::unordered_map<uint32_t, Value> constant_matrices_;
+    
+    // Modules imported so far; importing one again binds the same instance
+    std::unordered_map<std::string, std::shared_ptr<Module>> modules_;
+    
+    // Execution budget. fuel_ counts down the steps left in the current slice
+    // and is only examined at checks, so an unlimited run, whose slice never
+    // ends, pays one decrement per node.
+    ExecutionBudget budget_;
+    int64_t fuel_;
+    int64_t slice_;
+    // Steps in slices already ended, counted together with the sweep()
+    // workers and modules that share the budget
+    std::shared_ptr<std::atomic<uint64_t>> spent_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::string exhausted_;   // Why the budget ran out, once it has
+    
+    // User function calls in progress on this thread, at most MAX_CALL_DEPTH:
+    // frames_, or the importer's count for a module's interpreter
+    size_t frames_;
+    size_t* call_depth_;
+    
+    void check_budget() {
+        if (fuel_ <= 0) refuel();
+    }
+    void refuel();
+    void start_slice();
+    void share_budget(const Interpreter& owner);
+    
+    // Top-level statement running, which checkpoint() records, and the one
+    // execute() starts at after restore()
+    size_t statement_;
+    size_t resume_statement_;
+    uint32_t builtin_call_;   // Call node of the builtin running, 0 when called as a value
+    
+    // Where print() and runtime errors go, std::cout and std::cerr by default
+    std::ostream* output_;
+    std::ostream* errors_;
     
     // Helper methods
     Value evaluate_node(uint32_t node_index);
@@ -192,33 +502,124 @@ private:
     Value evaluate_identifier(const ASTNode& node);
     Value evaluate_function_call(const ASTNode& node);
     Value evaluate_matrix_literal(const ASTNode& node);
+    Value evaluate_dict_literal(const ASTNode& node);
     Value evaluate_matrix_access(const ASTNode& node);
+    Value evaluate_proven_access(const ASTNode& node, const Value& container);
+    void assign_element(const ASTNode& target, const Value& value);
+    bool append_in_place(const ASTNode& node, const std::string& name, Value& result);
     Value evaluate_member_access(const ASTNode& node);
+    Value evaluate_method_call(const ASTNode& node);
     
     void execute_statement(uint32_t node_index);
     void execute_if_statement(const ASTNode& node);
     void execute_while_statement(const ASTNode& node);
+    std::shared_ptr<const LoopIdiom> match_loop_idiom(const ASTNode& node) const;
+    bool run_loop_idiom(const ASTNode& node);
+    std::shared_ptr<const BoundsPlan> match_bounds_plan(const ASTNode& node) const;
+    bool scan_bounds_body(uint32_t node_index, BoundsPlan& plan, std::unordered_set<std::string>& assigned) const;
+    const BoundsPlan* prove_accesses(const ASTNode& node, int64_t& end);
+    void release_accesses(const BoundsPlan& plan);
     void execute_for_statement(const ASTNode& node);
     void execute_function_def(const ASTNode& node);
     void execute_return_statement(const ASTNode& node);
+    void execute_import(const ASTNode& node);
     void execute_block(uint32_t node_index);
     
+    // Closure conversion
+    void collect_names(uint32_t node_index, std::unordered_set<std::string>& referenced,
+                       std::unordered_set<std::string>& assigned) const;
+    std::shared_ptr<Environment> make_closure(const std::vector<std::string>& parameters, uint32_t body_index);
+    
     std::string get_node_string(uint32_t string_index) const;
     std::vector<uint32_t> get_child_indices(uint32_t node_index) const;
     
     void register_builtin_functions();
+    void link_externs();
+    
+    // Integration builtins need to call back into user code
+    enum class BatchMode : uint8_t { UNKNOWN, VECTOR, SCALAR };
+    void evaluate_batch(const Value& function, const std::vector<const std::vector<double>*>& arguments,
+                        std::vector<double>& results, BatchMode& mode);
+    // Whether a function called with column vectors computes its result point
+    // by point: straight-line + - * /, negation and the one-argument math
+    // builtins over its parameters and numbers
+    bool elementwise_function(const Function& function) const;
+    Value builtin_integrate(const std::vector<Value>& args);
+    Value builtin_integrate2(const std::vector<Value>& args);
+    Value builtin_print(const std::vector<Value>& args);
+    Value builtin_sweep(const std::vector<Value>& args);
+    Value builtin_checkpoint(const std::vector<Value>& args);
+    
+    // Identifies the program a snapshot belongs to: its node structure and strings
+    uint64_t program_fingerprint() const;
+    
+    // Identifies a user function's code for sweep() checkpoints: its parameters
+    // and the structure, names and literals of its body
+    uint64_t function_fingerprint(const Function& function) const;
+    
+    // A sweep() worker: shares the parsed program and the analyses made so
+    // far, but runs on private copies of every environment, list and dict
+    Interpreter(const Interpreter& parent, EnvironmentCopier& copier, std::ostream& output);
     
 public:
     explicit Interpreter(const Parser& parser);
     
     // Main execution methods
     void interpret();
+    
+    // Runs the program like interpret(), but runtime errors reach the caller
+    void execute();
     Value interpret_expression(uint32_t node_index);
     
+    // Load the state a checkpoint() call saved in this same program: globals,
+    // user functions and everything they reach. The next execute() carries on
+    // at the top-level statement that made the checkpoint, so a checkpoint
+    // taken as the last statement of a top-level loop resumes the loop.
+    // Locals of functions running at the time are not saved; modules are
+    // imported afresh. Throws RuntimeError if the snapshot cannot be read or
+    // belongs to another program.
+    void restore(const std::string& path);
+    
+    // Calls a function value (user-defined or built-in) with evaluated arguments
+    Value call_function(const Value& function, const std::vector<Value>& args);
+    
+    // Element loops over float lists run as native kernels unless disabled
+    void set_loop_idioms(bool enabled) { loop_idioms_enabled_ = enabled; }
+    
+    // Limit the steps and wall time of everything run from now on, resetting
+    // the count. Exceeding it raises BudgetExceeded. sweep() workers and
+    // modules imported by the program run on the same budget.
+    void set_budget(const ExecutionBudget& budget);
+    
+    // For a module's interpreter: draw on the importer's budget and count
+    // calls toward its call depth, as the two run on one thread
+    void run_for(Interpreter& importer);
+    
+    // AST nodes evaluated since construction or the last set_budget(),
+    // including those of sweep() workers and imported modules
+    uint64_t steps() const { return *spent_ + static_cast<uint64_t>(slice_ - fuel_); }
+    
+    // Indexing proven in range inside counted loops skips its checks unless disabled
+    void set_range_analysis(bool enabled) { range_analysis_enabled_ = enabled; }
+    
+    // Redirect print() and runtime errors, e.g. to capture one request's output
+    void set_output(std::ostream& output, std::ostream& errors) { output_ = &output; errors_ = &errors; }
+    
+    // Operator semantics, shared with constant folding in the optimizer
+    static Value apply_binary_op(BinaryOpType op, const Value& left, const Value& right);
+    static Value apply_unary_op(UnaryOpType op, const Value& operand);
+    bool is_builtin(const std::string& name) const { return builtin_functions_.count(name) != 0; }
+    
     // Environment access
     std::shared_ptr<Environment> get_global_environment() const { return global_env_; }
     std::shared_ptr<Environment> get_current_environment() const { return current_env_; }
     
+    // A global variable or user function by name, as a module member is read
+    bool find_global(const std::string& name, Value& value) const;
+    
+    std::ostream& get_output() const { return *output_; }
+    std::ostream& get_errors() const { return *errors_; }
+    
     // Error handling
     void print_runtime_error(const RuntimeError& error) const;
 };
@@ -0,0 +1,110 @@
+#include "jobs.h"
+#include "optimizer.h"
+#include <sstream>
+#include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+namespace Dakota {
+
+ProgramCache::ProgramCache(bool optimize, size_t capacity) : optimize_(optimize), capacity_(capacity) {}
+
+std::shared_ptr<const CompiledProgram> ProgramCache::get(const std::string& script) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto cached = programs_.find(script);
+        if (cached != programs_.end()) {
+            ++stats_.reused;
+            return cached->second;
+        }
+        ++stats_.compiled;
+    }
+
+    // Compiled outside the lock; two threads racing on a new script both
+    // compile it and the first to finish is kept
+    auto program = std::make_shared<CompiledProgram>();
+    program->script = script;
+    try {
+        Lexer lexer(script);
+        program->tokens = lexer.tokenize();
+        program->parser = std::make_unique<Parser>(program->tokens);
+        program->parser->parse();
+        if (program->parser->has_error()) {
+            program->error = "Parse error: " + program->parser->get_error();
+        } else if (optimize_) {
+            Interpreter scratch(*program->parser);
+            Optimizer(*program->parser, scratch).run();
+        }
+    } catch (const std::exception& e) {
+        program->error = std::string("Error: ") + e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = programs_.emplace(script, program);
+    if (inserted.second) {
+        order_.push_back(script);
+        while (programs_.size() > capacity_) {
+            programs_.erase(order_.front());
+            order_.pop_front();
+        }
+    }
+    return inserted.first->second;
+}
+
+ProgramCacheStats ProgramCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+Value parameter_value(const std::string& text) {
+    if (text == "true") return Value(true);
+    if (text == "false") return Value(false);
+    if (!text.empty() && (std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '-' ||
+                          text[0] == '+' || text[0] == '.')) {
+        char* end = nullptr;
+        errno = 0;
+        long long integer = std::strtoll(text.c_str(), &end, 10);
+        if (*end == '\0' && errno == 0) return Value(static_cast<int64_t>(integer));
+        double number = std::strtod(text.c_str(), &end);
+        if (*end == '\0') return Value(number);
+    }
+    return Value(text);
+}
+
+JobResult run_job(ProgramCache& cache, const JobRequest& request) {
+    auto start = std::chrono::steady_clock::now();
+    JobResult result;
+
+    std::shared_ptr<const CompiledProgram> program = cache.get(request.script);
+    if (!program->error.empty()) {
+        result.ok = false;
+        result.errors = program->error + "\n";
+    } else {
+        std::ostringstream output, errors;
+        try {
+            Interpreter interpreter(*program->parser);
+            interpreter.set_output(output, errors);
+            if (!request.budget.unlimited()) {
+                interpreter.set_budget(request.budget);
+            }
+            auto env = interpreter.get_global_environment();
+            for (const auto& parameter : request.parameters) {
+                env->define(parameter.first, parameter_value(parameter.second));
+            }
+            interpreter.interpret();
+        } catch (const RuntimeError& e) {
+            errors << "Runtime Error: " << e.what() << "\n";
+        } catch (const std::exception& e) {
+            errors << "Error: " << e.what() << "\n";
+        }
+        result.output = output.str();
+        result.errors = errors.str();
+        result.ok = result.errors.empty();
+    }
+
+    result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace Dakota
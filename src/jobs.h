@@ -0,0 +1,76 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "lexer.h"
+#include "parser.h"
+#include "interpreter.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Dakota {
+
+// Constants for running scripts as isolated jobs
+constexpr size_t PROGRAM_CACHE_CAPACITY = 256;   // Compiled scripts kept resident
+
+// One script run: parameters are defined as globals before the script runs.
+// A value that reads fully as an integer or float becomes a number, true and
+// false become booleans, anything else a string.
+struct JobRequest {
+    std::string script;
+    std::vector<std::pair<std::string, std::string>> parameters;
+    ExecutionBudget budget;   // Unlimited by default
+};
+
+struct JobResult {
+    bool ok = true;        // No parse error and nothing written to the error stream
+    std::string output;    // What print() wrote
+    std::string errors;    // Parse and runtime errors
+    double wall_ms = 0.0;  // Compilation (on a cache miss) plus execution
+};
+
+// A lexed, parsed and optimized script. Interpreters only read the parser,
+// so any number of jobs may run one program at the same time.
+struct CompiledProgram {
+    std::string script;
+    std::vector<Token> tokens;         // The parser refers to these
+    std::unique_ptr<Parser> parser;
+    std::string error;                 // Set instead of a usable parser
+};
+
+struct ProgramCacheStats {
+    size_t compiled = 0;
+    size_t reused = 0;
+};
+
+// Compiled programs keyed by script text, shared by every job running the
+// same script. Thread-safe; the oldest programs are evicted past capacity.
+class ProgramCache {
+public:
+    explicit ProgramCache(bool optimize = true, size_t capacity = PROGRAM_CACHE_CAPACITY);
+
+    std::shared_ptr<const CompiledProgram> get(const std::string& script);
+    ProgramCacheStats stats() const;
+
+private:
+    bool optimize_;
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const CompiledProgram>> programs_;
+    std::deque<std::string> order_;   // Oldest first, for eviction
+    ProgramCacheStats stats_;
+};
+
+// Run one job in the calling thread with its own Interpreter, capturing its
+// output and errors. Nothing but the compiled program is shared.
+JobResult run_job(ProgramCache& cache, const JobRequest& request);
+
+// The value a job parameter's text defines
+Value parameter_value(const std::string& text);
+
+} // namespace Dakota
+
+#endif // JOBS_H
@@ -0,0 +1,164 @@
+#include "kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Dakota {
+namespace Kernels {
+
+void fill(double* y, size_t n, double value) {
+    std::fill(y, y + n, value);
+}
+
+void copy(double* y, const double* x, size_t n) {
+    if (y != x && n > 0) {
+        std::memmove(y, x, n * sizeof(double));
+    }
+}
+
+void axpy(double* y, const double* x, size_t n, double a) {
+    for (size_t k = 0; k < n; ++k) {
+        y[k] = y[k] + a * x[k];
+    }
+}
+
+double sum(const double* x, size_t n, double init) {
+    double result = init;
+    for (size_t k = 0; k < n; ++k) {
+        result = result + x[k];
+    }
+    return result;
+}
+
+double dot(const double* x, const double* y, size_t n, double init) {
+    double result = init;
+    for (size_t k = 0; k < n; ++k) {
+        result = result + x[k] * y[k];
+    }
+    return result;
+}
+
+void prefix_sum(double* y, const double* x, size_t n, double carry) {
+    for (size_t k = 0; k < n; ++k) {
+        carry = carry + x[k];
+        y[k] = carry;
+    }
+}
+
+size_t Program::stack_depth() const {
+    size_t depth = 0, deepest = 0;
+    for (const Instruction& instruction : code) {
+        switch (instruction.op) {
+            case Op::LOAD_ARRAY:
+                if (instruction.operand >= arrays.size()) return 0;
+                ++depth;
+                break;
+            case Op::LOAD_SCALAR:
+                if (instruction.operand >= scalars.size()) return 0;
+                ++depth;
+                break;
+            case Op::ADD: case Op::SUB: case Op::MUL: case Op::DIV:
+                if (depth < 2) return 0;
+                --depth;
+                break;
+            default:
+                if (depth < 1) return 0;
+                break;
+        }
+        deepest = std::max(deepest, depth);
+    }
+    if (depth != 1 || deepest > MAX_STACK_DEPTH) return 0;
+    return deepest;
+}
+
+bool Program::has_division() const {
+    return std::any_of(code.begin(), code.end(),
+                       [](const Instruction& instruction) { return instruction.op == Op::DIV; });
+}
+
+namespace {
+
+template <typename Fn>
+void apply_unary(double* a, size_t count, Fn fn) {
+    for (size_t k = 0; k < count; ++k) a[k] = fn(a[k]);
+}
+
+// One block, each instruction runs over the whole block so the inner loops vectorize
+bool evaluate_block(const Program& program, size_t begin, size_t count, double* out) {
+    double stack[MAX_STACK_DEPTH][KERNEL_BLOCK];
+    size_t top = 0;
+
+    for (const Instruction& instruction : program.code) {
+        double* a = top >= 2 ? stack[top - 2] : nullptr;
+        double* b = top >= 1 ? stack[top - 1] : nullptr;
+        switch (instruction.op) {
+            case Op::LOAD_ARRAY:
+                std::memcpy(stack[top++], program.arrays[instruction.operand] + begin, count * sizeof(double));
+                break;
+            case Op::LOAD_SCALAR:
+                std::fill(stack[top], stack[top] + count, program.scalars[instruction.operand]);
+                ++top;
+                break;
+            case Op::ADD:
+                for (size_t k = 0; k < count; ++k) a[k] = a[k] + b[k];
+                --top;
+                break;
+            case Op::SUB:
+                for (size_t k = 0; k < count; ++k) a[k] = a[k] - b[k];
+                --top;
+                break;
+            case Op::MUL:
+                for (size_t k = 0; k < count; ++k) a[k] = a[k] * b[k];
+                --top;
+                break;
+            case Op::DIV:
+                for (size_t k = 0; k < count; ++k) {
+                    if (b[k] == 0.0) return false;
+                    a[k] = a[k] / b[k];
+                }
+                --top;
+                break;
+            case Op::NEG:
+                apply_unary(b, count, [](double x) { return -x; });
+                break;
+            case Op::SQRT:
+                apply_unary(b, count, [](double x) { return std::sqrt(x); });
+                break;
+            case Op::EXP:
+                apply_unary(b, count, [](double x) { return std::exp(x); });
+                break;
+            case Op::LOG:
+                apply_unary(b, count, [](double x) { return std::log(x); });
+                break;
+            case Op::SIN:
+                apply_unary(b, count, [](double x) { return std::sin(x); });
+                break;
+            case Op::COS:
+                apply_unary(b, count, [](double x) { return std::cos(x); });
+                break;
+            case Op::TAN:
+                apply_unary(b, count, [](double x) { return std::tan(x); });
+                break;
+            case Op::ABS:
+                apply_unary(b, count, [](double x) { return std::abs(x); });
+                break;
+        }
+    }
+    std::memcpy(out, stack[0], count * sizeof(double));
+    return true;
+}
+
+} // anonymous namespace
+
+bool evaluate(const Program& program, size_t begin, size_t count, double* out) {
+    for (size_t offset = 0; offset < count; offset += KERNEL_BLOCK) {
+        size_t block = std::min(KERNEL_BLOCK, count - offset);
+        if (!evaluate_block(program, begin + offset, block, out + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace Kernels
+} // namespace Dakota
@@ -0,0 +1,55 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dakota {
+namespace Kernels {
+
+// Constants for elementwise kernels
+constexpr size_t KERNEL_BLOCK = 256;      // Elements evaluated per pass over an expression
+constexpr size_t MAX_STACK_DEPTH = 16;    // Deepest expression a program may need
+
+// Every kernel applies the same double operations in the same order as the
+// element loop it replaces, so results match the interpreter bit for bit.
+// Reductions and prefix sums stay sequential for that reason.
+void fill(double* y, size_t n, double value);
+void copy(double* y, const double* x, size_t n);
+void axpy(double* y, const double* x, size_t n, double a);       // y[k] = y[k] + a * x[k]
+double sum(const double* x, size_t n, double init);              // init + x[0] + x[1] + ...
+double dot(const double* x, const double* y, size_t n, double init);
+void prefix_sum(double* y, const double* x, size_t n, double carry);  // y[k] = y[k - 1] + x[k]
+
+// Postfix program for one element of an elementwise expression
+enum class Op : uint8_t {
+    LOAD_ARRAY,   // Push arrays[operand][k]
+    LOAD_SCALAR,  // Push scalars[operand]
+    ADD, SUB, MUL, DIV, NEG,
+    SQRT, EXP, LOG, SIN, COS, TAN, ABS
+};
+
+struct Instruction {
+    Op op;
+    uint32_t operand;
+};
+
+struct Program {
+    std::vector<Instruction> code;
+    std::vector<const double*> arrays;
+    std::vector<double> scalars;
+
+    // Stack depth needed, or 0 when the program is malformed or too deep
+    size_t stack_depth() const;
+    bool has_division() const;
+};
+
+// out[k - begin] = program(k) for k in [begin, begin + count). Returns false
+// on division by zero, in which case out holds a partial result.
+bool evaluate(const Program& program, size_t begin, size_t count, double* out);
+
+} // namespace Kernels
+} // namespace Dakota
+
+#endif // KERNELS_H
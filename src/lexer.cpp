@@ -1,12 +1,91 @@
 #include "lexer.h"
 #include <iostream>
-#include <cctype>
+#include <array>
+#include <iterator>
 #include <stdexcept>
 
 namespace Dakota {
 
-// Keywords mapping
-const std::unordered_map<std::string, TokenType> Lexer::keywords = {
+namespace {
+
+// Character classes for next_token's dispatch: one table lookup per character
+// instead of a chain of comparisons
+enum CharClass : uint8_t {
+    CLASS_INVALID = 0,
+    CLASS_SPACE,        // ' ', '\t', '\r'
+    CLASS_NEWLINE,
+    CLASS_DIGIT,
+    CLASS_IDENTIFIER,   // Letters and '_'
+    CLASS_QUOTE,
+    CLASS_COMMENT,      // '\'
+    CLASS_OPERATOR      // See OPERATOR_TRANSITIONS
+};
+
+constexpr const char* OPERATOR_CHARS = "+-*/=<>!()[]{},;:.";
+
+constexpr std::array<uint8_t, 256> make_char_classes() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = CLASS_IDENTIFIER;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = CLASS_IDENTIFIER;
+    for (int c = '0'; c <= '9'; ++c) table[c] = CLASS_DIGIT;
+    table['_'] = CLASS_IDENTIFIER;
+    table[' '] = CLASS_SPACE;
+    table['\t'] = CLASS_SPACE;
+    table['\r'] = CLASS_SPACE;
+    table['\n'] = CLASS_NEWLINE;
+    table['"'] = CLASS_QUOTE;
+    table['\\'] = CLASS_COMMENT;
+    for (const char* op = OPERATOR_CHARS; *op; ++op) {
+        table[static_cast<unsigned char>(*op)] = CLASS_OPERATOR;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = make_char_classes();
+
+// Operator transitions: the token a character forms on its own, and the
+// token it forms when followed by `next` ('=' for <=, '*' for **, ...)
+struct OperatorTransition {
+    TokenType single;   // INVALID if the character cannot stand alone
+    char next;          // '\0' if there is no two-character form
+    TokenType pair;
+};
+
+constexpr std::array<OperatorTransition, 256> make_operator_transitions() {
+    std::array<OperatorTransition, 256> table{};
+    for (auto& entry : table) entry = {TokenType::INVALID, '\0', TokenType::INVALID};
+    table['+'] = {TokenType::PLUS, '\0', TokenType::INVALID};
+    table['-'] = {TokenType::MINUS, '>', TokenType::ARROW};
+    table['*'] = {TokenType::MULTIPLY, '*', TokenType::POWER};
+    table['/'] = {TokenType::DIVIDE, '\0', TokenType::INVALID};
+    table['='] = {TokenType::ASSIGN, '=', TokenType::EQUAL};
+    table['!'] = {TokenType::INVALID, '=', TokenType::NOT_EQUAL};
+    table['<'] = {TokenType::LESS, '=', TokenType::LESS_EQUAL};
+    table['>'] = {TokenType::GREATER, '=', TokenType::GREATER_EQUAL};
+    table['('] = {TokenType::LPAREN, '\0', TokenType::INVALID};
+    table[')'] = {TokenType::RPAREN, '\0', TokenType::INVALID};
+    table['['] = {TokenType::LBRACKET, '\0', TokenType::INVALID};
+    table[']'] = {TokenType::RBRACKET, '\0', TokenType::INVALID};
+    table['{'] = {TokenType::LBRACE, '\0', TokenType::INVALID};
+    table['}'] = {TokenType::RBRACE, '\0', TokenType::INVALID};
+    table[','] = {TokenType::COMMA, '\0', TokenType::INVALID};
+    table[';'] = {TokenType::SEMICOLON, '\0', TokenType::INVALID};
+    table[':'] = {TokenType::COLON, '\0', TokenType::INVALID};
+    table['.'] = {TokenType::DOT, '\0', TokenType::INVALID};
+    return table;
+}
+
+constexpr std::array<OperatorTransition, 256> OPERATOR_TRANSITIONS = make_operator_transitions();
+
+// Keywords, looked up by a perfect hash of the first and last characters:
+// every keyword has its own slot, so one comparison of the source span
+// decides whether an identifier is a keyword
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr Keyword KEYWORDS[] = {
     {"if", TokenType::IF},
     {"else", TokenType::ELSE},
     {"elif", TokenType::ELIF},
@@ -20,9 +99,47 @@ const std::unordered_map<std::string, TokenType> Lexer::keywords = {
     {"and", TokenType::AND},
     {"or", TokenType::OR},
     {"not", TokenType::NOT},
-    {"mult", TokenType::MATMUL}
+    {"mult", TokenType::MATMUL},
+    {"import", TokenType::IMPORT},
+    {"extern", TokenType::EXTERN}
 };
 
+constexpr size_t KEYWORD_SLOTS = 32;
+
+constexpr size_t keyword_slot(std::string_view text) {
+    return (static_cast<unsigned char>(text.front()) + 5u * static_cast<unsigned char>(text.back()) +
+            10u * text.size()) & (KEYWORD_SLOTS - 1);
+}
+
+constexpr bool keyword_hash_is_perfect() {
+    for (size_t i = 0; i < std::size(KEYWORDS); ++i) {
+        for (size_t j = i + 1; j < std::size(KEYWORDS); ++j) {
+            if (keyword_slot(KEYWORDS[i].text) == keyword_slot(KEYWORDS[j].text)) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(keyword_hash_is_perfect(), "Keyword hash collides, adjust keyword_slot");
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> make_keyword_table() {
+    std::array<Keyword, KEYWORD_SLOTS> table{};
+    for (auto& entry : table) entry = {std::string_view(), TokenType::IDENTIFIER};
+    for (const Keyword& keyword : KEYWORDS) {
+        table[keyword_slot(keyword.text)] = keyword;
+    }
+    return table;
+}
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> KEYWORD_TABLE = make_keyword_table();
+
+} // anonymous namespace
+
+TokenType Lexer::keyword_type(std::string_view text) {
+    const Keyword& keyword = KEYWORD_TABLE[keyword_slot(text)];
+    return keyword.text == text ? keyword.type : TokenType::IDENTIFIER;
+}
+
 Lexer::Lexer(const std::string& source_code, int tab_size, bool preserve_comments) 
     : source(source_code), position(0), line(1), column(1), 
       indent_style(Lexer::IndentStyle::UNKNOWN), base_indent(0), 
@@ -43,72 +160,66 @@ void Lexer::advance() {
     current_char = position < source.length() ? source[position] : '\0';
 }
 
+void Lexer::advance_span(size_t length) {
+    position += length;
+    column += length;
+    current_char = position < source.length() ? source[position] : '\0';
+}
+
 char Lexer::peek(size_t offset) const {
     size_t peek_pos = position + offset;
     return peek_pos < source.length() ? source[peek_pos] : '\0';
 }
 
 void Lexer::skip_whitespace() {
-    while (current_char == ' ' || current_char == '\t' || current_char == '\r') {
-        advance();
+    size_t end = position;
+    while (end < source.length() && CHAR_CLASSES[static_cast<unsigned char>(source[end])] == CLASS_SPACE) {
+        end++;
     }
+    advance_span(end - position);
 }
 
 bool Lexer::is_alpha(char c) const {
-    return std::isalpha(c) || c == '_';
+    return CHAR_CLASSES[static_cast<unsigned char>(c)] == CLASS_IDENTIFIER;
 }
 
 bool Lexer::is_digit(char c) const {
-    return std::isdigit(c);
+    return CHAR_CLASSES[static_cast<unsigned char>(c)] == CLASS_DIGIT;
 }
 
 bool Lexer::is_alnum(char c) const {
-    return std::isalnum(c) || c == '_';
+    uint8_t char_class = CHAR_CLASSES[static_cast<unsigned char>(c)];
+    return char_class == CLASS_IDENTIFIER || char_class == CLASS_DIGIT;
 }
 
 Token Lexer::make_number() {
-    size_t start_line = line;
     size_t start_column = column;
-    std::string number_str;
+    size_t end = position;
     bool is_float = false;
+    auto digit_at = [this](size_t index) { return index < source.length() && is_digit(source[index]); };
     
     // Handle integer part
-    while (is_digit(current_char)) {
-        number_str += current_char;
-        advance();
-    }
+    while (digit_at(end)) end++;
     
     // Handle decimal point
-    if (current_char == '.' && is_digit(peek())) {
+    if (end < source.length() && source[end] == '.' && digit_at(end + 1)) {
         is_float = true;
-        number_str += current_char;
-        advance();
-        
-        while (is_digit(current_char)) {
-            number_str += current_char;
-            advance();
-        }
+        end++;
+        while (digit_at(end)) end++;
     }
     
     // Handle scientific notation
-    if (current_char == 'e' || current_char == 'E') {
+    if (end < source.length() && (source[end] == 'e' || source[end] == 'E')) {
         is_float = true;
-        number_str += current_char;
-        advance();
-        
-        if (current_char == '+' || current_char == '-') {
-            number_str += current_char;
-            advance();
-        }
-        
-        while (is_digit(current_char)) {
-            number_str += current_char;
-            advance();
-        }
+        end++;
+        if (end < source.length() && (source[end] == '+' || source[end] == '-')) end++;
+        while (digit_at(end)) end++;
     }
     
+    std::string number_str = source.substr(position, end - position);
+    advance_span(end - position);
     TokenType type = is_float ? TokenType::FLOAT : TokenType::INTEGER;
-    return Token(type, number_str, start_line, start_column);
+    return Token(type, std::move(number_str), line, start_column);
 }
 
 Token Lexer::make_string() {
@@ -145,35 +256,31 @@ Token Lexer::make_string() {
 }
 
 Token Lexer::make_identifier() {
-    size_t start_line = line;
     size_t start_column = column;
-    std::string identifier;
+    size_t end = position;
+    while (end < source.length() && is_alnum(source[end])) end++;
     
-    while (is_alnum(current_char)) {
-        identifier += current_char;
-        advance();
-    }
-    
-    // Check if it's a keyword
-    auto keyword_it = keywords.find(identifier);
-    TokenType type = (keyword_it != keywords.end()) ? keyword_it->second : TokenType::IDENTIFIER;
+    // Keywords are recognized on the source span, before any string is built
+    std::string_view text(source.data() + position, end - position);
+    TokenType type = keyword_type(text);
+    std::string identifier(text);
+    advance_span(text.size());
     
-    return Token(type, identifier, start_line, start_column);
+    return Token(type, std::move(identifier), line, start_column);
 }
 
 Token Lexer::make_comment() {
     size_t start_line = line;
     size_t start_column = column;
-    std::string comment;
     
     advance(); // Skip the backslash
     
-    while (current_char != '\n' && current_char != '\0') {
-        comment += current_char;
-        advance();
-    }
+    size_t end = source.find('\n', position);
+    if (end == std::string::npos) end = source.length();
+    std::string comment = source.substr(position, end - position);
+    advance_span(end - position);
     
-    return Token(TokenType::COMMENT, comment, start_line, start_column);
+    return Token(TokenType::COMMENT, std::move(comment), start_line, start_column);
 }
 
 void Lexer::validate_indentation_style(bool has_spaces, bool has_tabs, int current_indent) {
@@ -325,94 +432,59 @@ Token Lexer::next_token() {
     while (current_char != '\0') {
         size_t start_line = line;
         size_t start_column = column;
+        unsigned char c = static_cast<unsigned char>(current_char);
         
-        // Handle newlines and indentation
-        if (current_char == '\n') {
-            advance();
-            return Token(TokenType::NEWLINE, "\n", start_line, start_column);
-        }
-        
-        // Skip whitespace (except newlines)
-        if (current_char == ' ' || current_char == '\t' || current_char == '\r') {
-            skip_whitespace();
-            continue;
-        }
-        
-        // Numbers
-        if (is_digit(current_char)) {
-            return make_number();
-        }
-        
-        // Strings
-        if (current_char == '"') {
-            return make_string();
-        }
-        
-        // Identifiers and keywords
-        if (is_alpha(current_char)) {
-            return make_identifier();
-        }
-        
-        // Comments - skip entirely for performance (unless preserve_comments is true)
-        if (current_char == '\\') {
-            if (preserve_comments) {
-                return make_comment();
-            } else {
-                // Skip comment without creating a token
-                advance(); // Skip the backslash
-                while (current_char != '\n' && current_char != '\0') {
+        switch (CHAR_CLASSES[c]) {
+            // Handle newlines and indentation
+            case CLASS_NEWLINE:
+                advance();
+                return Token(TokenType::NEWLINE, "\n", start_line, start_column);
+            
+            // Skip whitespace (except newlines)
+            case CLASS_SPACE:
+                skip_whitespace();
+                continue;
+            
+            case CLASS_DIGIT:
+                return make_number();
+            
+            case CLASS_QUOTE:
+                return make_string();
+            
+            // Identifiers and keywords
+            case CLASS_IDENTIFIER:
+                return make_identifier();
+            
+            // Comments - skip entirely for performance (unless preserve_comments is true)
+            case CLASS_COMMENT:
+                if (preserve_comments) {
+                    return make_comment();
+                } else {
+                    size_t end = source.find('\n', position);
+                    advance_span((end == std::string::npos ? source.length() : end) - position);
+                    continue; // Go to next iteration to get the next token
+                }
+            
+            case CLASS_OPERATOR: {
+                const OperatorTransition& transition = OPERATOR_TRANSITIONS[c];
+                if (transition.next != '\0' && peek() == transition.next) {
+                    std::string text = source.substr(position, 2);
+                    advance_span(2);
+                    return Token(transition.pair, std::move(text), start_line, start_column);
+                }
+                if (transition.single != TokenType::INVALID) {
                     advance();
+                    return Token(transition.single, std::string(1, static_cast<char>(c)), start_line, start_column);
                 }
-                continue; // Go to next iteration to get the next token
+                break;
             }
-        }
-        
-        // Two-character operators
-        if (current_char == '=' && peek() == '=') {
-            advance(); advance();
-            return Token(TokenType::EQUAL, "==", start_line, start_column);
-        }
-        if (current_char == '!' && peek() == '=') {
-            advance(); advance();
-            return Token(TokenType::NOT_EQUAL, "!=", start_line, start_column);
-        }
-        if (current_char == '<' && peek() == '=') {
-            advance(); advance();
-            return Token(TokenType::LESS_EQUAL, "<=", start_line, start_column);
-        }
-        if (current_char == '>' && peek() == '=') {
-            advance(); advance();
-            return Token(TokenType::GREATER_EQUAL, ">=", start_line, start_column);
-        }
-        if (current_char == '*' && peek() == '*') {
-            advance(); advance();
-            return Token(TokenType::POWER, "**", start_line, start_column);
-        }
-        
-        // Single-character tokens
-        switch (current_char) {
-            case '+': advance(); return Token(TokenType::PLUS, "+", start_line, start_column);
-            case '-': advance(); return Token(TokenType::MINUS, "-", start_line, start_column);
-            case '*': advance(); return Token(TokenType::MULTIPLY, "*", start_line, start_column);
-            case '/': advance(); return Token(TokenType::DIVIDE, "/", start_line, start_column);
-            case '=': advance(); return Token(TokenType::ASSIGN, "=", start_line, start_column);
-            case '<': advance(); return Token(TokenType::LESS, "<", start_line, start_column);
-            case '>': advance(); return Token(TokenType::GREATER, ">", start_line, start_column);
-            case '(': advance(); return Token(TokenType::LPAREN, "(", start_line, start_column);
-            case ')': advance(); return Token(TokenType::RPAREN, ")", start_line, start_column);
-            case '[': advance(); return Token(TokenType::LBRACKET, "[", start_line, start_column);
-            case ']': advance(); return Token(TokenType::RBRACKET, "]", start_line, start_column);
-            case '{': advance(); return Token(TokenType::LBRACE, "{", start_line, start_column);
-            case '}': advance(); return Token(TokenType::RBRACE, "}", start_line, start_column);
-            case ',': advance(); return Token(TokenType::COMMA, ",", start_line, start_column);
-            case ';': advance(); return Token(TokenType::SEMICOLON, ";", start_line, start_column);
-            case ':': advance(); return Token(TokenType::COLON, ":", start_line, start_column);
-            case '.': advance(); return Token(TokenType::DOT, ".", start_line, start_column);
             
             default:
-                advance();
-                return Token(TokenType::INVALID, std::string(1, source[position-1]), start_line, start_column);
+                break;
         }
+        
+        advance();
+        return Token(TokenType::INVALID, std::string(1, source[position-1]), start_line, start_column);
     }
     
     return Token(TokenType::EOF_TOKEN, "", line, column);
@@ -420,6 +492,7 @@ Token Lexer::next_token() {
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    tokens.reserve(source.length() / 6 + 16);  // About one token per six source bytes in typical code
     bool at_line_start = true;
     
     while (current_char != '\0') {
@@ -444,9 +517,10 @@ std::vector<Token> Lexer::tokenize() {
             // Skip comment tokens when not preserving
             continue;
         }
-        tokens.push_back(token);
+        bool at_end = token.type == TokenType::EOF_TOKEN;
+        tokens.push_back(std::move(token));
         
-        if (token.type == TokenType::EOF_TOKEN) {
+        if (at_end) {
             break;
         }
     }
@@ -475,6 +549,8 @@ std::string Lexer::token_type_to_string(TokenType type) const {
         case TokenType::IN: return "IN";
         case TokenType::FUNCTION: return "FUNCTION";
         case TokenType::RETURN: return "RETURN";
+        case TokenType::IMPORT: return "IMPORT";
+        case TokenType::EXTERN: return "EXTERN";
         case TokenType::TRUE: return "TRUE";
         case TokenType::FALSE: return "FALSE";
         case TokenType::PLUS: return "PLUS";
@@ -502,6 +578,7 @@ std::string Lexer::token_type_to_string(TokenType type) const {
         case TokenType::COMMA: return "COMMA";
         case TokenType::SEMICOLON: return "SEMICOLON";
         case TokenType::COLON: return "COLON";
+        case TokenType::ARROW: return "ARROW";
         case TokenType::DOT: return "DOT";
         case TokenType::NEWLINE: return "NEWLINE";
         case TokenType::INDENT: return "INDENT";
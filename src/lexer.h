@@ -2,6 +2,7 @@
 #define LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -27,6 +28,8 @@ enum class TokenType {
     IN,             // in
     FUNCTION,       // function
     RETURN,         // return
+    IMPORT,         // import
+    EXTERN,         // extern
     TRUE,           // true
     FALSE,          // false
     
@@ -67,6 +70,7 @@ enum class TokenType {
     COMMA,          // ,
     SEMICOLON,      // ; (for matrix row separation)
     COLON,          // :
+    ARROW,          // -> (extern return type)
     DOT,            // .
     
     // Special
@@ -88,8 +92,8 @@ struct Token {
     size_t line;
     size_t column;
     
-    Token(TokenType t, const std::string& v, size_t l, size_t c)
-        : type(t), value(v), line(l), column(c) {}
+    Token(TokenType t, std::string v, size_t l, size_t c)
+        : type(t), value(std::move(v)), line(l), column(c) {}
 };
 
 class Lexer {
@@ -111,11 +115,12 @@ private:
     bool first_indent_detected;
     bool preserve_comments; // Whether to include comments in token stream
     
-    // Keywords map
-    static const std::unordered_map<std::string, TokenType> keywords;
+    // Keyword for an identifier's text, or IDENTIFIER (perfect hash, see lexer.cpp)
+    static TokenType keyword_type(std::string_view text);
     
     // Helper methods
     void advance();
+    void advance_span(size_t length);  // Skip characters known not to include a newline
     char peek(size_t offset = 1) const;
     void skip_whitespace();
     Token make_number();
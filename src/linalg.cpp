@@ -0,0 +1,365 @@
+#include "linalg.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Dakota {
+namespace LinAlg {
+
+DenseMatrix from_nested(const Matrix& matrix) {
+    size_t rows = matrix.size();
+    size_t cols = rows > 0 ? matrix[0].size() : 0;
+
+    DenseMatrix result(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        if (matrix[i].size() != cols) {
+            throw std::invalid_argument("Matrix rows have inconsistent lengths");
+        }
+        std::copy(matrix[i].begin(), matrix[i].end(), result.row(i));
+    }
+    return result;
+}
+
+Matrix to_nested(const DenseMatrix& matrix) {
+    Matrix result(matrix.rows);
+    for (size_t i = 0; i < matrix.rows; ++i) {
+        result[i].assign(matrix.row(i), matrix.row(i) + matrix.cols);
+    }
+    return result;
+}
+
+namespace {
+
+// C += sign * A * B. Blocked over k and n so the touched rows of B stay
+// cache resident, i-p-j order keeps the innermost loop unit-stride on B and C
+template <typename T>
+void gemm_accumulate(size_t m, size_t n, size_t k, T sign,
+                     const T* a, size_t lda,
+                     const T* b, size_t ldb,
+                     T* c, size_t ldc) {
+    for (size_t kk = 0; kk < k; kk += GEMM_BLOCK_SIZE) {
+        size_t k_end = std::min(kk + GEMM_BLOCK_SIZE, k);
+        for (size_t jj = 0; jj < n; jj += GEMM_BLOCK_SIZE) {
+            size_t j_end = std::min(jj + GEMM_BLOCK_SIZE, n);
+            for (size_t i = 0; i < m; ++i) {
+                T* c_row = c + i * ldc;
+                const T* a_row = a + i * lda;
+                for (size_t p = kk; p < k_end; ++p) {
+                    T a_ip = sign * a_row[p];
+                    if (a_ip == T(0)) continue;
+                    const T* b_row = b + p * ldb;
+                    for (size_t j = jj; j < j_end; ++j) {
+                        c_row[j] += a_ip * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+template <typename T>
+void gemm_subtract(size_t m, size_t n, size_t k,
+                   const T* a, size_t lda,
+                   const T* b, size_t ldb,
+                   T* c, size_t ldc) {
+    gemm_accumulate(m, n, k, T(-1), a, lda, b, ldb, c, ldc);
+}
+
+DenseMatrix multiply(const DenseMatrix& a, const DenseMatrix& b) {
+    if (a.cols != b.rows) {
+        throw std::invalid_argument("Invalid matrix dimensions for multiplication");
+    }
+    DenseMatrix c(a.rows, b.cols, 0.0);
+    gemm_accumulate(a.rows, b.cols, a.cols, 1.0, a.data.data(), a.cols,
+                    b.data.data(), b.cols, c.data.data(), c.cols);
+    return c;
+}
+
+DenseMatrix identity(size_t n) {
+    DenseMatrix result(n, n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        result(i, i) = 1.0;
+    }
+    return result;
+}
+
+template <typename T>
+bool lu_factor(Dense<T>& a, std::vector<size_t>& pivots) {
+    if (!a.is_square()) {
+        throw std::invalid_argument("LU factorization requires a square matrix");
+    }
+
+    const size_t n = a.rows;
+    pivots.assign(n, 0);
+    bool nonsingular = true;
+
+    for (size_t k0 = 0; k0 < n; k0 += LU_BLOCK_SIZE) {
+        size_t k1 = std::min(k0 + LU_BLOCK_SIZE, n);
+
+        // Unblocked factorization of the panel (columns k0..k1-1, rows k0..n-1)
+        for (size_t k = k0; k < k1; ++k) {
+            size_t pivot_row = k;
+            T pivot_abs = std::abs(a(k, k));
+            for (size_t i = k + 1; i < n; ++i) {
+                T candidate = std::abs(a(i, k));
+                if (candidate > pivot_abs) {
+                    pivot_abs = candidate;
+                    pivot_row = i;
+                }
+            }
+
+            pivots[k] = pivot_row;
+            if (pivot_row != k) {
+                // Swap whole rows so the trailing matrix and L stay consistent
+                std::swap_ranges(a.row(k), a.row(k) + n, a.row(pivot_row));
+            }
+
+            T pivot = a(k, k);
+            if (pivot == T(0)) {
+                nonsingular = false;
+                continue;
+            }
+
+            for (size_t i = k + 1; i < n; ++i) {
+                T l_ik = a(i, k) / pivot;
+                a(i, k) = l_ik;
+                if (l_ik == T(0)) continue;
+                T* a_row = a.row(i);
+                const T* k_row = a.row(k);
+                for (size_t j = k + 1; j < k1; ++j) {
+                    a_row[j] -= l_ik * k_row[j];
+                }
+            }
+        }
+
+        if (k1 < n) {
+            // U12 = L11^-1 A12 (unit lower triangular forward substitution)
+            for (size_t k = k0; k < k1; ++k) {
+                const T* k_row = a.row(k);
+                for (size_t i = k + 1; i < k1; ++i) {
+                    T l_ik = a(i, k);
+                    if (l_ik == T(0)) continue;
+                    T* a_row = a.row(i);
+                    for (size_t j = k1; j < n; ++j) {
+                        a_row[j] -= l_ik * k_row[j];
+                    }
+                }
+            }
+
+            // Trailing update A22 -= L21 * U12 - this is where the time goes
+            gemm_subtract(n - k1, n - k1, k1 - k0,
+                          &a(k1, k0), n,
+                          &a(k0, k1), n,
+                          &a(k1, k1), n);
+        }
+    }
+
+    return nonsingular;
+}
+
+template <typename T>
+void lu_solve(const Dense<T>& lu, const std::vector<size_t>& pivots, Dense<T>& b) {
+    const size_t n = lu.rows;
+    const size_t m = b.cols;
+    if (b.rows != n) {
+        throw std::invalid_argument("Right-hand side has the wrong number of rows");
+    }
+
+    // Apply the row interchanges in factorization order
+    for (size_t k = 0; k < n; ++k) {
+        if (pivots[k] != k) {
+            std::swap_ranges(b.row(k), b.row(k) + m, b.row(pivots[k]));
+        }
+    }
+
+    // Forward substitution with unit lower triangular L
+    for (size_t i = 1; i < n; ++i) {
+        T* b_row = b.row(i);
+        for (size_t k = 0; k < i; ++k) {
+            T l_ik = lu(i, k);
+            if (l_ik == T(0)) continue;
+            const T* k_row = b.row(k);
+            for (size_t j = 0; j < m; ++j) {
+                b_row[j] -= l_ik * k_row[j];
+            }
+        }
+    }
+
+    // Back substitution with U
+    for (size_t i = n; i-- > 0;) {
+        T* b_row = b.row(i);
+        for (size_t k = i + 1; k < n; ++k) {
+            T u_ik = lu(i, k);
+            if (u_ik == T(0)) continue;
+            const T* k_row = b.row(k);
+            for (size_t j = 0; j < m; ++j) {
+                b_row[j] -= u_ik * k_row[j];
+            }
+        }
+        T diagonal = lu(i, i);
+        for (size_t j = 0; j < m; ++j) {
+            b_row[j] /= diagonal;
+        }
+    }
+}
+
+double norm_inf(const DenseMatrix& a) {
+    double result = 0.0;
+    for (size_t i = 0; i < a.rows; ++i) {
+        double row_sum = 0.0;
+        const double* row = a.row(i);
+        for (size_t j = 0; j < a.cols; ++j) {
+            row_sum += std::abs(row[j]);
+        }
+        result = std::max(result, row_sum);
+    }
+    return result;
+}
+
+double norm_one(const DenseMatrix& a) {
+    std::vector<double> column_sums(a.cols, 0.0);
+    for (size_t i = 0; i < a.rows; ++i) {
+        const double* row = a.row(i);
+        for (size_t j = 0; j < a.cols; ++j) {
+            column_sums[j] += std::abs(row[j]);
+        }
+    }
+    double result = 0.0;
+    for (double sum : column_sums) {
+        result = std::max(result, sum);
+    }
+    return result;
+}
+
+double max_abs(const DenseMatrix& a) {
+    double result = 0.0;
+    for (double value : a.data) {
+        // NaN must not be absorbed by max(), the refinement loop relies on seeing it
+        if (std::isnan(value)) return value;
+        result = std::max(result, std::abs(value));
+    }
+    return result;
+}
+
+namespace {
+
+// R = B - A X computed entirely in double precision
+DenseMatrix residual(const DenseMatrix& a, const DenseMatrix& x, const DenseMatrix& b) {
+    DenseMatrix r = b;
+    gemm_subtract(a.rows, b.cols, a.cols, a.data.data(), a.cols,
+                  x.data.data(), x.cols, r.data.data(), r.cols);
+    return r;
+}
+
+DenseMatrix solve_double(const DenseMatrix& a, const DenseMatrix& b, SolveReport* report) {
+    DenseMatrix lu = a;
+    std::vector<size_t> pivots;
+    if (!lu_factor(lu, pivots)) {
+        throw std::domain_error("Matrix is singular");
+    }
+
+    DenseMatrix x = b;
+    lu_solve(lu, pivots, x);
+
+    if (report) {
+        report->residual_norm = max_abs(residual(a, x, b));
+    }
+    return x;
+}
+
+// Factor once in float32, then recover double accuracy by correcting against
+// residuals computed in double. Returns false if refinement does not converge.
+bool solve_mixed(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& x, SolveReport* report) {
+    // Entries outside float range would overflow in the working copy
+    if (max_abs(a) > static_cast<double>(std::numeric_limits<float>::max())) {
+        return false;
+    }
+
+    Dense<float> lu = convert<float>(a);
+    std::vector<size_t> pivots;
+    if (!lu_factor(lu, pivots)) {
+        return false;
+    }
+
+    const double a_norm = norm_inf(a);
+    const double tolerance = std::sqrt(static_cast<double>(a.rows)) *
+                             std::numeric_limits<double>::epsilon();
+
+    x = DenseMatrix(b.rows, b.cols, 0.0);
+    DenseMatrix r = b;
+    double previous_norm = std::numeric_limits<double>::infinity();
+
+    for (int iteration = 1; iteration <= MAX_REFINEMENT_ITERATIONS; ++iteration) {
+        Dense<float> correction = convert<float>(r);
+        lu_solve(lu, pivots, correction);
+        for (size_t i = 0; i < x.data.size(); ++i) {
+            x.data[i] += static_cast<double>(correction.data[i]);
+        }
+
+        r = residual(a, x, b);
+        double r_norm = max_abs(r);
+        if (report) {
+            report->refinement_iterations = iteration;
+            report->residual_norm = r_norm;
+        }
+
+        if (std::isnan(r_norm)) {
+            return false;
+        }
+        if (r_norm <= max_abs(x) * a_norm * tolerance) {
+            return true;
+        }
+        // No progress means the float factorization is too inaccurate for this A
+        if (r_norm >= previous_norm) {
+            return false;
+        }
+        previous_norm = r_norm;
+    }
+
+    return false;
+}
+
+} // anonymous namespace
+
+DenseMatrix solve(const DenseMatrix& a, const DenseMatrix& b, SolveMode mode, SolveReport* report) {
+    if (a.rows == 0 || !a.is_square()) {
+        throw std::invalid_argument("solve() requires a non-empty square coefficient matrix");
+    }
+    if (b.rows != a.rows || b.cols == 0) {
+        throw std::invalid_argument("solve() right-hand side must have " +
+                                    std::to_string(a.rows) + " rows");
+    }
+
+    if (report) {
+        *report = SolveReport();
+        report->mode_used = mode;
+    }
+
+    if (mode == SolveMode::MIXED) {
+        DenseMatrix x;
+        if (solve_mixed(a, b, x, report)) {
+            return x;
+        }
+        if (report) {
+            report->fell_back = true;
+            report->mode_used = SolveMode::DOUBLE;
+        }
+    }
+
+    return solve_double(a, b, report);
+}
+
+// Explicit instantiations for the two working precisions
+template void gemm_subtract<float>(size_t, size_t, size_t, const float*, size_t,
+                                   const float*, size_t, float*, size_t);
+template void gemm_subtract<double>(size_t, size_t, size_t, const double*, size_t,
+                                    const double*, size_t, double*, size_t);
+template bool lu_factor<float>(Dense<float>&, std::vector<size_t>&);
+template bool lu_factor<double>(Dense<double>&, std::vector<size_t>&);
+template void lu_solve<float>(const Dense<float>&, const std::vector<size_t>&, Dense<float>&);
+template void lu_solve<double>(const Dense<double>&, const std::vector<size_t>&, Dense<double>&);
+
+} // namespace LinAlg
+} // namespace Dakota
@@ -0,0 +1,106 @@
+#ifndef LINALG_H
+#define LINALG_H
+
+#include "pool.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Dakota {
+namespace LinAlg {
+
+// Constants for dense kernel configuration
+constexpr size_t LU_BLOCK_SIZE = 64;           // Panel width for blocked LU
+constexpr size_t GEMM_BLOCK_SIZE = 128;        // Cache block for matrix multiply
+constexpr int MAX_REFINEMENT_ITERATIONS = 30;  // Same limit LAPACK's dsgesv uses
+constexpr double PARALLEL_GEMM_MIN_FLOPS = 4.0e6; // Below this threading costs more than it saves
+
+// Row-major dense matrix on contiguous storage
+// The interpreter's nested-vector matrices are converted at the kernel boundary
+template <typename T>
+struct Dense {
+    size_t rows;
+    size_t cols;
+    PooledVector<T> data;
+
+    Dense() : rows(0), cols(0) {}
+    Dense(size_t r, size_t c, T fill = T()) : rows(r), cols(c), data(r * c, fill) {}
+
+    T& operator()(size_t i, size_t j) { return data[i * cols + j]; }
+    const T& operator()(size_t i, size_t j) const { return data[i * cols + j]; }
+
+    T* row(size_t i) { return data.data() + i * cols; }
+    const T* row(size_t i) const { return data.data() + i * cols; }
+
+    bool is_square() const { return rows == cols; }
+};
+
+using DenseMatrix = Dense<double>;
+
+// Conversion to and from the interpreter's matrix representation
+DenseMatrix from_nested(const Matrix& matrix);
+Matrix to_nested(const DenseMatrix& matrix);
+
+// Precision conversion (double <-> float working copies)
+template <typename To, typename From>
+Dense<To> convert(const Dense<From>& source) {
+    Dense<To> result(source.rows, source.cols);
+    for (size_t i = 0; i < source.data.size(); ++i) {
+        result.data[i] = static_cast<To>(source.data[i]);
+    }
+    return result;
+}
+
+// C -= A * B on row-major blocks with explicit leading dimensions
+template <typename T>
+void gemm_subtract(size_t m, size_t n, size_t k,
+                   const T* a, size_t lda,
+                   const T* b, size_t ldb,
+                   T* c, size_t ldc);
+
+// C = A * B using the same blocked kernel
+DenseMatrix multiply(const DenseMatrix& a, const DenseMatrix& b);
+DenseMatrix identity(size_t n);
+
+// Blocked right-looking LU with partial pivoting, in place (L unit lower, U upper)
+// Returns false if a zero pivot was encountered
+template <typename T>
+bool lu_factor(Dense<T>& a, std::vector<size_t>& pivots);
+
+// Solve A X = B in place using a factorization produced by lu_factor
+template <typename T>
+void lu_solve(const Dense<T>& lu, const std::vector<size_t>& pivots, Dense<T>& b);
+
+// Norms used by the refinement stopping test and the matrix functions
+double norm_inf(const DenseMatrix& a);
+double norm_one(const DenseMatrix& a);
+double max_abs(const DenseMatrix& a);
+
+// Linear solver selection
+enum class SolveMode : uint8_t {
+    DOUBLE,  // Full double-precision LU
+    MIXED    // Float32 LU plus double-precision iterative refinement
+};
+
+// Diagnostics from a solve - useful for benchmarks and verbose output
+struct SolveReport {
+    SolveMode mode_used;
+    int refinement_iterations;
+    bool fell_back;          // Mixed mode failed to converge and re-factored in double
+    double residual_norm;    // ||B - A X||_inf at exit
+
+    SolveReport() : mode_used(SolveMode::DOUBLE), refinement_iterations(0),
+                    fell_back(false), residual_norm(0.0) {}
+};
+
+// Solve A X = B for square A and one or more right-hand sides
+// Throws std::invalid_argument for bad shapes and std::domain_error for singular A
+DenseMatrix solve(const DenseMatrix& a, const DenseMatrix& b,
+                  SolveMode mode = SolveMode::DOUBLE, SolveReport* report = nullptr);
+
+} // namespace LinAlg
+} // namespace Dakota
+
+#endif // LINALG_H
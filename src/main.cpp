@@ -1,9 +1,16 @@
 #include "lexer.h"
 #include "parser.h"
 #include "interpreter.h"
+#include "optimizer.h"
+#include "server.h"
+#include "batch.h"
+#include "modules.h"
+#include "plugins.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <csignal>
+#include <cstdlib>
 
 void print_usage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [options] <source_file>\n";
@@ -13,6 +20,20 @@ void print_usage(const char* program_name) {
     std::cout << "  -c <code>      Execute code string directly\n";
     std::cout << "  -p, --parse-only   Parse only, don't execute\n";
     std::cout << "  -v, --verbose      Verbose output\n";
+    std::cout << "  --no-optimize      Skip inlining and dead code elimination\n";
+    std::cout << "  --serve <socket>   Run as a daemon executing scripts sent over a Unix socket\n";
+    std::cout << "  --workers <n>      Worker threads for --serve (default: hardware threads)\n";
+    std::cout << "  --submit <socket>  Run the script on a --serve daemon instead of in process\n";
+    std::cout << "  --param <name=value>  Define a global for --submit (repeatable)\n";
+    std::cout << "  --batch <jobs>     Run every script listed in a jobs file concurrently\n";
+    std::cout << "  -j, --jobs <n>     Threads for --batch (default: hardware threads)\n";
+    std::cout << "  --output-dir <dir> Write each batch job's output to job-<n>.out and .err\n";
+    std::cout << "  --module-path <dir>  Search dir for imported modules first (repeatable)\n";
+    std::cout << "  --plugin <lib>     Load a plugin library of builtin functions (repeatable)\n";
+    std::cout << "  --plugin-dir <dir> Load every plugin library in dir (repeatable)\n";
+    std::cout << "  --restore <path>   Resume the program from a snapshot written by checkpoint()\n";
+    std::cout << "  --max-steps <n>    Stop a script after n evaluation steps (per job or request)\n";
+    std::cout << "  --timeout <sec>    Stop a script after sec seconds of wall time (per job or request)\n";
 }
 
 std::string read_file(const std::string& filename) {
@@ -26,7 +47,8 @@ std::string read_file(const std::string& filename) {
     return content.str();
 }
 
-void run_code(const std::string& code, bool parse_only = false, bool verbose = false) {
+void run_code(const std::string& code, bool parse_only = false, bool verbose = false, bool optimize = true,
+              const std::string& restore_path = "", const Dakota::ExecutionBudget& budget = {}) {
     try {
         if (verbose) {
             std::cout << "=== Lexing ===\n";
@@ -71,10 +93,36 @@ void run_code(const std::string& code, bool parse_only = false, bool verbose = f
             std::cout << "=== Interpreting ===\n";
         }
         
-        // Interpret
+        // Optimize, then interpret
         Dakota::Interpreter interpreter(parser);
+        if (optimize) {
+            Dakota::OptimizerStats stats = Dakota::Optimizer(parser, interpreter).run();
+            if (verbose) {
+                std::cout << "Optimizer: " << stats.calls_inlined << " calls inlined, "
+                          << stats.functions_removed << " functions removed, " << stats.constants_folded
+                          << " constants folded, " << stats.branches_removed << " dead branches, "
+                          << stats.stores_removed << " dead stores\n";
+            }
+        }
+        if (!restore_path.empty()) {
+            interpreter.restore(restore_path);
+        }
+        if (!budget.unlimited()) {
+            interpreter.set_budget(budget);
+        }
         interpreter.interpret();
         
+        if (verbose) {
+            Dakota::Pool::Stats stats = Dakota::Pool::stats();
+            std::cout << "Buffer pool: " << stats.hits << " hits, " << stats.misses << " misses ("
+                      << stats.hit_rate() * 100.0 << "% hit rate), " << stats.retained_bytes
+                      << " bytes retained\n";
+            Dakota::ModuleCacheStats modules = Dakota::ModuleCache::instance().stats();
+            if (modules.compiled + modules.reused > 0) {
+                std::cout << "Modules compiled: " << modules.compiled << ", reused: " << modules.reused << "\n";
+            }
+        }
+
     } catch (const Dakota::RuntimeError& e) {
         std::cerr << "Runtime Error: " << e.what() << std::endl;
     } catch (const std::exception& e) {
@@ -82,6 +130,67 @@ void run_code(const std::string& code, bool parse_only = false, bool verbose = f
     }
 }
 
+// The daemon being served, for the signal handler; stop() is async-signal-safe
+Dakota::Server* active_server = nullptr;
+
+void stop_server(int) {
+    if (active_server) {
+        active_server->stop();
+    }
+}
+
+int serve_mode(const std::string& socket_path, unsigned workers, bool optimize, const Dakota::ExecutionBudget& budget) {
+    Dakota::Server server(socket_path, workers, optimize);
+    server.set_limits(budget.max_steps, budget.max_seconds);
+    server.start();
+    active_server = &server;
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    
+    std::cout << "Serving on " << socket_path << " with " << server.worker_count() << " workers\n" << std::flush;
+    server.run();
+    active_server = nullptr;
+    
+    Dakota::ServeStats stats = server.stats();
+    std::cout << "Served " << stats.requests << " requests (" << stats.cache_hits << " compiled scripts reused)\n";
+    return 0;
+}
+
+int submit_mode(const std::string& socket_path, const Dakota::JobRequest& request) {
+    Dakota::JobResult response = Dakota::submit(socket_path, request);
+    std::cout << response.output;
+    std::cerr << response.errors;
+    return response.ok ? 0 : 1;
+}
+
+int batch_mode(const std::string& jobs_path, unsigned threads, const std::string& output_dir, bool optimize,
+               const Dakota::ExecutionBudget& budget) {
+    std::vector<Dakota::BatchJob> jobs = Dakota::load_batch(jobs_path);
+    for (auto& job : jobs) {
+        job.request.budget = budget;
+    }
+    Dakota::BatchReport report = Dakota::run_batch(jobs, threads, optimize);
+    
+    for (size_t k = 0; k < jobs.size(); ++k) {
+        const Dakota::JobResult& result = report.results[k];
+        if (!output_dir.empty()) {
+            std::string stem = output_dir + "/job-" + std::to_string(k + 1);
+            std::ofstream output(stem + ".out"), errors(stem + ".err");
+            if (!output.is_open() || !errors.is_open()) {
+                throw std::runtime_error("Cannot write to output directory: " + output_dir);
+            }
+            output << result.output;
+            errors << result.errors;
+        } else {
+            std::cout << "=== Job " << k + 1 << ": " << jobs[k].path << " ===\n" << result.output;
+            std::cerr << result.errors;
+        }
+    }
+    
+    Dakota::print_batch_summary(std::cout, jobs, report);
+    return report.failed() == 0 ? 0 : 1;
+}
+
 void interactive_mode() {
     std::cout << "Dakota Interactive Mode\n";
     std::cout << "Type 'exit' or 'quit' to exit, 'help' for help\n\n";
@@ -125,8 +234,20 @@ int main(int argc, char* argv[]) {
     bool interactive = false;
     bool parse_only = false;
     bool verbose = false;
+    bool optimize = true;
     std::string code_string;
     std::string filename;
+    std::string serve_socket;
+    std::string submit_socket;
+    std::string batch_file;
+    std::string output_dir;
+    unsigned workers = 0;
+    unsigned batch_threads = 0;
+    Dakota::JobRequest request;
+    std::vector<std::string> plugins;
+    std::vector<std::string> plugin_dirs;
+    std::string restore_path;
+    Dakota::ExecutionBudget budget;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -141,6 +262,49 @@ int main(int argc, char* argv[]) {
             parse_only = true;
         } else if (arg == "-v" || arg == "--verbose") {
             verbose = true;
+        } else if (arg == "--no-optimize") {
+            optimize = false;
+        } else if (arg == "--serve" || arg == "--submit" || arg == "--workers" || arg == "--param" ||
+                   arg == "--batch" || arg == "-j" || arg == "--jobs" || arg == "--output-dir" ||
+                   arg == "--module-path" || arg == "--plugin" || arg == "--plugin-dir" ||
+                   arg == "--restore" || arg == "--max-steps" || arg == "--timeout") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " option requires a value\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--serve") {
+                serve_socket = value;
+            } else if (arg == "--submit") {
+                submit_socket = value;
+            } else if (arg == "--workers") {
+                workers = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--batch") {
+                batch_file = value;
+            } else if (arg == "-j" || arg == "--jobs") {
+                batch_threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--output-dir") {
+                output_dir = value;
+            } else if (arg == "--module-path") {
+                Dakota::ModuleCache::instance().add_search_directory(value);
+            } else if (arg == "--plugin") {
+                plugins.push_back(value);
+            } else if (arg == "--plugin-dir") {
+                plugin_dirs.push_back(value);
+            } else if (arg == "--restore") {
+                restore_path = value;
+            } else if (arg == "--max-steps") {
+                budget.max_steps = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (arg == "--timeout") {
+                budget.max_seconds = std::strtod(value.c_str(), nullptr);
+            } else {
+                size_t equals = value.find('=');
+                if (equals == std::string::npos || equals == 0) {
+                    std::cerr << "Error: --param expects name=value\n";
+                    return 1;
+                }
+                request.parameters.emplace_back(value.substr(0, equals), value.substr(equals + 1));
+            }
         } else if (arg == "-c") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: -c option requires a code string\n";
@@ -157,13 +321,39 @@ int main(int argc, char* argv[]) {
     }
     
     try {
-        if (interactive) {
+        // Plugins load before anything runs, so every mode sees their functions
+        auto& registry = Dakota::PluginRegistry::instance();
+        if (const char* plugin_dir = std::getenv(Dakota::PLUGIN_DIR_VARIABLE)) {
+            registry.load_directory(plugin_dir);
+        }
+        for (const auto& dir : plugin_dirs) {
+            registry.load_directory(dir);
+        }
+        for (const auto& plugin : plugins) {
+            registry.load(plugin);
+        }
+        
+        if (!serve_socket.empty()) {
+            return serve_mode(serve_socket, workers, optimize, budget);
+        } else if (!batch_file.empty()) {
+            return batch_mode(batch_file, batch_threads, output_dir, optimize, budget);
+        } else if (!submit_socket.empty()) {
+            request.script = !code_string.empty() ? code_string : filename.empty() ? "" : read_file(filename);
+            if (request.script.empty()) {
+                std::cerr << "Error: No input provided\n";
+                return 1;
+            }
+            return submit_mode(submit_socket, request);
+        } else if (interactive) {
             interactive_mode();
         } else if (!code_string.empty()) {
-            run_code(code_string, parse_only, verbose);
+            run_code(code_string, parse_only, verbose, optimize, restore_path, budget);
         } else if (!filename.empty()) {
+            // A script's own directory is searched before --module-path ones
+            size_t slash = filename.find_last_of('/');
+            Dakota::ModuleCache::instance().add_search_directory(slash == std::string::npos ? "." : filename.substr(0, slash));
             std::string code = read_file(filename);
-            run_code(code, parse_only, verbose);
+            run_code(code, parse_only, verbose, optimize, restore_path, budget);
         } else {
             std::cerr << "Error: No input provided\n";
             print_usage(argv[0]);
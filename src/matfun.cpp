@@ -0,0 +1,325 @@
+#include "matfun.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Dakota {
+namespace LinAlg {
+
+namespace {
+
+void check_square(const DenseMatrix& a, const char* function) {
+    if (a.rows == 0 || !a.is_square()) {
+        throw std::invalid_argument(std::string(function) + "() requires a non-empty square matrix");
+    }
+}
+
+// dst += scale * src
+void add_scaled(DenseMatrix& dst, const DenseMatrix& src, double scale) {
+    for (size_t i = 0; i < dst.data.size(); ++i) {
+        dst.data[i] += scale * src.data[i];
+    }
+}
+
+void scale_in_place(DenseMatrix& a, double scale) {
+    for (double& value : a.data) {
+        value *= scale;
+    }
+}
+
+void add_identity(DenseMatrix& a, double scale) {
+    for (size_t i = 0; i < a.rows; ++i) {
+        a(i, i) += scale;
+    }
+}
+
+// For sqrtm() and logm(): a singular intermediate or a stalled iteration
+// means A has an eigenvalue at zero or on the negative real axis
+[[noreturn]] void throw_negative_axis(const char* function) {
+    throw std::domain_error(std::string(function) +
+                            "() requires a matrix with no eigenvalues on the closed negative real axis");
+}
+
+// Solves A X = B, optionally reporting log|det(A)| from the factorization
+DenseMatrix solve_exact(const DenseMatrix& a, const DenseMatrix& b, double* log_abs_det = nullptr) {
+    DenseMatrix lu = a;
+    std::vector<size_t> pivots;
+    if (!lu_factor(lu, pivots)) {
+        throw std::domain_error("Matrix is singular");
+    }
+    if (log_abs_det) {
+        *log_abs_det = 0.0;
+        for (size_t i = 0; i < lu.rows; ++i) {
+            *log_abs_det += std::log(std::abs(lu(i, i)));
+        }
+    }
+    DenseMatrix x = b;
+    lu_solve(lu, pivots, x);
+    return x;
+}
+
+// [m/m] Pade approximant of exp(A) as (V - U)^-1 (V + U), U odd and V even in A
+DenseMatrix pade_exp(const DenseMatrix& a, const double* b, int degree) {
+    const size_t n = a.rows;
+    DenseMatrix a2 = multiply(a, a);
+
+    DenseMatrix odd(n, n, 0.0);
+    DenseMatrix even(n, n, 0.0);
+    add_identity(odd, b[1]);
+    add_identity(even, b[0]);
+
+    DenseMatrix power = identity(n);
+    for (int j = 2; j < degree; j += 2) {
+        power = multiply(power, a2);
+        add_scaled(even, power, b[j]);
+        add_scaled(odd, power, b[j + 1]);
+    }
+    DenseMatrix u = multiply(a, odd);
+
+    DenseMatrix numerator = even;
+    DenseMatrix denominator = even;
+    add_scaled(numerator, u, 1.0);
+    add_scaled(denominator, u, -1.0);
+    return solve_exact(denominator, numerator);
+}
+
+// Degree 13 arranged as in Higham (2005) so it needs only six multiplies
+DenseMatrix pade_exp13(const DenseMatrix& a) {
+    static const double b[] = {
+        64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+        1187353796428800.0, 129060195264000.0, 10559470521600.0,
+        670442572800.0, 33522128640.0, 1323241920.0,
+        40840800.0, 960960.0, 16380.0, 182.0, 1.0
+    };
+    const size_t n = a.rows;
+    DenseMatrix a2 = multiply(a, a);
+    DenseMatrix a4 = multiply(a2, a2);
+    DenseMatrix a6 = multiply(a4, a2);
+
+    DenseMatrix inner(n, n, 0.0);
+    add_scaled(inner, a6, b[13]);
+    add_scaled(inner, a4, b[11]);
+    add_scaled(inner, a2, b[9]);
+    DenseMatrix odd = multiply(a6, inner);
+    add_scaled(odd, a6, b[7]);
+    add_scaled(odd, a4, b[5]);
+    add_scaled(odd, a2, b[3]);
+    add_identity(odd, b[1]);
+    DenseMatrix u = multiply(a, odd);
+
+    inner = DenseMatrix(n, n, 0.0);
+    add_scaled(inner, a6, b[12]);
+    add_scaled(inner, a4, b[10]);
+    add_scaled(inner, a2, b[8]);
+    DenseMatrix even = multiply(a6, inner);
+    add_scaled(even, a6, b[6]);
+    add_scaled(even, a4, b[4]);
+    add_scaled(even, a2, b[2]);
+    add_identity(even, b[0]);
+
+    DenseMatrix numerator = even;
+    DenseMatrix denominator = even;
+    add_scaled(numerator, u, 1.0);
+    add_scaled(denominator, u, -1.0);
+    return solve_exact(denominator, numerator);
+}
+
+// Gauss-Legendre nodes and weights on [0, 1] by Newton iteration on P_m
+void gauss_legendre(int m, std::vector<double>& nodes, std::vector<double>& weights) {
+    const double pi = std::acos(-1.0);
+    nodes.assign(m, 0.0);
+    weights.assign(m, 0.0);
+    for (int i = 0; i < m; ++i) {
+        double x = std::cos(pi * (i + 0.75) / (m + 0.5));
+        double derivative = 0.0;
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            double p0 = 1.0, p1 = x;
+            for (int k = 2; k <= m; ++k) {
+                double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                p0 = p1;
+                p1 = p2;
+            }
+            derivative = m * (x * p1 - p0) / (x * x - 1.0);
+            double step = p1 / derivative;
+            x -= step;
+            if (std::abs(step) < 1e-16) break;
+        }
+        nodes[i] = 0.5 * (1.0 - x);
+        weights[i] = 1.0 / ((1.0 - x * x) * derivative * derivative);
+    }
+}
+
+} // anonymous namespace
+
+DenseMatrix matrix_power(const DenseMatrix& a, int64_t n) {
+    check_square(a, "Matrix power");
+
+    DenseMatrix base = n < 0 ? solve_exact(a, identity(a.rows)) : a;
+    uint64_t exponent = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+    if (exponent == 0) {
+        return identity(a.rows);
+    }
+
+    // Skip the initial identity multiply by seeding with the lowest set bit
+    while ((exponent & 1) == 0) {
+        base = multiply(base, base);
+        exponent >>= 1;
+    }
+    DenseMatrix result = base;
+    exponent >>= 1;
+    while (exponent > 0) {
+        base = multiply(base, base);
+        if (exponent & 1) {
+            result = multiply(result, base);
+        }
+        exponent >>= 1;
+    }
+    for (double value : result.data) {
+        if (!std::isfinite(value)) {
+            throw std::overflow_error("Matrix power overflowed to a non-finite result");
+        }
+    }
+    return result;
+}
+
+DenseMatrix expm(const DenseMatrix& a) {
+    check_square(a, "expm");
+
+    // Largest 1-norm for which each degree meets double precision backward error
+    static const double theta[] = {
+        1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1, 2.097847961257068e0
+    };
+    static const int degrees[] = {3, 5, 7, 9};
+    static const double coefficients[4][10] = {
+        {120.0, 60.0, 12.0, 1.0},
+        {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0},
+        {17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0},
+        {17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+         2162160.0, 110880.0, 3960.0, 90.0, 1.0}
+    };
+    const double theta13 = 5.371920351148152;
+
+    double norm = norm_one(a);
+    if (!std::isfinite(norm)) {
+        throw std::domain_error("expm() requires finite matrix entries");
+    }
+    for (int d = 0; d < 4; ++d) {
+        if (norm <= theta[d]) {
+            return pade_exp(a, coefficients[d], degrees[d]);
+        }
+    }
+
+    int squarings = std::max(0, static_cast<int>(std::ceil(std::log2(norm / theta13))));
+    DenseMatrix scaled = a;
+    scale_in_place(scaled, std::ldexp(1.0, -squarings));
+
+    DenseMatrix result = pade_exp13(scaled);
+    for (int s = 0; s < squarings; ++s) {
+        result = multiply(result, result);
+    }
+    return result;
+}
+
+DenseMatrix sqrtm(const DenseMatrix& a) {
+    check_square(a, "sqrtm");
+    const size_t n = a.rows;
+    const double tolerance = static_cast<double>(n) * std::numeric_limits<double>::epsilon();
+
+    DenseMatrix m = a;
+    DenseMatrix y = a;
+    bool scaling = true;
+    double previous_distance = std::numeric_limits<double>::infinity();
+
+    for (int iteration = 0; iteration < MAX_SQRTM_ITERATIONS; ++iteration) {
+        double log_abs_det = 0.0;
+        DenseMatrix m_inverse;
+        try {
+            m_inverse = solve_exact(m, identity(n), &log_abs_det);
+        } catch (const std::domain_error&) {
+            throw_negative_axis("sqrtm");
+        }
+
+        // Determinant scaling speeds up the early iterations, it is dropped near convergence
+        double mu = scaling ? std::exp(-log_abs_det / (2.0 * static_cast<double>(n))) : 1.0;
+        double mu2 = mu * mu;
+
+        DenseMatrix factor = m_inverse;
+        scale_in_place(factor, 1.0 / mu2);
+        add_identity(factor, 1.0);
+        y = multiply(y, factor);
+        scale_in_place(y, 0.5 * mu);
+
+        scale_in_place(m, 0.25 * mu2);
+        add_scaled(m, m_inverse, 0.25 / mu2);
+        add_identity(m, 0.5);
+
+        DenseMatrix distance_matrix = m;
+        add_identity(distance_matrix, -1.0);
+        double distance = norm_one(distance_matrix);
+        if (std::isnan(distance)) {
+            break;
+        }
+        if (distance <= tolerance) {
+            return y;
+        }
+        // Once unscaled, stagnation at rounding level means we are done
+        if (!scaling && distance >= previous_distance && distance < 1e-8) {
+            return y;
+        }
+        if (distance < 1e-2) {
+            scaling = false;
+        }
+        previous_distance = distance;
+    }
+
+    throw_negative_axis("sqrtm");
+}
+
+DenseMatrix logm(const DenseMatrix& a) {
+    check_square(a, "logm");
+    const size_t n = a.rows;
+
+    DenseMatrix x = a;
+    int square_roots = 0;
+    for (;;) {
+        DenseMatrix shifted = x;
+        add_identity(shifted, -1.0);
+        if (norm_one(shifted) <= LOGM_PADE_RADIUS) {
+            x = shifted;
+            break;
+        }
+        if (square_roots == MAX_LOGM_SQUARE_ROOTS) {
+            throw std::domain_error("logm() did not converge");
+        }
+        try {
+            x = sqrtm(x);
+        } catch (const std::domain_error&) {
+            throw_negative_axis("logm");
+        }
+        ++square_roots;
+    }
+
+    // log(I + X) = sum_j w_j (I + t_j X)^-1 X, which is the [m/m] Pade approximant
+    std::vector<double> nodes, weights;
+    gauss_legendre(LOGM_PADE_DEGREE, nodes, weights);
+
+    DenseMatrix result(n, n, 0.0);
+    for (int j = 0; j < LOGM_PADE_DEGREE; ++j) {
+        DenseMatrix system = x;
+        scale_in_place(system, nodes[j]);
+        add_identity(system, 1.0);
+        try {
+            add_scaled(result, solve_exact(system, x), weights[j]);
+        } catch (const std::domain_error&) {
+            throw_negative_axis("logm");
+        }
+    }
+
+    scale_in_place(result, std::ldexp(1.0, square_roots));
+    return result;
+}
+
+} // namespace LinAlg
+} // namespace Dakota
@@ -0,0 +1,36 @@
+#ifndef MATFUN_H
+#define MATFUN_H
+
+#include "linalg.h"
+#include <cstdint>
+
+namespace Dakota {
+namespace LinAlg {
+
+// Constants for matrix function configuration
+constexpr int MAX_SQRTM_ITERATIONS = 100;     // Denman-Beavers converges quadratically, this is a safety net
+constexpr int MAX_LOGM_SQUARE_ROOTS = 64;     // Square roots taken before giving up on logm
+constexpr double LOGM_PADE_RADIUS = 0.25;     // ||A - I||_1 bound at which the Pade approximant is accurate
+constexpr int LOGM_PADE_DEGREE = 8;
+
+// A^n by binary exponentiation, O(log n) multiplies. Negative n inverts A first.
+// Throws std::overflow_error if an entry of the result is not finite.
+DenseMatrix matrix_power(const DenseMatrix& a, int64_t n);
+
+// Matrix exponential by scaling and squaring with [m/m] Pade approximants,
+// m chosen from the 1-norm as in Higham (2005)
+DenseMatrix expm(const DenseMatrix& a);
+
+// Principal square root by the product form of the determinant-scaled
+// Denman-Beavers iteration. A must have no eigenvalues on the closed negative real axis.
+DenseMatrix sqrtm(const DenseMatrix& a);
+
+// Principal logarithm by inverse scaling and squaring: repeated square roots
+// bring A near I, then a Gauss-Legendre partial-fraction Pade approximant is applied.
+// Like sqrtm(), reports eigenvalues on the closed negative real axis as std::domain_error.
+DenseMatrix logm(const DenseMatrix& a);
+
+} // namespace LinAlg
+} // namespace Dakota
+
+#endif // MATFUN_H
@@ -0,0 +1,298 @@
+#include "modules.h"
+#include "optimizer.h"
+#include "parallel.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <unordered_set>
+
+namespace Dakota {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t source_hash(const std::string& source) {
+    uint64_t hash = FNV_OFFSET;
+    for (unsigned char c : source) {
+        hash = (hash ^ c) * FNV_PRIME;
+    }
+    return hash;
+}
+
+bool valid_module_name(const std::string& name) {
+    if (name.empty()) return false;
+    for (unsigned char c : name) {
+        if (!std::isalnum(c) && c != '_') return false;
+    }
+    return true;
+}
+
+// Files whose top level is running on this thread, innermost last. Each
+// importer has its own Module instances, so a cycle shows up as the same
+// file being loaded again rather than as one instance re-entering itself.
+thread_local std::vector<std::string> loading_paths;
+
+} // anonymous namespace
+
+// ModuleCache implementation
+
+ModuleCache& ModuleCache::instance() {
+    static ModuleCache cache;
+    return cache;
+}
+
+ModuleCache::ModuleCache() {
+    if (const char* variable = std::getenv(MODULE_PATH_VARIABLE)) {
+        std::istringstream directories(variable);
+        std::string directory;
+        while (std::getline(directories, directory, ':')) {
+            if (!directory.empty()) search_path_.push_back(directory);
+        }
+    }
+    search_path_.push_back(".");
+}
+
+void ModuleCache::add_search_directory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    search_path_.erase(std::remove(search_path_.begin(), search_path_.end(), directory), search_path_.end());
+    search_path_.insert(search_path_.begin(), directory.empty() ? "." : directory);
+}
+
+std::vector<std::string> ModuleCache::search_path() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return search_path_;
+}
+
+std::string ModuleCache::resolve(const std::string& name) const {
+    if (!valid_module_name(name)) {
+        return "";
+    }
+    for (const auto& directory : search_path()) {
+        std::string path = directory + "/" + name + MODULE_EXTENSION;
+        if (std::ifstream(path).is_open()) {
+            return path;
+        }
+    }
+    return "";
+}
+
+std::shared_ptr<const CompiledModule> ModuleCache::load(const std::string& name) {
+    std::string path = resolve(name);
+    if (path.empty()) {
+        throw RuntimeError("No module named '" + name + "' on the search path");
+    }
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw RuntimeError("Cannot read module '" + name + "': " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    std::string source = content.str();
+    uint64_t hash = source_hash(source);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto cached = modules_.find(hash);
+        if (cached != modules_.end() && cached->second->source == source) {
+            ++stats_.reused;
+            current_[path] = hash;
+            return cached->second;
+        }
+        ++stats_.compiled;
+    }
+
+    // Compiled outside the lock, like ProgramCache; a racing compile of the
+    // same text is simply replaced
+    auto module = std::make_shared<CompiledModule>();
+    module->path = path;
+    module->hash = hash;
+    module->source = std::move(source);
+    Lexer lexer(module->source);
+    module->tokens = lexer.tokenize();
+    module->parser = std::make_unique<Parser>(module->tokens);
+    module->parser->parse();
+    if (module->parser->has_error()) {
+        throw RuntimeError("Parse error in module '" + name + "': " + module->parser->get_error());
+    }
+    {
+        // Library mode: functions nothing in the module calls are its exports
+        Interpreter scratch(*module->parser);
+        Optimizer(*module->parser, scratch, true).run();
+    }
+
+    const auto& nodes = module->parser->get_nodes();
+    for (const auto& node : nodes) {
+        if (node.type != NodeType::IMPORT_STATEMENT) continue;
+        for (uint32_t child = node.first_child_index; child != 0 && child < nodes.size();
+             child = nodes[child].next_sibling_index) {
+            module->imports.emplace_back(
+                module->parser->get_strings().get_string(nodes[child].identifier.name_index));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto previous = current_.find(path);
+    if (previous != current_.end() && previous->second != hash) {
+        // The file changed; drop the old version unless another path still has it
+        uint64_t stale = previous->second;
+        current_.erase(previous);
+        bool shared = std::any_of(current_.begin(), current_.end(),
+                                  [stale](const auto& entry) { return entry.second == stale; });
+        if (!shared) modules_.erase(stale);
+    }
+    modules_[hash] = module;
+    current_[path] = hash;
+    return module;
+}
+
+void ModuleCache::prefetch(const std::vector<std::string>& names) {
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> level;
+    for (const auto& name : names) {
+        if (seen.insert(name).second) level.push_back(name);
+    }
+
+    while (!level.empty()) {
+        std::vector<std::shared_ptr<const CompiledModule>> compiled(level.size());
+        parallel_for(level.size(), [&](size_t k) {
+            try {
+                compiled[k] = load(level[k]);
+            } catch (const std::exception&) {
+                // Reported by the import statement that needs it
+            }
+        });
+
+        std::vector<std::string> next;
+        for (const auto& module : compiled) {
+            if (!module) continue;
+            for (const auto& name : module->imports) {
+                if (seen.insert(name).second) next.push_back(name);
+            }
+        }
+        level.swap(next);
+    }
+}
+
+ModuleCacheStats ModuleCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Module implementation
+
+Module::Module(std::string name, std::shared_ptr<const CompiledModule> compiled, Interpreter& importer)
+    : name_(std::move(name)), compiled_(std::move(compiled)), importer_(importer), state_(State::UNLOADED) {}
+
+bool Module::loaded() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return state_ == State::LOADED;
+}
+
+Value Module::member(const std::string& member_name) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    load();
+    return exported(lookup(member_name));
+}
+
+Value Module::call(const std::string& function_name, const std::vector<Value>& args) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    load();
+    Value function = lookup(function_name);
+    if (!function.is_function()) {
+        throw RuntimeError("Module member '" + name_ + "." + function_name + "' is not a function");
+    }
+    std::vector<Value> converted;
+    converted.reserve(args.size());
+    for (const auto& arg : args) {
+        converted.push_back(imported(arg));
+    }
+    return exported(interpreter_->call_function(function, converted));
+}
+
+std::shared_ptr<Module> Module::fork(Interpreter& importer) const {
+    return std::make_shared<Module>(name_, compiled_, importer);
+}
+
+void Module::load() {
+    if (state_ == State::LOADED) {
+        return;
+    }
+    if (state_ == State::LOADING ||
+        std::find(loading_paths.begin(), loading_paths.end(), compiled_->path) != loading_paths.end()) {
+        throw RuntimeError("Circular import: module '" + name_ + "' is used while it is being loaded");
+    }
+
+    state_ = State::LOADING;
+    loading_paths.push_back(compiled_->path);
+    interpreter_ = std::make_unique<Interpreter>(*compiled_->parser);
+    interpreter_->set_output(importer_.get_output(), importer_.get_errors());
+    interpreter_->run_for(importer_);
+    try {
+        interpreter_->execute();
+    } catch (const RuntimeError& error) {
+        loading_paths.pop_back();
+        interpreter_.reset();
+        state_ = State::UNLOADED;
+        std::string message = error.what();
+        if (message.compare(0, 10, "In module ") == 0 || message.compare(0, 17, "Circular import: ") == 0 ||
+            dynamic_cast<const BudgetExceeded*>(&error)) {
+            throw;
+        }
+        throw RuntimeError("In module '" + name_ + "': " + message, error.get_line(), error.get_column());
+    }
+    loading_paths.pop_back();
+    state_ = State::LOADED;
+}
+
+Value Module::lookup(const std::string& member_name) {
+    Value value;
+    if (!interpreter_->find_global(member_name, value)) {
+        throw RuntimeError("Module '" + name_ + "' has no member '" + member_name + "'");
+    }
+    return value;
+}
+
+Value Module::exported(const Value& value) {
+    if (!value.is_function()) {
+        return value;
+    }
+    // Runs in this module's interpreter, which the wrapper keeps alive
+    std::shared_ptr<Module> self = shared_from_this();
+    std::shared_ptr<const Function> function = value.function_pointer();
+    NativeFunction wrapper = [self, function](const std::vector<Value>& args) {
+        std::lock_guard<std::recursive_mutex> lock(self->mutex_);
+        std::vector<Value> converted;
+        converted.reserve(args.size());
+        for (const auto& arg : args) {
+            converted.push_back(self->imported(arg));
+        }
+        return self->exported(self->interpreter_->call_function(Value(function), converted));
+    };
+    return Value(std::shared_ptr<const Function>(std::make_shared<Function>(name_ + "." + function->name, wrapper)));
+}
+
+Value Module::imported(const Value& value) {
+    if (!value.is_function()) {
+        return value;
+    }
+    // Runs in the importer's interpreter. The wrapper lives inside the
+    // module's interpreter and exported() rewraps it on the way out, so the
+    // raw pointer cannot outlive the module.
+    Module* self = this;
+    std::shared_ptr<const Function> function = value.function_pointer();
+    NativeFunction wrapper = [self, function](const std::vector<Value>& args) {
+        std::vector<Value> converted;
+        converted.reserve(args.size());
+        for (const auto& arg : args) {
+            converted.push_back(self->exported(arg));
+        }
+        return self->imported(self->importer_.call_function(Value(function), converted));
+    };
+    return Value(std::shared_ptr<const Function>(std::make_shared<Function>(function->name, wrapper)));
+}
+
+} // namespace Dakota
@@ -0,0 +1,118 @@
+#ifndef MODULES_H
+#define MODULES_H
+
+#include "lexer.h"
+#include "parser.h"
+#include "interpreter.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Dakota {
+
+// Constants for the module system
+constexpr const char* MODULE_EXTENSION = ".dk";
+constexpr const char* MODULE_PATH_VARIABLE = "DAKOTA_PATH";   // Colon-separated directories
+
+// A lexed, parsed and optimized module, shared read-only by every importer
+// of the same source text
+struct CompiledModule {
+    std::string path;                   // File it was compiled from
+    uint64_t hash = 0;                  // Of the source text
+    std::string source;
+    std::vector<Token> tokens;          // The parser refers to these
+    std::unique_ptr<Parser> parser;
+    std::vector<std::string> imports;   // Modules its own import statements name
+};
+
+struct ModuleCacheStats {
+    size_t compiled = 0;
+    size_t reused = 0;
+};
+
+// Process-wide cache of compiled modules keyed by a hash of their source, so
+// a module is compiled once however many scripts, jobs or requests import it,
+// and again only when its file changes. Thread-safe.
+//
+// `import a.b` is not supported; a module name is a file name without .dk,
+// looked up in each search directory in turn: those added with
+// add_search_directory() (most recent first), then $DAKOTA_PATH, then the
+// working directory.
+class ModuleCache {
+public:
+    static ModuleCache& instance();
+
+    void add_search_directory(const std::string& directory);
+    std::vector<std::string> search_path() const;
+
+    // Path of the module's file, or an empty string
+    std::string resolve(const std::string& name) const;
+
+    // The compiled module, from the cache when the file is unchanged.
+    // Throws RuntimeError if it cannot be found, read or parsed.
+    std::shared_ptr<const CompiledModule> load(const std::string& name);
+
+    // Compile the named modules and everything they import, one level of
+    // the import graph at a time with the modules of a level in parallel.
+    // Errors are left for the import statement to report.
+    void prefetch(const std::vector<std::string>& names);
+
+    ModuleCacheStats stats() const;
+
+private:
+    ModuleCache();
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> search_path_;
+    std::unordered_map<uint64_t, std::shared_ptr<const CompiledModule>> modules_;
+    std::unordered_map<std::string, uint64_t> current_;   // Path -> hash of the version last loaded
+    ModuleCacheStats stats_;
+};
+
+// The value `import name` binds. The module's top level runs on first use,
+// in an Interpreter of its own, so its globals are its own namespace.
+//
+// Functions cross between the two interpreters as native wrappers: a module
+// function read or returned by the importer runs in the module's
+// interpreter, and an importer function passed in runs in the importer's.
+// Calls into the module are serialized, so a module shared between threads
+// stays consistent; sweep() workers get forks of their own instead.
+class Module : public Object, public std::enable_shared_from_this<Module> {
+public:
+    Module(std::string name, std::shared_ptr<const CompiledModule> compiled, Interpreter& importer);
+
+    std::string type_name() const override { return "module"; }
+    const std::string& name() const { return name_; }
+    bool loaded() const;
+
+    // A global variable or function of the module, loading it if needed
+    Value member(const std::string& member_name);
+
+    // Call a module function with the importer's arguments
+    Value call(const std::string& function_name, const std::vector<Value>& args);
+
+    // An unloaded copy for another importer
+    std::shared_ptr<Module> fork(Interpreter& importer) const;
+
+private:
+    enum class State : uint8_t { UNLOADED, LOADING, LOADED };
+
+    std::string name_;
+    std::shared_ptr<const CompiledModule> compiled_;
+    Interpreter& importer_;
+    std::unique_ptr<Interpreter> interpreter_;
+    State state_;
+    mutable std::recursive_mutex mutex_;
+
+    void load();
+    Value lookup(const std::string& member_name);
+    Value exported(const Value& value);   // Module value handed to the importer
+    Value imported(const Value& value);   // Importer value handed to the module
+};
+
+} // namespace Dakota
+
+#endif // MODULES_H
@@ -0,0 +1,614 @@
+#include "optimizer.h"
+#include <algorithm>
+
+namespace Dakota {
+
+namespace {
+
+// Builtins without side effects; calls to them may be duplicated, moved or dropped
+bool is_pure_builtin(const std::string& name) {
+    static const std::unordered_set<std::string> names = {
+        "abs", "sqrt", "sin", "cos", "tan", "pow", "floor", "ceil", "round", "exp", "log", "len"
+    };
+    return names.count(name) != 0;
+}
+
+// Literals the optimizer can evaluate; strings would need the string table
+bool is_constant(const ASTNode& node) {
+    return node.type == NodeType::INTEGER_LITERAL || node.type == NodeType::FLOAT_LITERAL ||
+           node.type == NodeType::BOOLEAN_LITERAL;
+}
+
+bool is_literal(const ASTNode& node) {
+    return is_constant(node) || node.type == NodeType::STRING_LITERAL;
+}
+
+Value constant_value(const ASTNode& node) {
+    switch (node.type) {
+        case NodeType::INTEGER_LITERAL:
+            return Value(node.integer_literal.value);
+        case NodeType::FLOAT_LITERAL:
+            return Value(node.float_literal.value);
+        default:
+            return Value(node.boolean_literal.value);
+    }
+}
+
+// Overwrites node with the literal for value, keeping its place in the tree
+bool write_constant(ASTNode& node, const Value& value) {
+    if (value.is_integer()) {
+        node.type = NodeType::INTEGER_LITERAL;
+        node.integer_literal.value = value.as_integer();
+    } else if (value.is_float()) {
+        node.type = NodeType::FLOAT_LITERAL;
+        node.float_literal.value = value.as_float();
+    } else if (value.is_boolean()) {
+        node.type = NodeType::BOOLEAN_LITERAL;
+        node.integer_literal.value = 0;
+        node.boolean_literal.value = value.as_boolean();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+Optimizer::Optimizer(Parser& parser, const Interpreter& interpreter, bool library)
+    : parser_(parser), interpreter_(interpreter), library_(library), growth_budget_(0) {
+}
+
+OptimizerStats Optimizer::run() {
+    stats_ = OptimizerStats();
+    if (nodes().empty()) {
+        return stats_;
+    }
+    growth_budget_ = nodes().size() * INLINE_GROWTH_FACTOR;
+
+    for (int round = 0; round < INLINE_MAX_ROUNDS; ++round) {
+        find_inlinable();
+        if (inlinable_.empty()) {
+            break;
+        }
+        size_t inlined = stats_.calls_inlined;
+        std::vector<uint32_t> statements = chain(nodes()[0].first_child_index);
+        for (uint32_t position = 0; position < statements.size(); ++position) {
+            inline_calls(statements[position], 0, {}, position);
+        }
+        if (stats_.calls_inlined == inlined) {
+            break;
+        }
+    }
+
+    fold_constants(0);
+    prune(0);
+    if (!library_) {
+        remove_unused_functions();
+    }
+    remove_dead_stores(0);
+    return stats_;
+}
+
+std::string Optimizer::name_of(uint32_t string_index) const {
+    return std::string(parser_.get_strings().get_string(string_index));
+}
+
+std::vector<uint32_t> Optimizer::chain(uint32_t start_index) const {
+    std::vector<uint32_t> indices;
+    for (uint32_t current = start_index; valid(current) && indices.size() < nodes().size();
+         current = nodes()[current].next_sibling_index) {
+        indices.push_back(current);
+    }
+    return indices;
+}
+
+std::vector<uint32_t> Optimizer::children(uint32_t node_index) const {
+    return parser_.get_child_nodes(node_index);
+}
+
+void Optimizer::relink(uint32_t owner_index, const std::vector<uint32_t>& statements) {
+    ASTNode& owner = nodes()[owner_index];
+    owner.first_child_index = statements.empty() ? INVALID_INDEX : statements[0];
+    if (owner.type == NodeType::BLOCK) {
+        owner.block.statements_start_index = statements.empty() ? 0 : statements[0];
+        owner.block.statement_count = static_cast<uint32_t>(statements.size());
+    }
+    for (size_t i = 0; i < statements.size(); ++i) {
+        nodes()[statements[i]].next_sibling_index = i + 1 < statements.size() ? statements[i + 1] : INVALID_INDEX;
+    }
+}
+
+// Every read of a name, as a variable or as the callee of a call
+void Optimizer::count_names(uint32_t node_index, std::unordered_map<std::string, size_t>& counts) const {
+    if (node_index >= nodes().size()) {
+        return;
+    }
+    const ASTNode& node = nodes()[node_index];
+    if (node.type == NodeType::IDENTIFIER) {
+        ++counts[name_of(node.identifier.name_index)];
+    } else if (node.type == NodeType::FUNCTION_CALL) {
+        ++counts[name_of(node.function_call.name_index)];
+    }
+    for (uint32_t child : children(node_index)) {
+        count_names(child, counts);
+    }
+}
+
+size_t Optimizer::count_nodes(uint32_t node_index) const {
+    size_t count = 1;
+    for (uint32_t child : children(node_index)) {
+        count += count_nodes(child);
+    }
+    return count;
+}
+
+// Expressions whose only effect is their value (or an error)
+bool Optimizer::is_pure(uint32_t node_index) const {
+    const ASTNode& node = nodes()[node_index];
+    switch (node.type) {
+        case NodeType::INTEGER_LITERAL:
+        case NodeType::FLOAT_LITERAL:
+        case NodeType::STRING_LITERAL:
+        case NodeType::BOOLEAN_LITERAL:
+        case NodeType::IDENTIFIER:
+            return true;
+        case NodeType::FUNCTION_CALL: {
+            std::string name = name_of(node.function_call.name_index);
+            if (!is_pure_builtin(name) || !interpreter_.is_builtin(name)) {
+                return false;
+            }
+            break;
+        }
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP:
+        case NodeType::MATRIX_LITERAL:
+        case NodeType::DICT_LITERAL:
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS:
+        case NodeType::MEMBER_ACCESS:
+            break;
+        default:
+            return false;
+    }
+    for (uint32_t child : children(node_index)) {
+        if (!is_pure(child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Top-level functions defined once whose body is `return <pure expression>`.
+// Calls to other user functions keep a body out until those are inlined into it.
+void Optimizer::find_inlinable() {
+    inlinable_.clear();
+
+    std::unordered_map<std::string, size_t> definitions;
+    std::vector<uint32_t> pending = {0};
+    while (!pending.empty()) {
+        uint32_t index = pending.back();
+        pending.pop_back();
+        if (nodes()[index].type == NodeType::FUNCTION_DEF) {
+            ++definitions[name_of(nodes()[index].function_def.name_index)];
+        }
+        for (uint32_t child : children(index)) {
+            pending.push_back(child);
+        }
+    }
+
+    std::vector<uint32_t> statements = chain(nodes()[0].first_child_index);
+    for (uint32_t position = 0; position < statements.size(); ++position) {
+        const ASTNode& def = nodes()[statements[position]];
+        if (def.type != NodeType::FUNCTION_DEF || !valid(def.function_def.body_index)) {
+            continue;
+        }
+        std::string name = name_of(def.function_def.name_index);
+        if (definitions[name] != 1 || interpreter_.is_builtin(name)) {
+            continue;
+        }
+
+        std::vector<uint32_t> body = chain(nodes()[def.function_def.body_index].first_child_index);
+        if (body.size() != 1 || nodes()[body[0]].type != NodeType::RETURN_STATEMENT ||
+            !valid(nodes()[body[0]].return_statement.value_index)) {
+            continue;
+        }
+        uint32_t expression = nodes()[body[0]].return_statement.value_index;
+        size_t size = count_nodes(expression);
+        if (size > INLINE_MAX_NODES || !is_pure(expression)) {
+            continue;
+        }
+
+        Inlinable callee{position, expression, {}, {}, {}, size};
+        bool usable = true;
+        for (uint32_t param_index : chain(def.function_def.params_start_index)) {
+            const ASTNode& param = nodes()[param_index];
+            std::string parameter = param.type == NodeType::IDENTIFIER ? name_of(param.identifier.name_index) : "";
+            // Builtins win over parameters at call sites, so such a name is never substituted
+            if (parameter.empty() || interpreter_.is_builtin(parameter) ||
+                std::find(callee.parameters.begin(), callee.parameters.end(), parameter) != callee.parameters.end()) {
+                usable = false;
+                break;
+            }
+            callee.parameters.push_back(parameter);
+        }
+        if (!usable) {
+            continue;
+        }
+
+        std::unordered_map<std::string, size_t> counts;
+        count_names(expression, counts);
+        for (const std::string& parameter : callee.parameters) {
+            callee.uses.push_back(counts[parameter]);
+            counts.erase(parameter);
+        }
+        for (const auto& entry : counts) {
+            callee.free_names.insert(entry.first);
+        }
+        inlinable_.emplace(name, std::move(callee));
+    }
+}
+
+void Optimizer::inline_calls(uint32_t node_index, size_t depth, const std::unordered_set<std::string>& shadowed,
+                             uint32_t position) {
+    const ASTNode node = nodes()[node_index];
+
+    switch (node.type) {
+        case NodeType::FUNCTION_CALL:
+            if (try_inline(node_index, depth, shadowed, position)) {
+                return;  // Calls in the substituted arguments are visited next round
+            }
+            break;
+        case NodeType::WHILE_STATEMENT:
+            for (uint32_t child : children(node_index)) {
+                inline_calls(child, depth + 1, shadowed, position);
+            }
+            return;
+        case NodeType::FOR_STATEMENT:
+            inline_calls(node.for_statement.iterable_index, depth, shadowed, position);
+            inline_calls(node.for_statement.body_index, depth + 1, shadowed, position);
+            return;
+        case NodeType::FUNCTION_DEF: {
+            // Parameters hide globals of the same name from anything inlined into the body
+            std::unordered_set<std::string> inner = shadowed;
+            for (uint32_t param_index : chain(node.function_def.params_start_index)) {
+                if (nodes()[param_index].type == NodeType::IDENTIFIER) {
+                    inner.insert(name_of(nodes()[param_index].identifier.name_index));
+                }
+            }
+            if (valid(node.function_def.body_index)) {
+                inline_calls(node.function_def.body_index, depth + 1, inner, position);
+            }
+            return;
+        }
+        default:
+            break;
+    }
+
+    for (uint32_t child : children(node_index)) {
+        inline_calls(child, depth, shadowed, position);
+    }
+}
+
+bool Optimizer::try_inline(uint32_t call_index, size_t depth, const std::unordered_set<std::string>& shadowed,
+                           uint32_t position) {
+    const ASTNode call = nodes()[call_index];
+    auto it = inlinable_.find(name_of(call.function_call.name_index));
+    if (it == inlinable_.end()) {
+        return false;
+    }
+    const Inlinable& callee = it->second;
+
+    // A call that can run before the definition fails, and has to keep failing
+    if (position <= callee.position) {
+        return false;
+    }
+    for (const std::string& name : callee.free_names) {
+        if (shadowed.count(name)) {
+            return false;
+        }
+    }
+
+    std::vector<uint32_t> args = chain(call.function_call.args_start_index);
+    if (args.size() != callee.parameters.size()) {
+        return false;
+    }
+
+    // Each argument is evaluated exactly once by a call. Literals and names can be
+    // read any number of times; anything else has to be pure and read once.
+    std::unordered_map<std::string, uint32_t> substitution;
+    size_t size = callee.size;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const ASTNode& arg = nodes()[args[i]];
+        size_t uses = callee.uses[i];
+        if (arg.type == NodeType::IDENTIFIER && uses == 0) {
+            return false;  // The read of an undefined name has to fail
+        }
+        if (!is_literal(arg) && arg.type != NodeType::IDENTIFIER && (uses != 1 || !is_pure(args[i]))) {
+            return false;
+        }
+        size += uses * count_nodes(args[i]) - uses;
+        substitution[callee.parameters[i]] = args[i];
+    }
+
+    // Hot call sites may take larger bodies
+    if (size > INLINE_BASE_NODES + INLINE_LOOP_NODES * depth || size > growth_budget_) {
+        return false;
+    }
+
+    uint32_t root = clone(callee.expression, substitution, call.parent_index);
+    ASTNode replacement = nodes()[root];
+    replacement.parent_index = call.parent_index;
+    replacement.next_sibling_index = call.next_sibling_index;
+    nodes()[call_index] = replacement;
+    if (replacement.type == NodeType::MATRIX_LITERAL && replacement.matrix_literal.is_constant) {
+        parser_.get_mutable_constants().alias(call_index, root);
+    }
+    for (uint32_t child : children(call_index)) {
+        nodes()[child].parent_index = call_index;
+    }
+
+    growth_budget_ -= size;
+    ++stats_.calls_inlined;
+    return true;
+}
+
+uint32_t Optimizer::clone(uint32_t node_index, const std::unordered_map<std::string, uint32_t>& substitution,
+                          uint32_t parent_index) {
+    ASTNode node = nodes()[node_index];
+    if (node.type == NodeType::IDENTIFIER) {
+        auto it = substitution.find(name_of(node.identifier.name_index));
+        if (it != substitution.end()) {
+            return clone(it->second, {}, parent_index);
+        }
+    }
+
+    // nodes() may reallocate below, so children are written back by index
+    uint32_t copy = static_cast<uint32_t>(nodes().size());
+    node.parent_index = parent_index;
+    node.next_sibling_index = INVALID_INDEX;
+    nodes().push_back(node);
+
+    switch (node.type) {
+        case NodeType::BINARY_OP: {
+            uint32_t left = clone(node.binary_op.left_index, substitution, copy);
+            uint32_t right = clone(node.binary_op.right_index, substitution, copy);
+            nodes()[copy].binary_op.left_index = left;
+            nodes()[copy].binary_op.right_index = right;
+            break;
+        }
+        case NodeType::UNARY_OP: {
+            uint32_t operand = clone(node.unary_op.operand_index, substitution, copy);
+            nodes()[copy].unary_op.operand_index = operand;
+            break;
+        }
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS: {
+            uint32_t object = clone(node.array_access.object_index, substitution, copy);
+            uint32_t index = clone(node.array_access.index_index, substitution, copy);
+            nodes()[copy].array_access.object_index = object;
+            nodes()[copy].array_access.index_index = index;
+            break;
+        }
+        case NodeType::MEMBER_ACCESS: {
+            uint32_t object = clone(node.member_access.object_index, substitution, copy);
+            nodes()[copy].member_access.object_index = object;
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            uint32_t args = clone_chain(node.function_call.args_start_index, substitution, copy);
+            nodes()[copy].function_call.args_start_index = args;
+            break;
+        }
+        case NodeType::MATRIX_LITERAL: {
+            uint32_t elements = clone_chain(node.matrix_literal.elements_start_index, substitution, copy);
+            nodes()[copy].matrix_literal.elements_start_index = elements;
+            if (node.matrix_literal.is_constant) {
+                parser_.get_mutable_constants().alias(copy, node_index);
+            }
+            break;
+        }
+        case NodeType::DICT_LITERAL: {
+            uint32_t entries = clone_chain(node.dict_literal.entries_start_index, substitution, copy);
+            nodes()[copy].dict_literal.entries_start_index = entries;
+            break;
+        }
+        default:
+            break;
+    }
+    return copy;
+}
+
+uint32_t Optimizer::clone_chain(uint32_t start_index, const std::unordered_map<std::string, uint32_t>& substitution,
+                                uint32_t parent_index) {
+    if (!valid(start_index)) {
+        return start_index;
+    }
+    uint32_t first = INVALID_INDEX;
+    uint32_t previous = INVALID_INDEX;
+    for (uint32_t index : chain(start_index)) {
+        uint32_t copy = clone(index, substitution, parent_index);
+        if (previous == INVALID_INDEX) {
+            first = copy;
+        } else {
+            nodes()[previous].next_sibling_index = copy;
+        }
+        previous = copy;
+    }
+    return first;
+}
+
+// Folds with the interpreter's operators, so results match evaluation exactly.
+// Operations that throw are left for the interpreter to report.
+void Optimizer::fold_constants(uint32_t node_index) {
+    for (uint32_t child : children(node_index)) {
+        fold_constants(child);
+    }
+
+    const ASTNode node = nodes()[node_index];
+    Value result;
+    try {
+        if (node.type == NodeType::BINARY_OP && is_constant(nodes()[node.binary_op.left_index]) &&
+            is_constant(nodes()[node.binary_op.right_index])) {
+            result = Interpreter::apply_binary_op(node.binary_op.op_type,
+                                                  constant_value(nodes()[node.binary_op.left_index]),
+                                                  constant_value(nodes()[node.binary_op.right_index]));
+        } else if (node.type == NodeType::UNARY_OP && is_constant(nodes()[node.unary_op.operand_index])) {
+            result = Interpreter::apply_unary_op(node.unary_op.op_type,
+                                                 constant_value(nodes()[node.unary_op.operand_index]));
+        } else {
+            return;
+        }
+    } catch (const RuntimeError&) {
+        return;
+    }
+
+    if (write_constant(nodes()[node_index], result)) {
+        ++stats_.constants_folded;
+    }
+}
+
+void Optimizer::prune(uint32_t node_index) {
+    const ASTNode node = nodes()[node_index];
+
+    // A constant condition leaves one branch, or nothing, in the statement's place
+    bool constant_if = node.type == NodeType::IF_STATEMENT && is_constant(nodes()[node.if_statement.condition_index]);
+    bool dead_loop = node.type == NodeType::WHILE_STATEMENT &&
+                     is_constant(nodes()[node.while_statement.condition_index]) &&
+                     !constant_value(nodes()[node.while_statement.condition_index]).is_truthy();
+    if (constant_if || dead_loop) {
+        uint32_t branch = INVALID_INDEX;
+        if (constant_if) {
+            branch = constant_value(nodes()[node.if_statement.condition_index]).is_truthy()
+                         ? node.if_statement.then_block_index : node.if_statement.else_block_index;
+        }
+        ASTNode replacement = valid(branch) ? nodes()[branch] : ASTNode(NodeType::BLOCK, node.token_index);
+        replacement.parent_index = node.parent_index;
+        replacement.next_sibling_index = node.next_sibling_index;
+        nodes()[node_index] = replacement;
+        for (uint32_t child : children(node_index)) {
+            nodes()[child].parent_index = node_index;
+        }
+        ++stats_.branches_removed;
+        prune(node_index);  // An elif chain leaves another if
+        return;
+    }
+
+    // Statements after a return never run
+    if (node.type == NodeType::BLOCK || node.type == NodeType::PROGRAM) {
+        std::vector<uint32_t> statements = chain(node.first_child_index);
+        auto ret = std::find_if(statements.begin(), statements.end(), [this](uint32_t index) {
+            return nodes()[index].type == NodeType::RETURN_STATEMENT;
+        });
+        if (ret != statements.end() && ret + 1 != statements.end()) {
+            stats_.branches_removed += static_cast<size_t>(statements.end() - (ret + 1));
+            statements.erase(ret + 1, statements.end());
+            relink(node_index, statements);
+        }
+    }
+
+    for (uint32_t child : children(node_index)) {
+        prune(child);
+    }
+}
+
+// Top-level definitions no call or name refers to, repeated since removing
+// one may orphan the helpers it called
+void Optimizer::remove_unused_functions() {
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        std::unordered_map<std::string, size_t> counts;
+        count_names(0, counts);
+
+        std::vector<uint32_t> kept;
+        for (uint32_t index : chain(nodes()[0].first_child_index)) {
+            const ASTNode& node = nodes()[index];
+            if (node.type == NodeType::FUNCTION_DEF) {
+                std::string name = name_of(node.function_def.name_index);
+                std::unordered_map<std::string, size_t> own;
+                count_names(index, own);
+                if (counts[name] == own[name]) {
+                    ++stats_.functions_removed;
+                    removed = true;
+                    continue;
+                }
+            }
+            kept.push_back(index);
+        }
+        if (removed) {
+            relink(0, kept);
+        }
+    }
+}
+
+// Parameters are the only names local to a call. A store to one that no later
+// statement of the body reads, and that no nested function captured, is dead;
+// its value is still evaluated unless it is a literal.
+void Optimizer::remove_dead_stores(uint32_t node_index) {
+    const ASTNode node = nodes()[node_index];
+
+    if (node.type == NodeType::FUNCTION_DEF && valid(node.function_def.body_index)) {
+        std::unordered_set<std::string> parameters;
+        for (uint32_t param_index : chain(node.function_def.params_start_index)) {
+            if (nodes()[param_index].type == NodeType::IDENTIFIER) {
+                parameters.insert(name_of(nodes()[param_index].identifier.name_index));
+            }
+        }
+
+        std::unordered_map<std::string, size_t> captured;
+        std::vector<uint32_t> pending = children(node.function_def.body_index);
+        while (!pending.empty()) {
+            uint32_t index = pending.back();
+            pending.pop_back();
+            if (nodes()[index].type == NodeType::FUNCTION_DEF) {
+                count_names(index, captured);
+                continue;
+            }
+            for (uint32_t child : children(index)) {
+                pending.push_back(child);
+            }
+        }
+
+        uint32_t body_index = node.function_def.body_index;
+        std::vector<uint32_t> statements = chain(nodes()[body_index].first_child_index);
+        std::vector<uint32_t> kept;
+        for (size_t k = 0; k < statements.size(); ++k) {
+            const ASTNode& statement = nodes()[statements[k]];
+            bool dead = false;
+            if (statement.type == NodeType::ASSIGNMENT &&
+                nodes()[statement.assignment.target_index].type == NodeType::IDENTIFIER) {
+                std::string name = name_of(nodes()[statement.assignment.target_index].identifier.name_index);
+                if (parameters.count(name) && !captured.count(name)) {
+                    std::unordered_map<std::string, size_t> later;
+                    for (size_t j = k + 1; j < statements.size(); ++j) {
+                        count_names(statements[j], later);
+                    }
+                    dead = !later.count(name);
+                }
+            }
+
+            if (!dead) {
+                kept.push_back(statements[k]);
+                continue;
+            }
+            ++stats_.stores_removed;
+            uint32_t value_index = statement.assignment.value_index;
+            if (!is_literal(nodes()[value_index])) {
+                ASTNode& rewritten = nodes()[statements[k]];
+                rewritten.type = NodeType::EXPRESSION_STATEMENT;
+                rewritten.first_child_index = value_index;
+                rewritten.expression_statement.expression_index = value_index;
+                kept.push_back(statements[k]);
+            }
+        }
+        if (kept.size() != statements.size()) {
+            relink(body_index, kept);
+        }
+    }
+
+    for (uint32_t child : children(node_index)) {
+        remove_dead_stores(child);
+    }
+}
+
+} // namespace Dakota
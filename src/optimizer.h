@@ -0,0 +1,96 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "parser.h"
+#include "interpreter.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Dakota {
+
+// Constants for whole-program optimization
+constexpr size_t INLINE_BASE_NODES = 8;      // Largest inlined expression outside loops
+constexpr size_t INLINE_LOOP_NODES = 16;     // Extra nodes allowed per enclosing loop or function
+constexpr size_t INLINE_MAX_NODES = 64;      // Largest callee body considered at all
+constexpr size_t INLINE_GROWTH_FACTOR = 2;   // Inlining may add this many times the original node count
+constexpr int INLINE_MAX_ROUNDS = 4;         // Helpers calling helpers are inlined bottom-up, one level per round
+
+struct OptimizerStats {
+    size_t calls_inlined = 0;
+    size_t functions_removed = 0;
+    size_t constants_folded = 0;
+    size_t branches_removed = 0;   // Constant conditions, dead loops and statements after return
+    size_t stores_removed = 0;
+};
+
+// Rewrites the parser's flat AST in place before interpretation:
+//
+//   - calls to small top-level functions whose body is `return expr` are
+//     replaced by expr with the arguments substituted, sized by loop depth
+//   - literal subexpressions are folded with the interpreter's own operators
+//   - constant if/while conditions and statements after return are dropped
+//   - top-level functions nothing refers to any more are removed
+//   - stores to parameters that are never read again are dropped
+//
+// Only rewrites that cannot change what a program prints, returns or leaves
+// in the global environment are made. Assignments to new names inside a
+// function define globals, so parameters are the only stores that can die.
+class Optimizer {
+public:
+    // A library (an imported module) keeps every top-level function, since
+    // its importers call them
+    Optimizer(Parser& parser, const Interpreter& interpreter, bool library = false);
+
+    OptimizerStats run();
+
+private:
+    struct Inlinable {
+        uint32_t position;                       // Top-level statement defining the function
+        uint32_t expression;                     // The returned expression
+        std::vector<std::string> parameters;
+        std::vector<size_t> uses;                // Reads of each parameter in the expression
+        std::unordered_set<std::string> free_names;
+        size_t size;
+    };
+
+    Parser& parser_;
+    const Interpreter& interpreter_;
+    bool library_;
+    OptimizerStats stats_;
+    size_t growth_budget_;
+    std::unordered_map<std::string, Inlinable> inlinable_;
+
+    std::vector<ASTNode>& nodes() { return parser_.get_mutable_nodes(); }
+    const std::vector<ASTNode>& nodes() const { return parser_.get_nodes(); }
+    bool valid(uint32_t index) const { return index != 0 && index < nodes().size(); }
+    std::string name_of(uint32_t string_index) const;
+    std::vector<uint32_t> chain(uint32_t start_index) const;
+    std::vector<uint32_t> children(uint32_t node_index) const;
+    void relink(uint32_t owner_index, const std::vector<uint32_t>& statements);
+    void count_names(uint32_t node_index, std::unordered_map<std::string, size_t>& counts) const;
+    size_t count_nodes(uint32_t node_index) const;
+    bool is_pure(uint32_t node_index) const;
+
+    // Inlining
+    void find_inlinable();
+    void inline_calls(uint32_t node_index, size_t depth, const std::unordered_set<std::string>& shadowed,
+                      uint32_t position);
+    bool try_inline(uint32_t call_index, size_t depth, const std::unordered_set<std::string>& shadowed,
+                    uint32_t position);
+    uint32_t clone(uint32_t node_index, const std::unordered_map<std::string, uint32_t>& substitution,
+                   uint32_t parent_index);
+    uint32_t clone_chain(uint32_t start_index, const std::unordered_map<std::string, uint32_t>& substitution,
+                         uint32_t parent_index);
+
+    // Folding and elimination
+    void fold_constants(uint32_t node_index);
+    void prune(uint32_t node_index);
+    void remove_unused_functions();
+    void remove_dead_stores(uint32_t node_index);
+};
+
+} // namespace Dakota
+
+#endif // OPTIMIZER_H
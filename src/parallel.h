@@ -0,0 +1,70 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <exception>
+#include <mutex>
+#include <algorithm>
+#include <cstddef>
+
+namespace Dakota {
+
+// Upper bound on threads used by data-parallel kernels
+constexpr unsigned MAX_KERNEL_THREADS = 64;
+
+inline unsigned hardware_threads() {
+    unsigned count = std::thread::hardware_concurrency();
+    if (count == 0) count = 1;
+    return std::min(count, MAX_KERNEL_THREADS);
+}
+
+// Run body(i) for every i in [0, count) on up to max_threads threads and wait.
+// Work is handed out dynamically so uneven items (frontal matrices, row blocks)
+// still balance. The first exception thrown by any worker is rethrown here.
+template <typename Body>
+void parallel_for(size_t count, Body body, unsigned max_threads = 0) {
+    if (count == 0) return;
+
+    unsigned threads = max_threads == 0 ? hardware_threads() : max_threads;
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+
+    auto worker = [&]() {
+        try {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                body(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+            next.store(count);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace Dakota
+
+#endif // PARALLEL_H
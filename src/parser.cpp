@@ -2,6 +2,7 @@
 #include <iostream>
 #include <algorithm>
 #include <cstring>
+#include <cmath>
 
 namespace Dakota {
 
@@ -14,6 +15,7 @@ const OperatorInfo Parser::OPERATOR_TABLE[] = {
     {BinaryOpType::AND,    2, false},    // and
     {BinaryOpType::EQ,     3, false},    // ==
     {BinaryOpType::NE,     3, false},    // !=
+    {BinaryOpType::IN,     3, false},    // in (membership)
     {BinaryOpType::LT,     4, false},    // <
     {BinaryOpType::LE,     4, false},    // <=
     {BinaryOpType::GT,     4, false},    // >
@@ -62,6 +64,33 @@ void StringTable::clear() {
     offsets.clear();
 }
 
+// ConstantPool implementation
+void ConstantPool::add_matrix(uint32_t node_index, const std::vector<double>& values) {
+    offsets[node_index] = data.size();
+    data.insert(data.end(), values.begin(), values.end());
+}
+
+const double* ConstantPool::get_matrix(uint32_t node_index) const {
+    auto it = offsets.find(node_index);
+    return it == offsets.end() ? nullptr : data.data() + it->second;
+}
+
+void ConstantPool::alias(uint32_t node_index, uint32_t source_index) {
+    auto it = offsets.find(source_index);
+    if (it != offsets.end()) {
+        offsets[node_index] = it->second;
+    }
+}
+
+void ConstantPool::scale(uint32_t node_index, size_t count, double factor) {
+    auto it = offsets.find(node_index);
+    if (it != offsets.end()) {
+        for (size_t i = 0; i < count; ++i) {
+            data[it->second + i] *= factor;
+        }
+    }
+}
+
 // Parser implementation
 Parser::Parser(const std::vector<Token>& tokens) : ctx(tokens) {
     // Add empty string at index 0
@@ -114,6 +143,18 @@ bool Parser::check(TokenType type) const {
     return current_token().type == type;
 }
 
+// Result of the last parsed subexpression. A subexpression that failed to
+// parse pushes nothing, so an empty stack yields INVALID_INDEX; the parse has
+// already been marked as failed.
+uint32_t Parser::pop_node() {
+    if (ctx.node_stack.empty()) {
+        return INVALID_INDEX;
+    }
+    uint32_t node = ctx.node_stack.back();
+    ctx.node_stack.pop_back();
+    return node;
+}
+
 uint32_t Parser::create_node(NodeType type) {
     uint32_t index = static_cast<uint32_t>(ctx.nodes.size());
     ctx.nodes.emplace_back(type, ctx.current_token);
@@ -172,7 +213,7 @@ void Parser::synchronize() {
         TokenType type = current_token().type;
         if (type == TokenType::IF || type == TokenType::WHILE || 
             type == TokenType::FOR || type == TokenType::FUNCTION ||
-            type == TokenType::RETURN) {
+            type == TokenType::RETURN || type == TokenType::IMPORT || type == TokenType::EXTERN) {
             return;
         }
         
@@ -186,12 +227,10 @@ void Parser::parse_postfix_expressions() {
             // Array access
             advance(); // consume '['
             
-            uint32_t object_node = ctx.node_stack.back();
-            ctx.node_stack.pop_back();
+            uint32_t object_node = pop_node();
             
             parse_expression();
-            uint32_t index_node = ctx.node_stack.back();
-            ctx.node_stack.pop_back();
+            uint32_t index_node = pop_node();
             
             if (!match(TokenType::RBRACKET)) {
                 error_at_current("Expected ']' after array index");
@@ -212,12 +251,24 @@ void Parser::parse_postfix_expressions() {
                 break;
             }
             
-            uint32_t object_node = ctx.node_stack.back();
-            ctx.node_stack.pop_back();
+            uint32_t object_node = pop_node();
             
             std::string_view member_name = current_token().value;
             advance();
             
+            // Call of a member function: module.function(args)
+            if (check(TokenType::LPAREN)) {
+                uint32_t call_node = create_node(NodeType::METHOD_CALL);
+                uint32_t arg_count = 0;
+                uint32_t first_arg = parse_call_arguments(arg_count);
+                ctx.nodes[call_node].method_call.object_index = object_node;
+                ctx.nodes[call_node].method_call.name_index = ctx.strings.add_string(member_name);
+                ctx.nodes[call_node].method_call.args_start_index = arg_count > 0 ? first_arg : 0;
+                ctx.nodes[call_node].method_call.arg_count = arg_count;
+                ctx.node_stack.push_back(call_node);
+                continue;
+            }
+            
             uint32_t member_node = create_node(NodeType::MEMBER_ACCESS);
             ctx.nodes[member_node].member_access.object_index = object_node;
             ctx.nodes[member_node].member_access.member_name_index = ctx.strings.add_string(member_name);
@@ -230,10 +281,36 @@ void Parser::parse_postfix_expressions() {
     }
 }
 
+uint32_t Parser::parse_call_arguments(uint32_t& arg_count) {
+    advance(); // consume '('
+    
+    std::vector<uint32_t> args;
+    if (!check(TokenType::RPAREN)) {
+        do {
+            parse_expression();
+            args.push_back(pop_node());
+        } while (match(TokenType::COMMA));
+    }
+    
+    if (!match(TokenType::RPAREN)) {
+        error_at_current("Expected ')' after function arguments");
+    }
+    
+    // Link arguments as siblings
+    for (size_t i = 1; i < args.size(); i++) {
+        ctx.nodes[args[i-1]].next_sibling_index = args[i];
+    }
+    arg_count = static_cast<uint32_t>(args.size());
+    return args.empty() ? INVALID_INDEX : args[0];
+}
+
 // Main parsing entry point
 uint32_t Parser::parse() {
     try {
         parse_program();
+        if (!ctx.has_error && !ctx.units.empty()) {
+            check_units();
+        }
         return 0; // Root node index
     } catch (const std::exception& e) {
         error(std::string("Parse error: ") + e.what());
@@ -249,6 +326,7 @@ void Parser::parse_program() {
     
     // Add loop detection to prevent infinite loops
     size_t loop_detection_counter = 0;
+    uint32_t last_statement = INVALID_INDEX;
     const size_t MAX_PROGRAM_ITERATIONS = 50000; // Reasonable limit for program statements
     
     while (!at_end()) {
@@ -259,6 +337,7 @@ void Parser::parse_program() {
         }
         
         size_t start_token = ctx.current_token;
+        size_t stmt_start = ctx.nodes.size();
         
         try {
             parse_statement();
@@ -281,6 +360,19 @@ void Parser::parse_program() {
             break; // Stop parsing on error
         }
         
+        // Link the new top-level statement; nested ones were claimed by their block
+        for (size_t i = stmt_start; i < ctx.nodes.size(); i++) {
+            if (ctx.nodes[i].parent_index == ROOT_NODE_INDEX) {
+                uint32_t stmt_index = static_cast<uint32_t>(i);
+                if (last_statement == INVALID_INDEX) {
+                    ctx.nodes[ROOT_NODE_INDEX].first_child_index = stmt_index;
+                } else {
+                    ctx.nodes[last_statement].next_sibling_index = stmt_index;
+                }
+                last_statement = stmt_index;
+            }
+        }
+        
         // Skip any trailing newlines after each statement
         while (!at_end() && match(TokenType::NEWLINE)) {
             // continue skipping
@@ -316,6 +408,16 @@ void Parser::parse_statement() {
         return;
     }
     
+    if (check(TokenType::IMPORT)) {
+        parse_import_statement();
+        return;
+    }
+    
+    if (check(TokenType::EXTERN)) {
+        parse_extern_declaration();
+        return;
+    }
+    
     if (check(TokenType::RETURN)) {
         advance(); // consume 'return'
         uint32_t return_node = create_node(NodeType::RETURN_STATEMENT);
@@ -323,14 +425,13 @@ void Parser::parse_statement() {
         if (!check(TokenType::NEWLINE) && !at_end()) {
             ctx.node_stack.push_back(return_node);
             parse_expression();
-            uint32_t expr_node = ctx.node_stack.back();
-            ctx.node_stack.pop_back();
+            uint32_t expr_node = pop_node();
             ctx.nodes[return_node].return_statement.value_index = expr_node;
         } else {
             ctx.nodes[return_node].return_statement.value_index = 0; // void return
         }
         
-        add_child(ROOT_NODE_INDEX, return_node); // Add to program
+        set_parent(return_node, ROOT_NODE_INDEX); // Linked by the enclosing program or block
         return;
     }
     
@@ -349,14 +450,22 @@ void Parser::parse_statement() {
     parse_expression();
     
     if (!ctx.node_stack.empty()) {
-        uint32_t expr_node = ctx.node_stack.back();
-        ctx.node_stack.pop_back();
+        uint32_t expr_node = pop_node();
+        
+        // Indexed assignment: xs[i] = value
+        if (ctx.nodes[expr_node].type == NodeType::ARRAY_ACCESS && match(TokenType::ASSIGN)) {
+            uint32_t assign_node = create_node(NodeType::ASSIGNMENT);
+            parse_expression();
+            ctx.nodes[assign_node].assignment.target_index = expr_node;
+            ctx.nodes[assign_node].assignment.value_index = pop_node();
+            expr_node = assign_node;
+        }
         // Set both expression_index and first_child_index for consistency
         ctx.nodes[expr_stmt_node].expression_statement.expression_index = expr_node;
         ctx.nodes[expr_stmt_node].first_child_index = expr_node;
         // Set parent relationship
         ctx.nodes[expr_node].parent_index = expr_stmt_node;
-        add_child(ROOT_NODE_INDEX, expr_stmt_node);
+        set_parent(expr_stmt_node, ROOT_NODE_INDEX);
     } else {
         // If expression parsing failed and we have no nodes, advance to prevent infinite loop
         if (!at_end()) {
@@ -398,13 +507,11 @@ void Parser::parse_binary_expression(uint8_t min_precedence) {
         
         advance(); // consume operator
         
-        uint32_t left_node = ctx.node_stack.back();
-        ctx.node_stack.pop_back();
+        uint32_t left_node = pop_node();
         
         parse_binary_expression(next_min_prec);
         
-        uint32_t right_node = ctx.node_stack.back();
-        ctx.node_stack.pop_back();
+        uint32_t right_node = pop_node();
         
         uint32_t binary_node = create_node(NodeType::BINARY_OP);
         ctx.nodes[binary_node].binary_op.op_type = token_to_binary_op(op_token);
@@ -422,8 +529,7 @@ void Parser::parse_unary_expression() {
         
         parse_unary_expression();
         
-        uint32_t operand_node = ctx.node_stack.back();
-        ctx.node_stack.pop_back();
+        uint32_t operand_node = pop_node();
         
         uint32_t unary_node = create_node(NodeType::UNARY_OP);
         ctx.nodes[unary_node].unary_op.op_type = token_to_unary_op(op_token);
@@ -441,6 +547,9 @@ void Parser::parse_primary() {
         uint32_t node = create_node(NodeType::INTEGER_LITERAL);
         ctx.nodes[node].integer_literal.value = std::stoll(current_token().value);
         advance();
+        if (check(TokenType::LBRACKET)) {
+            parse_unit_annotation(node);
+        }
         ctx.node_stack.push_back(node);
         return;
     }
@@ -450,6 +559,9 @@ void Parser::parse_primary() {
         uint32_t node = create_node(NodeType::FLOAT_LITERAL);
         ctx.nodes[node].float_literal.value = std::stod(current_token().value);
         advance();
+        if (check(TokenType::LBRACKET)) {
+            parse_unit_annotation(node);
+        }
         ctx.node_stack.push_back(node);
         return;
     }
@@ -477,6 +589,15 @@ void Parser::parse_primary() {
     // Matrix literal
     if (check(TokenType::LBRACKET)) {
         parse_matrix_literal();
+        if (check(TokenType::LBRACKET) && !ctx.has_error && !ctx.node_stack.empty()) {
+            parse_unit_annotation(ctx.node_stack.back());
+        }
+        return;
+    }
+    
+    // Dictionary literal
+    if (check(TokenType::LBRACE)) {
+        parse_dict_literal();
         return;
     }
     
@@ -501,28 +622,11 @@ void Parser::parse_primary() {
             uint32_t func_node = create_node(NodeType::FUNCTION_CALL);
             ctx.nodes[func_node].function_call.name_index = ctx.strings.add_string(name);
             
-            advance(); // consume '('
-            
-            std::vector<uint32_t> args;
-            if (!check(TokenType::RPAREN)) {
-                do {
-                    parse_expression();
-                    args.push_back(ctx.node_stack.back());
-                    ctx.node_stack.pop_back();
-                } while (match(TokenType::COMMA));
-            }
-            
-            if (!match(TokenType::RPAREN)) {
-                error_at_current("Expected ')' after function arguments");
-            }
-            
-            ctx.nodes[func_node].function_call.arg_count = static_cast<uint32_t>(args.size());
-            if (!args.empty()) {
-                ctx.nodes[func_node].function_call.args_start_index = args[0];
-                // Link arguments as siblings
-                for (size_t i = 1; i < args.size(); i++) {
-                    ctx.nodes[args[i-1]].next_sibling_index = args[i];
-                }
+            uint32_t arg_count = 0;
+            uint32_t first_arg = parse_call_arguments(arg_count);
+            ctx.nodes[func_node].function_call.arg_count = arg_count;
+            if (arg_count > 0) {
+                ctx.nodes[func_node].function_call.args_start_index = first_arg;
             }
             
             ctx.node_stack.push_back(func_node);
@@ -549,6 +653,16 @@ void Parser::parse_matrix_literal() {
     advance(); // consume '['
 
     uint32_t matrix_node = create_node(NodeType::MATRIX_LITERAL);
+    ctx.nodes[matrix_node].matrix_literal.elements_start_index = INVALID_INDEX;
+    ctx.nodes[matrix_node].matrix_literal.validation_error = MatrixError::NONE;
+    ctx.nodes[matrix_node].matrix_literal.is_empty = check(TokenType::RBRACKET);
+    ctx.nodes[matrix_node].matrix_literal.is_constant = false;
+
+    if (parse_constant_matrix(matrix_node)) {
+        ctx.node_stack.push_back(matrix_node);
+        return;
+    }
+
     std::vector<uint32_t> elements;
     uint32_t rows = 0, cols = 0;
 
@@ -570,8 +684,7 @@ void Parser::parse_matrix_literal() {
                     return;
                 }
 
-                elements.push_back(ctx.node_stack.back());
-                ctx.node_stack.pop_back();
+                elements.push_back(pop_node());
                 row_cols++;
 
             } while (match(TokenType::COMMA));
@@ -613,6 +726,202 @@ void Parser::parse_matrix_literal() {
     ctx.node_stack.push_back(matrix_node);
 }
 
+// Fast path for literals made only of numbers, such as embedded lookup
+// tables: `[1, -2.5; 3, 4]` is read straight off the tokens into the
+// constant pool, with no element nodes to build or evaluate. Anything else,
+// including ragged rows, is left for the general path to parse and report.
+bool Parser::parse_constant_matrix(uint32_t matrix_node) {
+    size_t position = ctx.current_token;
+    std::vector<double> values;
+    uint32_t rows = 0, cols = 0, row_cols = 0;
+
+    while (position < ctx.token_count) {
+        bool negative = ctx.tokens[position].type == TokenType::MINUS;
+        if (negative) position++;
+        if (position >= ctx.token_count) return false;
+
+        const Token& number = ctx.tokens[position];
+        if (number.type == TokenType::INTEGER) {
+            values.push_back(static_cast<double>(std::stoll(number.value)));
+        } else if (number.type == TokenType::FLOAT) {
+            values.push_back(std::stod(number.value));
+        } else {
+            return false;
+        }
+        if (negative) values.back() = -values.back();
+        row_cols++;
+        position++;
+
+        if (position >= ctx.token_count) return false;
+        TokenType separator = ctx.tokens[position].type;
+        if (separator == TokenType::COMMA) {
+            position++;
+            continue;
+        }
+        if (separator != TokenType::SEMICOLON && separator != TokenType::RBRACKET) return false;
+
+        if (rows == 0) {
+            cols = row_cols;
+        } else if (row_cols != cols) {
+            return false;
+        }
+        rows++;
+        row_cols = 0;
+        position++;
+
+        if (separator == TokenType::RBRACKET) {
+            ASTNode& node = ctx.nodes[matrix_node];
+            node.matrix_literal.rows = rows;
+            node.matrix_literal.cols = cols;
+            node.matrix_literal.is_constant = true;
+            ctx.constants.add_matrix(matrix_node, values);
+            ctx.current_token = position;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A unit after a literal, e.g. `9.81 [m/s**2]`. The literal is converted to
+// SI base units here, so annotated code runs exactly like code written in SI,
+// and its dimension is kept for check_units.
+void Parser::parse_unit_annotation(uint32_t literal_node) {
+    advance(); // consume '['
+    
+    Unit unit;
+    if (!parse_unit_product(unit)) {
+        return;
+    }
+    if (!match(TokenType::RBRACKET)) {
+        error_at_current("Expected ']' after unit");
+        return;
+    }
+    
+    ASTNode& node = ctx.nodes[literal_node];
+    if (node.type == NodeType::INTEGER_LITERAL) {
+        double scaled = static_cast<double>(node.integer_literal.value) * unit.factor;
+        if (unit.factor != std::floor(unit.factor) || std::fabs(scaled) > UNIT_MAX_EXACT_INTEGER) {
+            node.type = NodeType::FLOAT_LITERAL;
+            node.float_literal.value = scaled;
+        } else {
+            node.integer_literal.value *= static_cast<int64_t>(unit.factor);
+        }
+    } else if (node.type == NodeType::FLOAT_LITERAL) {
+        node.float_literal.value *= unit.factor;
+    } else if (node.type == NodeType::MATRIX_LITERAL && node.matrix_literal.is_constant) {
+        ctx.constants.scale(literal_node, static_cast<size_t>(node.matrix_literal.rows) * node.matrix_literal.cols,
+                            unit.factor);
+    } else {
+        error_at_current("Units can only follow a number or a matrix of numbers");
+        return;
+    }
+    ctx.units[literal_node] = unit.dimension;
+}
+
+// Units multiplied and divided left to right: kg*m/s**2. A leading 1 is
+// only a numerator, as in 1/s; a bare [1] is not a unit.
+bool Parser::parse_unit_product(Unit& unit) {
+    if (check(TokenType::INTEGER) && current_token().value == "1" && peek_token().type == TokenType::DIVIDE) {
+        unit = Unit();
+        advance();
+    } else if (!parse_unit_power(unit)) {
+        return false;
+    }
+    while (check(TokenType::MULTIPLY) || check(TokenType::DIVIDE)) {
+        bool divide = check(TokenType::DIVIDE);
+        advance();
+        Unit next;
+        if (!parse_unit_power(next)) {
+            return false;
+        }
+        unit.factor = divide ? unit.factor / next.factor : unit.factor * next.factor;
+        unit.dimension = divide ? unit.dimension / next.dimension : unit.dimension * next.dimension;
+    }
+    return true;
+}
+
+// A unit name or a parenthesized product, with an optional integer power
+bool Parser::parse_unit_power(Unit& unit) {
+    if (match(TokenType::LPAREN)) {
+        if (!parse_unit_product(unit)) {
+            return false;
+        }
+        if (!match(TokenType::RPAREN)) {
+            error_at_current("Expected ')' in unit");
+            return false;
+        }
+    } else if (check(TokenType::IDENTIFIER)) {
+        if (!find_unit(current_token().value, unit)) {
+            error_at_current("Unknown unit '" + std::string(current_token().value) + "'");
+            return false;
+        }
+        advance();
+    } else {
+        error_at_current("Expected a unit name");
+        return false;
+    }
+    
+    if (match(TokenType::POWER)) {
+        bool negative = match(TokenType::MINUS);
+        if (!check(TokenType::INTEGER) || current_token().value.size() > 1) {
+            error_at_current("Expected a single-digit exponent in unit");
+            return false;
+        }
+        int exponent = static_cast<int>(std::stoll(current_token().value));
+        advance();
+        if (negative) exponent = -exponent;
+        unit.factor = std::pow(unit.factor, exponent);
+        unit.dimension = unit.dimension.power(exponent);
+    }
+    return true;
+}
+
+void Parser::check_units() {
+    UnitChecker checker(*this);
+    if (checker.run()) {
+        return;
+    }
+    const Token& token = ctx.tokens[std::min<size_t>(ctx.nodes[checker.error_node()].token_index, ctx.token_count - 1)];
+    ctx.has_error = true;
+    ctx.error_message = "Line " + std::to_string(token.line) + ", Column " + std::to_string(token.column) +
+                        ": " + checker.error();
+    ctx.error_token_index = ctx.nodes[checker.error_node()].token_index;
+}
+
+void Parser::parse_dict_literal() {
+    advance(); // consume '{'
+
+    uint32_t dict_node = create_node(NodeType::DICT_LITERAL);
+    std::vector<uint32_t> elements;
+
+    if (!check(TokenType::RBRACE)) {
+        do {
+            parse_expression();
+            elements.push_back(pop_node());
+
+            if (!match(TokenType::COLON)) {
+                error_at_current("Expected ':' after dictionary key");
+                return;
+            }
+
+            parse_expression();
+            elements.push_back(pop_node());
+        } while (match(TokenType::COMMA));
+    }
+
+    if (!match(TokenType::RBRACE)) {
+        error_at_current("Expected '}' after dictionary literal");
+        return;
+    }
+
+    ctx.nodes[dict_node].dict_literal.entry_count = static_cast<uint32_t>(elements.size() / 2);
+    ctx.nodes[dict_node].dict_literal.entries_start_index = elements.empty() ? 0 : elements[0];
+    for (size_t i = 1; i < elements.size(); i++) {
+        ctx.nodes[elements[i - 1]].next_sibling_index = elements[i];
+    }
+
+    ctx.node_stack.push_back(dict_node);
+}
 
 void Parser::parse_assignment() {
     if (!check(TokenType::IDENTIFIER)) {
@@ -636,13 +945,12 @@ void Parser::parse_assignment() {
     
     // Parse value expression
     parse_expression();
-    uint32_t value_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t value_node = pop_node();
     
     ctx.nodes[assign_node].assignment.target_index = target_node;
     ctx.nodes[assign_node].assignment.value_index = value_node;
     
-    add_child(ROOT_NODE_INDEX, assign_node); // Add to program
+    set_parent(assign_node, ROOT_NODE_INDEX);
 }
 
 void Parser::parse_if_statement() {
@@ -652,8 +960,7 @@ void Parser::parse_if_statement() {
     
     // Parse condition
     parse_expression();
-    uint32_t condition_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t condition_node = pop_node();
     
     if (!match(TokenType::COLON)) {
         error_at_current("Expected ':' after if condition");
@@ -661,15 +968,13 @@ void Parser::parse_if_statement() {
     
     // Parse then block
     parse_block();
-    uint32_t then_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t then_node = pop_node();
     
     uint32_t else_node = 0;
     if (match(TokenType::ELSE)) {
         if (match(TokenType::COLON)) {
             parse_block();
-            else_node = ctx.node_stack.back();
-            ctx.node_stack.pop_back();
+            else_node = pop_node();
         } else {
             error_at_current("Expected ':' after else");
         }
@@ -679,7 +984,7 @@ void Parser::parse_if_statement() {
     ctx.nodes[if_node].if_statement.then_block_index = then_node;
     ctx.nodes[if_node].if_statement.else_block_index = else_node;
     
-    add_child(ROOT_NODE_INDEX, if_node);
+    set_parent(if_node, ROOT_NODE_INDEX);
 }
 
 void Parser::parse_while_statement() {
@@ -689,8 +994,7 @@ void Parser::parse_while_statement() {
     
     // Parse condition
     parse_expression();
-    uint32_t condition_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t condition_node = pop_node();
     
     if (!match(TokenType::COLON)) {
         error_at_current("Expected ':' after while condition");
@@ -698,13 +1002,102 @@ void Parser::parse_while_statement() {
     
     // Parse body
     parse_block();
-    uint32_t body_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t body_node = pop_node();
     
     ctx.nodes[while_node].while_statement.condition_index = condition_node;
     ctx.nodes[while_node].while_statement.body_index = body_node;
     
-    add_child(ROOT_NODE_INDEX, while_node);
+    set_parent(while_node, ROOT_NODE_INDEX);
+}
+
+// import name, name, ...
+void Parser::parse_import_statement() {
+    advance(); // consume 'import'
+    
+    uint32_t import_node = create_node(NodeType::IMPORT_STATEMENT);
+    do {
+        if (!check(TokenType::IDENTIFIER)) {
+            error_at_current("Expected module name after 'import'");
+            return;
+        }
+        uint32_t name_node = create_node(NodeType::IDENTIFIER);
+        ctx.nodes[name_node].identifier.name_index = ctx.strings.add_string(current_token().value);
+        advance();
+        add_child(import_node, name_node);
+        ++ctx.nodes[import_node].import_statement.name_count;
+    } while (match(TokenType::COMMA));
+    
+    set_parent(import_node, ROOT_NODE_INDEX);
+}
+
+// extern "libfoo.so" function name(a: matrix, n: int) -> matrix
+void Parser::parse_extern_declaration() {
+    advance(); // consume 'extern'
+    
+    if (!check(TokenType::STRING)) {
+        error_at_current("Expected library path after 'extern'");
+        return;
+    }
+    uint32_t extern_node = create_node(NodeType::EXTERN_DECL);
+    ctx.nodes[extern_node].extern_decl.library_index = ctx.strings.add_string(current_token().value);
+    advance();
+    
+    if (!match(TokenType::FUNCTION)) {
+        error_at_current("Expected 'function' after extern library");
+        return;
+    }
+    if (!check(TokenType::IDENTIFIER)) {
+        error_at_current("Expected function name");
+        return;
+    }
+    ctx.nodes[extern_node].extern_decl.name_index = ctx.strings.add_string(current_token().value);
+    advance();
+    
+    auto type_code = [](std::string_view type) -> char {
+        if (type == "int") return 'i';
+        if (type == "float") return 'f';
+        if (type == "matrix") return 'm';
+        return '\0';
+    };
+    
+    std::string signature;
+    if (!match(TokenType::LPAREN)) {
+        error_at_current("Expected '(' after function name");
+        return;
+    }
+    if (!check(TokenType::RPAREN)) {
+        do {
+            if (!match(TokenType::IDENTIFIER) || !match(TokenType::COLON)) {
+                error_at_current("Expected 'name: type' parameter");
+                return;
+            }
+            char code = check(TokenType::IDENTIFIER) ? type_code(current_token().value) : '\0';
+            if (!code) {
+                error_at_current("Expected parameter type int, float or matrix");
+                return;
+            }
+            signature += code;
+            advance();
+        } while (match(TokenType::COMMA));
+    }
+    if (!match(TokenType::RPAREN)) {
+        error_at_current("Expected ')' after parameters");
+        return;
+    }
+    
+    char result = 'v';
+    if (match(TokenType::ARROW)) {
+        result = check(TokenType::IDENTIFIER) ? type_code(current_token().value) : '\0';
+        if (!result) {
+            error_at_current("Expected return type int, float or matrix");
+            return;
+        }
+        advance();
+    }
+    ctx.nodes[extern_node].extern_decl.param_count = static_cast<uint32_t>(signature.size());
+    ctx.nodes[extern_node].extern_decl.signature_index = ctx.strings.add_string(signature + result);
+    
+    set_parent(extern_node, ROOT_NODE_INDEX);
 }
 
 void Parser::parse_for_statement() {
@@ -732,8 +1125,7 @@ void Parser::parse_for_statement() {
     
     // Parse iterable expression
     parse_expression();
-    uint32_t iterable_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t iterable_node = pop_node();
     
     if (!match(TokenType::COLON)) {
         error_at_current("Expected ':' after for loop iterable");
@@ -742,14 +1134,13 @@ void Parser::parse_for_statement() {
     
     // Parse body
     parse_block();
-    uint32_t body_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t body_node = pop_node();
     
     ctx.nodes[for_node].for_statement.variable_index = var_node;
     ctx.nodes[for_node].for_statement.iterable_index = iterable_node;
     ctx.nodes[for_node].for_statement.body_index = body_node;
     
-    add_child(ROOT_NODE_INDEX, for_node);
+    set_parent(for_node, ROOT_NODE_INDEX);
 }
 
 void Parser::parse_function_definition() {
@@ -796,8 +1187,7 @@ void Parser::parse_function_definition() {
     
     // Parse body
     parse_block();
-    uint32_t body_node = ctx.node_stack.back();
-    ctx.node_stack.pop_back();
+    uint32_t body_node = pop_node();
     
     ctx.nodes[func_node].function_def.param_count = static_cast<uint32_t>(params.size());
     ctx.nodes[func_node].function_def.body_index = body_node;
@@ -810,7 +1200,7 @@ void Parser::parse_function_definition() {
         }
     }
     
-    add_child(ROOT_NODE_INDEX, func_node);
+    set_parent(func_node, ROOT_NODE_INDEX);
 }
 
 void Parser::parse_block() {
@@ -908,6 +1298,7 @@ BinaryOpType Parser::token_to_binary_op(TokenType token_type) const {
         case TokenType::GREATER_EQUAL: return BinaryOpType::GE;
         case TokenType::AND: return BinaryOpType::AND;
         case TokenType::OR: return BinaryOpType::OR;
+        case TokenType::IN: return BinaryOpType::IN;
         default: return BinaryOpType::ADD; // Default
     }
 }
@@ -945,7 +1336,7 @@ bool Parser::is_right_associative(TokenType token_type) const {
 }
 
 size_t Parser::get_memory_usage() const {
-    return ctx.nodes.size() * sizeof(ASTNode) + ctx.strings.memory_usage();
+    return ctx.nodes.size() * sizeof(ASTNode) + ctx.strings.memory_usage() + ctx.constants.memory_usage();
 }
 
 void Parser::create_program_block() {
@@ -1023,6 +1414,9 @@ void Parser::print_ast(uint32_t node_index, int indent) const {
         case NodeType::MATRIX_LITERAL:
             std::cout << "MATRIX: " << node.matrix_literal.rows << "x" << node.matrix_literal.cols << "\n";
             break;
+        case NodeType::DICT_LITERAL:
+            std::cout << "DICT: " << node.dict_literal.entry_count << " entries\n";
+            break;
         case NodeType::ARRAY_ACCESS:
             std::cout << "ARRAY_ACCESS\n";
             print_ast(node.array_access.object_index, indent + 1);
@@ -1032,6 +1426,17 @@ void Parser::print_ast(uint32_t node_index, int indent) const {
             std::cout << "MEMBER_ACCESS: " << ctx.strings.get_string(node.member_access.member_name_index) << "\n";
             print_ast(node.member_access.object_index, indent + 1);
             break;
+        case NodeType::METHOD_CALL:
+            std::cout << "METHOD_CALL: " << ctx.strings.get_string(node.method_call.name_index) << "\n";
+            print_ast(node.method_call.object_index, indent + 1);
+            break;
+        case NodeType::IMPORT_STATEMENT:
+            std::cout << "IMPORT: " << node.import_statement.name_count << " modules\n";
+            break;
+        case NodeType::EXTERN_DECL:
+            std::cout << "EXTERN: " << ctx.strings.get_string(node.extern_decl.name_index) << " from "
+                      << ctx.strings.get_string(node.extern_decl.library_index) << "\n";
+            break;
         default:
             std::cout << "NODE_TYPE: " << static_cast<int>(node.type) << "\n";
             break;
@@ -1058,6 +1463,90 @@ std::vector<uint32_t> Parser::get_children(uint32_t node_index) const {
     return children;
 }
 
+std::vector<uint32_t> Parser::get_child_nodes(uint32_t node_index) const {
+    auto valid = [this](uint32_t index) { return index != 0 && index < ctx.nodes.size(); };
+    auto chain = [this, &valid](uint32_t start_index) {
+        std::vector<uint32_t> indices;
+        for (uint32_t current = start_index; valid(current) && indices.size() < ctx.nodes.size();
+             current = ctx.nodes[current].next_sibling_index) {
+            indices.push_back(current);
+        }
+        return indices;
+    };
+    
+    std::vector<uint32_t> result;
+    if (node_index >= ctx.nodes.size()) {
+        return result;
+    }
+    const ASTNode& node = ctx.nodes[node_index];
+
+    switch (node.type) {
+        case NodeType::BINARY_OP:
+            result = {node.binary_op.left_index, node.binary_op.right_index};
+            break;
+        case NodeType::UNARY_OP:
+            result = {node.unary_op.operand_index};
+            break;
+        case NodeType::ASSIGNMENT:
+            result = {node.assignment.target_index, node.assignment.value_index};
+            break;
+        case NodeType::MATRIX_LITERAL:
+            result = chain(node.matrix_literal.elements_start_index);
+            break;
+        case NodeType::DICT_LITERAL:
+            result = chain(node.dict_literal.entries_start_index);
+            break;
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS:
+            result = {node.array_access.object_index, node.array_access.index_index};
+            break;
+        case NodeType::MEMBER_ACCESS:
+            result = {node.member_access.object_index};
+            break;
+        case NodeType::IF_STATEMENT:
+            result = {node.if_statement.condition_index, node.if_statement.then_block_index,
+                      node.if_statement.else_block_index};
+            break;
+        case NodeType::WHILE_STATEMENT:
+            result = {node.while_statement.condition_index, node.while_statement.body_index};
+            break;
+        case NodeType::FOR_STATEMENT:
+            result = {node.for_statement.variable_index, node.for_statement.iterable_index,
+                      node.for_statement.body_index};
+            break;
+        case NodeType::FUNCTION_DEF:
+            result = chain(node.function_def.params_start_index);
+            result.push_back(node.function_def.body_index);
+            break;
+        case NodeType::FUNCTION_CALL:
+            result = chain(node.function_call.args_start_index);
+            break;
+        case NodeType::METHOD_CALL:
+            result = chain(node.method_call.args_start_index);
+            result.insert(result.begin(), node.method_call.object_index);
+            break;
+        case NodeType::IMPORT_STATEMENT:
+            result = chain(node.first_child_index);
+            break;
+        case NodeType::RETURN_STATEMENT:
+            result = {node.return_statement.value_index};
+            break;
+        case NodeType::EXPRESSION_STATEMENT:
+            result = {node.first_child_index};
+            break;
+        case NodeType::BLOCK:
+        case NodeType::PROGRAM:
+            result = chain(node.first_child_index);
+            break;
+        default:
+            break;
+    }
+
+    result.erase(std::remove_if(result.begin(), result.end(), [&valid](uint32_t index) { return !valid(index); }),
+                 result.end());
+    return result;
+}
+
 bool Parser::is_matrix_operation(uint32_t node_index) const {
     if (node_index >= ctx.nodes.size()) return false;
     return AST::is_matrix_op(ctx.nodes[node_index]);
@@ -1106,6 +1595,7 @@ bool Parser::is_binary_operator(TokenType token_type) const {
         case TokenType::GREATER_EQUAL:
         case TokenType::AND:
         case TokenType::OR:
+        case TokenType::IN:
             return true;
         default:
             return false;
@@ -2,10 +2,12 @@
 #define PARSER_H
 
 #include "lexer.h"
+#include "units.h"
 #include <vector>
 #include <string_view>
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
 
 namespace Dakota {
 
@@ -39,6 +41,7 @@ enum class NodeType : uint8_t {
     FLOAT_LITERAL,
     STRING_LITERAL,
     BOOLEAN_LITERAL,
+    DICT_LITERAL,
     
     // Identifiers
     IDENTIFIER,
@@ -70,11 +73,16 @@ enum class NodeType : uint8_t {
     FUNCTION_DEF,
     FUNCTION_CALL,
     RETURN_STATEMENT,
+    EXTERN_DECL,
     
     // Blocks
     BLOCK,
     EXPRESSION_STATEMENT,
     
+    // Modules
+    IMPORT_STATEMENT,
+    METHOD_CALL,
+    
     // Program root
     PROGRAM
 };
@@ -83,7 +91,8 @@ enum class NodeType : uint8_t {
 enum class BinaryOpType : uint8_t {
     ADD, SUB, MUL, DIV, POW, MATMUL,
     EQ, NE, LT, LE, GT, GE,
-    AND, OR
+    AND, OR,
+    IN
 };
 
 // Operator types for unary operations
@@ -145,8 +154,14 @@ struct ASTNode {
             uint32_t elements_start_index; // Index of first element
             MatrixError validation_error;  // Track validation state
             bool is_empty;                 // Handle empty matrix case
+            bool is_constant;              // All-numeric literal, values in the constant pool
         } matrix_literal;
         
+        struct {
+            uint32_t entries_start_index; // Key and value nodes alternate as siblings
+            uint32_t entry_count;
+        } dict_literal;
+        
         struct {
             uint32_t object_index;  // Index of matrix being accessed
             uint32_t index_index;   // Index of access index
@@ -192,6 +207,25 @@ struct ASTNode {
             uint32_t arg_count;
         } function_call;
         
+        struct {
+            uint32_t object_index;      // Value the function is a member of, e.g. a module
+            uint32_t name_index;        // Member name
+            uint32_t args_start_index;  // First argument
+            uint32_t arg_count;
+        } method_call;
+        
+        struct {
+            uint32_t name_count;        // Module names are the IDENTIFIER children
+        } import_statement;
+        
+        struct {
+            uint32_t library_index;     // Shared library path, as written
+            uint32_t name_index;        // Symbol and function name
+            uint32_t signature_index;   // One code per parameter then the result:
+                                        // 'i' int, 'f' float, 'm' matrix, 'v' none
+            uint32_t param_count;
+        } extern_decl;
+        
         struct {
             uint32_t value_index;       // 0 if void return
         } return_statement;
@@ -248,6 +282,32 @@ public:
     size_t get_data_size() const { return data.size(); }
 };
 
+// Constant pool for matrix literals whose elements are all numeric literals.
+// Such literals are parsed without element nodes: their values are packed
+// row-major here, keyed by the literal's node index.
+class ConstantPool {
+private:
+    std::vector<double> data;
+    std::unordered_map<uint32_t, size_t> offsets;
+    
+public:
+    // Take ownership of a literal's values
+    void add_matrix(uint32_t node_index, const std::vector<double>& values);
+    
+    // Values of a constant literal, or nullptr if the node has none
+    const double* get_matrix(uint32_t node_index) const;
+    
+    // Let a copied node share the values of the node it was copied from
+    void alias(uint32_t node_index, uint32_t source_index);
+    
+    // Multiply a literal's count values by factor, e.g. to convert them to SI units
+    void scale(uint32_t node_index, size_t count, double factor);
+    
+    size_t memory_usage() const { return data.size() * sizeof(double) + offsets.size() * sizeof(size_t) * 2; }
+    void optimize_memory() { data.shrink_to_fit(); }
+    size_t get_matrix_count() const { return offsets.size(); }
+};
+
 // Parser state for iterative parsing
 enum class ParseState : uint8_t {
     PROGRAM,
@@ -284,6 +344,8 @@ struct ParseContext {
     // Pre-allocated AST storage
     std::vector<ASTNode> nodes;
     StringTable strings;
+    ConstantPool constants;
+    std::unordered_map<uint32_t, Dimension> units;  // Dimension of each unit-annotated literal
     
     // Parse state stack for iterative parsing
     std::vector<ParseState> state_stack;
@@ -359,6 +421,7 @@ private:
     bool check(TokenType type) const;
     
     // Node management
+    uint32_t pop_node();
     uint32_t create_node(NodeType type);
     void add_child(uint32_t parent_index, uint32_t child_index);
     void set_parent(uint32_t child_index, uint32_t parent_index);
@@ -388,7 +451,15 @@ private:
     void parse_primary();
     void parse_postfix_expressions();
     void parse_matrix_literal();
-    void parse_function_call();
+    bool parse_constant_matrix(uint32_t matrix_node);
+    void parse_dict_literal();
+    void parse_unit_annotation(uint32_t literal_node);
+    bool parse_unit_product(Unit& unit);
+    bool parse_unit_power(Unit& unit);
+    void check_units();
+    uint32_t parse_call_arguments(uint32_t& arg_count);
+    void parse_import_statement();
+    void parse_extern_declaration();
     void parse_block();
     void parse_if_statement();
     void parse_while_statement();
@@ -416,6 +487,10 @@ public:
     // Access parsed AST
     const std::vector<ASTNode>& get_nodes() const { return ctx.nodes; }
     const StringTable& get_strings() const { return ctx.strings; }
+    const ConstantPool& get_constants() const { return ctx.constants; }
+    const std::unordered_map<uint32_t, Dimension>& get_units() const { return ctx.units; }
+    std::vector<ASTNode>& get_mutable_nodes() { return ctx.nodes; }  // For the optimizer's rewrites
+    ConstantPool& get_mutable_constants() { return ctx.constants; }
     
     // Error information with detailed position tracking
     bool has_error() const { return ctx.has_error; }
@@ -434,6 +509,8 @@ public:
     // AST traversal utilities
     void print_ast(uint32_t node_index = 1, int indent = 0) const;
     std::vector<uint32_t> get_children(uint32_t node_index) const;
+    // Every node this one refers to: operands, conditions, bodies, arguments
+    std::vector<uint32_t> get_child_nodes(uint32_t node_index) const;
     uint32_t get_parent(uint32_t node_index) const;
     
     // Engineering-specific query methods
@@ -477,12 +554,14 @@ namespace AST {
                node.matrix_literal.is_empty;
     }
     
-    // Matrix dimension validation
+    // Matrix dimension validation - constant literals are packed, so only
+    // literals built from element nodes are capped
     inline bool has_valid_dimensions(const ASTNode& node) {
         return node.type == NodeType::MATRIX_LITERAL &&
                node.matrix_literal.rows > 0 && node.matrix_literal.cols > 0 &&
-               node.matrix_literal.rows <= MAX_MATRIX_DIMENSIONS &&
-               node.matrix_literal.cols <= MAX_MATRIX_DIMENSIONS;
+               (node.matrix_literal.is_constant ||
+                (node.matrix_literal.rows <= MAX_MATRIX_DIMENSIONS &&
+                 node.matrix_literal.cols <= MAX_MATRIX_DIMENSIONS));
     }
     
     // State stack safety check
@@ -0,0 +1,254 @@
+#include "plugins.h"
+#include "dakota_plugin.h"
+#include "ffi.h"
+#include <dlfcn.h>
+#include <dirent.h>
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+
+// Per-call state behind the ABI's opaque dakota_call
+struct dakota_call {
+    Dakota::MatrixRow result;
+    int64_t rows = 0;
+    int64_t cols = 0;
+    std::string error;
+};
+
+namespace Dakota {
+
+namespace {
+
+constexpr size_t INLINE_ARGS = 8;   // Argument counts up to this convert without allocating
+
+// Exceptions must not unwind through the plugin's C frames, so every
+// failure is a NULL return
+double* host_new_matrix(dakota_call* call, int64_t rows, int64_t cols) {
+    if (rows < 0 || cols < 0) {
+        return nullptr;
+    }
+    const uint64_t limit = std::numeric_limits<size_t>::max() / sizeof(double);
+    if (cols != 0 && static_cast<uint64_t>(rows) > limit / static_cast<uint64_t>(cols)) {
+        return nullptr;
+    }
+    try {
+        call->result.assign(static_cast<size_t>(rows) * static_cast<size_t>(cols), 0.0);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    } catch (const std::length_error&) {
+        return nullptr;
+    }
+    call->rows = rows;
+    call->cols = cols;
+    return call->result.data();
+}
+
+void host_set_error(dakota_call* call, const char* message) {
+    call->error = message ? message : "";
+}
+
+const dakota_host_api HOST_API = {DAKOTA_PLUGIN_ABI_VERSION, host_new_matrix, host_set_error};
+
+const char* type_name(int32_t type) {
+    switch (type) {
+        case DAKOTA_TYPE_INT: return "an int";
+        case DAKOTA_TYPE_FLOAT: return "a number";
+        case DAKOTA_TYPE_MATRIX: return "a matrix";
+        default: return "a number or matrix";
+    }
+}
+
+std::string arity_text(const dakota_function& entry) {
+    if (entry.min_arity == entry.max_arity) return std::to_string(entry.min_arity);
+    if (entry.max_arity < 0) return "at least " + std::to_string(entry.min_arity);
+    return std::to_string(entry.min_arity) + " to " + std::to_string(entry.max_arity);
+}
+
+// Checks and converts arguments, calls the plugin and converts its result
+NativeFunction wrap(const dakota_function& entry) {
+    std::string name = entry.name;
+    return [entry, name](const std::vector<Value>& args) -> Value {
+        int32_t argc = static_cast<int32_t>(args.size());
+        if (argc < entry.min_arity || (entry.max_arity >= 0 && argc > entry.max_arity)) {
+            throw RuntimeError("Function '" + name + "' expects " + arity_text(entry) + " arguments, got " +
+                               std::to_string(argc));
+        }
+
+        dakota_value inline_values[INLINE_ARGS];
+        std::vector<dakota_value> heap_values;
+        dakota_value* values = inline_values;
+        if (args.size() > INLINE_ARGS) {
+            heap_values.resize(args.size());
+            values = heap_values.data();
+        }
+        std::vector<MatrixRow> scratch;   // Gathered multi-row arguments
+        MatrixRow unused;
+
+        for (size_t k = 0; k < args.size(); ++k) {
+            const Value& arg = args[k];
+            int32_t expected = entry.parameter_types ? entry.parameter_types[k] : DAKOTA_TYPE_ANY;
+            dakota_value& value = values[k];
+            value = dakota_value{};
+            if (expected == DAKOTA_TYPE_ANY) {
+                expected = arg.is_integer() ? DAKOTA_TYPE_INT : arg.is_float() ? DAKOTA_TYPE_FLOAT : DAKOTA_TYPE_MATRIX;
+            }
+            bool accepted = expected == DAKOTA_TYPE_INT ? arg.is_integer()
+                          : expected == DAKOTA_TYPE_FLOAT ? arg.is_numeric()
+                          : arg.is_matrix();
+            if (!accepted) {
+                throw RuntimeError("Function '" + name + "' expects " + type_name(expected) + " for argument " +
+                                   std::to_string(k + 1));
+            }
+            value.type = expected;
+            if (expected == DAKOTA_TYPE_INT) {
+                value.integer = arg.as_integer();
+            } else if (expected == DAKOTA_TYPE_FLOAT) {
+                value.real = arg.to_double();
+            } else {
+                const Matrix& matrix = arg.as_matrix();
+                if (matrix.size() > 1 && scratch.empty()) {
+                    scratch.resize(args.size());
+                }
+                value.data = FFI::contiguous(matrix, matrix.size() > 1 ? scratch[k] : unused, name);
+                value.rows = static_cast<int64_t>(matrix.size());
+                value.cols = matrix.empty() ? 0 : static_cast<int64_t>(matrix[0].size());
+            }
+        }
+
+        dakota_call call;
+        dakota_value result{};
+        result.type = DAKOTA_TYPE_NONE;
+        if (entry.function(&call, values, argc, &result) != 0) {
+            throw RuntimeError("Function '" + name + "' failed" + (call.error.empty() ? "" : ": " + call.error));
+        }
+        if (entry.result_type != DAKOTA_TYPE_ANY && result.type != entry.result_type) {
+            throw RuntimeError("Function '" + name + "' returned the wrong type");
+        }
+
+        switch (result.type) {
+            case DAKOTA_TYPE_INT:
+                return Value(static_cast<int64_t>(result.integer));
+            case DAKOTA_TYPE_FLOAT:
+                return Value(result.real);
+            case DAKOTA_TYPE_MATRIX: {
+                if (result.rows < 0 || result.cols < 0 || (!result.data && result.rows * result.cols != 0)) {
+                    throw RuntimeError("Function '" + name + "' returned a malformed matrix");
+                }
+                Matrix matrix;
+                if (result.rows == 1 && result.data == call.result.data() && call.rows * call.cols >= result.cols) {
+                    // The host's own buffer becomes the row
+                    call.result.resize(static_cast<size_t>(result.cols));
+                    matrix.push_back(std::move(call.result));
+                } else {
+                    matrix.reserve(static_cast<size_t>(result.rows));
+                    for (int64_t i = 0; i < result.rows; ++i) {
+                        const double* row = result.data + i * result.cols;
+                        matrix.emplace_back(row, row + result.cols);
+                    }
+                }
+                return Value(std::move(matrix));
+            }
+            case DAKOTA_TYPE_NONE:
+                return Value();
+            default:
+                throw RuntimeError("Function '" + name + "' returned an unknown type");
+        }
+    };
+}
+
+} // anonymous namespace
+
+PluginRegistry& PluginRegistry::instance() {
+    static PluginRegistry registry;
+    return registry;
+}
+
+void PluginRegistry::load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::find(paths_.begin(), paths_.end(), path) != paths_.end()) {
+        return;
+    }
+
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* reason = dlerror();
+        throw RuntimeError("Cannot load plugin '" + path + "': " + (reason ? reason : "unknown error"));
+    }
+    auto fail = [&](const std::string& message) {
+        dlclose(handle);
+        throw RuntimeError("Plugin '" + path + "' " + message);
+    };
+
+    auto init = reinterpret_cast<dakota_plugin_init_function>(dlsym(handle, DAKOTA_PLUGIN_ENTRY));
+    if (!init) {
+        fail(std::string("does not export ") + DAKOTA_PLUGIN_ENTRY);
+    }
+    const dakota_plugin* plugin = init(&HOST_API);
+    if (!plugin) {
+        fail("failed to initialize");
+    }
+    if (plugin->abi_version != DAKOTA_PLUGIN_ABI_VERSION) {
+        fail("was built for plugin ABI version " + std::to_string(plugin->abi_version) + ", not " +
+             std::to_string(DAKOTA_PLUGIN_ABI_VERSION));
+    }
+
+    std::unordered_map<std::string, size_t> known;
+    for (size_t k = 0; k < functions_.size(); ++k) {
+        known[functions_[k].first] = k;
+    }
+    std::vector<std::pair<std::string, NativeFunction>> added;
+    for (size_t k = 0; k < plugin->function_count; ++k) {
+        const dakota_function& entry = plugin->functions[k];
+        if (!entry.name || !entry.function || entry.min_arity < 0 ||
+            (entry.max_arity >= 0 && entry.max_arity < entry.min_arity) ||
+            (entry.parameter_types && entry.max_arity < 0)) {
+            fail("has a malformed entry " + std::to_string(k) + " in its function table");
+        }
+        if (known.count(entry.name)) {
+            fail("defines '" + std::string(entry.name) + "', which another plugin already defines");
+        }
+        known[entry.name] = functions_.size() + added.size();
+        added.emplace_back(entry.name, wrap(entry));
+    }
+
+    paths_.push_back(path);
+    names_.push_back(plugin->name ? plugin->name : path);
+    functions_.insert(functions_.end(), added.begin(), added.end());
+}
+
+size_t PluginRegistry::load_directory(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        throw RuntimeError("Cannot open plugin directory '" + directory + "'");
+    }
+    std::vector<std::string> libraries;
+    std::string extension = PLUGIN_EXTENSION;
+    while (dirent* entry = readdir(dir)) {
+        std::string file = entry->d_name;
+        if (file.size() > extension.size() &&
+            file.compare(file.size() - extension.size(), extension.size(), extension) == 0) {
+            libraries.push_back(directory + "/" + file);
+        }
+    }
+    closedir(dir);
+
+    std::sort(libraries.begin(), libraries.end());
+    for (const auto& library : libraries) {
+        load(library);
+    }
+    return libraries.size();
+}
+
+std::vector<std::string> PluginRegistry::plugins() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_;
+}
+
+std::vector<std::pair<std::string, NativeFunction>> PluginRegistry::functions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return functions_;
+}
+
+} // namespace Dakota
@@ -0,0 +1,49 @@
+#ifndef PLUGINS_H
+#define PLUGINS_H
+
+#include "interpreter.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <mutex>
+
+namespace Dakota {
+
+// Constants for plugin loading
+constexpr const char* PLUGIN_DIR_VARIABLE = "DAKOTA_PLUGIN_DIR";   // Loaded at startup when set
+constexpr const char* PLUGIN_EXTENSION = ".so";
+
+// Process-wide set of loaded plugins (see dakota_plugin.h for the ABI).
+// Plugins are meant to be loaded at startup; every Interpreter constructed
+// afterwards has their functions as builtins. Thread-safe.
+class PluginRegistry {
+public:
+    static PluginRegistry& instance();
+
+    // Load a plugin library; loading the same path again does nothing.
+    // Throws RuntimeError if it cannot be opened, has no entry point, was
+    // built for another ABI version, has a malformed function table or
+    // defines a function another plugin already has.
+    void load(const std::string& path);
+
+    // Load every library in directory, in name order. Returns how many.
+    size_t load_directory(const std::string& directory);
+
+    // Names of the loaded plugins, in load order
+    std::vector<std::string> plugins() const;
+
+    // Every plugin function, ready to enter as a builtin
+    std::vector<std::pair<std::string, NativeFunction>> functions() const;
+
+private:
+    PluginRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> paths_;
+    std::vector<std::string> names_;
+    std::vector<std::pair<std::string, NativeFunction>> functions_;
+};
+
+} // namespace Dakota
+
+#endif // PLUGINS_H
@@ -0,0 +1,212 @@
+#include "pool.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace Dakota {
+namespace Pool {
+
+namespace {
+
+// Free buffers are chained through their first word
+struct FreeBuffer {
+    FreeBuffer* next;
+};
+
+struct FreeList {
+    FreeBuffer* head = nullptr;
+    size_t count = 0;
+
+    void push(void* buffer) {
+        auto* node = static_cast<FreeBuffer*>(buffer);
+        node->next = head;
+        head = node;
+        ++count;
+    }
+
+    void* pop() {
+        FreeBuffer* node = head;
+        head = node->next;
+        --count;
+        return node;
+    }
+};
+
+size_t class_bytes(size_t size_class) {
+    return size_t(1) << (size_class + MIN_CLASS_SHIFT);
+}
+
+// Smallest class holding `bytes`, or SIZE_CLASSES if it is too large to pool
+size_t size_class_of(size_t bytes) {
+    size_t size_class = 0;
+    while (size_class < SIZE_CLASSES && class_bytes(size_class) < bytes) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+struct GlobalPool {
+    std::mutex mutex;
+    FreeList lists[SIZE_CLASSES];
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> releases{0};
+    std::atomic<size_t> retained{0};
+    std::atomic<size_t> cap{DEFAULT_RETAINED_CAP};
+};
+
+// Never destroyed, so thread caches can flush into it during shutdown
+GlobalPool& global_pool() {
+    static GlobalPool* pool = new GlobalPool;
+    return *pool;
+}
+
+// Reserves room for one more cached buffer, or reports that the cap is reached
+bool try_retain(GlobalPool& pool, size_t bytes) {
+    size_t retained = pool.retained.load(std::memory_order_relaxed);
+    do {
+        if (retained + bytes > pool.cap.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    } while (!pool.retained.compare_exchange_weak(retained, retained + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+// Set once a thread's cache has been destroyed, so frees from later
+// destructors (thread or static teardown) go straight to the global pool
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache {
+    FreeList lists[SIZE_CLASSES];
+
+    // Cached buffers move to the global pool when the thread exits
+    ~ThreadCache() {
+        GlobalPool& pool = global_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        for (size_t c = 0; c < SIZE_CLASSES; ++c) {
+            while (lists[c].count > 0) {
+                pool.lists[c].push(lists[c].pop());
+            }
+        }
+        thread_cache_destroyed = true;
+    }
+};
+
+ThreadCache* thread_cache() {
+    if (thread_cache_destroyed) return nullptr;
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+// Drops buffers from `lists` (largest first) until retained <= keep_bytes
+size_t trim_lists(GlobalPool& pool, FreeList* lists, size_t keep_bytes) {
+    size_t released = 0;
+    for (size_t c = SIZE_CLASSES; c-- > 0;) {
+        while (lists[c].count > 0 && pool.retained.load(std::memory_order_relaxed) > keep_bytes) {
+            ::operator delete(lists[c].pop());
+            pool.retained.fetch_sub(class_bytes(c), std::memory_order_relaxed);
+            released += class_bytes(c);
+        }
+    }
+    return released;
+}
+
+} // anonymous namespace
+
+void* allocate(size_t bytes) {
+    GlobalPool& pool = global_pool();
+    size_t size_class = size_class_of(bytes);
+    if (size_class == SIZE_CLASSES) {
+        pool.misses.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(bytes);
+    }
+
+    void* buffer = nullptr;
+    if (ThreadCache* cache = thread_cache()) {
+        FreeList& local = cache->lists[size_class];
+        if (local.count == 0) {
+            // Refill half a cache's worth at once so the lock is taken rarely
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            FreeList& shared = pool.lists[size_class];
+            while (shared.count > 0 && local.count < THREAD_CACHE_BUFFERS / 2) {
+                local.push(shared.pop());
+            }
+        }
+        if (local.count > 0) {
+            buffer = local.pop();
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.lists[size_class].count > 0) {
+            buffer = pool.lists[size_class].pop();
+        }
+    }
+
+    if (buffer) {
+        pool.hits.fetch_add(1, std::memory_order_relaxed);
+        pool.retained.fetch_sub(class_bytes(size_class), std::memory_order_relaxed);
+        return buffer;
+    }
+    pool.misses.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(class_bytes(size_class));
+}
+
+void deallocate(void* buffer, size_t bytes) {
+    if (!buffer) return;
+    GlobalPool& pool = global_pool();
+    size_t size_class = size_class_of(bytes);
+    if (size_class == SIZE_CLASSES) {
+        ::operator delete(buffer);
+        return;
+    }
+    if (!try_retain(pool, class_bytes(size_class))) {
+        pool.releases.fetch_add(1, std::memory_order_relaxed);
+        ::operator delete(buffer);
+        return;
+    }
+
+    ThreadCache* cache = thread_cache();
+    if (!cache) {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.lists[size_class].push(buffer);
+        return;
+    }
+    FreeList& local = cache->lists[size_class];
+    if (local.count == THREAD_CACHE_BUFFERS) {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        FreeList& shared = pool.lists[size_class];
+        while (local.count > THREAD_CACHE_BUFFERS / 2) {
+            shared.push(local.pop());
+        }
+    }
+    local.push(buffer);
+}
+
+Stats stats() {
+    GlobalPool& pool = global_pool();
+    Stats result;
+    result.hits = pool.hits.load(std::memory_order_relaxed);
+    result.misses = pool.misses.load(std::memory_order_relaxed);
+    result.releases = pool.releases.load(std::memory_order_relaxed);
+    result.retained_bytes = pool.retained.load(std::memory_order_relaxed);
+    result.cap_bytes = pool.cap.load(std::memory_order_relaxed);
+    return result;
+}
+
+void set_retained_cap(size_t bytes) {
+    global_pool().cap.store(bytes, std::memory_order_relaxed);
+    trim(bytes);
+}
+
+size_t trim(size_t keep_bytes) {
+    GlobalPool& pool = global_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    size_t released = trim_lists(pool, pool.lists, keep_bytes);
+    if (ThreadCache* cache = thread_cache()) {
+        released += trim_lists(pool, cache->lists, keep_bytes);
+    }
+    return released;
+}
+
+} // namespace Pool
+} // namespace Dakota
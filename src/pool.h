@@ -0,0 +1,81 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dakota {
+namespace Pool {
+
+// Constants for the buffer pool
+constexpr size_t MIN_CLASS_SHIFT = 6;                  // Smallest size class is 64 bytes
+constexpr size_t MAX_CLASS_SHIFT = 26;                 // Larger requests bypass the pool (64 MB)
+constexpr size_t SIZE_CLASSES = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+constexpr size_t THREAD_CACHE_BUFFERS = 32;            // Per class and thread before spilling to the global pool
+constexpr size_t DEFAULT_RETAINED_CAP = size_t(256) << 20; // Free bytes kept for reuse across all threads
+
+// Buffers are rounded up to a power-of-two size class. Freed buffers go to a
+// thread-local cache first and spill to a shared global list, so a loop that
+// allocates the same shapes every iteration gets last iteration's memory back.
+void* allocate(size_t bytes);
+void deallocate(void* buffer, size_t bytes);
+
+struct Stats {
+    uint64_t hits;            // Requests served from a cache
+    uint64_t misses;          // Requests that went to the system allocator
+    uint64_t releases;        // Frees returned to the system because of the cap
+    size_t retained_bytes;    // Free memory currently held in caches
+    size_t cap_bytes;
+
+    double hit_rate() const {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+Stats stats();
+
+// Frees past the cap are released immediately; lowering the cap trims at once
+void set_retained_cap(size_t bytes);
+
+// Releases cached buffers (largest classes first) until at most keep_bytes
+// remain. Covers the global pool and the calling thread's cache; other
+// threads' caches are bounded by THREAD_CACHE_BUFFERS and drain on exit.
+// Returns the number of bytes released.
+size_t trim(size_t keep_bytes = 0);
+
+} // namespace Pool
+
+// Stateless STL allocator over the pool
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(Pool::allocate(count * sizeof(T)));
+    }
+    void deallocate(T* buffer, size_t count) noexcept {
+        Pool::deallocate(buffer, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using PooledVector = std::vector<T, PoolAllocator<T>>;
+
+// Interpreter matrix storage - both the rows and the row table come from the pool
+using MatrixRow = PooledVector<double>;
+using Matrix = std::vector<MatrixRow, PoolAllocator<MatrixRow>>;
+
+} // namespace Dakota
+
+#endif // POOL_H
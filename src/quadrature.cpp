@@ -0,0 +1,348 @@
+#include "quadrature.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace Dakota {
+namespace Quadrature {
+
+namespace {
+
+// Gauss-Kronrod 15-point rule on [-1, 1] (QUADPACK qk15), positive half
+const double KRONROD_NODES[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+const double KRONROD_WEIGHTS[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+const double GAUSS_WEIGHTS[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+// Full 15-point node and weight tables; Gauss weights are zero off the 7 Gauss nodes
+struct Rule {
+    double nodes[KRONROD_POINTS];
+    double kronrod[KRONROD_POINTS];
+    double gauss[KRONROD_POINTS];
+
+    Rule() {
+        for (size_t i = 0; i < 7; ++i) {
+            nodes[i] = -KRONROD_NODES[i];
+            nodes[14 - i] = KRONROD_NODES[i];
+            kronrod[i] = kronrod[14 - i] = KRONROD_WEIGHTS[i];
+            gauss[i] = gauss[14 - i] = (i % 2 == 1) ? GAUSS_WEIGHTS[i / 2] : 0.0;
+        }
+        nodes[7] = 0.0;
+        kronrod[7] = KRONROD_WEIGHTS[7];
+        gauss[7] = GAUSS_WEIGHTS[3];
+    }
+};
+
+const Rule& rule() {
+    static const Rule instance;
+    return instance;
+}
+
+// QUADPACK's error scaling, which is far less pessimistic than |K - G|
+// for smooth integrands while staying safe for rough ones
+double scaled_error(double difference, double mean_deviation) {
+    double error = std::abs(difference);
+    if (mean_deviation != 0.0 && error != 0.0) {
+        error = mean_deviation * std::min(1.0, std::pow(200.0 * error / mean_deviation, 1.5));
+    }
+    return error;
+}
+
+struct Panel {
+    double a;
+    double b;
+    double value;
+    double error;
+
+    bool operator<(const Panel& other) const { return error < other.error; }
+};
+
+// Evaluates every panel's nodes with a single integrand call
+void evaluate_panels(const BatchIntegrand& f, std::vector<Panel>& panels, Result& result) {
+    const Rule& r = rule();
+    std::vector<double> x;
+    x.reserve(panels.size() * KRONROD_POINTS);
+    for (const Panel& panel : panels) {
+        double center = 0.5 * (panel.a + panel.b);
+        double half = 0.5 * (panel.b - panel.a);
+        for (size_t i = 0; i < KRONROD_POINTS; ++i) {
+            x.push_back(center + half * r.nodes[i]);
+        }
+    }
+
+    std::vector<double> fx;
+    f(x, fx);
+    if (fx.size() != x.size()) {
+        throw std::invalid_argument("Integrand returned the wrong number of values");
+    }
+    result.evaluations += x.size();
+    result.batches++;
+
+    for (size_t p = 0; p < panels.size(); ++p) {
+        const double* values = fx.data() + p * KRONROD_POINTS;
+        double half = 0.5 * (panels[p].b - panels[p].a);
+
+        double kronrod = 0.0, gauss = 0.0;
+        for (size_t i = 0; i < KRONROD_POINTS; ++i) {
+            kronrod += r.kronrod[i] * values[i];
+            gauss += r.gauss[i] * values[i];
+        }
+        double mean = 0.5 * kronrod;
+        double deviation = 0.0;
+        for (size_t i = 0; i < KRONROD_POINTS; ++i) {
+            deviation += r.kronrod[i] * std::abs(values[i] - mean);
+        }
+
+        panels[p].value = kronrod * half;
+        panels[p].error = scaled_error((kronrod - gauss) * half, deviation * std::abs(half));
+        if (!std::isfinite(panels[p].value)) {
+            throw std::domain_error("Integrand is not finite on the interval");
+        }
+    }
+}
+
+struct Rectangle {
+    double ax, bx, ay, by;
+    double value;
+    double error;
+    bool split_x;   // Axis that contributes more of the error
+
+    bool operator<(const Rectangle& other) const { return error < other.error; }
+};
+
+void evaluate_rectangles(const BatchIntegrand2D& f, std::vector<Rectangle>& rectangles, Result& result) {
+    const Rule& r = rule();
+    const size_t points = KRONROD_POINTS * KRONROD_POINTS;
+    std::vector<double> x, y;
+    x.reserve(rectangles.size() * points);
+    y.reserve(rectangles.size() * points);
+    for (const Rectangle& rect : rectangles) {
+        double cx = 0.5 * (rect.ax + rect.bx), hx = 0.5 * (rect.bx - rect.ax);
+        double cy = 0.5 * (rect.ay + rect.by), hy = 0.5 * (rect.by - rect.ay);
+        for (size_t i = 0; i < KRONROD_POINTS; ++i) {
+            for (size_t j = 0; j < KRONROD_POINTS; ++j) {
+                x.push_back(cx + hx * r.nodes[i]);
+                y.push_back(cy + hy * r.nodes[j]);
+            }
+        }
+    }
+
+    std::vector<double> fxy;
+    f(x, y, fxy);
+    if (fxy.size() != x.size()) {
+        throw std::invalid_argument("Integrand returned the wrong number of values");
+    }
+    result.evaluations += x.size();
+    result.batches++;
+
+    for (size_t p = 0; p < rectangles.size(); ++p) {
+        const double* values = fxy.data() + p * points;
+        Rectangle& rect = rectangles[p];
+        double area = 0.25 * (rect.bx - rect.ax) * (rect.by - rect.ay);
+
+        // Full Kronrod product, plus Gauss in one axis with Kronrod in the other
+        double kk = 0.0, gk = 0.0, kg = 0.0;
+        for (size_t i = 0; i < KRONROD_POINTS; ++i) {
+            double kronrod_row = 0.0, gauss_row = 0.0;
+            for (size_t j = 0; j < KRONROD_POINTS; ++j) {
+                double v = values[i * KRONROD_POINTS + j];
+                kronrod_row += r.kronrod[j] * v;
+                gauss_row += r.gauss[j] * v;
+            }
+            kk += r.kronrod[i] * kronrod_row;
+            gk += r.gauss[i] * kronrod_row;
+            kg += r.kronrod[i] * gauss_row;
+        }
+
+        double error_x = std::abs(kk - gk) * area;
+        double error_y = std::abs(kk - kg) * area;
+        rect.value = kk * area;
+        rect.error = error_x + error_y;
+        rect.split_x = error_x >= error_y;
+        if (!std::isfinite(rect.value)) {
+            throw std::domain_error("Integrand is not finite on the region");
+        }
+    }
+}
+
+bool within_tolerance(double error, double value, double abs_tolerance, double rel_tolerance) {
+    return error <= std::max(abs_tolerance, rel_tolerance * std::abs(value));
+}
+
+} // anonymous namespace
+
+Result gauss_kronrod(const BatchIntegrand& f, double a, double b,
+                     double abs_tolerance, double rel_tolerance, size_t max_subdivisions) {
+    if (!std::isfinite(a) || !std::isfinite(b)) {
+        throw std::invalid_argument("Integration limits must be finite");
+    }
+
+    Result result;
+    if (a == b) {
+        result.converged = true;
+        return result;
+    }
+
+    std::vector<Panel> batch = {{a, b, 0.0, 0.0}};
+    evaluate_panels(f, batch, result);
+
+    std::priority_queue<Panel> panels;
+    panels.push(batch[0]);
+    double total = batch[0].value;
+    double total_error = batch[0].error;
+
+    while (!within_tolerance(total_error, total, abs_tolerance, rel_tolerance) &&
+           panels.size() < max_subdivisions) {
+        Panel worst = panels.top();
+        double middle = 0.5 * (worst.a + worst.b);
+        if (middle <= std::min(worst.a, worst.b) || middle >= std::max(worst.a, worst.b)) {
+            break;  // Interval can no longer be split in floating point
+        }
+        panels.pop();
+
+        batch = {{worst.a, middle, 0.0, 0.0}, {middle, worst.b, 0.0, 0.0}};
+        evaluate_panels(f, batch, result);
+        for (const Panel& panel : batch) {
+            panels.push(panel);
+        }
+        total += batch[0].value + batch[1].value - worst.value;
+        total_error += batch[0].error + batch[1].error - worst.error;
+    }
+
+    // Re-sum to shed the drift of the running totals
+    result.value = 0.0;
+    result.error = 0.0;
+    while (!panels.empty()) {
+        result.value += panels.top().value;
+        result.error += panels.top().error;
+        panels.pop();
+    }
+    result.converged = within_tolerance(result.error, result.value, abs_tolerance, rel_tolerance);
+    return result;
+}
+
+Result cubature(const BatchIntegrand2D& f, double ax, double bx, double ay, double by,
+                double abs_tolerance, double rel_tolerance, size_t max_subdivisions) {
+    if (!std::isfinite(ax) || !std::isfinite(bx) || !std::isfinite(ay) || !std::isfinite(by)) {
+        throw std::invalid_argument("Integration limits must be finite");
+    }
+
+    Result result;
+    if (ax == bx || ay == by) {
+        result.converged = true;
+        return result;
+    }
+
+    std::vector<Rectangle> batch = {{ax, bx, ay, by, 0.0, 0.0, true}};
+    evaluate_rectangles(f, batch, result);
+
+    std::priority_queue<Rectangle> rectangles;
+    rectangles.push(batch[0]);
+    double total = batch[0].value;
+    double total_error = batch[0].error;
+
+    while (!within_tolerance(total_error, total, abs_tolerance, rel_tolerance) &&
+           rectangles.size() < max_subdivisions) {
+        Rectangle worst = rectangles.top();
+        rectangles.pop();
+
+        Rectangle first = worst, second = worst;
+        if (worst.split_x) {
+            double middle = 0.5 * (worst.ax + worst.bx);
+            first.bx = middle;
+            second.ax = middle;
+        } else {
+            double middle = 0.5 * (worst.ay + worst.by);
+            first.by = middle;
+            second.ay = middle;
+        }
+
+        batch = {first, second};
+        evaluate_rectangles(f, batch, result);
+        for (const Rectangle& rect : batch) {
+            rectangles.push(rect);
+        }
+        total += batch[0].value + batch[1].value - worst.value;
+        total_error += batch[0].error + batch[1].error - worst.error;
+    }
+
+    result.value = 0.0;
+    result.error = 0.0;
+    while (!rectangles.empty()) {
+        result.value += rectangles.top().value;
+        result.error += rectangles.top().error;
+        rectangles.pop();
+    }
+    result.converged = within_tolerance(result.error, result.value, abs_tolerance, rel_tolerance);
+    return result;
+}
+
+namespace {
+
+void check_samples(const std::vector<double>& x, const std::vector<double>& y) {
+    if (!x.empty() && x.size() != y.size()) {
+        throw std::invalid_argument("Sample points and values must have the same length");
+    }
+}
+
+double spacing(const std::vector<double>& x, size_t i) {
+    return x.empty() ? 1.0 : x[i + 1] - x[i];
+}
+
+} // anonymous namespace
+
+double trapezoid(const std::vector<double>& x, const std::vector<double>& y) {
+    check_samples(x, y);
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < y.size(); ++i) {
+        sum += 0.5 * spacing(x, i) * (y[i] + y[i + 1]);
+    }
+    return sum;
+}
+
+double simpson(const std::vector<double>& x, const std::vector<double>& y) {
+    check_samples(x, y);
+    const size_t n = y.size();
+    if (n < 3) {
+        return trapezoid(x, y);
+    }
+
+    // Pairs of intervals, each integrated exactly for quadratics
+    double sum = 0.0;
+    size_t i = 0;
+    for (; i + 2 < n; i += 2) {
+        double h0 = spacing(x, i);
+        double h1 = spacing(x, i + 1);
+        double h = h0 + h1;
+        sum += h / 6.0 * ((2.0 - h1 / h0) * y[i] +
+                          h * h / (h0 * h1) * y[i + 1] +
+                          (2.0 - h0 / h1) * y[i + 2]);
+    }
+
+    // One interval left over: integrate the quadratic through the last three points over it
+    if (i + 1 < n) {
+        double h0 = spacing(x, n - 3);
+        double h1 = spacing(x, n - 2);
+        sum += y[n - 1] * (2.0 * h1 * h1 + 3.0 * h0 * h1) / (6.0 * (h0 + h1)) +
+               y[n - 2] * (h1 * h1 + 3.0 * h0 * h1) / (6.0 * h0) -
+               y[n - 3] * h1 * h1 * h1 / (6.0 * h0 * (h0 + h1));
+    }
+    return sum;
+}
+
+} // namespace Quadrature
+} // namespace Dakota
@@ -0,0 +1,59 @@
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace Dakota {
+namespace Quadrature {
+
+// Constants for adaptive integration
+constexpr double DEFAULT_ABS_TOLERANCE = 1e-10;
+constexpr double DEFAULT_REL_TOLERANCE = 1e-10;
+constexpr size_t MAX_SUBDIVISIONS = 2000;       // Panels refined before giving up
+constexpr size_t KRONROD_POINTS = 15;           // Nodes per panel, per axis in 2-D
+
+// Integrands are evaluated a whole batch of nodes at a time so that callers
+// with per-call overhead (the interpreter) can amortize it over many points.
+// fx must be resized to x.size() and filled.
+using BatchIntegrand = std::function<void(const std::vector<double>& x, std::vector<double>& fx)>;
+using BatchIntegrand2D = std::function<void(const std::vector<double>& x, const std::vector<double>& y,
+                                            std::vector<double>& fxy)>;
+
+struct Result {
+    double value;
+    double error;          // Estimated absolute error
+    size_t evaluations;    // Integrand points evaluated
+    size_t batches;        // Calls made to the integrand
+    bool converged;
+
+    Result() : value(0.0), error(0.0), evaluations(0), batches(0), converged(false) {}
+};
+
+// Globally adaptive Gauss-Kronrod (G7/K15) on [a, b]. Each refinement step
+// bisects the panel with the largest error and evaluates both halves in one batch.
+Result gauss_kronrod(const BatchIntegrand& f, double a, double b,
+                     double abs_tolerance = DEFAULT_ABS_TOLERANCE,
+                     double rel_tolerance = DEFAULT_REL_TOLERANCE,
+                     size_t max_subdivisions = MAX_SUBDIVISIONS);
+
+// Adaptive tensor-product Gauss-Kronrod cubature on [ax, bx] x [ay, by].
+// Rectangles are bisected along the axis with the larger error estimate.
+Result cubature(const BatchIntegrand2D& f, double ax, double bx, double ay, double by,
+                double abs_tolerance = DEFAULT_ABS_TOLERANCE,
+                double rel_tolerance = DEFAULT_REL_TOLERANCE,
+                size_t max_subdivisions = MAX_SUBDIVISIONS);
+
+// Integration of sampled data. An empty x means unit spacing.
+// Throws std::invalid_argument for mismatched lengths.
+double trapezoid(const std::vector<double>& x, const std::vector<double>& y);
+
+// Composite Simpson's rule for (possibly non-uniform) samples; an odd number
+// of intervals is closed with a quadratic over the last three points
+double simpson(const std::vector<double>& x, const std::vector<double>& y);
+
+} // namespace Quadrature
+} // namespace Dakota
+
+#endif // QUADRATURE_H
@@ -0,0 +1,414 @@
+#include "server.h"
+#include "parallel.h"
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Dakota {
+
+namespace {
+
+constexpr size_t MAX_LINE_BYTES = 1024 * 1024;  // Longest PARAM or header line accepted
+
+} // anonymous namespace
+
+// Buffered reads and whole writes on a connected socket
+class Connection {
+public:
+    explicit Connection(int fd) : fd_(fd), begin_(0), end_(0) {}
+
+    int fd() const { return fd_; }
+
+    // Bytes already received but not yet consumed, such as a pipelined request
+    bool buffered() const { return begin_ < end_; }
+
+    // Next line without its '\n'; false at end of stream or on an overlong line
+    bool read_line(std::string& line) {
+        line.clear();
+        while (true) {
+            for (size_t k = begin_; k < end_; ++k) {
+                if (buffer_[k] == '\n') {
+                    line.append(buffer_ + begin_, k - begin_);
+                    begin_ = k + 1;
+                    return true;
+                }
+            }
+            line.append(buffer_ + begin_, end_ - begin_);
+            begin_ = end_;
+            if (line.size() > MAX_LINE_BYTES || !fill()) return false;
+        }
+    }
+
+    bool read_exact(std::string& out, size_t length) {
+        out.clear();
+        out.reserve(length);
+        while (out.size() < length) {
+            if (begin_ == end_ && !fill()) return false;
+            size_t take = std::min(length - out.size(), end_ - begin_);
+            out.append(buffer_ + begin_, take);
+            begin_ += take;
+        }
+        return true;
+    }
+
+    bool write_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    char buffer_[64 * 1024];
+    size_t begin_, end_;
+
+    bool fill() {
+        while (true) {
+            ssize_t n = ::recv(fd_, buffer_, sizeof(buffer_), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            begin_ = 0;
+            end_ = static_cast<size_t>(n);
+            return true;
+        }
+    }
+};
+
+namespace {
+
+sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return address;
+}
+
+bool parse_length(const std::string& text, size_t& length) {
+    if (text.empty() || text.size() > 19) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    length = static_cast<size_t>(std::strtoull(text.c_str(), nullptr, 10));
+    return true;
+}
+
+std::string response_header(const JobResult& response) {
+    return std::string(response.ok ? "OK " : "ERROR ") + std::to_string(response.output.size()) + " " +
+           std::to_string(response.errors.size()) + "\n";
+}
+
+} // anonymous namespace
+
+Server::Server(std::string socket_path, unsigned workers, bool optimize)
+    : socket_path_(std::move(socket_path)), workers_(workers == 0 ? hardware_threads() : workers),
+      listen_fd_(-1), stopping_(false), wake_{-1, -1}, programs_(optimize), requests_(0), max_steps_(0),
+      max_seconds_(0.0) {}
+
+Server::~Server() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+    }
+    for (int fd : wake_) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void Server::start() {
+    sockaddr_un address = socket_address(socket_path_);
+
+    // A socket file left behind by a daemon that did not shut down cleanly
+    struct stat existing;
+    if (::stat(socket_path_.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(socket_path_.c_str());
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        throw std::runtime_error("Cannot listen on " + socket_path_ + ": " + reason);
+    }
+
+    // Non-blocking, so stop() never waits on it and the accept loop can drain it
+    if (::pipe(wake_) < 0) {
+        throw std::runtime_error(std::string("Cannot create wake pipe: ") + std::strerror(errno));
+    }
+    for (int fd : wake_) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+void Server::run() {
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Server::run called before start");
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers_);
+    for (unsigned k = 0; k < workers_; ++k) {
+        pool.emplace_back([this] { worker_loop(); });
+    }
+
+    // Connections between requests: the first byte of the next one hands
+    // the connection to a worker
+    std::vector<std::unique_ptr<Connection>> idle;
+    std::vector<pollfd> watched;
+    const timeval timeout{SERVE_IO_TIMEOUT_SECONDS, 0};
+
+    while (!stopping_.load()) {
+        watched.assign({pollfd{listen_fd_, POLLIN, 0}, pollfd{wake_[0], POLLIN, 0}});
+        for (const auto& connection : idle) {
+            watched.push_back(pollfd{connection->fd(), POLLIN, 0});
+        }
+        if (::poll(watched.data(), watched.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            // End of stream and errors are readable too; the worker sees them and closes
+            size_t kept = 0;
+            for (size_t k = 0; k < idle.size(); ++k) {
+                if (watched[k + 2].revents != 0) {
+                    ready_.push_back(std::move(idle[k]));
+                    queue_ready_.notify_one();
+                } else {
+                    idle[kept++] = std::move(idle[k]);
+                }
+            }
+            idle.resize(kept);
+            if (watched[1].revents != 0) {
+                char drained[64];
+                while (::read(wake_[0], drained, sizeof(drained)) > 0) {}
+                for (auto& connection : returned_) {
+                    idle.push_back(std::move(connection));
+                }
+                returned_.clear();
+            }
+        }
+
+        if (watched[0].revents != 0) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                break;  // stop() shut the socket down, or it failed for good
+            }
+            // Only stalls inside a request block a worker, and only this long
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            idle.push_back(std::make_unique<Connection>(fd));
+        }
+    }
+
+    // Let connections mid-request see end of stream; requests already running still reply
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_.store(true);
+        for (int fd : active_) {
+            ::shutdown(fd, SHUT_RD);
+        }
+        queue_ready_.notify_all();
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (auto& connection : idle) {
+        ::close(connection->fd());
+    }
+    for (auto& connection : ready_) {
+        ::close(connection->fd());
+    }
+    for (auto& connection : returned_) {
+        ::close(connection->fd());
+    }
+    ready_.clear();
+    returned_.clear();
+}
+
+void Server::stop() {
+    stopping_.store(true);
+    if (listen_fd_ >= 0) {
+        ::shutdown(listen_fd_, SHUT_RDWR);
+    }
+    wake();
+}
+
+void Server::wake() {
+    if (wake_[1] >= 0) {
+        char byte = 0;
+        ssize_t written = ::write(wake_[1], &byte, 1);
+        (void)written;   // A full pipe already has a wakeup pending
+    }
+}
+
+ServeStats Server::stats() const {
+    ProgramCacheStats cache = programs_.stats();
+    ServeStats stats;
+    stats.requests = requests_.load();
+    stats.cache_hits = cache.reused;
+    stats.cache_misses = cache.compiled;
+    return stats;
+}
+
+void Server::worker_loop() {
+    while (true) {
+        std::unique_ptr<Connection> connection;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_ready_.wait(lock, [this] { return stopping_.load() || !ready_.empty(); });
+            if (stopping_.load()) return;
+            connection = std::move(ready_.front());
+            ready_.pop_front();
+            active_.insert(connection->fd());
+        }
+        bool open = serve_request(*connection);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            active_.erase(connection->fd());
+            if (open && !stopping_.load()) {
+                if (connection->buffered()) {
+                    // The next request is already here; no need to wait on poll for it
+                    ready_.push_back(std::move(connection));
+                    queue_ready_.notify_one();
+                } else {
+                    returned_.push_back(std::move(connection));
+                    wake();
+                }
+                continue;
+            }
+        }
+        ::close(connection->fd());
+    }
+}
+
+// Reads and answers one request; false once the connection should be closed
+bool Server::serve_request(Connection& connection) {
+    std::string line;
+    if (!connection.read_line(line)) return false;
+
+    JobRequest request;
+    std::string protocol_error;
+
+    while (line.compare(0, 6, "PARAM ") == 0 && protocol_error.empty()) {
+        size_t space = line.find(' ', 6);
+        if (space == std::string::npos || space == 6) {
+            protocol_error = "Malformed PARAM line";
+        } else if (request.parameters.size() >= SERVE_MAX_PARAMETERS) {
+            protocol_error = "Too many parameters";
+        } else {
+            request.parameters.emplace_back(line.substr(6, space - 6), line.substr(space + 1));
+            if (!connection.read_line(line)) return false;
+        }
+    }
+
+    size_t length = 0;
+    if (protocol_error.empty()) {
+        if (line.compare(0, 4, "RUN ") != 0 || !parse_length(line.substr(4), length)) {
+            protocol_error = "Expected PARAM or RUN <length>";
+        } else if (length > SERVE_MAX_SCRIPT_BYTES) {
+            protocol_error = "Script exceeds " + std::to_string(SERVE_MAX_SCRIPT_BYTES) + " bytes";
+        }
+    }
+
+    // The stream cannot be resynchronized after a bad request, so it ends here
+    if (!protocol_error.empty()) {
+        JobResult response;
+        response.ok = false;
+        response.errors = "Protocol error: " + protocol_error + "\n";
+        connection.write_all(response_header(response) + response.errors);
+        return false;
+    }
+
+    if (!connection.read_exact(request.script, length)) return false;
+
+    JobResult response = execute(request);
+    return connection.write_all(response_header(response)) && connection.write_all(response.output) &&
+           connection.write_all(response.errors);
+}
+
+void Server::set_limits(uint64_t max_steps, double max_seconds) {
+    max_steps_ = max_steps;
+    max_seconds_ = max_seconds;
+}
+
+JobResult Server::execute(const JobRequest& request) {
+    ++requests_;
+    JobRequest limited = request;
+    limited.budget.max_steps = max_steps_;
+    limited.budget.max_seconds = max_seconds_;
+    limited.budget.on_slice = [this] { return !stopping_.load(std::memory_order_relaxed); };
+    return run_job(programs_, limited);
+}
+
+JobResult submit(const std::string& socket_path, const JobRequest& request) {
+    for (const auto& parameter : request.parameters) {
+        if (parameter.first.empty() || parameter.first.find_first_of(" \n") != std::string::npos ||
+            parameter.second.find('\n') != std::string::npos) {
+            throw std::runtime_error("Invalid parameter '" + parameter.first + "'");
+        }
+    }
+
+    sockaddr_un address = socket_address(socket_path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::string reason = std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error("Cannot connect to " + socket_path + ": " + reason);
+    }
+
+    Connection connection(fd);
+    std::string message;
+    for (const auto& parameter : request.parameters) {
+        message += "PARAM " + parameter.first + " " + parameter.second + "\n";
+    }
+    message += "RUN " + std::to_string(request.script.size()) + "\n";
+    message += request.script;
+
+    JobResult response;
+    std::string header;
+    bool received = connection.write_all(message) && connection.read_line(header);
+    if (received) {
+        std::istringstream fields(header);
+        std::string status;
+        size_t output_length = 0, error_length = 0;
+        received = static_cast<bool>(fields >> status >> output_length >> error_length) &&
+                   connection.read_exact(response.output, output_length) &&
+                   connection.read_exact(response.errors, error_length);
+        response.ok = status == "OK";
+    }
+    ::close(fd);
+
+    if (!received) {
+        throw std::runtime_error("Connection to " + socket_path + " closed before a response");
+    }
+    return response;
+}
+
+} // namespace Dakota
@@ -0,0 +1,106 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "jobs.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <unordered_set>
+
+namespace Dakota {
+
+// Constants for the compile-and-execute daemon
+constexpr size_t SERVE_MAX_SCRIPT_BYTES = 64 * 1024 * 1024;  // Largest script a request may carry
+constexpr size_t SERVE_MAX_PARAMETERS = 4096;                // Parameters per request
+constexpr int SERVE_IO_TIMEOUT_SECONDS = 30;                 // A client stalled mid-request or mid-response is dropped
+
+struct ServeStats {
+    size_t requests = 0;
+    size_t cache_hits = 0;
+    size_t cache_misses = 0;
+};
+
+// `dakota --serve /path/to.sock`: a long-running daemon that accepts scripts
+// over a local Unix socket and runs them on a pool of worker threads.
+//
+// Scripts are lexed, parsed and optimized once and kept resident, keyed by
+// their text, so a scheduler submitting the same job script thousands of
+// times pays for compilation once. Process-wide state such as the buffer
+// pool and the sparse symbolic cache stays warm between requests. Every
+// request still gets its own Interpreter, so globals, user functions and
+// output never leak from one request into another.
+//
+// Workers are held per request, not per connection: between requests a
+// connection waits in the accept loop's poll set, so idle clients cannot
+// starve the pool.
+//
+// Wire protocol, any number of requests per connection:
+//
+//   request:   PARAM <name> <value>\n        (zero or more)
+//              RUN <length>\n<script bytes>
+//   response:  OK|ERROR <output length> <error length>\n<output bytes><error bytes>
+class Connection;
+
+class Server {
+public:
+    Server(std::string socket_path, unsigned workers = 0, bool optimize = true);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // Bind and listen, replacing a stale socket file; throws std::runtime_error
+    void start();
+
+    // Accept connections until stop(), then wait for the workers to finish
+    void run();
+
+    // Safe to call from another thread or a signal handler. The socket file
+    // is removed when the server is destroyed.
+    void stop();
+
+    // Steps and wall time allowed to every request. Whatever the limits,
+    // stop() cancels running scripts at their next budget check.
+    void set_limits(uint64_t max_steps, double max_seconds);
+
+    // Run one request in this thread, as a worker does
+    JobResult execute(const JobRequest& request);
+
+    ServeStats stats() const;
+    unsigned worker_count() const { return workers_; }
+
+private:
+    std::string socket_path_;
+    unsigned workers_;
+    int listen_fd_;
+    std::atomic<bool> stopping_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_ready_;
+    int wake_[2];                          // Pipe that interrupts the accept loop's poll
+
+    std::deque<std::unique_ptr<Connection>> ready_;       // A request is arriving, waiting for a worker
+    std::vector<std::unique_ptr<Connection>> returned_;   // Served, handed back to wait for the next request
+    std::unordered_set<int> active_;                      // Being served
+
+    ProgramCache programs_;
+    std::atomic<size_t> requests_;
+    uint64_t max_steps_;
+    double max_seconds_;
+
+    void wake();
+    void worker_loop();
+    bool serve_request(Connection& connection);
+};
+
+// Client side of the protocol: send one request and wait for the response.
+// Throws std::runtime_error if the daemon cannot be reached.
+JobResult submit(const std::string& socket_path, const JobRequest& request);
+
+} // namespace Dakota
+
+#endif // SERVER_H
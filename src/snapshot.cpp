@@ -0,0 +1,620 @@
+#include "snapshot.h"
+#include "sparse.h"
+#include "modules.h"
+#include "embed.h"
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Dakota {
+
+namespace {
+
+// Snapshot layout, native byte order: a Header, the metadata stream at
+// metadata_offset, then the data section at data_offset (page-aligned).
+//
+// The metadata stream is the object graph in depth-first order. Shared
+// objects (scopes, slots, functions, lists, dicts, matrices, modules) are
+// written as a uint64 id per kind; the first time an id appears its
+// definition follows, so aliasing and cycles survive a round trip. Arrays
+// are written as offsets into the data section.
+constexpr char SNAPSHOT_MAGIC[8] = {'D', 'K', 'S', 'N', 'A', 'P', '0', '1'};
+
+struct Header {
+    char magic[8];
+    uint64_t program;
+    uint64_t statement;
+    uint64_t metadata_offset;
+    uint64_t metadata_size;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+constexpr size_t METADATA_OFFSET = 64;
+static_assert(sizeof(Header) <= METADATA_OFFSET, "snapshot header must fit before the metadata");
+
+enum Kind : size_t { ENVIRONMENT, SLOT, FUNCTION, LIST, DICT, MATRIX, SPARSE, MODULE, KIND_COUNT };
+
+enum class FunctionKind : uint8_t { USER, BUILTIN };
+
+size_t align_up(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+struct File {
+    std::FILE* handle;
+    explicit File(std::FILE* h) : handle(h) {}
+    ~File() { if (handle) std::fclose(handle); }
+};
+
+// A read-only private mapping of a whole file
+struct Mapping {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit Mapping(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw RuntimeError("Cannot open snapshot '" + path + "'");
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = static_cast<size_t>(info.st_size);
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            data = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+        }
+        close(fd);
+        if (!data) {
+            throw RuntimeError("Cannot map snapshot '" + path + "'");
+        }
+    }
+    ~Mapping() { munmap(const_cast<char*>(data), size); }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+};
+
+} // anonymous namespace
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::function<bool(const std::string&)>& is_builtin) : is_builtin_(is_builtin) {}
+
+    size_t save(const std::string& path, const Snapshot::State& state) {
+        write_environment(state.globals);
+        put<uint64_t>(state.functions.size());
+        for (const auto& function : state.functions) {
+            put_string(function.first);
+            write_function(function.second);
+        }
+
+        Header header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.program = state.program;
+        header.statement = state.statement;
+        header.metadata_offset = METADATA_OFFSET;
+        header.metadata_size = metadata_.size();
+        header.data_offset = align_up(METADATA_OFFSET + metadata_.size(), Snapshot::PAGE_ALIGNMENT);
+        header.data_size = data_size_;
+
+        std::string temporary = path + ".tmp";
+        {
+            File file(std::fopen(temporary.c_str(), "wb"));
+            if (!file.handle) {
+                throw RuntimeError("Cannot write snapshot '" + temporary + "'");
+            }
+            size_t position = 0;
+            bool written = emit(file.handle, &header, sizeof(header), position) &&
+                           pad(file.handle, METADATA_OFFSET, position) &&
+                           emit(file.handle, metadata_.data(), metadata_.size(), position);
+            for (const auto& piece : pieces_) {
+                written = written && pad(file.handle, header.data_offset + piece.offset, position) &&
+                          emit(file.handle, piece.data, piece.bytes, position);
+            }
+            // The reader maps data_offset even when no data follows it
+            written = written && pad(file.handle, header.data_offset + data_size_, position);
+            if (!written || std::fflush(file.handle) != 0) {
+                throw RuntimeError("Cannot write snapshot '" + temporary + "'");
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            throw RuntimeError("Cannot replace snapshot '" + path + "'");
+        }
+        return header.data_offset + data_size_;
+    }
+
+private:
+    struct Piece {
+        const void* data;
+        size_t bytes;
+        size_t offset;   // In the data section
+    };
+
+    const std::function<bool(const std::string&)>& is_builtin_;
+    std::string metadata_;
+    std::vector<Piece> pieces_;
+    size_t data_size_ = 0;
+    std::unordered_map<const void*, uint64_t> ids_[KIND_COUNT];
+    std::vector<std::vector<int64_t>> gathered_;   // Integer lists, which have no public buffer
+
+    template <typename T>
+    void put(T value) {
+        metadata_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put_string(const std::string& text) {
+        put<uint64_t>(text.size());
+        metadata_.append(text);
+    }
+
+    // Writes the object's id; true if this is its first appearance and its
+    // definition must follow
+    bool reference(Kind kind, const void* object) {
+        auto& ids = ids_[kind];
+        auto known = ids.find(object);
+        if (known != ids.end()) {
+            put<uint64_t>(known->second);
+            return false;
+        }
+        uint64_t id = ids.size();
+        ids.emplace(object, id);
+        put<uint64_t>(id);
+        return true;
+    }
+
+    // Appends bytes to the data section and writes their offset
+    void put_buffer(const void* data, size_t bytes, size_t alignment) {
+        data_size_ = align_up(data_size_, alignment);
+        put<uint64_t>(data_size_);
+        if (bytes > 0) {
+            pieces_.push_back({data, bytes, data_size_});
+        }
+        data_size_ += bytes;
+    }
+
+    static size_t alignment_for(size_t bytes) {
+        return bytes >= Snapshot::LARGE_BUFFER_BYTES ? Snapshot::PAGE_ALIGNMENT : Snapshot::BUFFER_ALIGNMENT;
+    }
+
+    static bool emit(std::FILE* file, const void* data, size_t bytes, size_t& position) {
+        position += bytes;
+        return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+    }
+
+    static bool pad(std::FILE* file, size_t offset, size_t& position) {
+        static const char zeros[Snapshot::PAGE_ALIGNMENT] = {};
+        while (position < offset) {
+            size_t bytes = std::min(offset - position, sizeof(zeros));
+            if (!emit(file, zeros, bytes, position)) return false;
+        }
+        return true;
+    }
+
+    void write_environment(const std::shared_ptr<Environment>& env) {
+        put<uint8_t>(env ? 1 : 0);
+        if (!env || !reference(ENVIRONMENT, env.get())) return;
+        write_environment(env->parent_);
+        put<uint64_t>(env->variables_.size());
+        for (const auto& variable : env->variables_) {
+            put_string(variable.first);
+            if (reference(SLOT, variable.second.get())) {
+                write_value(*variable.second);
+            }
+        }
+    }
+
+    void write_function(const std::shared_ptr<const Function>& function) {
+        if (!reference(FUNCTION, function.get())) return;
+        if (function->native) {
+            if (!is_builtin_(function->name)) {
+                throw RuntimeError("checkpoint() cannot save native function '" + function->name + "'");
+            }
+            put<uint8_t>(static_cast<uint8_t>(FunctionKind::BUILTIN));
+            put_string(function->name);
+            return;
+        }
+        put<uint8_t>(static_cast<uint8_t>(FunctionKind::USER));
+        put_string(function->name);
+        put<uint64_t>(function->parameters.size());
+        for (const auto& parameter : function->parameters) {
+            put_string(parameter);
+        }
+        put<uint32_t>(function->body_node_index);
+        write_environment(function->closure);
+    }
+
+    void write_matrix(const std::shared_ptr<const Matrix>& matrix) {
+        put<uint8_t>(static_cast<uint8_t>(Value::Type::MATRIX));
+        if (!reference(MATRIX, matrix.get())) return;
+        size_t rows = matrix->size();
+        size_t cols = rows ? (*matrix)[0].size() : 0;
+        put<uint64_t>(rows);
+        put<uint64_t>(cols);
+        for (size_t i = 0; i < rows; ++i) {
+            if ((*matrix)[i].size() != cols) {
+                throw RuntimeError("checkpoint() cannot save a matrix with rows of different lengths");
+            }
+        }
+        // Rows are written back to back, so the matrix is one contiguous array
+        size_t bytes = rows * cols * sizeof(double);
+        data_size_ = align_up(data_size_, alignment_for(bytes));
+        put<uint64_t>(data_size_);
+        for (size_t i = 0; i < rows && cols > 0; ++i) {
+            pieces_.push_back({(*matrix)[i].data(), cols * sizeof(double), data_size_});
+            data_size_ += cols * sizeof(double);
+        }
+    }
+
+    void write_value(const Value& value) {
+        switch (value.get_type()) {
+            case Value::Type::INTEGER:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::INTEGER));
+                put<int64_t>(value.as_integer());
+                return;
+            case Value::Type::FLOAT:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::FLOAT));
+                put<double>(value.as_float());
+                return;
+            case Value::Type::STRING:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::STRING));
+                put_string(value.as_string());
+                return;
+            case Value::Type::BOOLEAN:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::BOOLEAN));
+                put<uint8_t>(value.as_boolean() ? 1 : 0);
+                return;
+            case Value::Type::NONE:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::NONE));
+                return;
+            case Value::Type::MATRIX:
+                write_matrix(value.matrix_pointer());
+                return;
+            case Value::Type::SPARSE: {
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::SPARSE));
+                const LinAlg::SparseMatrix& sparse = value.as_sparse();
+                if (!reference(SPARSE, &sparse)) return;
+                put<uint64_t>(sparse.rows);
+                put<uint64_t>(sparse.cols);
+                put<uint64_t>(sparse.nnz());
+                put_buffer(sparse.col_ptr.data(), sparse.col_ptr.size() * sizeof(int32_t), Snapshot::BUFFER_ALIGNMENT);
+                put_buffer(sparse.row_idx.data(), sparse.row_idx.size() * sizeof(int32_t), Snapshot::BUFFER_ALIGNMENT);
+                put_buffer(sparse.values.data(), sparse.values.size() * sizeof(double),
+                           alignment_for(sparse.values.size() * sizeof(double)));
+                return;
+            }
+            case Value::Type::FUNCTION:
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::FUNCTION));
+                write_function(value.function_pointer());
+                return;
+            case Value::Type::LIST: {
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::LIST));
+                List& list = value.as_list();
+                if (!reference(LIST, &list)) return;
+                put<uint8_t>(static_cast<uint8_t>(list.storage()));
+                put<uint64_t>(list.size());
+                if (list.storage() == List::Storage::FLOAT) {
+                    put_buffer(list.float_data(), list.size() * sizeof(double), alignment_for(list.size() * sizeof(double)));
+                } else if (list.storage() == List::Storage::INTEGER) {
+                    std::vector<int64_t> integers(list.size());
+                    for (size_t i = 0; i < integers.size(); ++i) {
+                        integers[i] = list.get_unchecked(i).as_integer();
+                    }
+                    gathered_.push_back(std::move(integers));
+                    put_buffer(gathered_.back().data(), list.size() * sizeof(int64_t),
+                               alignment_for(list.size() * sizeof(int64_t)));
+                } else {
+                    // Rows and boxed lists rebuild their storage as they are appended to
+                    for (size_t i = 0; i < list.size(); ++i) {
+                        write_value(list.get_unchecked(i));
+                    }
+                }
+                return;
+            }
+            case Value::Type::DICT: {
+                put<uint8_t>(static_cast<uint8_t>(Value::Type::DICT));
+                Dict& dict = value.as_dict();
+                if (!reference(DICT, &dict)) return;
+                put<uint64_t>(dict.size());
+                for (const auto& entry : dict.entries()) {
+                    if (!entry.live) continue;
+                    write_value(entry.key);
+                    write_value(entry.value);
+                }
+                return;
+            }
+            case Value::Type::OBJECT: {
+                Object& object = value.as_object();
+                if (auto* array = dynamic_cast<ExternalArray*>(&object)) {
+                    write_matrix(array->matrix());
+                    return;
+                }
+                if (auto* module = dynamic_cast<Module*>(&object)) {
+                    // Re-imported on restore; the module's own globals start afresh
+                    put<uint8_t>(static_cast<uint8_t>(Value::Type::OBJECT));
+                    if (reference(MODULE, module)) {
+                        put_string(module->name());
+                    }
+                    return;
+                }
+                throw RuntimeError("checkpoint() cannot save a " + object.type_name() + " value");
+            }
+        }
+    }
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const std::string& path, const Snapshot::Resolver& resolver)
+        : path_(path), resolver_(resolver), mapping_(path) {}
+
+    Snapshot::State load(uint64_t program) {
+        Header header;
+        if (mapping_.size < sizeof(header)) {
+            corrupt();
+        }
+        std::memcpy(&header, mapping_.data, sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+            throw RuntimeError("'" + path_ + "' is not a snapshot");
+        }
+        if (header.metadata_offset > mapping_.size || header.metadata_size > mapping_.size - header.metadata_offset ||
+            header.data_offset > mapping_.size || header.data_size > mapping_.size - header.data_offset) {
+            corrupt();
+        }
+        if (header.program != program) {
+            throw RuntimeError("Snapshot '" + path_ + "' was taken from a different program");
+        }
+        metadata_ = mapping_.data + header.metadata_offset;
+        metadata_end_ = metadata_ + header.metadata_size;
+        data_ = mapping_.data + header.data_offset;
+        data_size_ = header.data_size;
+
+        Snapshot::State state;
+        state.program = header.program;
+        state.statement = header.statement;
+        state.globals = read_environment();
+        uint64_t count = get<uint64_t>();
+        for (uint64_t k = 0; k < count; ++k) {
+            std::string name = get_string();
+            state.functions.emplace_back(std::move(name), read_function());
+        }
+        if (!state.globals || metadata_ != metadata_end_) {
+            corrupt();
+        }
+        return state;
+    }
+
+private:
+    std::string path_;
+    const Snapshot::Resolver& resolver_;
+    Mapping mapping_;
+    const char* metadata_ = nullptr;
+    const char* metadata_end_ = nullptr;
+    const char* data_ = nullptr;
+    size_t data_size_ = 0;
+
+    std::vector<std::shared_ptr<Environment>> environments_;
+    std::vector<Environment::Slot> slots_;
+    std::vector<std::shared_ptr<const Function>> functions_;
+    std::vector<Value> values_[KIND_COUNT];   // Lists, dicts, matrices, sparse matrices and modules
+
+    [[noreturn]] void corrupt() const {
+        throw RuntimeError("Snapshot '" + path_ + "' is corrupt");
+    }
+
+    template <typename T>
+    T get() {
+        if (static_cast<size_t>(metadata_end_ - metadata_) < sizeof(T)) corrupt();
+        T value;
+        std::memcpy(&value, metadata_, sizeof(T));
+        metadata_ += sizeof(T);
+        return value;
+    }
+
+    std::string get_string() {
+        uint64_t size = get<uint64_t>();
+        if (static_cast<uint64_t>(metadata_end_ - metadata_) < size) corrupt();
+        std::string text(metadata_, size);
+        metadata_ += size;
+        return text;
+    }
+
+    // count elements of T at the next offset in the stream, in the mapping
+    template <typename T>
+    const T* get_buffer(uint64_t count) {
+        uint64_t offset = get<uint64_t>();
+        if (count > data_size_ / sizeof(T) || offset > data_size_ - count * sizeof(T) || offset % alignof(T) != 0) {
+            corrupt();
+        }
+        return reinterpret_cast<const T*>(data_ + offset);
+    }
+
+    // Reads an id: the known object, or nullptr-like false if it is new and
+    // its definition follows
+    template <typename T>
+    bool known(std::vector<T>& table, T& out) {
+        uint64_t id = get<uint64_t>();
+        if (id < table.size()) {
+            out = table[id];
+            return true;
+        }
+        if (id != table.size()) corrupt();
+        return false;
+    }
+
+    std::shared_ptr<Environment> read_environment() {
+        if (get<uint8_t>() == 0) return nullptr;
+        std::shared_ptr<Environment> env;
+        if (known(environments_, env)) return env;
+
+        size_t id = environments_.size();
+        environments_.push_back(nullptr);
+        std::shared_ptr<Environment> parent = read_environment();
+        env = std::make_shared<Environment>(parent);
+        environments_[id] = env;
+
+        uint64_t count = get<uint64_t>();
+        for (uint64_t k = 0; k < count; ++k) {
+            std::string name = get_string();
+            Environment::Slot slot;
+            if (!known(slots_, slot)) {
+                slot = std::allocate_shared<Value>(PoolAllocator<Value>());
+                slots_.push_back(slot);
+                *slot = read_value();
+            }
+            env->variables_[name] = slot;
+        }
+        return env;
+    }
+
+    std::shared_ptr<const Function> read_function() {
+        std::shared_ptr<const Function> known_function;
+        if (known(functions_, known_function)) return known_function;
+
+        size_t id = functions_.size();
+        functions_.push_back(nullptr);
+        auto kind = static_cast<FunctionKind>(get<uint8_t>());
+        std::string name = get_string();
+        if (kind == FunctionKind::BUILTIN) {
+            functions_[id] = std::make_shared<Function>(name, resolver_.builtin(name));
+            return functions_[id];
+        }
+        if (kind != FunctionKind::USER) corrupt();
+
+        auto function = std::make_shared<Function>();
+        function->name = std::move(name);
+        functions_[id] = function;
+        uint64_t count = get<uint64_t>();
+        for (uint64_t k = 0; k < count; ++k) {
+            function->parameters.push_back(get_string());
+        }
+        function->body_node_index = get<uint32_t>();
+        if (function->body_node_index >= resolver_.node_count) corrupt();
+        function->closure = read_environment();
+        return function;
+    }
+
+    Value read_matrix() {
+        Value value;
+        if (known(values_[MATRIX], value)) return value;
+        size_t id = values_[MATRIX].size();
+        values_[MATRIX].emplace_back();
+
+        uint64_t rows = get<uint64_t>();
+        uint64_t cols = get<uint64_t>();
+        if (cols != 0 && rows > data_size_ / sizeof(double) / cols) corrupt();
+        const double* data = get_buffer<double>(rows * cols);
+        Matrix matrix;
+        matrix.reserve(rows);
+        for (uint64_t i = 0; i < rows; ++i) {
+            matrix.emplace_back(data + i * cols, data + (i + 1) * cols);
+        }
+        values_[MATRIX][id] = Value(std::move(matrix));
+        return values_[MATRIX][id];
+    }
+
+    Value read_value() {
+        auto type = static_cast<Value::Type>(get<uint8_t>());
+        switch (type) {
+            case Value::Type::INTEGER:
+                return Value(get<int64_t>());
+            case Value::Type::FLOAT:
+                return Value(get<double>());
+            case Value::Type::STRING:
+                return Value(get_string());
+            case Value::Type::BOOLEAN:
+                return Value(get<uint8_t>() != 0);
+            case Value::Type::NONE:
+                return Value();
+            case Value::Type::MATRIX:
+                return read_matrix();
+            case Value::Type::SPARSE: {
+                Value value;
+                if (known(values_[SPARSE], value)) return value;
+                auto sparse = std::make_shared<LinAlg::SparseMatrix>();
+                sparse->rows = get<uint64_t>();
+                sparse->cols = get<uint64_t>();
+                uint64_t nnz = get<uint64_t>();
+                // cols + 1 must not wrap, and column offsets are int32
+                if (sparse->cols >= data_size_ / sizeof(int32_t) ||
+                    nnz > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+                    corrupt();
+                }
+                const int32_t* col_ptr = get_buffer<int32_t>(sparse->cols + 1);
+                const int32_t* row_idx = get_buffer<int32_t>(nnz);
+                const double* entries = get_buffer<double>(nnz);
+                // Kernels index by these without checking, so the structure is validated here
+                if (col_ptr[0] != 0 || static_cast<uint64_t>(col_ptr[sparse->cols]) != nnz) corrupt();
+                for (size_t j = 0; j < sparse->cols; ++j) {
+                    if (col_ptr[j] > col_ptr[j + 1]) corrupt();
+                }
+                for (uint64_t k = 0; k < nnz; ++k) {
+                    if (row_idx[k] < 0 || static_cast<uint64_t>(row_idx[k]) >= sparse->rows) corrupt();
+                }
+                sparse->col_ptr.assign(col_ptr, col_ptr + sparse->cols + 1);
+                sparse->row_idx.assign(row_idx, row_idx + nnz);
+                sparse->values.assign(entries, entries + nnz);
+                values_[SPARSE].push_back(Value(std::shared_ptr<const LinAlg::SparseMatrix>(std::move(sparse))));
+                return values_[SPARSE].back();
+            }
+            case Value::Type::FUNCTION:
+                return Value(read_function());
+            case Value::Type::LIST: {
+                Value value;
+                if (known(values_[LIST], value)) return value;
+                auto list = std::make_shared<List>();
+                values_[LIST].push_back(Value(list));
+                auto storage = static_cast<List::Storage>(get<uint8_t>());
+                uint64_t count = get<uint64_t>();
+                if (storage == List::Storage::FLOAT) {
+                    const double* data = get_buffer<double>(count);
+                    list->reserve(count);
+                    for (uint64_t i = 0; i < count; ++i) list->append(Value(data[i]));
+                } else if (storage == List::Storage::INTEGER) {
+                    const int64_t* data = get_buffer<int64_t>(count);
+                    list->reserve(count);
+                    for (uint64_t i = 0; i < count; ++i) list->append(Value(data[i]));
+                } else {
+                    for (uint64_t i = 0; i < count; ++i) list->append(read_value());
+                }
+                return Value(list);
+            }
+            case Value::Type::DICT: {
+                Value value;
+                if (known(values_[DICT], value)) return value;
+                auto dict = std::make_shared<Dict>();
+                values_[DICT].push_back(Value(dict));
+                uint64_t count = get<uint64_t>();
+                for (uint64_t k = 0; k < count; ++k) {
+                    Value key = read_value();
+                    dict->set(key, read_value());
+                }
+                return Value(dict);
+            }
+            case Value::Type::OBJECT: {
+                Value value;
+                if (known(values_[MODULE], value)) return value;
+                values_[MODULE].push_back(Value(std::shared_ptr<Object>(resolver_.module(get_string()))));
+                return values_[MODULE].back();
+            }
+        }
+        corrupt();
+    }
+};
+
+namespace Snapshot {
+
+size_t save(const std::string& path, const State& state, const std::function<bool(const std::string&)>& is_builtin) {
+    return SnapshotWriter(is_builtin).save(path, state);
+}
+
+State load(const std::string& path, uint64_t program, const Resolver& resolver) {
+    return SnapshotReader(path, resolver).load(program);
+}
+
+} // namespace Snapshot
+} // namespace Dakota
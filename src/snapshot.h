@@ -0,0 +1,57 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "interpreter.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace Dakota {
+namespace Snapshot {
+
+// Constants for interpreter snapshots
+constexpr size_t BUFFER_ALIGNMENT = 64;            // Every array in the data section starts on a cache line
+constexpr size_t PAGE_ALIGNMENT = 4096;            // The data section, and arrays of at least LARGE_BUFFER_BYTES
+constexpr size_t LARGE_BUFFER_BYTES = 64 * 1024;
+
+// The interpreter state a snapshot holds: the global scope and everything
+// reachable from it (closures, lists, dicts, matrices), the user functions,
+// and where in the program to carry on
+struct State {
+    uint64_t program = 0;     // Fingerprint of the program the state belongs to
+    uint64_t statement = 0;   // Top-level statement to resume at
+    std::shared_ptr<Environment> globals;
+    std::vector<std::pair<std::string, std::shared_ptr<const Function>>> functions;
+};
+
+// Builtin function values and modules are saved by name and looked up again
+// on restore; these resolve a name or throw RuntimeError. User function
+// bodies are saved as node indices, which must be below node_count.
+struct Resolver {
+    std::function<NativeFunction(const std::string&)> builtin;
+    std::function<std::shared_ptr<Module>(const std::string&)> module;
+    size_t node_count = 0;
+};
+
+// Write state to path, replacing it atomically, and return its size in
+// bytes. Small values go in a compact metadata stream; matrix, sparse and
+// numeric list buffers go in a page-aligned data section, each aligned to
+// BUFFER_ALIGNMENT. is_builtin says whether a native function value can be
+// saved by its name. Throws RuntimeError for values that cannot be saved
+// (native functions that are not builtins, objects other than modules) or
+// if the file cannot be written.
+size_t save(const std::string& path, const State& state, const std::function<bool(const std::string&)>& is_builtin);
+
+// Map the snapshot at path and rebuild its state, copying each buffer once
+// straight out of the mapping. Throws RuntimeError if the file is missing,
+// corrupt, or was taken from a program other than program.
+State load(const std::string& path, uint64_t program, const Resolver& resolver);
+
+} // namespace Snapshot
+} // namespace Dakota
+
+#endif // SNAPSHOT_H
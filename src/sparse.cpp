@@ -0,0 +1,1172 @@
+#include "sparse.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace Dakota {
+namespace LinAlg {
+
+// SparseMatrix implementation
+
+SparseMatrix SparseMatrix::from_dense(const DenseMatrix& dense) {
+    SparseMatrix result(dense.rows, dense.cols);
+    for (size_t j = 0; j < dense.cols; ++j) {
+        for (size_t i = 0; i < dense.rows; ++i) {
+            double value = dense(i, j);
+            if (value != 0.0) {
+                result.row_idx.push_back(static_cast<int32_t>(i));
+                result.values.push_back(value);
+            }
+        }
+        result.col_ptr[j + 1] = static_cast<int32_t>(result.row_idx.size());
+    }
+    return result;
+}
+
+SparseMatrix SparseMatrix::from_triplets(size_t rows, size_t cols,
+                                         const std::vector<int64_t>& row_indices,
+                                         const std::vector<int64_t>& col_indices,
+                                         const std::vector<double>& entries) {
+    if (row_indices.size() != col_indices.size() || row_indices.size() != entries.size()) {
+        throw std::invalid_argument("Triplet arrays must have the same length");
+    }
+
+    // Bucket triplets by column
+    std::vector<int32_t> counts(cols + 1, 0);
+    for (size_t t = 0; t < entries.size(); ++t) {
+        if (row_indices[t] < 0 || static_cast<size_t>(row_indices[t]) >= rows ||
+            col_indices[t] < 0 || static_cast<size_t>(col_indices[t]) >= cols) {
+            throw std::invalid_argument("Triplet index out of range");
+        }
+        counts[col_indices[t] + 1]++;
+    }
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+    std::vector<std::pair<int32_t, double>> bucketed(entries.size());
+    std::vector<int32_t> next(counts.begin(), counts.end() - 1);
+    for (size_t t = 0; t < entries.size(); ++t) {
+        bucketed[next[col_indices[t]]++] = {static_cast<int32_t>(row_indices[t]), entries[t]};
+    }
+
+    // Sort each column by row and sum duplicates
+    SparseMatrix result(rows, cols);
+    result.row_idx.reserve(entries.size());
+    result.values.reserve(entries.size());
+    for (size_t j = 0; j < cols; ++j) {
+        auto first = bucketed.begin() + counts[j];
+        auto last = bucketed.begin() + counts[j + 1];
+        std::sort(first, last, [](const std::pair<int32_t, double>& x, const std::pair<int32_t, double>& y) {
+            return x.first < y.first;
+        });
+        for (auto it = first; it != last; ++it) {
+            if (!result.row_idx.empty() &&
+                static_cast<size_t>(result.col_ptr[j]) < result.row_idx.size() &&
+                result.row_idx.back() == it->first) {
+                result.values.back() += it->second;
+            } else {
+                result.row_idx.push_back(it->first);
+                result.values.push_back(it->second);
+            }
+        }
+        result.col_ptr[j + 1] = static_cast<int32_t>(result.row_idx.size());
+    }
+    return result;
+}
+
+DenseMatrix SparseMatrix::to_dense() const {
+    DenseMatrix result(rows, cols, 0.0);
+    for (size_t j = 0; j < cols; ++j) {
+        for (int32_t p = col_ptr[j]; p < col_ptr[j + 1]; ++p) {
+            result(row_idx[p], j) = values[p];
+        }
+    }
+    return result;
+}
+
+DenseMatrix SparseMatrix::multiply(const DenseMatrix& x) const {
+    if (x.rows != cols) {
+        throw std::invalid_argument("Invalid matrix dimensions for multiplication");
+    }
+
+    DenseMatrix y(rows, x.cols, 0.0);
+    for (size_t j = 0; j < cols; ++j) {
+        const double* x_row = x.row(j);
+        for (int32_t p = col_ptr[j]; p < col_ptr[j + 1]; ++p) {
+            double a_ij = values[p];
+            double* y_row = y.row(row_idx[p]);
+            for (size_t c = 0; c < x.cols; ++c) {
+                y_row[c] += a_ij * x_row[c];
+            }
+        }
+    }
+    return y;
+}
+
+uint64_t SparseMatrix::pattern_hash() const {
+    // FNV-1a over dimensions and both index arrays
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash ^= (value >> (byte * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+    mix(rows);
+    mix(cols);
+    for (int32_t p : col_ptr) mix(static_cast<uint64_t>(p));
+    for (int32_t i : row_idx) mix(static_cast<uint64_t>(i));
+    return hash;
+}
+
+bool SparseMatrix::same_pattern(const SparseMatrix& other) const {
+    return rows == other.rows && cols == other.cols &&
+           col_ptr == other.col_ptr && row_idx == other.row_idx;
+}
+
+namespace {
+
+// Adjacency of the pattern of A + A^T without self loops, in CSR form
+struct Graph {
+    int32_t n;
+    std::vector<int32_t> ptr;
+    std::vector<int32_t> adj;
+
+    int32_t degree(int32_t v) const { return ptr[v + 1] - ptr[v]; }
+};
+
+Graph symmetric_graph(const SparseMatrix& a) {
+    Graph graph;
+    graph.n = static_cast<int32_t>(a.cols);
+
+    std::vector<std::vector<int32_t>> lists(a.cols);
+    for (size_t j = 0; j < a.cols; ++j) {
+        for (int32_t p = a.col_ptr[j]; p < a.col_ptr[j + 1]; ++p) {
+            int32_t i = a.row_idx[p];
+            if (i == static_cast<int32_t>(j)) continue;
+            lists[i].push_back(static_cast<int32_t>(j));
+            lists[j].push_back(i);
+        }
+    }
+
+    graph.ptr.assign(a.cols + 1, 0);
+    for (size_t v = 0; v < a.cols; ++v) {
+        std::sort(lists[v].begin(), lists[v].end());
+        lists[v].erase(std::unique(lists[v].begin(), lists[v].end()), lists[v].end());
+        graph.ptr[v + 1] = graph.ptr[v] + static_cast<int32_t>(lists[v].size());
+    }
+    graph.adj.reserve(graph.ptr.back());
+    for (auto& list : lists) {
+        graph.adj.insert(graph.adj.end(), list.begin(), list.end());
+    }
+    return graph;
+}
+
+// Minimum degree on the quotient graph. Eliminated pivots become elements;
+// a variable's degree is approximated by its variable neighbours plus the
+// sizes of its adjacent elements, with each element's overlap with the newest
+// element removed (the AMD external degree bound). Elements wholly contained
+// in the new element are absorbed.
+std::vector<int32_t> approximate_minimum_degree(const Graph& graph) {
+    const int32_t n = graph.n;
+    enum : uint8_t { VARIABLE = 0, ELEMENT = 1, ABSORBED = 2 };
+
+    std::vector<std::vector<int32_t>> var_adj(n), elem_adj(n), members(n);
+    std::vector<uint8_t> state(n, VARIABLE);
+    std::vector<int32_t> degree(n);
+    for (int32_t v = 0; v < n; ++v) {
+        var_adj[v].assign(graph.adj.begin() + graph.ptr[v], graph.adj.begin() + graph.ptr[v + 1]);
+        degree[v] = graph.degree(v);
+    }
+
+    // Degree buckets as doubly linked lists
+    std::vector<int32_t> head(n + 1, -1), next(n, -1), prev(n, -1);
+    auto insert = [&](int32_t v) {
+        int32_t d = degree[v];
+        next[v] = head[d];
+        prev[v] = -1;
+        if (head[d] != -1) prev[head[d]] = v;
+        head[d] = v;
+    };
+    auto remove = [&](int32_t v) {
+        if (prev[v] != -1) next[prev[v]] = next[v];
+        else head[degree[v]] = next[v];
+        if (next[v] != -1) prev[next[v]] = prev[v];
+    };
+    for (int32_t v = 0; v < n; ++v) insert(v);
+
+    std::vector<size_t> mark(n, 0), element_mark(n, 0);
+    std::vector<int32_t> external(n, 0);
+    size_t stamp = 0;
+    int32_t min_degree = 0;
+
+    std::vector<int32_t> order;
+    order.reserve(n);
+
+    for (int32_t k = 0; k < n; ++k) {
+        while (head[min_degree] == -1) ++min_degree;
+        int32_t pivot = head[min_degree];
+        remove(pivot);
+        order.push_back(pivot);
+
+        // Form the new element from the pivot's variables and absorbed elements
+        ++stamp;
+        mark[pivot] = stamp;
+        std::vector<int32_t> element;
+        for (int32_t v : var_adj[pivot]) {
+            if (state[v] == VARIABLE && mark[v] != stamp) {
+                mark[v] = stamp;
+                element.push_back(v);
+            }
+        }
+        for (int32_t e : elem_adj[pivot]) {
+            if (state[e] != ELEMENT) continue;
+            for (int32_t v : members[e]) {
+                if (state[v] == VARIABLE && mark[v] != stamp) {
+                    mark[v] = stamp;
+                    element.push_back(v);
+                }
+            }
+            state[e] = ABSORBED;
+            std::vector<int32_t>().swap(members[e]);
+        }
+        state[pivot] = ELEMENT;
+        std::vector<int32_t>().swap(var_adj[pivot]);
+        std::vector<int32_t>().swap(elem_adj[pivot]);
+
+        // |Le \ Lp| for every older element touching the new one
+        for (int32_t v : element) {
+            for (int32_t e : elem_adj[v]) {
+                if (state[e] != ELEMENT) continue;
+                if (element_mark[e] != stamp) {
+                    element_mark[e] = stamp;
+                    external[e] = static_cast<int32_t>(members[e].size());
+                }
+                external[e]--;
+            }
+        }
+
+        const int32_t remaining = n - k - 1;
+        const int32_t element_degree = static_cast<int32_t>(element.size()) - 1;
+        for (int32_t v : element) {
+            remove(v);
+
+            int32_t external_degree = 0;
+            auto& elements = elem_adj[v];
+            size_t kept = 0;
+            for (int32_t e : elements) {
+                if (state[e] != ELEMENT) continue;
+                if (external[e] <= 0) {
+                    // Le is a subset of Lp - aggressive absorption
+                    state[e] = ABSORBED;
+                    std::vector<int32_t>().swap(members[e]);
+                    continue;
+                }
+                external_degree += external[e];
+                elements[kept++] = e;
+            }
+            elements.resize(kept);
+            elements.push_back(pivot);
+
+            // Variables reachable through the new element no longer need an explicit edge
+            auto& variables = var_adj[v];
+            kept = 0;
+            for (int32_t u : variables) {
+                if (state[u] == VARIABLE && mark[u] != stamp) {
+                    variables[kept++] = u;
+                }
+            }
+            variables.resize(kept);
+
+            int32_t d = static_cast<int32_t>(variables.size()) + element_degree + external_degree;
+            degree[v] = std::min(d, remaining);
+            insert(v);
+            min_degree = std::min(min_degree, degree[v]);
+        }
+
+        members[pivot] = std::move(element);
+    }
+
+    return order;
+}
+
+// Order an induced subgraph with AMD and append the result
+void order_leaf(const Graph& graph, const std::vector<int32_t>& vertices,
+                std::vector<int32_t>& local_id, std::vector<int32_t>& order) {
+    Graph sub;
+    sub.n = static_cast<int32_t>(vertices.size());
+    for (int32_t i = 0; i < sub.n; ++i) local_id[vertices[i]] = i;
+
+    sub.ptr.assign(sub.n + 1, 0);
+    for (int32_t i = 0; i < sub.n; ++i) {
+        int32_t v = vertices[i];
+        for (int32_t p = graph.ptr[v]; p < graph.ptr[v + 1]; ++p) {
+            int32_t u = graph.adj[p];
+            if (local_id[u] >= 0) sub.adj.push_back(local_id[u]);
+        }
+        sub.ptr[i + 1] = static_cast<int32_t>(sub.adj.size());
+    }
+
+    for (int32_t local : approximate_minimum_degree(sub)) {
+        order.push_back(vertices[local]);
+    }
+    for (int32_t v : vertices) local_id[v] = -1;
+}
+
+class NestedDissection {
+private:
+    const Graph& graph_;
+    std::vector<int32_t> owner_;     // Subgraph tag each vertex currently belongs to
+    std::vector<int32_t> level_;
+    std::vector<int32_t> local_id_;
+    int32_t next_tag_;
+
+    // Breadth-first level structure rooted at root, restricted to tag
+    std::vector<int32_t> level_structure(int32_t root, int32_t tag, int32_t& depth) {
+        std::vector<int32_t> queue;
+        queue.push_back(root);
+        level_[root] = 0;
+        int32_t visit_tag = -tag - 2;  // Distinguishes "visited" from "member"
+        owner_[root] = visit_tag;
+        depth = 0;
+        for (size_t q = 0; q < queue.size(); ++q) {
+            int32_t v = queue[q];
+            depth = std::max(depth, level_[v]);
+            for (int32_t p = graph_.ptr[v]; p < graph_.ptr[v + 1]; ++p) {
+                int32_t u = graph_.adj[p];
+                if (owner_[u] == tag) {
+                    owner_[u] = visit_tag;
+                    level_[u] = level_[v] + 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+        for (int32_t v : queue) owner_[v] = tag;
+        return queue;
+    }
+
+    void dissect(std::vector<int32_t> vertices, std::vector<int32_t>& order) {
+        if (vertices.size() <= ND_LEAF_SIZE) {
+            order_leaf(graph_, vertices, local_id_, order);
+            return;
+        }
+
+        int32_t tag = next_tag_++;
+        for (int32_t v : vertices) owner_[v] = tag;
+
+        // Pseudo-peripheral root: repeat BFS from the farthest vertex while eccentricity grows
+        int32_t depth = 0;
+        std::vector<int32_t> reached = level_structure(vertices[0], tag, depth);
+        if (reached.size() < vertices.size()) {
+            // Disconnected - order each component independently
+            for (int32_t v : reached) owner_[v] = -1;
+            std::vector<int32_t> rest;
+            for (int32_t v : vertices) {
+                if (owner_[v] == tag) rest.push_back(v);
+                owner_[v] = -1;
+            }
+            dissect(std::move(reached), order);
+            dissect(std::move(rest), order);
+            return;
+        }
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            int32_t candidate = reached.back();
+            int32_t candidate_depth = 0;
+            std::vector<int32_t> candidate_levels = level_structure(candidate, tag, candidate_depth);
+            if (candidate_depth <= depth) {
+                // Restore the levels of the best root found so far
+                level_structure(reached.front(), tag, depth);
+                break;
+            }
+            depth = candidate_depth;
+            reached = std::move(candidate_levels);
+        }
+
+        if (depth < 2) {
+            for (int32_t v : vertices) owner_[v] = -1;
+            order_leaf(graph_, vertices, local_id_, order);
+            return;
+        }
+
+        // Separator level splits the vertex count roughly in half
+        std::vector<size_t> level_counts(depth + 1, 0);
+        for (int32_t v : vertices) level_counts[level_[v]]++;
+        int32_t separator_level = 1;
+        size_t cumulative = 0;
+        for (int32_t l = 0; l <= depth; ++l) {
+            cumulative += level_counts[l];
+            if (cumulative * 2 >= vertices.size()) {
+                separator_level = std::min(std::max(l, 1), depth - 1);
+                break;
+            }
+        }
+
+        std::vector<int32_t> part_a, part_b, separator;
+        for (int32_t v : vertices) {
+            int32_t l = level_[v];
+            if (l < separator_level) {
+                part_a.push_back(v);
+            } else if (l > separator_level) {
+                part_b.push_back(v);
+            } else {
+                // Only separator vertices touching the far side are needed
+                bool touches_far_side = false;
+                for (int32_t p = graph_.ptr[v]; p < graph_.ptr[v + 1]; ++p) {
+                    int32_t u = graph_.adj[p];
+                    if (owner_[u] == tag && level_[u] == separator_level + 1) {
+                        touches_far_side = true;
+                        break;
+                    }
+                }
+                (touches_far_side ? separator : part_a).push_back(v);
+            }
+        }
+        for (int32_t v : vertices) owner_[v] = -1;
+
+        dissect(std::move(part_a), order);
+        dissect(std::move(part_b), order);
+        order.insert(order.end(), separator.begin(), separator.end());
+    }
+
+public:
+    explicit NestedDissection(const Graph& graph)
+        : graph_(graph), owner_(graph.n, -1), level_(graph.n, -1),
+          local_id_(graph.n, -1), next_tag_(0) {}
+
+    std::vector<int32_t> order() {
+        std::vector<int32_t> vertices(graph_.n);
+        std::iota(vertices.begin(), vertices.end(), 0);
+        std::vector<int32_t> result;
+        result.reserve(graph_.n);
+        dissect(std::move(vertices), result);
+        return result;
+    }
+};
+
+std::vector<int32_t> invert_permutation(const std::vector<int32_t>& perm) {
+    std::vector<int32_t> inverse(perm.size());
+    for (size_t k = 0; k < perm.size(); ++k) {
+        inverse[perm[k]] = static_cast<int32_t>(k);
+    }
+    return inverse;
+}
+
+// Lower triangle of P A P^T built from the lower triangle of A
+SparseMatrix permute_lower(const SparseMatrix& a, const std::vector<int32_t>& pinv) {
+    const size_t n = a.cols;
+    SparseMatrix c(n, n);
+
+    std::vector<int32_t> counts(n + 1, 0);
+    for (size_t j = 0; j < n; ++j) {
+        for (int32_t p = a.col_ptr[j]; p < a.col_ptr[j + 1]; ++p) {
+            int32_t i = a.row_idx[p];
+            if (i < static_cast<int32_t>(j)) continue;
+            counts[std::min(pinv[i], pinv[j]) + 1]++;
+        }
+    }
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+    c.col_ptr = counts;
+    c.row_idx.resize(counts[n]);
+    c.values.resize(counts[n]);
+
+    std::vector<int32_t> next(counts.begin(), counts.end() - 1);
+    for (size_t j = 0; j < n; ++j) {
+        for (int32_t p = a.col_ptr[j]; p < a.col_ptr[j + 1]; ++p) {
+            int32_t i = a.row_idx[p];
+            if (i < static_cast<int32_t>(j)) continue;
+            int32_t r = std::max(pinv[i], pinv[j]);
+            int32_t col = std::min(pinv[i], pinv[j]);
+            c.row_idx[next[col]] = r;
+            c.values[next[col]++] = a.values[p];
+        }
+    }
+    return c;
+}
+
+// Column pattern of the transpose (upper triangle when given a lower one)
+SparseMatrix transpose_pattern(const SparseMatrix& a) {
+    SparseMatrix t(a.cols, a.rows);
+    std::vector<int32_t> counts(a.rows + 1, 0);
+    for (int32_t i : a.row_idx) counts[i + 1]++;
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+    t.col_ptr = counts;
+    t.row_idx.resize(a.nnz());
+
+    std::vector<int32_t> next(counts.begin(), counts.end() - 1);
+    for (size_t j = 0; j < a.cols; ++j) {
+        for (int32_t p = a.col_ptr[j]; p < a.col_ptr[j + 1]; ++p) {
+            t.row_idx[next[a.row_idx[p]]++] = static_cast<int32_t>(j);
+        }
+    }
+    return t;
+}
+
+// Elimination tree from the upper triangular pattern (Liu's algorithm)
+std::vector<int32_t> elimination_tree(const SparseMatrix& upper) {
+    const int32_t n = static_cast<int32_t>(upper.cols);
+    std::vector<int32_t> parent(n, -1), ancestor(n, -1);
+    for (int32_t k = 0; k < n; ++k) {
+        for (int32_t p = upper.col_ptr[k]; p < upper.col_ptr[k + 1]; ++p) {
+            int32_t i = upper.row_idx[p];
+            while (i != -1 && i < k) {
+                int32_t next = ancestor[i];
+                ancestor[i] = k;
+                if (next == -1) parent[i] = k;
+                i = next;
+            }
+        }
+    }
+    return parent;
+}
+
+std::vector<int32_t> tree_postorder(const std::vector<int32_t>& parent) {
+    const int32_t n = static_cast<int32_t>(parent.size());
+    std::vector<int32_t> head(n, -1), next(n, -1);
+    for (int32_t j = n - 1; j >= 0; --j) {
+        if (parent[j] == -1) continue;
+        next[j] = head[parent[j]];
+        head[parent[j]] = j;
+    }
+
+    std::vector<int32_t> post;
+    post.reserve(n);
+    std::vector<int32_t> stack;
+    for (int32_t root = 0; root < n; ++root) {
+        if (parent[root] != -1) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t v = stack.back();
+            int32_t child = head[v];
+            if (child == -1) {
+                stack.pop_back();
+                post.push_back(v);
+            } else {
+                head[v] = next[child];
+                stack.push_back(child);
+            }
+        }
+    }
+    return post;
+}
+
+// Symbolic cache shared by every interpreter in the process
+struct CacheEntry {
+    int kind;
+    Ordering ordering;
+    uint64_t hash;
+    std::shared_ptr<const SparseMatrix> pattern;
+    std::shared_ptr<const void> symbolic;
+};
+
+class SymbolicCache {
+private:
+    std::mutex mutex_;
+    std::list<CacheEntry> entries_;  // Most recently used first
+    size_t hits_;
+    size_t misses_;
+
+public:
+    SymbolicCache() : hits_(0), misses_(0) {}
+
+    std::shared_ptr<const void> find(int kind, Ordering ordering, const SparseMatrix& a, uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->kind == kind && it->ordering == ordering && it->hash == hash &&
+                it->pattern->same_pattern(a)) {
+                entries_.splice(entries_.begin(), entries_, it);
+                ++hits_;
+                return entries_.front().symbolic;
+            }
+        }
+        ++misses_;
+        return nullptr;
+    }
+
+    void insert(int kind, Ordering ordering, const SparseMatrix& a, uint64_t hash,
+                std::shared_ptr<const void> symbolic) {
+        auto pattern = std::make_shared<SparseMatrix>(a.rows, a.cols);
+        pattern->col_ptr = a.col_ptr;
+        pattern->row_idx = a.row_idx;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_front({kind, ordering, hash, pattern, std::move(symbolic)});
+        if (entries_.size() > SYMBOLIC_CACHE_CAPACITY) {
+            entries_.pop_back();
+        }
+    }
+
+    SymbolicCacheStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {hits_, misses_, entries_.size()};
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        hits_ = misses_ = 0;
+    }
+};
+
+SymbolicCache& symbolic_cache() {
+    static SymbolicCache cache;
+    return cache;
+}
+
+constexpr int CACHE_KIND_CHOLESKY = 0;
+constexpr int CACHE_KIND_LU = 1;
+
+void check_square(const SparseMatrix& a, const char* what) {
+    if (!a.is_square() || a.rows == 0) {
+        throw std::invalid_argument(std::string(what) + " requires a non-empty square matrix");
+    }
+}
+
+} // anonymous namespace
+
+std::vector<int32_t> fill_reducing_order(const SparseMatrix& a, Ordering ordering) {
+    check_square(a, "Ordering");
+    if (ordering == Ordering::NATURAL) {
+        std::vector<int32_t> perm(a.cols);
+        std::iota(perm.begin(), perm.end(), 0);
+        return perm;
+    }
+
+    Graph graph = symmetric_graph(a);
+    if (ordering == Ordering::NESTED_DISSECTION) {
+        return NestedDissection(graph).order();
+    }
+    return approximate_minimum_degree(graph);
+}
+
+// Cholesky
+
+std::shared_ptr<const CholeskySymbolic> cholesky_analyze(const SparseMatrix& a, Ordering ordering) {
+    check_square(a, "Cholesky factorization");
+    const int32_t n = static_cast<int32_t>(a.cols);
+
+    // Fill-reducing order, then relabel by an etree postorder so that
+    // supernodes are contiguous and children precede parents
+    std::vector<int32_t> perm = fill_reducing_order(a, ordering);
+    {
+        SparseMatrix upper = transpose_pattern(permute_lower(a, invert_permutation(perm)));
+        std::vector<int32_t> post = tree_postorder(elimination_tree(upper));
+        std::vector<int32_t> relabeled(n);
+        for (int32_t k = 0; k < n; ++k) relabeled[k] = perm[post[k]];
+        perm.swap(relabeled);
+    }
+
+    auto symbolic = std::make_shared<CholeskySymbolic>();
+    symbolic->n = n;
+    symbolic->ordering = ordering;
+    symbolic->perm = perm;
+    symbolic->pinv = invert_permutation(perm);
+
+    SparseMatrix lower = permute_lower(a, symbolic->pinv);
+    SparseMatrix upper = transpose_pattern(lower);
+    std::vector<int32_t> parent = elimination_tree(upper);
+
+    // Column counts of L from the row subtrees
+    std::vector<int32_t> col_count(n, 1), mark(n, -1);
+    for (int32_t k = 0; k < n; ++k) {
+        mark[k] = k;
+        for (int32_t p = upper.col_ptr[k]; p < upper.col_ptr[k + 1]; ++p) {
+            int32_t i = upper.row_idx[p];
+            while (i < k && mark[i] != k) {
+                mark[i] = k;
+                col_count[i]++;
+                i = parent[i];
+            }
+        }
+    }
+
+    // Fundamental supernodes: chains where each column's pattern is its parent's plus itself
+    std::vector<int32_t> child_count(n, 0);
+    for (int32_t j = 0; j < n; ++j) {
+        if (parent[j] != -1) child_count[parent[j]]++;
+    }
+    symbolic->super_start.push_back(0);
+    for (int32_t j = 1; j < n; ++j) {
+        bool merge = parent[j - 1] == j && col_count[j - 1] == col_count[j] + 1 && child_count[j] == 1;
+        if (!merge) symbolic->super_start.push_back(j);
+    }
+    symbolic->super_start.push_back(n);
+
+    const int32_t supernodes = static_cast<int32_t>(symbolic->super_start.size()) - 1;
+    std::vector<int32_t> supernode_of(n);
+    for (int32_t s = 0; s < supernodes; ++s) {
+        for (int32_t j = symbolic->super_start[s]; j < symbolic->super_start[s + 1]; ++j) {
+            supernode_of[j] = s;
+        }
+    }
+
+    symbolic->super_parent.assign(supernodes, -1);
+    std::vector<int32_t> child_counts(supernodes + 1, 0);
+    for (int32_t s = 0; s < supernodes; ++s) {
+        int32_t last = symbolic->super_start[s + 1] - 1;
+        if (parent[last] != -1) {
+            symbolic->super_parent[s] = supernode_of[parent[last]];
+            child_counts[symbolic->super_parent[s] + 1]++;
+        }
+    }
+    std::partial_sum(child_counts.begin(), child_counts.end(), child_counts.begin());
+    symbolic->child_ptr = child_counts;
+    symbolic->child_list.resize(child_counts[supernodes]);
+    std::vector<int32_t> next_child(child_counts.begin(), child_counts.end() - 1);
+    for (int32_t s = 0; s < supernodes; ++s) {
+        if (symbolic->super_parent[s] != -1) {
+            symbolic->child_list[next_child[symbolic->super_parent[s]]++] = s;
+        }
+    }
+
+    // Row structure of each front: own columns, A's entries below, children's update rows
+    symbolic->struct_ptr.assign(1, 0);
+    std::fill(mark.begin(), mark.end(), -1);
+    symbolic->factor_nnz = 0;
+    symbolic->factor_flops = 0.0;
+    for (int32_t s = 0; s < supernodes; ++s) {
+        int32_t first = symbolic->super_start[s];
+        int32_t last = symbolic->super_start[s + 1];
+        size_t begin = symbolic->struct_rows.size();
+
+        for (int32_t j = first; j < last; ++j) {
+            mark[j] = s;
+            symbolic->struct_rows.push_back(j);
+        }
+        for (int32_t j = first; j < last; ++j) {
+            for (int32_t p = lower.col_ptr[j]; p < lower.col_ptr[j + 1]; ++p) {
+                int32_t r = lower.row_idx[p];
+                if (mark[r] != s) {
+                    mark[r] = s;
+                    symbolic->struct_rows.push_back(r);
+                }
+            }
+        }
+        for (int32_t c = symbolic->child_ptr[s]; c < symbolic->child_ptr[s + 1]; ++c) {
+            int32_t child = symbolic->child_list[c];
+            int32_t child_cols = symbolic->super_start[child + 1] - symbolic->super_start[child];
+            for (int32_t p = symbolic->struct_ptr[child] + child_cols; p < symbolic->struct_ptr[child + 1]; ++p) {
+                int32_t r = symbolic->struct_rows[p];
+                if (mark[r] != s) {
+                    mark[r] = s;
+                    symbolic->struct_rows.push_back(r);
+                }
+            }
+        }
+        std::sort(symbolic->struct_rows.begin() + begin + (last - first), symbolic->struct_rows.end());
+        symbolic->struct_ptr.push_back(static_cast<int32_t>(symbolic->struct_rows.size()));
+
+        double m = static_cast<double>(symbolic->struct_rows.size() - begin);
+        double k = static_cast<double>(last - first);
+        symbolic->factor_nnz += static_cast<size_t>(m * k - k * (k - 1) / 2);
+        symbolic->factor_flops += k * m * m;
+    }
+
+    return symbolic;
+}
+
+CholeskyFactor cholesky_factor(const SparseMatrix& a, std::shared_ptr<const CholeskySymbolic> symbolic) {
+    check_square(a, "Cholesky factorization");
+    if (!symbolic || symbolic->n != a.cols) {
+        throw std::invalid_argument("Symbolic analysis does not match the matrix");
+    }
+
+    const CholeskySymbolic& sym = *symbolic;
+    const int32_t supernodes = static_cast<int32_t>(sym.supernode_count());
+    SparseMatrix lower = permute_lower(a, sym.pinv);
+
+    CholeskyFactor factor;
+    factor.symbolic = symbolic;
+    factor.block_ptr.assign(supernodes + 1, 0);
+    for (int32_t s = 0; s < supernodes; ++s) {
+        size_t m = sym.struct_ptr[s + 1] - sym.struct_ptr[s];
+        size_t k = sym.super_start[s + 1] - sym.super_start[s];
+        factor.block_ptr[s + 1] = factor.block_ptr[s] + m * k;
+    }
+    factor.values.assign(factor.block_ptr[supernodes], 0.0);
+
+    std::vector<std::vector<double>> updates(supernodes);
+    std::vector<int32_t> relative(sym.n, -1);
+    const size_t block = 64;
+
+    for (int32_t s = 0; s < supernodes; ++s) {
+        const int32_t first = sym.super_start[s];
+        const size_t k = sym.super_start[s + 1] - first;
+        const int32_t* rows = sym.struct_rows.data() + sym.struct_ptr[s];
+        const size_t m = sym.struct_ptr[s + 1] - sym.struct_ptr[s];
+        for (size_t i = 0; i < m; ++i) relative[rows[i]] = static_cast<int32_t>(i);
+
+        // Assemble the frontal matrix (lower triangle, row-major m x m)
+        std::vector<double> front(m * m, 0.0);
+        for (size_t j = 0; j < k; ++j) {
+            int32_t col = first + static_cast<int32_t>(j);
+            for (int32_t p = lower.col_ptr[col]; p < lower.col_ptr[col + 1]; ++p) {
+                front[relative[lower.row_idx[p]] * m + j] += lower.values[p];
+            }
+        }
+
+        // Extend-add the children's update matrices
+        for (int32_t c = sym.child_ptr[s]; c < sym.child_ptr[s + 1]; ++c) {
+            int32_t child = sym.child_list[c];
+            size_t child_cols = sym.super_start[child + 1] - sym.super_start[child];
+            const int32_t* child_rows = sym.struct_rows.data() + sym.struct_ptr[child] + child_cols;
+            size_t mc = sym.struct_ptr[child + 1] - sym.struct_ptr[child] - child_cols;
+            const std::vector<double>& update = updates[child];
+            for (size_t x = 0; x < mc; ++x) {
+                double* front_row = front.data() + relative[child_rows[x]] * m;
+                const double* update_row = update.data() + x * mc;
+                for (size_t y = 0; y <= x; ++y) {
+                    front_row[relative[child_rows[y]]] += update_row[y];
+                }
+            }
+            std::vector<double>().swap(updates[child]);
+        }
+
+        // Dense partial Cholesky of the k pivot columns
+        for (size_t j = 0; j < k; ++j) {
+            double diagonal = front[j * m + j];
+            if (!(diagonal > 0.0)) {
+                throw std::domain_error("Matrix is not positive definite");
+            }
+            diagonal = std::sqrt(diagonal);
+            front[j * m + j] = diagonal;
+            for (size_t i = j + 1; i < m; ++i) {
+                front[i * m + j] /= diagonal;
+            }
+            for (size_t c = j + 1; c < k; ++c) {
+                double l_cj = front[c * m + j];
+                if (l_cj == 0.0) continue;
+                for (size_t i = c; i < m; ++i) {
+                    front[i * m + c] -= front[i * m + j] * l_cj;
+                }
+            }
+        }
+
+        double* block_values = factor.values.data() + factor.block_ptr[s];
+        for (size_t i = 0; i < m; ++i) {
+            std::copy(front.begin() + i * m, front.begin() + i * m + k, block_values + i * k);
+        }
+
+        // Schur complement U = F22 - L21 L21^T, lower triangle only, by row blocks
+        const size_t mu = m - k;
+        if (mu > 0 && sym.super_parent[s] != -1) {
+            std::vector<double> update(mu * mu, 0.0);
+            for (size_t i = 0; i < mu; ++i) {
+                std::copy(front.begin() + (k + i) * m + k, front.begin() + (k + i) * m + k + i + 1,
+                          update.begin() + i * mu);
+            }
+
+            std::vector<double> l21_transposed(k * mu);
+            for (size_t i = 0; i < mu; ++i) {
+                for (size_t j = 0; j < k; ++j) {
+                    l21_transposed[j * mu + i] = front[(k + i) * m + j];
+                }
+            }
+
+            size_t row_blocks = (mu + block - 1) / block;
+            auto update_block = [&](size_t b) {
+                size_t i0 = b * block;
+                size_t i1 = std::min(i0 + block, mu);
+                gemm_subtract(i1 - i0, i1, k,
+                              front.data() + (k + i0) * m, m,
+                              l21_transposed.data(), mu,
+                              update.data() + i0 * mu, mu);
+            };
+            double flops = static_cast<double>(mu) * static_cast<double>(mu) * static_cast<double>(k);
+            if (flops >= PARALLEL_GEMM_MIN_FLOPS && row_blocks > 1) {
+                parallel_for(row_blocks, update_block);
+            } else {
+                for (size_t b = 0; b < row_blocks; ++b) update_block(b);
+            }
+            updates[s] = std::move(update);
+        }
+
+        for (size_t i = 0; i < m; ++i) relative[rows[i]] = -1;
+    }
+
+    return factor;
+}
+
+DenseMatrix CholeskyFactor::solve(const DenseMatrix& b) const {
+    const CholeskySymbolic& sym = *symbolic;
+    if (b.rows != sym.n) {
+        throw std::invalid_argument("Right-hand side has the wrong number of rows");
+    }
+
+    const size_t nrhs = b.cols;
+    DenseMatrix y(sym.n, nrhs);
+    for (size_t k = 0; k < sym.n; ++k) {
+        std::copy(b.row(sym.perm[k]), b.row(sym.perm[k]) + nrhs, y.row(k));
+    }
+
+    const int32_t supernodes = static_cast<int32_t>(sym.supernode_count());
+
+    // Forward substitution L y = P b
+    for (int32_t s = 0; s < supernodes; ++s) {
+        const int32_t first = sym.super_start[s];
+        const size_t k = sym.super_start[s + 1] - first;
+        const int32_t* rows = sym.struct_rows.data() + sym.struct_ptr[s];
+        const size_t m = sym.struct_ptr[s + 1] - sym.struct_ptr[s];
+        const double* l = values.data() + block_ptr[s];
+
+        for (size_t j = 0; j < k; ++j) {
+            double* y_j = y.row(first + j);
+            double diagonal = l[j * k + j];
+            for (size_t c = 0; c < nrhs; ++c) y_j[c] /= diagonal;
+            for (size_t i = j + 1; i < m; ++i) {
+                double l_ij = l[i * k + j];
+                if (l_ij == 0.0) continue;
+                double* y_i = y.row(rows[i]);
+                for (size_t c = 0; c < nrhs; ++c) y_i[c] -= l_ij * y_j[c];
+            }
+        }
+    }
+
+    // Back substitution L^T x = y
+    for (int32_t s = supernodes - 1; s >= 0; --s) {
+        const int32_t first = sym.super_start[s];
+        const size_t k = sym.super_start[s + 1] - first;
+        const int32_t* rows = sym.struct_rows.data() + sym.struct_ptr[s];
+        const size_t m = sym.struct_ptr[s + 1] - sym.struct_ptr[s];
+        const double* l = values.data() + block_ptr[s];
+
+        for (size_t j = k; j-- > 0;) {
+            double* y_j = y.row(first + j);
+            for (size_t i = j + 1; i < m; ++i) {
+                double l_ij = l[i * k + j];
+                if (l_ij == 0.0) continue;
+                const double* y_i = y.row(rows[i]);
+                for (size_t c = 0; c < nrhs; ++c) y_j[c] -= l_ij * y_i[c];
+            }
+            double diagonal = l[j * k + j];
+            for (size_t c = 0; c < nrhs; ++c) y_j[c] /= diagonal;
+        }
+    }
+
+    DenseMatrix x(sym.n, nrhs);
+    for (size_t k = 0; k < sym.n; ++k) {
+        std::copy(y.row(k), y.row(k) + nrhs, x.row(sym.perm[k]));
+    }
+    return x;
+}
+
+// LU
+
+std::shared_ptr<const LUSymbolic> lu_analyze(const SparseMatrix& a, Ordering ordering) {
+    check_square(a, "LU factorization");
+    auto symbolic = std::make_shared<LUSymbolic>();
+    symbolic->n = a.cols;
+    symbolic->ordering = ordering;
+    symbolic->column_order = fill_reducing_order(a, ordering);
+    symbolic->nnz_estimate = 4 * a.nnz() + a.cols;
+    return symbolic;
+}
+
+namespace {
+
+// Nonzero pattern of L \ A(:,col) by depth-first search through the columns
+// of L factored so far (Gilbert-Peierls). Returns the start of the
+// topologically ordered pattern in xi[top..n).
+int32_t sparse_reach(const SparseMatrix& l, const std::vector<int32_t>& l_ptr,
+                     const SparseMatrix& a, int32_t col, const std::vector<int32_t>& pinv,
+                     std::vector<int32_t>& xi, std::vector<int32_t>& stack,
+                     std::vector<int32_t>& position, std::vector<size_t>& mark, size_t stamp) {
+    const int32_t n = static_cast<int32_t>(a.rows);
+    int32_t top = n;
+
+    for (int32_t p = a.col_ptr[col]; p < a.col_ptr[col + 1]; ++p) {
+        int32_t start = a.row_idx[p];
+        if (mark[start] == stamp) continue;
+
+        int32_t head = 0;
+        stack[0] = start;
+        while (head >= 0) {
+            int32_t j = stack[head];
+            int32_t column = pinv[j];
+            if (mark[j] != stamp) {
+                mark[j] = stamp;
+                position[head] = column < 0 ? 0 : l_ptr[column];
+            }
+            bool done = true;
+            int32_t end = column < 0 ? 0 : l_ptr[column + 1];
+            for (int32_t q = position[head]; q < end; ++q) {
+                int32_t i = l.row_idx[q];
+                if (mark[i] == stamp) continue;
+                position[head] = q;
+                stack[++head] = i;
+                done = false;
+                break;
+            }
+            if (done) {
+                --head;
+                xi[--top] = j;
+            }
+        }
+    }
+    return top;
+}
+
+} // anonymous namespace
+
+LUFactor lu_factor(const SparseMatrix& a, const LUSymbolic& symbolic, double pivot_tolerance) {
+    check_square(a, "LU factorization");
+    if (symbolic.n != a.cols) {
+        throw std::invalid_argument("Symbolic analysis does not match the matrix");
+    }
+
+    const int32_t n = static_cast<int32_t>(a.cols);
+    LUFactor factor;
+    factor.n = n;
+    factor.column_order = symbolic.column_order;
+    factor.pinv.assign(n, -1);
+    factor.lower = SparseMatrix(n, n);
+    factor.upper = SparseMatrix(n, n);
+    factor.lower.row_idx.reserve(symbolic.nnz_estimate);
+    factor.lower.values.reserve(symbolic.nnz_estimate);
+    factor.upper.row_idx.reserve(symbolic.nnz_estimate);
+    factor.upper.values.reserve(symbolic.nnz_estimate);
+
+    std::vector<double> x(n, 0.0);
+    std::vector<int32_t> xi(n), stack(n), position(n);
+    std::vector<size_t> mark(n, 0);
+    std::vector<int32_t>& l_ptr = factor.lower.col_ptr;
+    std::vector<int32_t>& pinv = factor.pinv;
+
+    for (int32_t k = 0; k < n; ++k) {
+        l_ptr[k] = static_cast<int32_t>(factor.lower.row_idx.size());
+        factor.upper.col_ptr[k] = static_cast<int32_t>(factor.upper.row_idx.size());
+
+        // x = L \ A(:, col) restricted to its nonzero pattern
+        int32_t col = symbolic.column_order[k];
+        int32_t top = sparse_reach(factor.lower, l_ptr, a, col, pinv, xi, stack, position, mark,
+                                   static_cast<size_t>(k) + 1);
+        for (int32_t p = top; p < n; ++p) x[xi[p]] = 0.0;
+        for (int32_t p = a.col_ptr[col]; p < a.col_ptr[col + 1]; ++p) x[a.row_idx[p]] = a.values[p];
+        for (int32_t p = top; p < n; ++p) {
+            int32_t j = xi[p];
+            int32_t column = pinv[j];
+            if (column < 0) continue;
+            double x_j = x[j];  // L has a unit diagonal stored first
+            for (int32_t q = l_ptr[column] + 1; q < l_ptr[column + 1]; ++q) {
+                x[factor.lower.row_idx[q]] -= factor.lower.values[q] * x_j;
+            }
+        }
+
+        // Partial pivoting, preferring the diagonal when it is large enough
+        int32_t pivot_row = -1;
+        double largest = -1.0;
+        for (int32_t p = top; p < n; ++p) {
+            int32_t i = xi[p];
+            if (pinv[i] < 0) {
+                double magnitude = std::abs(x[i]);
+                if (magnitude > largest) {
+                    largest = magnitude;
+                    pivot_row = i;
+                }
+            } else {
+                factor.upper.row_idx.push_back(pinv[i]);
+                factor.upper.values.push_back(x[i]);
+            }
+        }
+        if (pivot_row == -1 || largest <= 0.0) {
+            throw std::domain_error("Matrix is singular");
+        }
+        if (pinv[col] < 0 && std::abs(x[col]) >= largest * pivot_tolerance) {
+            pivot_row = col;
+        }
+
+        double pivot = x[pivot_row];
+        factor.upper.row_idx.push_back(k);
+        factor.upper.values.push_back(pivot);
+        pinv[pivot_row] = k;
+        factor.lower.row_idx.push_back(pivot_row);
+        factor.lower.values.push_back(1.0);
+        for (int32_t p = top; p < n; ++p) {
+            int32_t i = xi[p];
+            if (pinv[i] < 0) {
+                factor.lower.row_idx.push_back(i);
+                factor.lower.values.push_back(x[i] / pivot);
+            }
+            x[i] = 0.0;
+        }
+    }
+
+    l_ptr[n] = static_cast<int32_t>(factor.lower.row_idx.size());
+    factor.upper.col_ptr[n] = static_cast<int32_t>(factor.upper.row_idx.size());
+
+    // Renumber L's rows into pivot order
+    for (int32_t& row : factor.lower.row_idx) row = pinv[row];
+    return factor;
+}
+
+DenseMatrix LUFactor::solve(const DenseMatrix& b) const {
+    if (b.rows != n) {
+        throw std::invalid_argument("Right-hand side has the wrong number of rows");
+    }
+
+    DenseMatrix result(n, b.cols);
+    std::vector<double> x(n);
+    for (size_t c = 0; c < b.cols; ++c) {
+        for (size_t i = 0; i < n; ++i) x[pinv[i]] = b(i, c);
+
+        for (size_t j = 0; j < n; ++j) {
+            double x_j = x[j];
+            if (x_j == 0.0) continue;
+            for (int32_t p = lower.col_ptr[j] + 1; p < lower.col_ptr[j + 1]; ++p) {
+                x[lower.row_idx[p]] -= lower.values[p] * x_j;
+            }
+        }
+        for (size_t j = n; j-- > 0;) {
+            int32_t diagonal = upper.col_ptr[j + 1] - 1;
+            x[j] /= upper.values[diagonal];
+            double x_j = x[j];
+            if (x_j == 0.0) continue;
+            for (int32_t p = upper.col_ptr[j]; p < diagonal; ++p) {
+                x[upper.row_idx[p]] -= upper.values[p] * x_j;
+            }
+        }
+
+        for (size_t k = 0; k < n; ++k) result(column_order[k], c) = x[k];
+    }
+    return result;
+}
+
+// Cached drivers
+
+DenseMatrix cholesky_solve(const SparseMatrix& a, const DenseMatrix& b, Ordering ordering) {
+    check_square(a, "Cholesky factorization");
+    uint64_t hash = a.pattern_hash();
+    auto symbolic = std::static_pointer_cast<const CholeskySymbolic>(
+        symbolic_cache().find(CACHE_KIND_CHOLESKY, ordering, a, hash));
+    if (!symbolic) {
+        symbolic = cholesky_analyze(a, ordering);
+        symbolic_cache().insert(CACHE_KIND_CHOLESKY, ordering, a, hash, symbolic);
+    }
+    return cholesky_factor(a, symbolic).solve(b);
+}
+
+DenseMatrix sparse_lu_solve(const SparseMatrix& a, const DenseMatrix& b, Ordering ordering) {
+    check_square(a, "LU factorization");
+    uint64_t hash = a.pattern_hash();
+    auto symbolic = std::static_pointer_cast<const LUSymbolic>(
+        symbolic_cache().find(CACHE_KIND_LU, ordering, a, hash));
+    if (!symbolic) {
+        symbolic = lu_analyze(a, ordering);
+        symbolic_cache().insert(CACHE_KIND_LU, ordering, a, hash, symbolic);
+    }
+    return lu_factor(a, *symbolic).solve(b);
+}
+
+SymbolicCacheStats symbolic_cache_stats() {
+    return symbolic_cache().stats();
+}
+
+void clear_symbolic_cache() {
+    symbolic_cache().clear();
+}
+
+} // namespace LinAlg
+} // namespace Dakota
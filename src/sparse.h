@@ -0,0 +1,135 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "linalg.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace Dakota {
+namespace LinAlg {
+
+// Constants for sparse factorization configuration
+constexpr size_t ND_LEAF_SIZE = 256;            // Subgraphs below this are ordered with AMD
+constexpr size_t SYMBOLIC_CACHE_CAPACITY = 8;   // Analyses kept for reuse when only values change
+constexpr double LU_PIVOT_TOLERANCE = 0.1;      // Keep the diagonal pivot if within this factor of the max
+
+// Compressed sparse column storage
+// Row indices within each column are sorted and unique
+struct SparseMatrix {
+    size_t rows;
+    size_t cols;
+    std::vector<int32_t> col_ptr;  // cols + 1 entries
+    std::vector<int32_t> row_idx;  // nnz entries
+    std::vector<double> values;    // nnz entries
+
+    SparseMatrix() : rows(0), cols(0), col_ptr(1, 0) {}
+    SparseMatrix(size_t r, size_t c) : rows(r), cols(c), col_ptr(c + 1, 0) {}
+
+    size_t nnz() const { return row_idx.size(); }
+    bool is_square() const { return rows == cols; }
+
+    // Construction - duplicates in triplet form are summed
+    static SparseMatrix from_dense(const DenseMatrix& dense);
+    static SparseMatrix from_triplets(size_t rows, size_t cols,
+                                      const std::vector<int64_t>& row_indices,
+                                      const std::vector<int64_t>& col_indices,
+                                      const std::vector<double>& entries);
+
+    DenseMatrix to_dense() const;
+
+    // Y = A * X for a dense X with any number of columns
+    DenseMatrix multiply(const DenseMatrix& x) const;
+
+    // Hash of dimensions and sparsity pattern (values excluded)
+    uint64_t pattern_hash() const;
+    bool same_pattern(const SparseMatrix& other) const;
+};
+
+// Fill-reducing orderings
+enum class Ordering : uint8_t {
+    NATURAL,
+    AMD,              // Approximate minimum degree on the quotient graph
+    NESTED_DISSECTION // Recursive level-set bisection, AMD on the leaves
+};
+
+// Returns perm with perm[k] = original index eliminated k-th.
+// Uses the pattern of A + A^T, the diagonal is ignored.
+std::vector<int32_t> fill_reducing_order(const SparseMatrix& a, Ordering ordering);
+
+// Symbolic analysis for supernodal multifrontal Cholesky
+// Depends only on the pattern, so it is shared by every matrix with that pattern
+struct CholeskySymbolic {
+    size_t n;
+    Ordering ordering;
+    std::vector<int32_t> perm;           // perm[k] = original index of pivot k
+    std::vector<int32_t> pinv;           // inverse of perm
+    std::vector<int32_t> super_start;    // Supernode s owns columns [super_start[s], super_start[s+1])
+    std::vector<int32_t> super_parent;   // -1 for roots
+    std::vector<int32_t> struct_ptr;     // Row structure of supernode s is
+    std::vector<int32_t> struct_rows;    //   struct_rows[struct_ptr[s] .. struct_ptr[s+1])
+    std::vector<int32_t> child_ptr;      // Children of supernode s in postorder
+    std::vector<int32_t> child_list;
+    size_t factor_nnz;
+    double factor_flops;
+
+    size_t supernode_count() const { return super_start.size() - 1; }
+};
+
+// Numeric supernodal factor L (A = P^T L L^T P)
+struct CholeskyFactor {
+    std::shared_ptr<const CholeskySymbolic> symbolic;
+    std::vector<size_t> block_ptr;   // Dense block of supernode s starts at values[block_ptr[s]]
+    std::vector<double> values;      // Row-major |struct| x |columns| blocks
+
+    // Solves A X = B for dense B
+    DenseMatrix solve(const DenseMatrix& b) const;
+};
+
+// Symbolic analysis for left-looking sparse LU with partial pivoting
+struct LUSymbolic {
+    size_t n;
+    Ordering ordering;
+    std::vector<int32_t> column_order;   // q[k] = original column factored k-th
+    size_t nnz_estimate;
+};
+
+// Numeric factor P A Q = L U
+struct LUFactor {
+    size_t n;
+    std::vector<int32_t> pinv;          // pinv[i] = pivot position of original row i
+    std::vector<int32_t> column_order;
+    SparseMatrix lower;                 // Unit diagonal stored first in each column
+    SparseMatrix upper;                 // Diagonal stored last in each column
+
+    DenseMatrix solve(const DenseMatrix& b) const;
+};
+
+// Analysis, then numeric factorization. Symmetric input to the Cholesky
+// routines is read from the lower triangle of A only.
+std::shared_ptr<const CholeskySymbolic> cholesky_analyze(const SparseMatrix& a, Ordering ordering);
+CholeskyFactor cholesky_factor(const SparseMatrix& a, std::shared_ptr<const CholeskySymbolic> symbolic);
+
+std::shared_ptr<const LUSymbolic> lu_analyze(const SparseMatrix& a, Ordering ordering);
+LUFactor lu_factor(const SparseMatrix& a, const LUSymbolic& symbolic,
+                   double pivot_tolerance = LU_PIVOT_TOLERANCE);
+
+// Convenience solvers that consult the symbolic cache first
+DenseMatrix cholesky_solve(const SparseMatrix& a, const DenseMatrix& b, Ordering ordering = Ordering::AMD);
+DenseMatrix sparse_lu_solve(const SparseMatrix& a, const DenseMatrix& b, Ordering ordering = Ordering::AMD);
+
+// Symbolic cache statistics
+struct SymbolicCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t entries;
+};
+
+SymbolicCacheStats symbolic_cache_stats();
+void clear_symbolic_cache();
+
+} // namespace LinAlg
+} // namespace Dakota
+
+#endif // SPARSE_H
@@ -0,0 +1,364 @@
+#include "stats.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Dakota {
+namespace Stats {
+
+namespace {
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// Splits [0, count) into pieces of roughly chunk items, or one piece if the
+// whole range is too small to be worth threading
+size_t chunk_count(size_t count, size_t elements_per_item, size_t chunk) {
+    if (count * elements_per_item < PARALLEL_MIN_ELEMENTS) return 1;
+    size_t items = std::max<size_t>(1, chunk / std::max<size_t>(1, elements_per_item));
+    return (count + items - 1) / items;
+}
+
+void check_bins(size_t bins) {
+    if (bins == 0) {
+        throw std::invalid_argument("histogram() requires at least one bin");
+    }
+}
+
+} // anonymous namespace
+
+Moments::Moments()
+    : count(0.0), mean(0.0), m2(0.0), m3(0.0),
+      min(std::numeric_limits<double>::infinity()),
+      max(-std::numeric_limits<double>::infinity()) {}
+
+void Moments::add(double x) {
+    double n1 = count;
+    count += 1.0;
+    double delta = x - mean;
+    double delta_n = delta / count;
+    double term = delta * delta_n * n1;
+    mean += delta_n;
+    m3 += term * delta_n * (count - 2.0) - 3.0 * delta_n * m2;
+    m2 += term;
+    min = std::min(min, x);
+    max = std::max(max, x);
+}
+
+void Moments::merge(const Moments& other) {
+    if (other.count == 0.0) return;
+    if (count == 0.0) {
+        *this = other;
+        return;
+    }
+    double na = count;
+    double nb = other.count;
+    double n = na + nb;
+    double delta = other.mean - mean;
+    double delta_n = delta / n;
+
+    m3 += other.m3 + delta * delta_n * delta_n * na * nb * (na - nb)
+        + 3.0 * delta_n * (na * other.m2 - nb * m2);
+    m2 += other.m2 + delta * delta_n * na * nb;
+    mean += delta_n * nb;
+    count = n;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+double Moments::variance() const {
+    return count < 2.0 ? NaN : m2 / (count - 1.0);
+}
+
+double Moments::skewness() const {
+    if (count < 2.0) return NaN;
+    if (m2 == 0.0) return 0.0;
+    return std::sqrt(count) * m3 / std::pow(m2, 1.5);
+}
+
+void MomentAccumulator::add(const DenseMatrix& batch, const char* function) {
+    if (batch.data.empty()) return;
+
+    switch (axis_) {
+    case Axis::ALL: {
+        if (moments_.empty()) moments_.resize(1);
+        const size_t total = batch.data.size();
+        const size_t pieces = chunk_count(total, 1, PARALLEL_CHUNK_ELEMENTS);
+        const size_t per_piece = (total + pieces - 1) / pieces;
+        std::vector<Moments> partial(pieces);
+        parallel_for(pieces, [&](size_t p) {
+            size_t end = std::min(total, (p + 1) * per_piece);
+            for (size_t i = p * per_piece; i < end; ++i) {
+                partial[p].add(batch.data[i]);
+            }
+        });
+        // Merged in a fixed order so results do not depend on scheduling
+        for (const Moments& m : partial) moments_[0].merge(m);
+        break;
+    }
+    case Axis::COLUMNS: {
+        if (moments_.empty()) moments_.resize(batch.cols);
+        if (moments_.size() != batch.cols) {
+            throw std::invalid_argument(std::string(function) + "() batch has " + std::to_string(batch.cols) +
+                                        " columns, accumulator expects " + std::to_string(moments_.size()));
+        }
+        // Row-major rows update every column's accumulator in one sweep
+        const size_t pieces = chunk_count(batch.rows, batch.cols, PARALLEL_CHUNK_ELEMENTS);
+        const size_t per_piece = (batch.rows + pieces - 1) / pieces;
+        std::vector<std::vector<Moments>> partial(pieces, std::vector<Moments>(batch.cols));
+        parallel_for(pieces, [&](size_t p) {
+            std::vector<Moments>& local = partial[p];
+            size_t end = std::min(batch.rows, (p + 1) * per_piece);
+            for (size_t i = p * per_piece; i < end; ++i) {
+                const double* row = batch.row(i);
+                for (size_t j = 0; j < batch.cols; ++j) {
+                    local[j].add(row[j]);
+                }
+            }
+        });
+        for (const auto& local : partial) {
+            for (size_t j = 0; j < batch.cols; ++j) moments_[j].merge(local[j]);
+        }
+        break;
+    }
+    case Axis::ROWS: {
+        if (moments_.empty()) moments_.resize(batch.rows);
+        if (moments_.size() != batch.rows) {
+            throw std::invalid_argument(std::string(function) + "() batch has " + std::to_string(batch.rows) +
+                                        " rows, accumulator expects " + std::to_string(moments_.size()));
+        }
+        const size_t pieces = chunk_count(batch.rows, batch.cols, PARALLEL_CHUNK_ELEMENTS);
+        const size_t per_piece = (batch.rows + pieces - 1) / pieces;
+        parallel_for(pieces, [&](size_t p) {
+            size_t end = std::min(batch.rows, (p + 1) * per_piece);
+            for (size_t i = p * per_piece; i < end; ++i) {
+                Moments local;
+                const double* row = batch.row(i);
+                for (size_t j = 0; j < batch.cols; ++j) local.add(row[j]);
+                moments_[i].merge(local);
+            }
+        });
+        break;
+    }
+    }
+}
+
+DenseMatrix MomentAccumulator::summary() const {
+    size_t k = moments_.empty() ? 1 : moments_.size();
+    DenseMatrix result(STATS_ROWS, k, NaN);
+    for (size_t j = 0; j < k; ++j) {
+        Moments m = moments_.empty() ? Moments() : moments_[j];
+        result(0, j) = m.count;
+        if (m.count == 0.0) continue;
+        result(1, j) = m.mean;
+        result(2, j) = m.variance();
+        result(3, j) = m.skewness();
+        result(4, j) = m.min;
+        result(5, j) = m.max;
+    }
+    return result;
+}
+
+Histogram::Histogram(size_t bins, double lo, double hi)
+    : lo_(lo), hi_(hi), below_(0), above_(0), nan_(0) {
+    check_bins(bins);
+    if (!std::isfinite(lo) || !std::isfinite(hi) || !(lo < hi)) {
+        throw std::invalid_argument("histogram() range must be finite with lo < hi");
+    }
+    counts_.assign(bins, 0);
+}
+
+void Histogram::add_serial(const double* data, size_t count) {
+    const size_t bins = counts_.size();
+    const double scale = static_cast<double>(bins) / (hi_ - lo_);
+    for (size_t i = 0; i < count; ++i) {
+        double x = data[i];
+        if (std::isnan(x)) {
+            ++nan_;
+        } else if (x < lo_) {
+            ++below_;
+        } else if (x > hi_) {
+            ++above_;
+        } else {
+            // The top edge belongs to the last bin
+            size_t bin = static_cast<size_t>((x - lo_) * scale);
+            ++counts_[std::min(bin, bins - 1)];
+        }
+    }
+}
+
+void Histogram::add(const double* data, size_t count) {
+    const size_t pieces = chunk_count(count, 1, PARALLEL_CHUNK_ELEMENTS);
+    if (pieces == 1) {
+        add_serial(data, count);
+        return;
+    }
+    // Per-thread bins avoid contended increments; they are merged once at the end
+    const unsigned threads = static_cast<unsigned>(std::min<size_t>(hardware_threads(), pieces));
+    const size_t per_thread = (count + threads - 1) / threads;
+    std::vector<Histogram> partial(threads, Histogram(counts_.size(), lo_, hi_));
+    parallel_for(threads, [&](size_t t) {
+        size_t begin = std::min(count, t * per_thread);
+        size_t end = std::min(count, begin + per_thread);
+        partial[t].add_serial(data + begin, end - begin);
+    }, threads);
+    for (const Histogram& h : partial) merge(h);
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.counts_.size() != counts_.size() || other.lo_ != lo_ || other.hi_ != hi_) {
+        throw std::invalid_argument("Cannot merge histograms with different bins");
+    }
+    for (size_t b = 0; b < counts_.size(); ++b) counts_[b] += other.counts_[b];
+    below_ += other.below_;
+    above_ += other.above_;
+    nan_ += other.nan_;
+}
+
+DenseMatrix Histogram::table() const {
+    const size_t bins = counts_.size();
+    const double width = (hi_ - lo_) / static_cast<double>(bins);
+    DenseMatrix result(bins, 3);
+    for (size_t b = 0; b < bins; ++b) {
+        result(b, 0) = lo_ + width * static_cast<double>(b);
+        result(b, 1) = b + 1 == bins ? hi_ : lo_ + width * static_cast<double>(b + 1);
+        result(b, 2) = static_cast<double>(counts_[b]);
+    }
+    return result;
+}
+
+void CovarianceAccumulator::add(const DenseMatrix& batch, const char* function) {
+    if (batch.rows == 0) return;
+    const size_t p = batch.cols;
+    if (mean_.empty()) {
+        mean_.assign(p, 0.0);
+        comoment_ = DenseMatrix(p, p, 0.0);
+    } else if (mean_.size() != p) {
+        throw std::invalid_argument(std::string(function) + "() batch has " + std::to_string(p) +
+                                    " columns, accumulator expects " + std::to_string(mean_.size()));
+    }
+
+    // Each block of rows becomes a (count, mean, co-moment) triple merged with
+    // C = Ca + Cb + (mb - ma)(mb - ma)^T na nb / n
+    std::vector<double> block_mean(p);
+    std::vector<double> delta(p);
+    DenseMatrix centered(COV_BLOCK_ROWS, p);
+    DenseMatrix negated_transpose(p, COV_BLOCK_ROWS);
+
+    for (size_t start = 0; start < batch.rows; start += COV_BLOCK_ROWS) {
+        const size_t b = std::min(COV_BLOCK_ROWS, batch.rows - start);
+
+        std::fill(block_mean.begin(), block_mean.end(), 0.0);
+        for (size_t i = 0; i < b; ++i) {
+            const double* row = batch.row(start + i);
+            for (size_t j = 0; j < p; ++j) block_mean[j] += row[j];
+        }
+        for (size_t j = 0; j < p; ++j) block_mean[j] /= static_cast<double>(b);
+
+        for (size_t i = 0; i < b; ++i) {
+            const double* row = batch.row(start + i);
+            double* out = centered.row(i);
+            for (size_t j = 0; j < p; ++j) {
+                out[j] = row[j] - block_mean[j];
+                negated_transpose(j, i) = -out[j];
+            }
+        }
+
+        const double na = count_;
+        const double nb = static_cast<double>(b);
+        const double n = na + nb;
+        const double weight = na * nb / n;
+        for (size_t j = 0; j < p; ++j) delta[j] = block_mean[j] - mean_[j];
+
+        // comoment -= (-Xc^T) Xc
+        LinAlg::gemm_subtract(p, p, b, negated_transpose.data.data(), COV_BLOCK_ROWS,
+                              centered.data.data(), p, comoment_.data.data(), p);
+        if (na > 0.0) {
+            for (size_t r = 0; r < p; ++r) {
+                double* out = comoment_.row(r);
+                double scaled = delta[r] * weight;
+                for (size_t c = 0; c < p; ++c) out[c] += scaled * delta[c];
+            }
+        }
+        for (size_t j = 0; j < p; ++j) mean_[j] += delta[j] * nb / n;
+        count_ = n;
+    }
+}
+
+DenseMatrix CovarianceAccumulator::covariance() const {
+    const size_t p = mean_.size();
+    DenseMatrix result(p, p, NaN);
+    if (count_ < 2.0) return result;
+    for (size_t i = 0; i < p * p; ++i) {
+        result.data[i] = comoment_.data[i] / (count_ - 1.0);
+    }
+    return result;
+}
+
+DenseMatrix CovarianceAccumulator::correlation() const {
+    DenseMatrix result = covariance();
+    const size_t p = result.rows;
+    // A variable with no spread has no defined correlation; 0 * inf would
+    // leave NaNs of either sign, so they are written explicitly
+    std::vector<double> scale(p);
+    for (size_t j = 0; j < p; ++j) scale[j] = result(j, j) > 0.0 ? 1.0 / std::sqrt(result(j, j)) : NaN;
+    for (size_t r = 0; r < p; ++r) {
+        for (size_t c = 0; c < p; ++c) {
+            if (std::isnan(scale[r]) || std::isnan(scale[c])) {
+                result(r, c) = NaN;
+            } else {
+                result(r, c) = r == c ? 1.0 : result(r, c) * scale[r] * scale[c];
+            }
+        }
+    }
+    return result;
+}
+
+DenseMatrix stats(const DenseMatrix& a, Axis axis) {
+    MomentAccumulator accumulator(axis);
+    accumulator.add(a);
+    return accumulator.summary();
+}
+
+DenseMatrix histogram(const DenseMatrix& a, size_t bins) {
+    check_bins(bins);
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -lo;
+    for (double x : a.data) {
+        if (std::isnan(x)) continue;
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+    }
+    if (a.data.empty()) {
+        lo = 0.0;
+        hi = 1.0;
+    }
+    if (!std::isfinite(lo) || !std::isfinite(hi)) {
+        throw std::invalid_argument("histogram() requires finite data when no range is given");
+    }
+    // A constant sample still needs a non-empty range
+    if (lo == hi) {
+        lo -= 0.5;
+        hi += 0.5;
+    }
+    Histogram result(bins, lo, hi);
+    result.add(a.data.data(), a.data.size());
+    return result.table();
+}
+
+DenseMatrix covariance(const DenseMatrix& a) {
+    CovarianceAccumulator accumulator;
+    accumulator.add(a);
+    return accumulator.covariance();
+}
+
+DenseMatrix correlation(const DenseMatrix& a) {
+    CovarianceAccumulator accumulator;
+    accumulator.add(a);
+    return accumulator.correlation();
+}
+
+} // namespace Stats
+} // namespace Dakota
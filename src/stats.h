@@ -0,0 +1,127 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "linalg.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Dakota {
+namespace Stats {
+
+using LinAlg::DenseMatrix;
+
+// Constants for streaming statistics
+constexpr size_t PARALLEL_MIN_ELEMENTS = 1 << 16;  // Below this a single thread is faster
+constexpr size_t PARALLEL_CHUNK_ELEMENTS = 1 << 14; // Work item size for threaded passes
+constexpr size_t COV_BLOCK_ROWS = 256;             // Rows centered and multiplied per GEMM
+constexpr size_t STATS_ROWS = 6;                   // count, mean, variance, skewness, min, max
+
+// Running count, mean, second and third central moments, min and max.
+// Updates use Welford's recurrence; partial results combine with the
+// pairwise formulas of Chan et al. so chunks can be reduced in any grouping.
+struct Moments {
+    double count;
+    double mean;
+    double m2;
+    double m3;
+    double min;
+    double max;
+
+    Moments();
+
+    void add(double x);
+    void merge(const Moments& other);
+
+    double variance() const;   // Sample variance (n - 1 denominator), NaN for n < 2
+    double skewness() const;   // Population skewness g1, NaN for n < 2
+};
+
+// Which moments a MomentAccumulator keeps
+enum class Axis : uint8_t {
+    ALL,       // One set over every element
+    COLUMNS,   // One per column, reducing over rows (axis 0)
+    ROWS       // One per row, reducing over columns (axis 1)
+};
+
+class MomentAccumulator {
+private:
+    Axis axis_;
+    std::vector<Moments> moments_;
+
+public:
+    explicit MomentAccumulator(Axis axis = Axis::ALL) : axis_(axis) {}
+
+    // Feed a batch. For COLUMNS every batch must have the same column count,
+    // for ROWS the same row count; a mismatch is reported against function().
+    void add(const DenseMatrix& batch, const char* function = "stats");
+
+    Axis axis() const { return axis_; }
+    const std::vector<Moments>& moments() const { return moments_; }
+
+    // STATS_ROWS x k summary, one column per moment set
+    DenseMatrix summary() const;
+};
+
+// Fixed-range histogram with equal-width bins. Values outside [lo, hi] and
+// NaNs are counted separately rather than dropped silently.
+class Histogram {
+private:
+    double lo_;
+    double hi_;
+    std::vector<uint64_t> counts_;
+    uint64_t below_;
+    uint64_t above_;
+    uint64_t nan_;
+
+    void add_serial(const double* data, size_t count);
+
+public:
+    Histogram(size_t bins, double lo, double hi);
+
+    // Large inputs are split across threads with private bins merged at the end
+    void add(const double* data, size_t count);
+    void merge(const Histogram& other);
+
+    size_t bins() const { return counts_.size(); }
+    double lo() const { return lo_; }
+    double hi() const { return hi_; }
+    const std::vector<uint64_t>& counts() const { return counts_; }
+    uint64_t below() const { return below_; }
+    uint64_t above() const { return above_; }
+    uint64_t nan_count() const { return nan_; }
+
+    // bins x 3 table of [left edge, right edge, count]
+    DenseMatrix table() const;
+};
+
+// Streaming covariance of column variables over row observations. Each batch
+// is centered on its own mean and its co-moment X^T X formed with the blocked
+// GEMM kernel, then merged into the running total.
+class CovarianceAccumulator {
+private:
+    double count_;
+    std::vector<double> mean_;
+    DenseMatrix comoment_;
+
+public:
+    CovarianceAccumulator() : count_(0.0) {}
+
+    // Every batch must have the same column count; a mismatch is reported against function()
+    void add(const DenseMatrix& batch, const char* function = "cov");
+
+    double count() const { return count_; }
+    DenseMatrix covariance() const;    // n - 1 denominator
+    DenseMatrix correlation() const;   // NaN in the row and column of a constant variable
+};
+
+// One-shot conveniences
+DenseMatrix stats(const DenseMatrix& a, Axis axis);
+DenseMatrix histogram(const DenseMatrix& a, size_t bins);   // Range taken from the data
+DenseMatrix covariance(const DenseMatrix& a);
+DenseMatrix correlation(const DenseMatrix& a);
+
+} // namespace Stats
+} // namespace Dakota
+
+#endif // STATS_H
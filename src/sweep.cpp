@@ -0,0 +1,130 @@
+#include "sweep.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace Dakota {
+namespace Sweep {
+
+namespace {
+
+// Checkpoint layout, native byte order: magic, then total points, chunk
+// size and fingerprint as uint64, then each completed chunk as its uint64
+// index followed by its values
+constexpr char CHECKPOINT_MAGIC[8] = {'D', 'K', 'S', 'W', 'E', 'E', 'P', '1'};
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+void hash_bytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+}
+
+struct File {
+    std::FILE* handle;
+    explicit File(std::FILE* h) : handle(h) {}
+    ~File() { if (handle) std::fclose(handle); }
+};
+
+} // anonymous namespace
+
+size_t chunk_points(size_t total) {
+    return std::max<size_t>(1, std::min(MAX_CHUNK_POINTS, total / TARGET_CHUNKS));
+}
+
+uint64_t fingerprint(const std::string& function_name, uint64_t code, const std::vector<std::vector<double>>& grids) {
+    uint64_t hash = FNV_OFFSET;
+    hash_bytes(hash, function_name.data(), function_name.size());
+    hash_bytes(hash, &code, sizeof(code));
+    for (const auto& grid : grids) {
+        uint64_t size = grid.size();
+        hash_bytes(hash, &size, sizeof(size));
+        hash_bytes(hash, grid.data(), grid.size() * sizeof(double));
+    }
+    return hash;
+}
+
+Progress::Progress(size_t total, uint64_t fingerprint)
+    : values_(total, 0.0), chunk_points_(chunk_points(total)),
+      chunks_((total + chunk_points_ - 1) / chunk_points_), fingerprint_(fingerprint),
+      done_(new std::atomic<bool>[chunks_]) {
+    for (size_t c = 0; c < chunks_; ++c) {
+        done_[c].store(false, std::memory_order_relaxed);
+    }
+}
+
+size_t Progress::chunk_end(size_t chunk) const {
+    return std::min(values_.size(), (chunk + 1) * chunk_points_);
+}
+
+size_t Progress::done_count() const {
+    size_t count = 0;
+    for (size_t c = 0; c < chunks_; ++c) {
+        if (is_done(c)) ++count;
+    }
+    return count;
+}
+
+bool Progress::load(const std::string& path) {
+    File file(std::fopen(path.c_str(), "rb"));
+    if (!file.handle) {
+        return false;
+    }
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint64_t header[3];
+    if (std::fread(magic, 1, sizeof(magic), file.handle) != sizeof(magic) ||
+        std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        std::fread(header, sizeof(uint64_t), 3, file.handle) != 3) {
+        throw std::runtime_error("'" + path + "' is not a sweep checkpoint");
+    }
+    if (header[0] != values_.size() || header[1] != chunk_points_ || header[2] != fingerprint_) {
+        throw std::runtime_error("Checkpoint '" + path + "' belongs to a different sweep");
+    }
+
+    uint64_t chunk;
+    while (std::fread(&chunk, sizeof(chunk), 1, file.handle) == 1) {
+        if (chunk >= chunks_) {
+            throw std::runtime_error("Checkpoint '" + path + "' is corrupt");
+        }
+        size_t count = chunk_end(chunk) - chunk_begin(chunk);
+        if (std::fread(values_.data() + chunk_begin(chunk), sizeof(double), count, file.handle) != count) {
+            throw std::runtime_error("Checkpoint '" + path + "' is truncated");
+        }
+        mark_done(chunk);
+    }
+    return true;
+}
+
+void Progress::save(const std::string& path) const {
+    std::string temporary = path + ".tmp";
+    {
+        File file(std::fopen(temporary.c_str(), "wb"));
+        if (!file.handle) {
+            throw std::runtime_error("Cannot write checkpoint '" + temporary + "'");
+        }
+        uint64_t header[3] = {values_.size(), chunk_points_, fingerprint_};
+        bool written = std::fwrite(CHECKPOINT_MAGIC, 1, sizeof(CHECKPOINT_MAGIC), file.handle) ==
+                           sizeof(CHECKPOINT_MAGIC) &&
+                       std::fwrite(header, sizeof(uint64_t), 3, file.handle) == 3;
+        for (uint64_t chunk = 0; written && chunk < chunks_; ++chunk) {
+            if (!is_done(chunk)) continue;
+            size_t count = chunk_end(chunk) - chunk_begin(chunk);
+            written = std::fwrite(&chunk, sizeof(chunk), 1, file.handle) == 1 &&
+                      std::fwrite(values_.data() + chunk_begin(chunk), sizeof(double), count, file.handle) == count;
+        }
+        if (!written || std::fflush(file.handle) != 0) {
+            throw std::runtime_error("Cannot write checkpoint '" + temporary + "'");
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace checkpoint '" + path + "'");
+    }
+}
+
+} // namespace Sweep
+} // namespace Dakota
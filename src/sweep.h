@@ -0,0 +1,66 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Dakota {
+namespace Sweep {
+
+// Constants for parameter sweeps
+constexpr size_t MAX_CHUNK_POINTS = 64;      // Grid points handed to a worker at once
+constexpr size_t TARGET_CHUNKS = 256;        // Smaller sweeps use smaller chunks to keep workers busy
+constexpr double CHECKPOINT_SECONDS = 5.0;   // Least time between checkpoint writes
+
+// Points per chunk for a sweep of total points. Depends on nothing else, so
+// a checkpoint can be resumed with any number of threads.
+size_t chunk_points(size_t total);
+
+// Identifies one sweep in its checkpoint: the function name, a hash of its
+// code and every grid value
+uint64_t fingerprint(const std::string& function_name, uint64_t code, const std::vector<std::vector<double>>& grids);
+
+// Results of a sweep in row-major grid order, preallocated, and which chunks
+// of them are complete. Workers fill disjoint chunks and mark them done;
+// save() may run concurrently and writes only chunks already marked.
+class Progress {
+public:
+    Progress(size_t total, uint64_t fingerprint);
+
+    size_t total() const { return values_.size(); }
+    size_t chunk_count() const { return chunks_; }
+    size_t chunk_begin(size_t chunk) const { return chunk * chunk_points_; }
+    size_t chunk_end(size_t chunk) const;
+
+    double* values() { return values_.data(); }
+    const std::vector<double>& results() const { return values_; }
+
+    bool is_done(size_t chunk) const { return done_[chunk].load(std::memory_order_acquire); }
+    void mark_done(size_t chunk) { done_[chunk].store(true, std::memory_order_release); }
+    size_t done_count() const;
+
+    // Restore completed chunks from a checkpoint. Returns false if there is
+    // no file; throws std::runtime_error if it is unreadable or belongs to
+    // a different sweep.
+    bool load(const std::string& path);
+
+    // Write the completed chunks to path, replacing it atomically.
+    // Throws std::runtime_error if the file cannot be written.
+    void save(const std::string& path) const;
+
+private:
+    std::vector<double> values_;
+    size_t chunk_points_;
+    size_t chunks_;
+    uint64_t fingerprint_;
+    std::unique_ptr<std::atomic<bool>[]> done_;
+};
+
+} // namespace Sweep
+} // namespace Dakota
+
+#endif // SWEEP_H
@@ -0,0 +1,483 @@
+#include "units.h"
+#include "parser.h"
+#include <cmath>
+
+namespace Dakota {
+
+namespace {
+
+const char* const BASE_NAMES[UNIT_BASE_COUNT] = {"m", "kg", "s", "A", "K", "mol", "cd"};
+const size_t DISPLAY_ORDER[UNIT_BASE_COUNT] = {1, 0, 2, 3, 4, 5, 6};   // kg*m/s**2, as usually written
+
+Unit make_unit(double factor, int m, int kg = 0, int s = 0, int a = 0, int k = 0, int mol = 0, int cd = 0) {
+    Unit unit;
+    unit.factor = factor;
+    unit.dimension.exponents = {static_cast<int8_t>(m), static_cast<int8_t>(kg), static_cast<int8_t>(s),
+                                static_cast<int8_t>(a), static_cast<int8_t>(k), static_cast<int8_t>(mol),
+                                static_cast<int8_t>(cd)};
+    return unit;
+}
+
+const std::unordered_map<std::string, Unit>& unit_table() {
+    static const std::unordered_map<std::string, Unit> table = {
+        // Length
+        {"m", make_unit(1.0, 1)}, {"km", make_unit(1e3, 1)}, {"cm", make_unit(1e-2, 1)},
+        {"mm", make_unit(1e-3, 1)}, {"um", make_unit(1e-6, 1)}, {"nm", make_unit(1e-9, 1)},
+        {"in", make_unit(0.0254, 1)}, {"ft", make_unit(0.3048, 1)}, {"mi", make_unit(1609.344, 1)},
+        // Mass
+        {"kg", make_unit(1.0, 0, 1)}, {"g", make_unit(1e-3, 0, 1)}, {"mg", make_unit(1e-6, 0, 1)},
+        {"t", make_unit(1e3, 0, 1)}, {"lb", make_unit(0.45359237, 0, 1)},
+        // Time
+        {"s", make_unit(1.0, 0, 0, 1)}, {"ms", make_unit(1e-3, 0, 0, 1)}, {"us", make_unit(1e-6, 0, 0, 1)},
+        {"ns", make_unit(1e-9, 0, 0, 1)}, {"min", make_unit(60.0, 0, 0, 1)}, {"h", make_unit(3600.0, 0, 0, 1)},
+        {"day", make_unit(86400.0, 0, 0, 1)}, {"Hz", make_unit(1.0, 0, 0, -1)},
+        // Current, temperature, amount, luminous intensity
+        {"A", make_unit(1.0, 0, 0, 0, 1)}, {"mA", make_unit(1e-3, 0, 0, 0, 1)},
+        {"K", make_unit(1.0, 0, 0, 0, 0, 1)}, {"mol", make_unit(1.0, 0, 0, 0, 0, 0, 1)},
+        {"cd", make_unit(1.0, 0, 0, 0, 0, 0, 0, 1)},
+        // Derived
+        {"N", make_unit(1.0, 1, 1, -2)}, {"kN", make_unit(1e3, 1, 1, -2)},
+        {"J", make_unit(1.0, 2, 1, -2)}, {"kJ", make_unit(1e3, 2, 1, -2)},
+        {"W", make_unit(1.0, 2, 1, -3)}, {"kW", make_unit(1e3, 2, 1, -3)},
+        {"Pa", make_unit(1.0, -1, 1, -2)}, {"kPa", make_unit(1e3, -1, 1, -2)},
+        {"MPa", make_unit(1e6, -1, 1, -2)}, {"bar", make_unit(1e5, -1, 1, -2)},
+        {"C", make_unit(1.0, 0, 0, 1, 1)}, {"V", make_unit(1.0, 2, 1, -3, -1)},
+        {"ohm", make_unit(1.0, 2, 1, -3, -2)}, {"L", make_unit(1e-3, 3)},
+        // Angles are dimensionless
+        {"rad", make_unit(1.0, 0)}, {"deg", make_unit(M_PI / 180.0, 0)},
+    };
+    return table;
+}
+
+// The dimension whose square is dimension, if there is one
+bool square_root(const Dimension& dimension, Dimension& root) {
+    for (size_t i = 0; i < UNIT_BASE_COUNT; ++i) {
+        if (dimension.exponents[i] % 2 != 0) {
+            return false;
+        }
+        root.exponents[i] = static_cast<int8_t>(dimension.exponents[i] / 2);
+    }
+    return true;
+}
+
+// Builtins returning their argument's unit, and builtins needing a
+// dimensionless argument
+bool keeps_unit(const std::string& name) {
+    return name == "abs" || name == "floor" || name == "ceil" || name == "round" || name == "transpose";
+}
+
+bool needs_dimensionless(const std::string& name) {
+    return name == "sin" || name == "cos" || name == "tan" || name == "exp" || name == "log";
+}
+
+} // anonymous namespace
+
+bool Dimension::dimensionless() const {
+    for (int8_t exponent : exponents) {
+        if (exponent != 0) return false;
+    }
+    return true;
+}
+
+Dimension Dimension::operator*(const Dimension& other) const {
+    Dimension result;
+    for (size_t i = 0; i < UNIT_BASE_COUNT; ++i) {
+        result.exponents[i] = static_cast<int8_t>(exponents[i] + other.exponents[i]);
+    }
+    return result;
+}
+
+Dimension Dimension::operator/(const Dimension& other) const {
+    Dimension result;
+    for (size_t i = 0; i < UNIT_BASE_COUNT; ++i) {
+        result.exponents[i] = static_cast<int8_t>(exponents[i] - other.exponents[i]);
+    }
+    return result;
+}
+
+Dimension Dimension::power(int exponent) const {
+    Dimension result;
+    for (size_t i = 0; i < UNIT_BASE_COUNT; ++i) {
+        result.exponents[i] = static_cast<int8_t>(exponents[i] * exponent);
+    }
+    return result;
+}
+
+std::string Dimension::to_string() const {
+    if (dimensionless()) {
+        return "dimensionless";
+    }
+    std::string numerator, denominator;
+    size_t denominator_terms = 0;
+    for (size_t i : DISPLAY_ORDER) {
+        int exponent = exponents[i];
+        if (exponent == 0) continue;
+        std::string& side = exponent > 0 ? numerator : denominator;
+        if (!side.empty()) side += "*";
+        side += BASE_NAMES[i];
+        if (std::abs(exponent) != 1) side += "**" + std::to_string(std::abs(exponent));
+        if (exponent < 0) ++denominator_terms;
+    }
+    if (denominator.empty()) return numerator;
+    return (numerator.empty() ? "1" : numerator) + "/" +
+           (denominator_terms > 1 ? "(" + denominator + ")" : denominator);
+}
+
+bool find_unit(std::string_view name, Unit& unit) {
+    auto it = unit_table().find(std::string(name));
+    if (it == unit_table().end()) {
+        return false;
+    }
+    unit = it->second;
+    return true;
+}
+
+UnitChecker::UnitChecker(const Parser& parser) : parser_(parser), learned_(false), error_node_(0) {
+}
+
+bool UnitChecker::run() {
+    const auto& nodes = parser_.get_nodes();
+    if (nodes.empty()) {
+        return true;
+    }
+    // Each pass may learn the units of variables assigned after they are
+    // read; an error found with partial knowledge is still an error
+    for (int pass = 0; pass < UNIT_CHECK_MAX_PASSES; ++pass) {
+        learned_ = false;
+        parameters_.clear();
+        if (!check_statements(nodes[0].first_child_index)) {
+            return false;
+        }
+        if (!learned_) {
+            break;
+        }
+    }
+    return true;
+}
+
+std::string UnitChecker::name_of(uint32_t string_index) const {
+    return std::string(parser_.get_strings().get_string(string_index));
+}
+
+bool UnitChecker::is_parameter(const std::string& name) const {
+    for (const auto& names : parameters_) {
+        if (names.count(name)) return true;
+    }
+    return false;
+}
+
+bool UnitChecker::fail(uint32_t node_index, const std::string& message) {
+    error_ = message;
+    error_node_ = node_index;
+    return false;
+}
+
+bool UnitChecker::check_statements(uint32_t first_index) {
+    const auto& nodes = parser_.get_nodes();
+    size_t visited = 0;
+    for (uint32_t current = first_index; current != 0 && current < nodes.size() && visited < nodes.size();
+         current = nodes[current].next_sibling_index, ++visited) {
+        if (!check_statement(current)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UnitChecker::check_statement(uint32_t node_index) {
+    const auto& nodes = parser_.get_nodes();
+    if (node_index == 0 || node_index >= nodes.size()) {
+        return true;
+    }
+    const ASTNode& node = nodes[node_index];
+    Inferred ignored;
+
+    switch (node.type) {
+        case NodeType::EXPRESSION_STATEMENT:
+            return infer(node.first_child_index, ignored);
+        case NodeType::IF_STATEMENT:
+            return infer(node.if_statement.condition_index, ignored) &&
+                   check_statement(node.if_statement.then_block_index) &&
+                   check_statement(node.if_statement.else_block_index);
+        case NodeType::WHILE_STATEMENT:
+            return infer(node.while_statement.condition_index, ignored) &&
+                   check_statement(node.while_statement.body_index);
+        case NodeType::FOR_STATEMENT: {
+            Inferred iterable;
+            return infer(node.for_statement.iterable_index, iterable) &&
+                   check_assignment(node.for_statement.variable_index, iterable, node_index) &&
+                   check_statement(node.for_statement.body_index);
+        }
+        case NodeType::FUNCTION_DEF: {
+            std::unordered_set<std::string> names;
+            size_t visited = 0;
+            for (uint32_t param = node.function_def.params_start_index;
+                 param != 0 && param < nodes.size() && visited < node.function_def.param_count;
+                 param = nodes[param].next_sibling_index, ++visited) {
+                names.insert(name_of(nodes[param].identifier.name_index));
+            }
+            parameters_.push_back(std::move(names));
+            bool ok = check_statement(node.function_def.body_index);
+            parameters_.pop_back();
+            return ok;
+        }
+        case NodeType::RETURN_STATEMENT:
+            return infer(node.return_statement.value_index, ignored);
+        case NodeType::BLOCK:
+        case NodeType::PROGRAM:
+            return check_statements(node.first_child_index);
+        case NodeType::IMPORT_STATEMENT:
+        case NodeType::EXTERN_DECL:
+            return true;
+        default:
+            return infer(node_index, ignored);
+    }
+}
+
+bool UnitChecker::check_assignment(uint32_t target_index, const Inferred& value, uint32_t node_index) {
+    const auto& nodes = parser_.get_nodes();
+    if (target_index == 0 || target_index >= nodes.size()) {
+        return true;
+    }
+    const ASTNode& target = nodes[target_index];
+
+    if (target.type == NodeType::IDENTIFIER) {
+        std::string name = name_of(target.identifier.name_index);
+        if (!value.known || is_parameter(name)) {
+            return true;
+        }
+        auto it = variables_.find(name);
+        if (it == variables_.end()) {
+            variables_.emplace(name, value.dimension);
+            learned_ = true;
+        } else if (it->second != value.dimension) {
+            return fail(node_index, "'" + name + "' holds " + it->second.to_string() + ", cannot assign " +
+                                    value.dimension.to_string());
+        }
+        return true;
+    }
+
+    Inferred element;
+    if (!infer(target_index, element)) {
+        return false;
+    }
+    if (element.known && value.known && element.dimension != value.dimension) {
+        return fail(node_index, "Cannot assign " + value.dimension.to_string() + " to an element holding " +
+                                element.dimension.to_string());
+    }
+    return true;
+}
+
+bool UnitChecker::infer(uint32_t node_index, Inferred& result) {
+    result = Inferred();
+    const auto& nodes = parser_.get_nodes();
+    if (node_index == 0 || node_index >= nodes.size()) {
+        return true;
+    }
+    const ASTNode& node = nodes[node_index];
+    auto annotated = parser_.get_units().find(node_index);
+
+    switch (node.type) {
+        case NodeType::INTEGER_LITERAL:
+        case NodeType::FLOAT_LITERAL: {
+            // An unannotated zero fits any unit
+            double value = node.type == NodeType::INTEGER_LITERAL ? static_cast<double>(node.integer_literal.value)
+                                                                  : node.float_literal.value;
+            if (annotated != parser_.get_units().end()) {
+                result.known = true;
+                result.dimension = annotated->second;
+            } else {
+                result.known = value != 0.0;
+            }
+            return true;
+        }
+        case NodeType::MATRIX_LITERAL: {
+            if (annotated != parser_.get_units().end()) {
+                result.known = true;
+                result.dimension = annotated->second;
+                return true;
+            }
+            if (node.matrix_literal.is_constant) {
+                const double* values = parser_.get_constants().get_matrix(node_index);
+                size_t count = static_cast<size_t>(node.matrix_literal.rows) * node.matrix_literal.cols;
+                for (size_t i = 0; values && i < count; ++i) {
+                    if (values[i] != 0.0) result.known = true;
+                }
+                return true;
+            }
+            // Elements of one unit give the matrix that unit; mixed ones are allowed, as in a state vector
+            bool first = true;
+            bool uniform = true;
+            size_t visited = 0;
+            for (uint32_t element = node.matrix_literal.elements_start_index;
+                 element != 0 && element < nodes.size() && visited < nodes.size();
+                 element = nodes[element].next_sibling_index, ++visited) {
+                Inferred inferred;
+                if (!infer(element, inferred)) return false;
+                if (!inferred.known || (!first && inferred.dimension != result.dimension)) {
+                    uniform = false;
+                }
+                result.dimension = inferred.dimension;
+                first = false;
+            }
+            result.known = !first && uniform;
+            return true;
+        }
+        case NodeType::IDENTIFIER: {
+            std::string name = name_of(node.identifier.name_index);
+            if (is_parameter(name)) return true;
+            auto it = variables_.find(name);
+            if (it != variables_.end()) {
+                result.known = true;
+                result.dimension = it->second;
+            }
+            return true;
+        }
+        case NodeType::BINARY_OP:
+            return infer_binary(node_index, result);
+        case NodeType::UNARY_OP: {
+            Inferred operand;
+            if (!infer(node.unary_op.operand_index, operand)) return false;
+            if (node.unary_op.op_type == UnaryOpType::NEGATE) result = operand;
+            return true;
+        }
+        case NodeType::ASSIGNMENT: {
+            Inferred value;
+            return infer(node.assignment.value_index, value) &&
+                   check_assignment(node.assignment.target_index, value, node_index);
+        }
+        case NodeType::MATRIX_ACCESS:
+        case NodeType::ARRAY_ACCESS: {
+            Inferred index;
+            return infer(node.array_access.object_index, result) && infer(node.array_access.index_index, index);
+        }
+        case NodeType::FUNCTION_CALL:
+            return infer_call(node_index, result);
+        default: {
+            // Strings, dicts, members and method calls: check what they contain
+            std::vector<uint32_t> children;
+            auto add_chain = [&](uint32_t start) {
+                for (uint32_t child = start; child != 0 && child < nodes.size() && children.size() < nodes.size();
+                     child = nodes[child].next_sibling_index) {
+                    children.push_back(child);
+                }
+            };
+            if (node.type == NodeType::DICT_LITERAL) {
+                add_chain(node.dict_literal.entries_start_index);
+            } else if (node.type == NodeType::METHOD_CALL) {
+                children.push_back(node.method_call.object_index);
+                add_chain(node.method_call.args_start_index);
+            } else if (node.type == NodeType::MEMBER_ACCESS) {
+                children.push_back(node.member_access.object_index);
+            }
+            Inferred ignored;
+            for (uint32_t child : children) {
+                if (!infer(child, ignored)) return false;
+            }
+            return true;
+        }
+    }
+}
+
+bool UnitChecker::infer_binary(uint32_t node_index, Inferred& result) {
+    const auto& nodes = parser_.get_nodes();
+    const ASTNode& node = nodes[node_index];
+    Inferred left, right;
+    if (!infer(node.binary_op.left_index, left) || !infer(node.binary_op.right_index, right)) {
+        return false;
+    }
+    bool both = left.known && right.known;
+
+    switch (node.binary_op.op_type) {
+        case BinaryOpType::ADD:
+        case BinaryOpType::SUB:
+            if (both && left.dimension != right.dimension) {
+                return fail(node_index, node.binary_op.op_type == BinaryOpType::ADD
+                    ? "Cannot add " + left.dimension.to_string() + " and " + right.dimension.to_string()
+                    : "Cannot subtract " + right.dimension.to_string() + " from " + left.dimension.to_string());
+            }
+            result = left.known ? left : right;
+            return true;
+        case BinaryOpType::MUL:
+        case BinaryOpType::MATMUL:
+        case BinaryOpType::DIV:
+            if (both) {
+                result.known = true;
+                result.dimension = node.binary_op.op_type == BinaryOpType::DIV ? left.dimension / right.dimension
+                                                                                : left.dimension * right.dimension;
+            }
+            return true;
+        case BinaryOpType::POW: {
+            if (right.known && !right.dimension.dimensionless()) {
+                return fail(node_index, "Exponents must be dimensionless, got " + right.dimension.to_string());
+            }
+            if (!left.known || left.dimension.dimensionless()) {
+                result = left;
+                return true;
+            }
+            // A dimensional base needs a literal integer exponent
+            const ASTNode* exponent = &nodes[node.binary_op.right_index];
+            bool negative = exponent->type == NodeType::UNARY_OP && exponent->unary_op.op_type == UnaryOpType::NEGATE;
+            if (negative) exponent = &nodes[exponent->unary_op.operand_index];
+            if (exponent->type != NodeType::INTEGER_LITERAL || std::abs(exponent->integer_literal.value) > 9) {
+                return fail(node_index, "Cannot raise " + left.dimension.to_string() +
+                                        " to anything but a small integer literal");
+            }
+            int power = static_cast<int>(exponent->integer_literal.value);
+            result.known = true;
+            result.dimension = left.dimension.power(negative ? -power : power);
+            return true;
+        }
+        case BinaryOpType::EQ:
+        case BinaryOpType::NE:
+        case BinaryOpType::LT:
+        case BinaryOpType::LE:
+        case BinaryOpType::GT:
+        case BinaryOpType::GE:
+            if (both && left.dimension != right.dimension) {
+                return fail(node_index, "Cannot compare " + left.dimension.to_string() + " and " +
+                                        right.dimension.to_string());
+            }
+            return true;
+        default:
+            return true;
+    }
+}
+
+bool UnitChecker::infer_call(uint32_t node_index, Inferred& result) {
+    const auto& nodes = parser_.get_nodes();
+    const ASTNode& node = nodes[node_index];
+    std::string name = name_of(node.function_call.name_index);
+
+    std::vector<Inferred> args;
+    size_t visited = 0;
+    for (uint32_t arg = node.function_call.args_start_index;
+         arg != 0 && arg < nodes.size() && visited < node.function_call.arg_count;
+         arg = nodes[arg].next_sibling_index, ++visited) {
+        args.emplace_back();
+        if (!infer(arg, args.back())) return false;
+    }
+    if (args.size() != 1) {
+        return true;
+    }
+    const Inferred& arg = args[0];
+
+    if (keeps_unit(name)) {
+        result = arg;
+    } else if (name == "sqrt") {
+        if (arg.known && !square_root(arg.dimension, result.dimension)) {
+            return fail(node_index, "Cannot take the square root of " + arg.dimension.to_string());
+        }
+        result.known = arg.known;
+    } else if (needs_dimensionless(name)) {
+        if (arg.known && !arg.dimension.dimensionless()) {
+            return fail(node_index, name + " expects a dimensionless argument, got " + arg.dimension.to_string());
+        }
+        result.known = true;
+    } else if (name == "len") {
+        result.known = true;
+    }
+    return true;
+}
+
+} // namespace Dakota
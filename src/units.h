@@ -0,0 +1,91 @@
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Dakota {
+
+class Parser;
+
+// Constants for units of measurement
+constexpr size_t UNIT_BASE_COUNT = 7;          // m, kg, s, A, K, mol, cd
+constexpr int UNIT_CHECK_MAX_PASSES = 8;       // Variables learn their units over repeated passes
+constexpr double UNIT_MAX_EXACT_INTEGER = 9007199254740992.0;  // 2^53; larger converted integers become floats
+
+// A physical dimension as exponents of the SI base units. Dimensions exist
+// only while a program is checked; values carry none at runtime.
+struct Dimension {
+    std::array<int8_t, UNIT_BASE_COUNT> exponents{};
+
+    bool dimensionless() const;
+    Dimension operator*(const Dimension& other) const;
+    Dimension operator/(const Dimension& other) const;
+    Dimension power(int exponent) const;
+    bool operator==(const Dimension& other) const { return exponents == other.exponents; }
+    bool operator!=(const Dimension& other) const { return exponents != other.exponents; }
+
+    // In base units, e.g. "kg*m/s**2", or "dimensionless"
+    std::string to_string() const;
+};
+
+// A named unit: the factor converting it to SI base units, and its dimension
+struct Unit {
+    double factor = 1.0;
+    Dimension dimension;
+};
+
+// Looks up a unit name such as "km" or "N". Returns false for unknown names.
+bool find_unit(std::string_view name, Unit& unit);
+
+// Checks the units of a parsed program. Annotated literals have already been
+// converted to SI by the parser; this pass infers the dimension of every
+// expression from them and rejects adding, subtracting, comparing or
+// assigning values of different dimensions, and passing dimensional values
+// to functions such as sin and exp. It is flow-insensitive, as variables keep
+// one unit for the whole program. Values it cannot follow (parameters,
+// function results, list elements, unannotated zeros) are unknown and never
+// cause errors.
+class UnitChecker {
+public:
+    explicit UnitChecker(const Parser& parser);
+
+    // Returns false, with error() and error_node() set, on the first mismatch
+    bool run();
+
+    const std::string& error() const { return error_; }
+    uint32_t error_node() const { return error_node_; }
+
+private:
+    struct Inferred {
+        bool known = false;
+        Dimension dimension;
+    };
+
+    const Parser& parser_;
+    std::unordered_map<std::string, Dimension> variables_;
+    std::vector<std::unordered_set<std::string>> parameters_;   // Of each enclosing function
+    bool learned_;
+    std::string error_;
+    uint32_t error_node_;
+
+    std::string name_of(uint32_t string_index) const;
+    bool is_parameter(const std::string& name) const;
+    bool fail(uint32_t node_index, const std::string& message);
+    bool check_statements(uint32_t first_index);
+    bool check_statement(uint32_t node_index);
+    bool check_assignment(uint32_t target_index, const Inferred& value, uint32_t node_index);
+    bool infer(uint32_t node_index, Inferred& result);
+    bool infer_binary(uint32_t node_index, Inferred& result);
+    bool infer_call(uint32_t node_index, Inferred& result);
+};
+
+} // namespace Dakota
+
+#endif // UNITS_H
@@ -0,0 +1,72 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Runs `loop` with range analysis on or off and returns the wall time in
+// milliseconds. Loop idioms are disabled so every access goes through the
+// interpreter.
+double run_loop(const std::string& setup, const std::string& loop, bool range_analysis, Dakota::Value& result) {
+    std::string code = setup + "\n" + loop;
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    interpreter.set_loop_idioms(false);
+    interpreter.set_range_analysis(range_analysis);
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    result = interpreter.get_global_environment()->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string list_setup(int n) {
+    return "n = " + std::to_string(n) + "\nxs = list()\nys = list()\ni = 0\nwhile i < n:\n"
+           "    append(xs, i * 0.5)\n    append(ys, 0.0)\n    i = i + 1";
+}
+
+std::string matrix_setup(int rows) {
+    return "m = zeros(" + std::to_string(rows) + ", 8)\nresult = zeros(1, 8)";
+}
+
+int main() {
+    std::cout << "Range Analysis Benchmark (indexed loops, checked vs proven)\n";
+    std::cout << "===========================================================\n";
+
+    const std::pair<const char*, const char*> list_loops[] = {
+        {"stencil", "i = 1\nwhile i < n - 1:\n    ys[i] = (xs[i - 1] + xs[i] + xs[i + 1]) / 3\n    i = i + 1\nresult = ys[100]"},
+        {"reverse", "i = 0\nwhile i < len(xs):\n    ys[i] = xs[len(xs) - 1 - i]\n    i = i + 1\nresult = ys[0]"},
+    };
+
+    const int n = 200000;
+    for (const auto& loop : list_loops) {
+        Dakota::Value proven_result, checked_result;
+        double checked_ms = run_loop(list_setup(n), loop.second, false, checked_result);
+        double proven_ms = run_loop(list_setup(n), loop.second, true, proven_result);
+        bool same = (proven_result == checked_result).is_truthy();
+        std::cout << "  " << loop.first << " (" << n << " elements): checked " << checked_ms << " ms, proven "
+                  << proven_ms << " ms (" << checked_ms / proven_ms << "x)" << (same ? "" : "  RESULT MISMATCH") << "\n";
+    }
+
+    // Indexing a matrix variable copies it on the checked path
+    const char* row_loop = "k = 0\nwhile k < len(m):\n    result = result + m[k]\n    k = k + 1";
+    for (int rows : {1000, 4000}) {
+        Dakota::Value proven_result, checked_result;
+        double checked_ms = run_loop(matrix_setup(rows), row_loop, false, checked_result);
+        double proven_ms = run_loop(matrix_setup(rows), row_loop, true, proven_result);
+        bool same = (proven_result == checked_result).is_truthy();
+        std::cout << "  row sum (" << rows << " x 8): checked " << checked_ms << " ms, proven "
+                  << proven_ms << " ms (" << checked_ms / proven_ms << "x)" << (same ? "" : "  RESULT MISMATCH") << "\n";
+    }
+
+    return 0;
+}
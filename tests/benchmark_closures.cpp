@@ -0,0 +1,94 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+
+// Resident set size in MB, from /proc/self/statm
+double resident_mb() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+// Runs a Dakota program and returns the wall time in milliseconds. The
+// interpreter stays alive until the resident size has been sampled, so
+// anything still reachable from a closure is counted in `growth_mb`.
+double run_program(const std::string& code, Dakota::Value& result, double& growth_mb) {
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    double before = resident_mb();
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    growth_mb = resident_mb() - before;
+    result = interpreter.get_global_environment()->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Each closure is made in a call that was passed an 8 MB matrix it never uses
+std::string retention_program(int closures) {
+    return R"(pool_cap(0)
+function make(k, data):
+    function scale(x):
+        return x * k
+    return scale
+fs = list()
+i = 0
+while i < )" + std::to_string(closures) + R"(:
+    append(fs, make(i, zeros(1, 1000000)))
+    i = i + 1
+result = len(fs))";
+}
+
+// The called function is defined four loop scopes deep inside another call
+std::string lookup_program(int calls) {
+    return R"(g = 1
+function outer(d):
+    total = 0
+    for a in list(0):
+        for b in list(0):
+            for c in list(0):
+                for e in list(0):
+                    function inner(x):
+                        return x * d + g + d * g + d * g + d * g
+                    i = 0
+                    while i < )" + std::to_string(calls) + R"(:
+                        total = total + inner(i)
+                        i = i + 1
+    return total
+result = outer(2))";
+}
+
+int main() {
+    std::cout << "Closure Benchmark (captured slots vs enclosing scopes)\n";
+    std::cout << "======================================================\n";
+
+    Dakota::Value value;
+    double growth_mb = 0.0;
+    for (int closures : {8, 32}) {
+        double ms = run_program(retention_program(closures), value, growth_mb);
+        std::cout << "\n" << value.to_string() << " closures over an unused 8 MB argument: "
+                  << ms << " ms, resident growth " << growth_mb << " MB\n";
+    }
+
+    for (int calls : {100000, 400000}) {
+        double ms = run_program(lookup_program(calls), value, growth_mb);
+        std::cout << "\n" << calls << " calls reading captured and global names: "
+                  << ms << " ms (" << ms * 1e6 / calls << " ns per call)\n";
+    }
+
+    return 0;
+}
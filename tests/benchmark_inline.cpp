@@ -0,0 +1,75 @@
+#include "optimizer.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Runs a Dakota program, optimized or not, and returns the wall time of
+// interpretation in milliseconds
+double run_program(const std::string& code, bool optimize, Dakota::Value& result, Dakota::OptimizerStats& stats) {
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    interpreter.set_loop_idioms(false);
+    if (optimize) {
+        stats = Dakota::Optimizer(parser, interpreter).run();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    result = interpreter.get_global_environment()->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string loop(const std::string& helpers, const std::string& body, int iterations) {
+    return helpers + "\nresult = 0\ni = 0\nwhile i < " + std::to_string(iterations) +
+           ":\n    result = " + body + "\n    i = i + 1";
+}
+
+int main() {
+    std::cout << "Inlining Benchmark (small helpers called in hot loops)\n";
+    std::cout << "======================================================\n";
+
+    const std::string helpers = R"(function sq(x):
+    return x * x
+function lerp(a, b, t):
+    return a + (b - a) * t
+function norm2(x, y):
+    return sq(x) + sq(y)
+function poly(x):
+    return 1 + x * (2 + x * 3)
+function unused(x):
+    return x)";
+
+    const std::pair<const char*, const char*> bodies[] = {
+        {"sq     ", "result + sq(i)"},
+        {"lerp   ", "result + lerp(0.0, 2.0, 0.25) * i"},
+        {"norm2  ", "result + norm2(i, 3)"},
+        {"poly   ", "result + poly(i)"},
+    };
+
+    const int iterations = 200000;
+    for (const auto& body : bodies) {
+        Dakota::Value optimized_result, plain_result;
+        Dakota::OptimizerStats stats;
+        std::string code = loop(helpers, body.second, iterations);
+        double optimized_ms = run_program(code, true, optimized_result, stats);
+        double plain_ms = run_program(code, false, plain_result, stats);
+        bool same = (optimized_result == plain_result).is_truthy();
+        std::cout << "  " << body.first << ": calls " << plain_ms << " ms, inlined " << optimized_ms << " ms ("
+                  << plain_ms / optimized_ms << "x, " << stats.calls_inlined << " sites, "
+                  << stats.functions_removed << " functions removed)"
+                  << (same ? "" : "  RESULT MISMATCH") << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Runs a Dakota program and returns the wall time in milliseconds
+double run_program(const std::string& code, Dakota::Value& result) {
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    result = interpreter.get_global_environment()->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "Integration Benchmark (vectorized vs per-point integrand calls)\n";
+    std::cout << "==============================================================\n";
+
+    // Same oscillatory integrand twice; the 'if' keeps the second one scalar-only
+    const std::string vectorized = R"(function f(x):
+    return sin(x * 40) * exp(0 - x) + x * x
+result = integrate(f, 0, 10))";
+    const std::string scalar = R"(function f(x):
+    if x < 0:
+        return 0
+    return sin(x * 40) * exp(0 - x) + x * x
+result = integrate(f, 0, 10))";
+    const std::string cubature = R"(function f(x, y):
+    return exp(0 - x * x - y * y)
+result = integrate2(f, -2, 2, -2, 2))";
+
+    Dakota::Value value;
+    double vector_ms = run_program(vectorized, value);
+    std::cout << "\n1-D, vectorized integrand: " << vector_ms << " ms, result " << value.to_string() << "\n";
+    double scalar_ms = run_program(scalar, value);
+    std::cout << "1-D, scalar integrand:     " << scalar_ms << " ms, result " << value.to_string() << "\n";
+    std::cout << "  speedup: " << scalar_ms / vector_ms << "x\n";
+
+    double cubature_ms = run_program(cubature, value);
+    std::cout << "\n2-D Gaussian on [-2,2]^2:  " << cubature_ms << " ms, result " << value.to_string() << "\n";
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Identifier-heavy code: long names, keywords and calls on every line
+std::string generate_identifier_heavy_code(int lines) {
+    std::string code;
+    for (int i = 0; i < lines; i++) {
+        std::string n = std::to_string(i % 97);
+        code += "function update_state_" + n + "(position_x, velocity_x, time_step):\n";
+        code += "    if position_x > boundary_limit and not is_frozen:\n";
+        code += "        return position_x + velocity_x * time_step\n";
+        code += "    elif velocity_x <= minimum_speed or is_stopped:\n";
+        code += "        return position_x\n";
+        code += "    else:\n";
+        code += "        return clamp_value(position_x, lower_bound, upper_bound)\n";
+        code += "while iteration_count < max_iterations:\n";
+        code += "    total_energy = total_energy + kinetic_energy(mass_value, velocity_x) ** 2\n";
+        code += "    iteration_count = iteration_count + 1\n";
+    }
+    return code;
+}
+
+// Numeric tables and operators
+std::string generate_numeric_code(int lines) {
+    std::string code;
+    for (int i = 0; i < lines; i++) {
+        code += "row_" + std::to_string(i) + " = [" + std::to_string(i) + ", -2.5e-3, 3.75; 4, 5, 6] != [1, 2, 3; 4, 5, 6]\n";
+    }
+    return code;
+}
+
+// Token count of one pass: the whole token vector, or only the lexer core
+// when streaming with next_token (no indentation tokens, nothing kept)
+size_t lex(const std::string& code, bool streaming) {
+    Dakota::Lexer lexer(code);
+    if (!streaming) {
+        return lexer.tokenize().size();
+    }
+    size_t count = 1;
+    while (lexer.next_token().type != Dakota::TokenType::EOF_TOKEN) {
+        count++;
+    }
+    return count;
+}
+
+void benchmark_lexing(const std::string& description, const std::string& code, bool streaming) {
+    // Warm up
+    for (int i = 0; i < 3; i++) {
+        lex(code, streaming);
+    }
+
+    // Best of several runs, the machine's noise only ever adds time
+    size_t token_count = 0;
+    double ms = 0.0;
+    for (int i = 0; i < 10; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        token_count = lex(code, streaming);
+        auto end = std::chrono::high_resolution_clock::now();
+        double run_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (i == 0 || run_ms < ms) ms = run_ms;
+    }
+
+    std::cout << "  " << description << ": " << token_count << " tokens, " << ms << " ms, "
+              << (code.length() / (1024.0 * 1024.0)) / (ms / 1000.0) << " MB/s, "
+              << token_count / (ms / 1000.0) / 1e6 << " M tokens/s\n";
+}
+
+int main() {
+    std::cout << "Lexer Benchmark (table-driven dispatch, perfect-hash keywords)\n";
+    std::cout << "==============================================================\n";
+
+    std::string identifiers = generate_identifier_heavy_code(5000);
+    std::string numbers = generate_numeric_code(20000);
+    benchmark_lexing("identifiers, tokenize   ", identifiers, false);
+    benchmark_lexing("identifiers, next_token ", identifiers, true);
+    benchmark_lexing("numbers, tokenize       ", numbers, false);
+    benchmark_lexing("numbers, next_token     ", numbers, true);
+
+    return 0;
+}
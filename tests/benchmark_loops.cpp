@@ -0,0 +1,74 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Float list of n elements, xs[k] = k * step
+Dakota::Value float_list(long n, double step) {
+    auto list = std::make_shared<Dakota::List>();
+    list->reserve(static_cast<size_t>(n));
+    for (long k = 0; k < n; ++k) {
+        list->append(Dakota::Value(k * step));
+    }
+    return Dakota::Value(list);
+}
+
+// Runs `loop` over fresh lists xs and ys of n floats and returns the wall
+// time in milliseconds. The lists are built natively so only the loop is timed.
+double run_loop(const std::string& loop, long n, bool loop_idioms, Dakota::Value& result) {
+    std::string code = loop + "\nresult = s + ys[n - 1]";
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    interpreter.set_loop_idioms(loop_idioms);
+    auto env = interpreter.get_global_environment();
+    env->define("n", Dakota::Value(static_cast<int64_t>(n)));
+    env->define("xs", float_list(n, 0.001));
+    env->define("ys", float_list(n, 0.0));
+    env->define("s", Dakota::Value(0.0));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    result = env->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    std::cout << "Loop Idiom Benchmark (element loops over float lists)\n";
+    std::cout << "=====================================================\n";
+
+    const std::pair<const char*, const char*> loops[] = {
+        {"fill", "i = 0\nwhile i < n:\n    ys[i] = 1.5\n    i = i + 1"},
+        {"copy", "i = 0\nwhile i < n:\n    ys[i] = xs[i]\n    i = i + 1"},
+        {"axpy", "i = 0\nwhile i < n:\n    ys[i] = ys[i] + 0.5 * xs[i]\n    i = i + 1"},
+        {"map ", "i = 0\nwhile i < n:\n    ys[i] = sqrt(xs[i]) * 2 - xs[i] / 3\n    i = i + 1"},
+        {"sum ", "i = 0\nwhile i < n:\n    s = s + xs[i]\n    i = i + 1"},
+        {"dot ", "i = 0\nwhile i < n:\n    s = s + xs[i] * xs[i]\n    i = i + 1"},
+        {"scan", "i = 1\nwhile i < n:\n    ys[i] = ys[i - 1] + xs[i]\n    i = i + 1"},
+    };
+
+    for (long n : {10000L, 1000000L}) {
+        std::cout << "\n" << n << " elements\n";
+        for (const auto& loop : loops) {
+            Dakota::Value native_result, interpreted_result;
+            double native_ms = run_loop(loop.second, n, true, native_result);
+            double interpreted_ms = run_loop(loop.second, n, false, interpreted_result);
+            bool same = (native_result == interpreted_result).is_truthy();
+            std::cout << "  " << loop.first << ": interpreted " << interpreted_ms << " ms, kernel "
+                      << native_ms << " ms (" << interpreted_ms / native_ms << "x)"
+                      << (same ? "" : "  RESULT MISMATCH") << "\n";
+        }
+    }
+
+    return 0;
+}
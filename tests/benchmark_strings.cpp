@@ -0,0 +1,66 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Runs a Dakota program and returns the wall time in milliseconds
+double run_program(const std::string& code, Dakota::Value& result) {
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return 0.0;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    result = interpreter.get_global_environment()->get("result");
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Appends `lines` lines of 1 KiB each. With `shared` a second variable holds
+// the report at every step, so each append has to copy it first.
+std::string report_program(long lines, bool shared) {
+    std::string code = R"(line = "x"
+i = 0
+while i < 10:
+    line = line + line
+    i = i + 1
+report = ""
+i = 0
+while i < )" + std::to_string(lines) + R"(:
+    report = report + line + "\n"
+)";
+    if (shared) {
+        code += "    snapshot = report\n";
+    }
+    code += R"(    i = i + 1
+result = len(report))";
+    return code;
+}
+
+int main() {
+    std::cout << "String Builder Benchmark (report built line by line)\n";
+    std::cout << "====================================================\n";
+
+    Dakota::Value value;
+    for (long lines : {1000L, 10000L, 100000L}) {
+        double ms = run_program(report_program(lines, false), value);
+        std::cout << "\nIn place, " << value.to_string() << " bytes: " << ms << " ms\n";
+    }
+
+    // A second reference forces copy-on-append, which is quadratic
+    std::cout << "\nShared buffer (copy per append):\n";
+    for (long lines : {1000L, 2000L, 4000L}) {
+        double ms = run_program(report_program(lines, true), value);
+        std::cout << "  " << value.to_string() << " bytes: " << ms << " ms\n";
+    }
+
+    return 0;
+}
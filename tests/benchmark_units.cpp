@@ -0,0 +1,102 @@
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+// Projectile with quadratic drag, integrated with explicit Euler steps. The
+// annotated and SI versions differ only in how their literals are written.
+const char* ANNOTATED = R"(dt = 1 [ms]
+g = 9.81 [m/s**2]
+mass = 2 [kg]
+drag = 0.02 [kg/m]
+x = 0 [m]
+y = 0 [m]
+vx = 108 [km/h]
+vy = 40 [m/s]
+t = 0 [s]
+steps = 0
+while steps < n:
+    speed = sqrt(vx * vx + vy * vy)
+    ax = -drag * speed * vx / mass
+    ay = -g - drag * speed * vy / mass
+    vx = vx + ax * dt
+    vy = vy + ay * dt
+    x = x + vx * dt
+    y = y + vy * dt
+    t = t + dt
+    steps = steps + 1
+result = x / 1 [km] + y / 1 [km] + t / 1 [min])";
+
+const char* SI = R"(dt = 0.001
+g = 9.81
+mass = 2
+drag = 0.02
+x = 0
+y = 0
+vx = 30.0
+vy = 40
+t = 0
+steps = 0
+while steps < n:
+    speed = sqrt(vx * vx + vy * vy)
+    ax = -drag * speed * vx / mass
+    ay = -g - drag * speed * vy / mass
+    vx = vx + ax * dt
+    vy = vy + ay * dt
+    x = x + vx * dt
+    y = y + vy * dt
+    t = t + dt
+    steps = steps + 1
+result = x / 1000 + y / 1000 + t / 60)";
+
+struct Timing {
+    double compile_ms = 0.0;   // Lexing and parsing, including the unit check
+    double run_ms = 0.0;
+    Dakota::Value result;
+};
+
+// One run of the script with n steps, folded into best
+void run_script(const std::string& script, int n, Timing& best) {
+    std::string code = "n = " + std::to_string(n) + "\n" + script;
+    auto start = std::chrono::high_resolution_clock::now();
+    Dakota::Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    Dakota::Parser parser(tokens);
+    parser.parse();
+    auto parsed = std::chrono::high_resolution_clock::now();
+    if (parser.has_error()) {
+        std::cerr << "Parse error: " << parser.get_error() << "\n";
+        return;
+    }
+
+    Dakota::Interpreter interpreter(parser);
+    interpreter.interpret();
+    auto end = std::chrono::high_resolution_clock::now();
+    best.compile_ms = std::min(best.compile_ms, std::chrono::duration<double, std::milli>(parsed - start).count());
+    best.run_ms = std::min(best.run_ms, std::chrono::duration<double, std::milli>(end - parsed).count());
+    best.result = interpreter.get_global_environment()->get("result");
+}
+
+int main() {
+    std::cout << "Units Benchmark (kinematics with unit annotations vs plain SI)\n";
+    std::cout << "==============================================================\n";
+
+    for (int n : {20000, 200000}) {
+        // Alternate the two so drift in machine load hits both alike
+        Timing annotated, si;
+        annotated.compile_ms = annotated.run_ms = si.compile_ms = si.run_ms = 1e300;
+        for (int k = 0; k < 7; ++k) {
+            run_script(SI, n, si);
+            run_script(ANNOTATED, n, annotated);
+        }
+        bool same = (annotated.result == si.result).is_truthy();
+        std::cout << "  " << n << " steps: annotated " << annotated.run_ms << " ms, SI " << si.run_ms
+                  << " ms (" << annotated.run_ms / si.run_ms << "x); compile " << annotated.compile_ms
+                  << " ms vs " << si.compile_ms << " ms" << (same ? "" : "  RESULT MISMATCH") << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Plugin for the plugin loading tests, built as bin/libdakota_example_plugin.so
+#include "dakota_plugin.h"
+#include <cmath>
+
+namespace {
+
+const dakota_host_api* host = nullptr;
+
+// norm2(x): Euclidean norm of a matrix
+int norm2(dakota_call*, const dakota_value* args, int32_t, dakota_value* result) {
+    double sum = 0.0;
+    for (int64_t i = 0; i < args[0].rows * args[0].cols; ++i) {
+        sum += args[0].data[i] * args[0].data[i];
+    }
+    result->type = DAKOTA_TYPE_FLOAT;
+    result->real = std::sqrt(sum);
+    return 0;
+}
+
+// axpy(a, x, y): a*x + y, written into a host buffer
+int axpy(dakota_call* call, const dakota_value* args, int32_t, dakota_value* result) {
+    const dakota_value& x = args[1];
+    const dakota_value& y = args[2];
+    if (x.rows != y.rows || x.cols != y.cols) {
+        host->set_error(call, "x and y must have the same shape");
+        return 1;
+    }
+    double* out = host->new_matrix(call, x.rows, x.cols);
+    for (int64_t i = 0; i < x.rows * x.cols; ++i) {
+        out[i] = args[0].real * x.data[i] + y.data[i];
+    }
+    result->type = DAKOTA_TYPE_MATRIX;
+    result->data = out;
+    result->rows = x.rows;
+    result->cols = x.cols;
+    return 0;
+}
+
+// host_ones(rows, cols): a host buffer of ones, or an error if the host cannot provide one
+int host_ones(dakota_call* call, const dakota_value* args, int32_t, dakota_value* result) {
+    double* out = host->new_matrix(call, args[0].integer, args[1].integer);
+    if (!out) {
+        host->set_error(call, "no buffer of that size");
+        return 1;
+    }
+    for (int64_t i = 0; i < args[0].integer * args[1].integer; ++i) out[i] = 1.0;
+    result->type = DAKOTA_TYPE_MATRIX;
+    result->data = out;
+    result->rows = args[0].integer;
+    result->cols = args[1].integer;
+    return 0;
+}
+
+// total(...): sum of any mix of numbers and matrices
+int total(dakota_call*, const dakota_value* args, int32_t argc, dakota_value* result) {
+    double sum = 0.0;
+    for (int32_t k = 0; k < argc; ++k) {
+        if (args[k].type == DAKOTA_TYPE_INT) {
+            sum += static_cast<double>(args[k].integer);
+        } else if (args[k].type == DAKOTA_TYPE_FLOAT) {
+            sum += args[k].real;
+        } else {
+            for (int64_t i = 0; i < args[k].rows * args[k].cols; ++i) sum += args[k].data[i];
+        }
+    }
+    result->type = DAKOTA_TYPE_FLOAT;
+    result->real = sum;
+    return 0;
+}
+
+// abs(x): replaces the builtin for numbers; matrices are an error
+int plugin_abs(dakota_call* call, const dakota_value* args, int32_t, dakota_value* result) {
+    if (args[0].type == DAKOTA_TYPE_INT) {
+        result->type = DAKOTA_TYPE_INT;
+        result->integer = args[0].integer < 0 ? -args[0].integer : args[0].integer;
+    } else if (args[0].type == DAKOTA_TYPE_FLOAT) {
+        result->type = DAKOTA_TYPE_FLOAT;
+        result->real = std::fabs(args[0].real);
+    } else {
+        host->set_error(call, "matrices are not supported");
+        return 1;
+    }
+    return 0;
+}
+
+const int32_t NORM2_TYPES[] = {DAKOTA_TYPE_MATRIX};
+const int32_t AXPY_TYPES[] = {DAKOTA_TYPE_FLOAT, DAKOTA_TYPE_MATRIX, DAKOTA_TYPE_MATRIX};
+const int32_t HOST_ONES_TYPES[] = {DAKOTA_TYPE_INT, DAKOTA_TYPE_INT};
+
+const dakota_function FUNCTIONS[] = {
+    {"norm2", norm2, 1, 1, NORM2_TYPES, DAKOTA_TYPE_FLOAT, "Euclidean norm"},
+    {"axpy", axpy, 3, 3, AXPY_TYPES, DAKOTA_TYPE_MATRIX, "a*x + y"},
+    {"host_ones", host_ones, 2, 2, HOST_ONES_TYPES, DAKOTA_TYPE_MATRIX, "rows x cols matrix of ones"},
+    {"total", total, 0, -1, nullptr, DAKOTA_TYPE_FLOAT, "Sum of numbers and matrix entries"},
+    {"abs", plugin_abs, 1, 1, nullptr, DAKOTA_TYPE_ANY, "Absolute value of a number"},
+};
+
+const dakota_plugin PLUGIN = {DAKOTA_PLUGIN_ABI_VERSION, "example", FUNCTIONS,
+                              sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0])};
+
+} // anonymous namespace
+
+extern "C" const dakota_plugin* dakota_plugin_init(const dakota_host_api* api) {
+    if (api->abi_version != DAKOTA_PLUGIN_ABI_VERSION) {
+        return nullptr;
+    }
+    host = api;
+    return &PLUGIN;
+}
@@ -0,0 +1,32 @@
+// Kernels for the extern function tests, built as bin/libextern_kernels.so
+#include <cstdint>
+
+extern "C" {
+
+void scale(double* a, int64_t n, double factor) {
+    for (int64_t i = 0; i < n; ++i) {
+        a[i] *= factor;
+    }
+}
+
+double dot(const double* a, const double* b, int64_t n) {
+    double sum = 0.0;
+    for (int64_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+int64_t count_above(const double* a, int64_t n, double threshold) {
+    int64_t count = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        if (a[i] > threshold) ++count;
+    }
+    return count;
+}
+
+double answer() {
+    return 42.0;
+}
+
+}
@@ -1,9 +1,29 @@
 #include "../src/interpreter.h"
 #include "../src/parser.h"
 #include "../src/lexer.h"
+#include "../src/sparse.h"
+#include "../src/optimizer.h"
+#include "../src/server.h"
+#include "../src/batch.h"
+#include "../src/modules.h"
+#include "../src/embed.h"
+#include "../src/plugins.h"
 #include <iostream>
 #include <cassert>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <iterator>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 void test_basic_arithmetic() {
     std::cout << "\n=== Basic Arithmetic Test ===\n";
@@ -181,6 +201,1976 @@ print(x))";
     }
 }
 
+void test_linear_solve() {
+    std::cout << "\n=== Linear Solve Test ===\n";
+    
+    std::string code = R"(A = [4, 1, 0; 1, 3, 1; 0, 1, 2]
+b = [1; 2; 3]
+x = solve(A, b)
+y = solve(A, b, "mixed"))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // Both paths must satisfy A x = b to double precision
+        auto A = env->get("A").as_matrix();
+        auto b = env->get("b").as_matrix();
+        for (const char* name : {"x", "y"}) {
+            auto x = env->get(name).as_matrix();
+            assert(x.size() == 3 && x[0].size() == 1);
+            for (size_t i = 0; i < 3; ++i) {
+                double row = 0.0;
+                for (size_t j = 0; j < 3; ++j) {
+                    row += A[i][j] * x[j][0];
+                }
+                assert(std::abs(row - b[i][0]) < 1e-12);
+            }
+        }
+        
+        std::cout << "✓ All linear solve tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_sparse_solve() {
+    std::cout << "\n=== Sparse Solve Test ===\n";
+    
+    std::string code = R"(A = [4, 1, 0, 0; 1, 4, 1, 0; 0, 1, 4, 1; 0, 0, 1, 4]
+S = sparse(A)
+T = sparse([0, 1, 2, 3, 0, 2], [0, 1, 2, 3, 3, 1], [2, 3, 4, 5, 1, 1], 4, 4)
+b = [1; 2; 3; 4]
+x = cholsolve(S, b)
+y = cholsolve(S, b, "nd")
+z = spsolve(T, b)
+w = spsolve(T, b, "natural")
+Tb = T mult z
+count = nnz(S))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::LinAlg::clear_symbolic_cache();
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        assert(env->get("count").as_integer() == 10);
+        
+        // Cholesky with either ordering must satisfy A x = b
+        auto A = env->get("A").as_matrix();
+        auto b = env->get("b").as_matrix();
+        for (const char* name : {"x", "y"}) {
+            auto x = env->get(name).as_matrix();
+            assert(x.size() == 4 && x[0].size() == 1);
+            for (size_t i = 0; i < 4; ++i) {
+                double row = 0.0;
+                for (size_t j = 0; j < 4; ++j) {
+                    row += A[i][j] * x[j][0];
+                }
+                assert(std::abs(row - b[i][0]) < 1e-12);
+            }
+        }
+        
+        // Unsymmetric LU, checked through sparse-dense multiply
+        auto Tb = env->get("Tb").as_matrix();
+        auto z = env->get("z").as_matrix();
+        auto w = env->get("w").as_matrix();
+        for (size_t i = 0; i < 4; ++i) {
+            assert(std::abs(Tb[i][0] - b[i][0]) < 1e-12);
+            assert(std::abs(z[i][0] - w[i][0]) < 1e-12);
+        }
+        
+        // Re-solving with the same pattern must reuse the symbolic analysis
+        auto before = Dakota::LinAlg::symbolic_cache_stats();
+        interpreter.interpret();
+        auto after = Dakota::LinAlg::symbolic_cache_stats();
+        assert(after.hits == before.hits + 4);
+        assert(after.misses == before.misses);
+        
+        std::cout << "✓ All sparse solve tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_matrix_functions() {
+    std::cout << "\n=== Matrix Functions Test ===\n";
+    
+    std::string code = R"(A = [1, 1; 0, 2]
+P = A ** 10
+Q = A ** -2
+R = [0, 1; -1, 0]
+E = expm(R * 10)
+S = [4, 1; 1, 3]
+H = sqrtm(S)
+HH = H mult H
+L = logm(expm(A)))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // [1 1; 0 2]^n = [1, 2^n - 1; 0, 2^n]
+        auto P = env->get("P").as_matrix();
+        assert(P[0][0] == 1.0 && P[0][1] == 1023.0 && P[1][0] == 0.0 && P[1][1] == 1024.0);
+        auto Q = env->get("Q").as_matrix();
+        assert(std::abs(Q[0][1] + 0.75) < 1e-14 && std::abs(Q[1][1] - 0.25) < 1e-14);
+        
+        // exp(10 R) is a rotation by 10 radians
+        auto E = env->get("E").as_matrix();
+        assert(std::abs(E[0][0] - std::cos(10.0)) < 1e-12);
+        assert(std::abs(E[0][1] - std::sin(10.0)) < 1e-12);
+        assert(std::abs(E[1][0] + std::sin(10.0)) < 1e-12);
+        
+        auto S = env->get("S").as_matrix();
+        auto HH = env->get("HH").as_matrix();
+        auto A = env->get("A").as_matrix();
+        auto L = env->get("L").as_matrix();
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 2; ++j) {
+                assert(std::abs(HH[i][j] - S[i][j]) < 1e-12);
+                assert(std::abs(L[i][j] - A[i][j]) < 1e-12);
+            }
+        }
+        
+        // A singular intermediate is reported as a domain problem, and overflow is not silent
+        auto error_of = [](const std::string& source) {
+            Dakota::Lexer error_lexer(source);
+            auto error_tokens = error_lexer.tokenize();
+            Dakota::Parser error_parser(error_tokens);
+            error_parser.parse();
+            assert(!error_parser.has_error());
+            std::ostringstream output, errors;
+            Dakota::Interpreter error_interpreter(error_parser);
+            error_interpreter.set_output(output, errors);
+            error_interpreter.interpret();
+            return errors.str();
+        };
+        const std::string negative_axis = "requires a matrix with no eigenvalues on the closed negative real axis";
+        assert(error_of("sqrtm([0, 0; 0, 0])").find("sqrtm() " + negative_axis) != std::string::npos);
+        assert(error_of("logm([1, 0; 0, 0])").find("logm() " + negative_axis) != std::string::npos);
+        assert(error_of("logm([-1, 0; 0, -1])").find("logm() " + negative_axis) != std::string::npos);
+        assert(error_of("print([2, 0; 0, 2] ** 100000)").find("Matrix power overflowed to a non-finite result") !=
+               std::string::npos);
+        
+        std::cout << "✓ All matrix function tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_integration() {
+    std::cout << "\n=== Integration Test ===\n";
+    
+    std::string code = R"(calls = 0
+function f(x):
+    calls = calls + 1
+    return x * x
+function g(x):
+    calls = calls + 1
+    if x < 0:
+        return 0 - x
+    return x
+function h(x, y):
+    return x * y + 1
+a = integrate(f, 0, 3)
+vector_calls = calls
+calls = 0
+b = integrate(g, 0, 2)
+scalar_calls = calls
+c = integrate(exp, 0, 1)
+d = integrate2(h, 0, 1, 0, 2)
+t = trapz([0, 1, 4, 9])
+s = simpson([0, 0.5, 1, 1.5], [0, 0.25, 1, 2.25]))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        assert(std::abs(env->get("a").as_float() - 9.0) < 1e-12);
+        assert(std::abs(env->get("b").as_float() - 2.0) < 1e-12);
+        assert(std::abs(env->get("c").as_float() - (std::exp(1.0) - 1.0)) < 1e-12);
+        assert(std::abs(env->get("d").as_float() - 3.0) < 1e-12);
+        assert(std::abs(env->get("t").as_float() - 9.5) < 1e-12);
+        assert(std::abs(env->get("s").as_float() - 1.125) < 1e-12);
+        
+        // Elementwise integrands take whole panels per call, others fall back to one point per call
+        assert(env->get("vector_calls").as_integer() <= 2);
+        assert(env->get("scalar_calls").as_integer() >= 15);
+        
+        // Each point runs once, side effects included, and the integrand's own errors come through
+        auto integrate_run = [](const std::string& program, std::ostringstream& output, std::ostringstream& errors) {
+            Dakota::Lexer program_lexer(program);
+            auto program_tokens = program_lexer.tokenize();
+            Dakota::Parser program_parser(program_tokens);
+            program_parser.parse();
+            assert(!program_parser.has_error());
+            Dakota::Interpreter program_interpreter(program_parser);
+            program_interpreter.set_output(output, errors);
+            program_interpreter.interpret();
+            return program_interpreter.get_global_environment()->get("calls").as_integer();
+        };
+        std::ostringstream noisy_output, noisy_errors;
+        int64_t noisy_calls = integrate_run("calls = 0\nfunction noisy(x):\n    calls = calls + 1\n    print(x)\n"
+                                            "    return x\nr = integrate(noisy, 0, 1)", noisy_output, noisy_errors);
+        assert(noisy_errors.str().empty());
+        std::string printed = noisy_output.str();
+        assert(std::count(printed.begin(), printed.end(), '\n') == noisy_calls);
+        std::ostringstream failing_output, failing_errors;
+        integrate_run("calls = 0\nfunction spike(x):\n    return 1 / (x - x)\nr = integrate(spike, 0, 1)",
+                      failing_output, failing_errors);
+        assert(failing_errors.str().find("Division by zero") != std::string::npos);
+        integrate_run("calls = 0\nfunction broken(x):\n    calls = calls + 1\n    return x * missing\n"
+                      "r = integrate(broken, 0, 1)", failing_output, failing_errors);
+        assert(failing_errors.str().find("missing") != std::string::npos);
+        
+        std::cout << "✓ All integration tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_statistics() {
+    std::cout << "\n=== Statistics Test ===\n";
+    
+    std::string code = R"(A = [1, 2; 3, 4; 5, 9]
+by_column = stats(A, 0)
+overall = stats(A)
+acc = stats_accumulator(0)
+accumulate(acc, [1, 2])
+accumulate(acc, [3, 4; 5, 9])
+streamed = stats(acc)
+h = histogram([0, 0.5, 1, 1.5, 2, 10], 2, 0, 2)
+hacc = histogram_accumulator(2, 0, 2)
+accumulate(hacc, [0, 0.5, 1])
+accumulate(hacc, [1.5, 2, 10])
+streamed_h = histogram(hacc)
+C = cov(A)
+R = corrcoef(A)
+cacc = cov_accumulator()
+accumulate(cacc, [1, 2])
+accumulate(cacc, [3, 4; 5, 9])
+streamed_C = cov(cacc))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // Rows are count, mean, variance, skewness, min, max
+        auto s = env->get("by_column").as_matrix();
+        assert(s.size() == 6 && s[0].size() == 2);
+        assert(s[0][0] == 3.0 && s[1][0] == 3.0 && std::abs(s[2][0] - 4.0) < 1e-12);
+        assert(std::abs(s[3][0]) < 1e-12);
+        assert(std::abs(s[1][1] - 5.0) < 1e-12 && std::abs(s[2][1] - 13.0) < 1e-12);
+        assert(s[3][1] > 0.0 && s[4][1] == 2.0 && s[5][1] == 9.0);
+        
+        auto all = env->get("overall").as_matrix();
+        assert(all.size() == 6 && all[0].size() == 1);
+        assert(all[0][0] == 6.0 && std::abs(all[1][0] - 4.0) < 1e-12);
+        
+        auto streamed = env->get("streamed").as_matrix();
+        for (size_t i = 0; i < 6; ++i) {
+            for (size_t j = 0; j < 2; ++j) {
+                assert(std::abs(streamed[i][j] - s[i][j]) < 1e-12);
+            }
+        }
+        
+        // [left, right, count] per bin, out-of-range values are not binned
+        auto h = env->get("h").as_matrix();
+        assert(h.size() == 2 && h[0][2] == 2.0 && h[1][2] == 3.0 && h[1][1] == 2.0);
+        assert(env->get("streamed_h").as_matrix() == h);
+        
+        auto c = env->get("C").as_matrix();
+        assert(std::abs(c[0][0] - 4.0) < 1e-12 && std::abs(c[1][1] - 13.0) < 1e-12);
+        assert(std::abs(c[0][1] - 7.0) < 1e-12 && std::abs(c[1][0] - 7.0) < 1e-12);
+        auto r = env->get("R").as_matrix();
+        assert(r[0][0] == 1.0 && std::abs(r[0][1] - 7.0 / std::sqrt(52.0)) < 1e-12);
+        auto streamed_c = env->get("streamed_C").as_matrix();
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 2; ++j) {
+                assert(std::abs(streamed_c[i][j] - c[i][j]) < 1e-12);
+            }
+        }
+        
+        // A constant column has no correlation with anything, itself included
+        auto degenerate_output = [](const std::string& source, std::string& error_text) {
+            Dakota::Lexer degenerate_lexer(source);
+            auto degenerate_tokens = degenerate_lexer.tokenize();
+            Dakota::Parser degenerate_parser(degenerate_tokens);
+            degenerate_parser.parse();
+            assert(!degenerate_parser.has_error());
+            std::ostringstream output, errors;
+            Dakota::Interpreter degenerate_interpreter(degenerate_parser);
+            degenerate_interpreter.set_output(output, errors);
+            degenerate_interpreter.interpret();
+            error_text = errors.str();
+            return output.str();
+        };
+        std::string error_text;
+        std::string constant = degenerate_output("print(corrcoef([1, 2, 4; 1, 3, 5; 1, 5, 9]))", error_text);
+        assert(error_text.empty());
+        assert(constant == "[nan,nan,nan;nan,1,0.989743;nan,0.989743,1]\n");
+        
+        // Shape mismatches in a later batch name the builtin that was called
+        degenerate_output("acc = stats_accumulator(0)\naccumulate(acc, [1, 2])\naccumulate(acc, [1, 2, 3])",
+                          error_text);
+        assert(error_text.find("accumulate() batch has 3 columns, accumulator expects 2") != std::string::npos);
+        degenerate_output("acc = cov_accumulator()\naccumulate(acc, [1, 2])\naccumulate(acc, [1, 2, 3])",
+                          error_text);
+        assert(error_text.find("accumulate() batch has 3 columns, accumulator expects 2") != std::string::npos);
+        
+        std::cout << "✓ All statistics tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_lists() {
+    std::cout << "\n=== List Test ===\n";
+    
+    std::string code = R"(xs = list()
+for i in list(0, 1, 2, 3):
+    append(xs, i * 0.5)
+count = len(xs)
+second = xs[1]
+xs[0] = 7.5
+last = pop(xs)
+alias = xs
+append(alias, 9.0)
+total = 0
+for v in xs:
+    total = total + v
+row = to_matrix(xs)
+drained = len(xs)
+rows = list([1, 2], [3, 4])
+append(rows, [5, 6])
+M = to_matrix(rows)
+mixed = list(1, "two", 3.0)
+word = mixed[1])";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        assert(env->get("count").as_integer() == 4);
+        assert(env->get("second").as_float() == 0.5);
+        assert(env->get("last").as_float() == 1.5);
+        assert(env->get("total").as_float() == 18.0);
+        
+        // Lists are shared by reference and drained by to_matrix()
+        assert(env->get("drained").as_integer() == 0);
+        assert(env->get("word").as_string() == "two");
+        assert(env->get("M").as_matrix() == Dakota::Matrix({{1, 2}, {3, 4}, {5, 6}}));
+        
+        assert(env->get("row").as_matrix() == Dakota::Matrix({{7.5, 0.5, 1.0, 9.0}}));
+        
+        std::cout << "✓ All list tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_dictionaries() {
+    std::cout << "\n=== Dictionary Test ===\n";
+    
+    std::string code = R"(density = {"steel": 7.85, "aluminium": 2.7}
+density["gold"] = 19.3
+steel = density["steel"]
+has_gold = "gold" in density
+has_lead = "lead" in density
+removed = remove(density, "aluminium")
+count = len(density)
+order = ""
+for name in density:
+    order = order + name + ";"
+index = {}
+i = 0
+while i < 100:
+    index[i] = i * i
+    i = i + 1
+i = 0
+while i < 90:
+    remove(index, i)
+    i = i + 1
+squares = len(index)
+last = index[99]
+by_float = index[95.0])";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        assert(env->get("steel").as_float() == 7.85);
+        assert(env->get("has_gold").as_boolean());
+        assert(!env->get("has_lead").as_boolean());
+        assert(env->get("removed").as_boolean());
+        assert(env->get("count").as_integer() == 2);
+        
+        // Iteration follows insertion order
+        assert(env->get("order").as_string() == "steel;gold;");
+        
+        // Erased slots are reclaimed without losing the remaining keys
+        assert(env->get("squares").as_integer() == 10);
+        assert(env->get("last").as_integer() == 9801);
+        assert(env->get("by_float").as_integer() == 9025);
+        
+        std::cout << "✓ All dictionary tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_string_building() {
+    std::cout << "\n=== String Building Test ===\n";
+    
+    std::string code = R"(s = "a"
+alias = s
+s = s + "b" + "c"
+later = s
+s = s + "d"
+report = ""
+i = 0
+while i < 1000:
+    report = report + "line" + "\n"
+    i = i + 1
+size = len(report))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // Appending in place must never show through other references
+        assert(env->get("alias").as_string() == "a");
+        assert(env->get("later").as_string() == "abc");
+        assert(env->get("s").as_string() == "abcd");
+        assert(env->get("size").as_integer() == 5000);
+        
+        std::cout << "✓ All string building tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_buffer_pool() {
+    std::cout << "\n=== Buffer Pool Test ===\n";
+    
+    std::string code = R"(before = pool_stats()
+i = 0
+while i < 50:
+    A = zeros(64, 64) + ones(64, 64)
+    i = i + 1
+after = pool_stats()
+hits = after["hits"] - before["hits"]
+misses = after["misses"] - before["misses"]
+released = pool_trim()
+trimmed = pool_stats())";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // After the first iteration every row buffer comes back from the pool
+        assert(env->get("hits").as_integer() > 10 * env->get("misses").as_integer());
+        assert(env->get("released").as_integer() >= 0);
+        auto trimmed = env->get("trimmed");
+        assert(trimmed.as_dict().find(Dakota::Value(std::string("retained_bytes")))->as_integer() == 0);
+        
+        std::cout << "✓ All buffer pool tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_closures() {
+    std::cout << "\n=== Closure Test ===\n";
+    
+    std::string code = R"(g = 10
+function make(k, data):
+    function scale(x):
+        return x * k + g
+    return scale
+f = make(3, zeros(100, 100))
+y = f(2)
+g = 20
+z = f(2)
+function outer(n):
+    function fallback():
+        return later
+    later = n
+    return fallback()
+w = outer(7))";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        
+        auto env = interpreter.get_global_environment();
+        
+        // Only k is captured, the unused matrix argument is not kept alive
+        auto closure = env->get("f").as_function().closure;
+        assert(closure->size() == 1);
+        assert(closure->exists_in_current_scope("k"));
+        assert(!closure->exists("data"));
+        
+        // Globals stay late bound through the parent link
+        assert(env->get("y").as_integer() == 16);
+        assert(env->get("z").as_integer() == 26);
+        assert(env->get("w").as_integer() == 7);
+        
+        std::cout << "✓ All closure tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_loop_idioms() {
+    std::cout << "\n=== Loop Idiom Test ===\n";
+    
+    std::string code = R"(n = 1000
+xs = list()
+ys = list()
+zs = list()
+i = 0
+while i < n:
+    append(xs, i * 0.5)
+    append(ys, 1.0)
+    append(zs, 0.0)
+    i = i + 1
+i = 0
+while i < n:
+    zs[i] = 2.5
+    i = i + 1
+filled = i
+i = 0
+while i < len(xs):
+    ys[i] = ys[i] + 3 * xs[i]
+    i = i + 1
+i = 0
+while i < n:
+    zs[i] = sqrt(xs[i]) / (ys[i] + 1) - xs[i] * 0.25
+    i = i + 1
+dot = 0
+i = 0
+while i < n:
+    dot = dot + xs[i] * ys[i]
+    i = i + 1
+total = 0
+i = 0
+while i <= n - 1:
+    total = total + abs(zs[i])
+    i = i + 1
+i = 1
+while i < n:
+    ys[i] = ys[i - 1] + xs[i]
+    i = i + 1
+ints = list(1, 2, 3)
+int_total = 0
+i = 0
+while i < 3:
+    int_total = int_total + ints[i]
+    i = i + 1)";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        // Kernels must reproduce the interpreted loops exactly
+        Dakota::Interpreter native(parser);
+        native.interpret();
+        Dakota::Interpreter interpreted(parser);
+        interpreted.set_loop_idioms(false);
+        interpreted.interpret();
+        
+        auto env = native.get_global_environment();
+        auto reference = interpreted.get_global_environment();
+        for (const char* name : {"ys", "zs"}) {
+            auto list = env->get(name);
+            auto expected = reference->get(name);
+            assert(list.as_list().storage() == Dakota::List::Storage::FLOAT);
+            for (size_t k = 0; k < 1000; ++k) {
+                assert(list.as_list().get(k).as_float() == expected.as_list().get(k).as_float());
+            }
+        }
+        assert(env->get("filled").as_integer() == 1000);
+        assert(env->get("i").as_integer() == 3);
+        assert(env->get("dot").as_float() == reference->get("dot").as_float());
+        assert(env->get("total").as_float() == reference->get("total").as_float());
+        
+        // Integer lists keep integer arithmetic through the interpreter
+        assert(env->get("int_total").is_integer());
+        assert(env->get("int_total").as_integer() == 6);
+        
+        std::cout << "✓ All loop idiom tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_optimizer() {
+    std::cout << "\n=== Optimizer Test ===\n";
+    
+    std::string code = R"(function sq(x):
+    return x * x
+function norm2(a, b):
+    return sq(a) + sq(b)
+function fact(n):
+    if n <= 1:
+        return 1
+    return n * fact(n - 1)
+function unused(x):
+    return x + 1
+function shift(x):
+    return x + offset
+function scaled(offset):
+    return shift(offset) * 2
+function twice(x):
+    x = x * 2
+    y = x
+    x = 0
+    return y
+offset = 10
+total = 0
+i = 0
+while i < 100:
+    total = total + sq(i) + norm2(i, 1)
+    i = i + 1
+if 2 * 3 > 5:
+    branch = "taken"
+else:
+    branch = "dropped"
+shifted = scaled(1)
+f = sq
+indirect = f(7)
+doubled = twice(21)
+factorial = fact(10))";
+
+    try {
+        // The optimizer rewrites the tree, so each run parses its own copy
+        auto run = [&code](bool optimize, Dakota::OptimizerStats& stats) {
+            Dakota::Lexer lexer(code);
+            auto tokens = lexer.tokenize();
+            auto parser = std::make_shared<Dakota::Parser>(tokens);
+            parser->parse();
+            assert(!parser->has_error());
+            auto interpreter = std::make_shared<Dakota::Interpreter>(*parser);
+            if (optimize) {
+                stats = Dakota::Optimizer(*parser, *interpreter).run();
+            }
+            interpreter->interpret();
+            return std::make_pair(parser, interpreter);
+        };
+        
+        Dakota::OptimizerStats stats;
+        auto optimized = run(true, stats);
+        auto reference = run(false, stats);
+        auto env = optimized.second->get_global_environment();
+        auto expected = reference.second->get_global_environment();
+        
+        for (const char* name : {"total", "branch", "shifted", "indirect", "doubled", "factorial"}) {
+            assert((env->get(name) == expected->get(name)).is_truthy());
+        }
+        assert(env->get("total").as_integer() == 656800);
+        assert(env->get("shifted").as_integer() == 22);  // offset is the parameter, not the global
+        assert(env->get("factorial").as_integer() == 3628800);
+        
+        // sq inlines into norm2 and the loop, then norm2 into the loop; norm2 and unused
+        // are then dead. sq is still read through f, and shift would see a parameter.
+        stats = Dakota::OptimizerStats();
+        run(true, stats);
+        assert(stats.calls_inlined == 4);
+        assert(stats.functions_removed == 2);
+        assert(stats.constants_folded >= 2);
+        assert(stats.branches_removed == 1);
+        assert(stats.stores_removed == 1);
+        
+        std::cout << "✓ All optimizer tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_range_analysis() {
+    std::cout << "\n=== Range Analysis Test ===\n";
+    
+    std::string code = R"(n = 50
+xs = list()
+ys = list()
+i = 0
+while i < n:
+    append(xs, i * 1.5)
+    append(ys, 0)
+    i = i + 1
+i = 1
+while i < n - 1:
+    ys[i] = xs[i - 1] + xs[i] + xs[i + 1]
+    i = i + 1
+m = [1, 2; 3, 4; 5, 6]
+rows = [0, 0]
+k = 0
+while k < 3:
+    rows = rows + m[k]
+    k = k + 1
+short = list(1, 2, 3)
+j = 0
+total = 0
+while j <= len(xs):
+    if j < 3:
+        total = total + short[j]
+    j = j + 1
+grown = list(1)
+g = 0
+while g < 5:
+    append(grown, grown[g] * 2)
+    g = g + 1)";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        // Unchecked accesses must behave exactly like checked ones
+        Dakota::Interpreter proven(parser);
+        proven.interpret();
+        Dakota::Interpreter checked(parser);
+        checked.set_range_analysis(false);
+        checked.interpret();
+        
+        auto env = proven.get_global_environment();
+        auto reference = checked.get_global_environment();
+        for (size_t k = 0; k < 50; ++k) {
+            assert((env->get("ys").as_list().get(k) == reference->get("ys").as_list().get(k)).is_truthy());
+        }
+        assert(env->get("ys").as_list().get(10).as_float() == 45.0);
+        assert((env->get("rows") == reference->get("rows")).is_truthy());
+        assert(env->get("rows").as_matrix()[0][1] == 12.0);
+        assert(env->get("total").as_integer() == 6);
+        assert(env->get("grown").as_list().size() == 6);
+        assert(env->get("grown").as_list().get(5).as_integer() == 32);
+        
+        // A read the loop does not keep in range still fails
+        Dakota::Lexer bad_lexer("xs = list(1, 2, 3)\ns = 0\ni = 0\nwhile i < 4:\n    s = s + xs[i]\n    i = i + 1");
+        auto bad_tokens = bad_lexer.tokenize();
+        Dakota::Parser bad_parser(bad_tokens);
+        bad_parser.parse();
+        Dakota::Interpreter bad(bad_parser);
+        std::ostringstream errors;
+        std::streambuf* old_cerr = std::cerr.rdbuf(errors.rdbuf());
+        bad.interpret();
+        std::cerr.rdbuf(old_cerr);
+        assert(errors.str().find("List index out of bounds") != std::string::npos);
+        assert(bad.get_global_environment()->get("s").as_integer() == 6);
+        
+        // to_matrix empties the list mid-loop, so later accesses are out of bounds
+        Dakota::Lexer drained_lexer("xs = list()\ni = 0\nwhile i < 100:\n    append(xs, 1.5)\n    i = i + 1\n"
+                                    "i = 0\nwhile i < 100:\n    if i == 10:\n        m = to_matrix(xs)\n"
+                                    "    xs[i] = 2.5\n    i = i + 1");
+        auto drained_tokens = drained_lexer.tokenize();
+        Dakota::Parser drained_parser(drained_tokens);
+        drained_parser.parse();
+        Dakota::Interpreter drained(drained_parser);
+        errors.str("");
+        drained.set_output(std::cout, errors);
+        drained.interpret();
+        assert(errors.str().find("List index out of bounds") != std::string::npos);
+        assert(drained.get_global_environment()->get("i").as_integer() == 10);
+        
+        std::cout << "✓ All range analysis tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_constant_matrices() {
+    std::cout << "\n=== Constant Matrix Literal Test ===\n";
+    
+    // A lookup table larger than MAX_MATRIX_DIMENSIONS rows
+    std::string table = "big = [";
+    for (int k = 0; k < 1500; ++k) {
+        table += (k ? "; " : "") + std::to_string(k) + ", -" + std::to_string(k) + ".5";
+    }
+    table += "]";
+    
+    std::string code = table + R"(
+function small():
+    return [1, -2; 3, 4.5]
+a = small()
+b = small()
+x = 2
+c = [1, x; -3, 4]
+d = [1, 2] * 2)";
+
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        
+        if (parser.has_error()) {
+            std::cout << "Parse error: " << parser.get_error() << "\n";
+            return;
+        }
+        
+        // Only the literals with a non-literal element get element nodes
+        assert(parser.get_constants().get_matrix_count() == 3);
+        assert(parser.get_nodes().size() < 100);
+        
+        Dakota::Interpreter interpreter(parser);
+        interpreter.interpret();
+        auto env = interpreter.get_global_environment();
+        
+        const auto& big = env->get("big").as_matrix();
+        assert(big.size() == 1500 && big[0].size() == 2);
+        assert(big[1499][0] == 1499.0 && big[1499][1] == -1499.5);
+        
+        // Every evaluation of a constant literal shares one buffer
+        assert(&env->get("a").as_matrix() == &env->get("b").as_matrix());
+        assert(env->get("a").as_matrix()[0][1] == -2.0);
+        assert(env->get("a").as_matrix()[1][1] == 4.5);
+        
+        assert(env->get("c").as_matrix()[0][1] == 2.0);
+        assert(env->get("c").as_matrix()[1][0] == -3.0);
+        assert(env->get("d").as_matrix()[0][1] == 4.0);
+        
+        std::cout << "✓ All constant matrix literal tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_sweep() {
+    std::cout << "\n=== Parameter Sweep Test ===\n";
+    
+    std::string checkpoint = "/tmp/dakota_sweep_" + std::to_string(getpid()) + ".ckpt";
+    auto run = [](const std::string& code, std::ostringstream& output, std::ostringstream& errors) {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        auto parser = std::make_shared<Dakota::Parser>(tokens);
+        parser->parse();
+        assert(!parser->has_error());
+        auto interpreter = std::make_shared<Dakota::Interpreter>(*parser);
+        interpreter->set_output(output, errors);
+        interpreter->interpret();
+        auto env = interpreter->get_global_environment();
+        return env->exists("r") ? env->get("r") : Dakota::Value();
+    };
+    
+    try {
+        std::string code = R"(calls = 0
+hits = list()
+function f(x, y):
+    calls = calls + 1
+    append(hits, x)
+    return x * 10 + y
+function make(offset):
+    function shifted(x):
+        return x + offset
+    return shifted
+function volume(a, b, c):
+    return a * b * c
+g = make(100)
+grid = sweep(f, [1, 2, 3], [0, 1])
+line = sweep(g, range(300))
+cube = sweep(volume, [1, 2], [1, 2, 3], [1, 10])
+print(sweep(f, 5, 7))
+r = calls + len(hits))";
+        std::ostringstream output, errors;
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        assert(!parser.has_error());
+        Dakota::Interpreter interpreter(parser);
+        interpreter.set_output(output, errors);
+        interpreter.interpret();
+        assert(errors.str().empty());
+        
+        auto env = interpreter.get_global_environment();
+        const Dakota::Matrix& grid = env->get("grid").as_matrix();
+        assert(grid.size() == 3 && grid[0].size() == 2);
+        assert(grid[0][0] == 10.0 && grid[0][1] == 11.0 && grid[2][0] == 30.0 && grid[2][1] == 31.0);
+        
+        const Dakota::Matrix& line = env->get("line").as_matrix();
+        assert(line.size() == 1 && line[0].size() == 300);
+        assert(line[0][0] == 100.0 && line[0][299] == 399.0);
+        
+        // Three axes: a list of matrices over the last two
+        Dakota::List& cube = env->get("cube").as_list();
+        assert(cube.size() == 2);
+        const Dakota::Matrix& slice = cube.get(1).as_matrix();
+        assert(slice.size() == 3 && slice[2][1] == 60.0);
+        assert(output.str() == "[57]\n");
+        
+        // Workers update their own copies of globals and lists
+        assert(env->get("r").as_integer() == 0);
+        
+        std::ostringstream sweep_errors;
+        run("function bad(x):\n    return \"text\"\nr = sweep(bad, [1, 2])", output, sweep_errors);
+        assert(sweep_errors.str().find("sweep() function must return a number") != std::string::npos);
+        
+        // Builtins run in the worker's own interpreter, passed directly or held in a variable
+        std::ostringstream builtin_output, builtin_errors;
+        Dakota::Value roots = run("r = sweep(sqrt, [1, 4, 9])", builtin_output, builtin_errors);
+        assert(builtin_errors.str().empty());
+        assert(roots.as_matrix()[0][2] == 3.0);
+        run("show = print\nfunction f(x):\n    show(x)\n    return x\nr = sweep(f, [1, 2])", builtin_output, builtin_errors);
+        assert(builtin_errors.str().empty());
+        assert(builtin_output.str().find("1\n") != std::string::npos && builtin_output.str().find("2\n") != std::string::npos);
+        
+        // A failed sweep keeps its finished chunks; the rerun resumes from them
+        std::remove(checkpoint.c_str());
+        std::string failing = "function f(x):\n    if x >= limit:\n        return \"stop\"\n    return x * scale\n"
+                              "r = sweep(f, range(1000), \"" + checkpoint + "\")";
+        std::ostringstream first_errors;
+        run("limit = 900\nscale = 2\n" + failing, output, first_errors);
+        assert(!first_errors.str().empty());
+        std::ifstream saved(checkpoint);
+        assert(saved.good());
+        saved.close();
+        
+        // Once the function is edited, its old results no longer apply
+        std::ostringstream edited_errors;
+        run("function f(x):\n    return 0 - 1\nr = sweep(f, range(1000), \"" + checkpoint + "\")", output, edited_errors);
+        assert(edited_errors.str().find("belongs to a different sweep") != std::string::npos);
+        
+        std::ostringstream second_errors;
+        Dakota::Value resumed = run("limit = 1000\nscale = 3\n" + failing, output, second_errors);
+        assert(second_errors.str().empty());
+        const Dakota::Matrix& values = resumed.as_matrix();
+        assert(values[0][0] == 0.0 && values[0][10] == 20.0);
+        assert(values[0][999] == 2997.0);
+        std::ifstream removed(checkpoint);
+        assert(!removed.good());
+        
+        std::cout << "✓ All parameter sweep tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_server() {
+    std::cout << "\n=== Serve Daemon Test ===\n";
+    
+    try {
+        std::string socket_path = "/tmp/dakota_test_" + std::to_string(getpid()) + ".sock";
+        Dakota::Server server(socket_path, 2);
+        server.start();
+        std::thread serving([&server] { server.run(); });
+        
+        Dakota::JobRequest job;
+        job.script = "function scale(v):\n    return v * factor\nprint(scale(x), label)";
+        job.parameters = {{"x", "21"}, {"factor", "2"}, {"label", "run"}};
+        Dakota::JobResult first = Dakota::submit(socket_path, job);
+        assert(first.ok);
+        assert(first.output == "42 run\n");
+        
+        job.parameters = {{"x", "0.25"}, {"factor", "2"}, {"label", "again"}};
+        Dakota::JobResult second = Dakota::submit(socket_path, job);
+        assert(second.output == "0.5 again\n");
+        
+        // Globals from earlier requests are not visible
+        Dakota::JobRequest isolated;
+        isolated.script = "print(x)";
+        Dakota::JobResult missing = Dakota::submit(socket_path, isolated);
+        assert(!missing.ok);
+        assert(missing.output.empty());
+        assert(missing.errors.find("Undefined variable 'x'") != std::string::npos);
+        
+        Dakota::JobRequest broken;
+        broken.script = "x = (1 +";
+        Dakota::JobResult parse_failure = Dakota::submit(socket_path, broken);
+        assert(!parse_failure.ok);
+        assert(parse_failure.errors.find("Parse error") != std::string::npos);
+        
+        // Concurrent clients share the compiled script
+        std::vector<std::thread> clients;
+        std::vector<std::string> outputs(8);
+        for (int k = 0; k < 8; ++k) {
+            clients.emplace_back([&, k] {
+                Dakota::JobRequest request;
+                request.script = job.script;
+                request.parameters = {{"x", std::to_string(k)}, {"factor", "10"}, {"label", "c"}};
+                outputs[k] = Dakota::submit(socket_path, request).output;
+            });
+        }
+        for (auto& client : clients) client.join();
+        for (int k = 0; k < 8; ++k) {
+            assert(outputs[k] == std::to_string(k * 10) + " c\n");
+        }
+        
+        // Silent connections do not hold workers: with one per worker open,
+        // other clients are still served, and the silent ones later are too
+        std::vector<int> silent;
+        for (int k = 0; k < 2; ++k) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            assert(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+            silent.push_back(fd);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        job.parameters = {{"x", "5"}, {"factor", "3"}, {"label", "busy"}};
+        assert(Dakota::submit(socket_path, job).output == "15 busy\n");
+        for (int fd : silent) {
+            const std::string request = "RUN 9\nprint(42)";
+            assert(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+            std::string reply;
+            char buffer[64];
+            while (reply.size() < 10) {
+                ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+                assert(n > 0);
+                reply.append(buffer, static_cast<size_t>(n));
+            }
+            assert(reply == "OK 3 0\n42\n");
+            ::close(fd);
+        }
+        
+        server.stop();
+        serving.join();
+        Dakota::ServeStats stats = server.stats();
+        assert(stats.requests == 15);
+        assert(stats.cache_misses == 4);
+        assert(stats.cache_hits == 11);
+        
+        std::cout << "✓ All serve daemon tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_batch() {
+    std::cout << "\n=== Batch Runner Test ===\n";
+    
+    try {
+        std::string dir = "/tmp/dakota_batch_" + std::to_string(getpid());
+        std::string script = "function scale(v):\n    return v * factor\nprint(scale(x))";
+        std::ofstream(dir + "_fit.dk") << script;
+        std::ofstream(dir + "_copy.dk") << script;
+        std::ofstream(dir + "_bad.dk") << "print(missing)";
+        {
+            std::ofstream jobs(dir + "_jobs.txt");
+            jobs << "# sweep over x\n\n";
+            for (int k = 0; k < 20; ++k) {
+                jobs << dir << (k % 2 ? "_copy.dk" : "_fit.dk") << " x=" << k << " factor=3\n";
+            }
+            jobs << dir << "_bad.dk\n";
+        }
+        
+        std::vector<Dakota::BatchJob> jobs = Dakota::load_batch(dir + "_jobs.txt");
+        assert(jobs.size() == 21);
+        assert(jobs[1].request.parameters.size() == 2);
+        
+        Dakota::BatchReport report = Dakota::run_batch(jobs, 4);
+        assert(report.results.size() == 21);
+        for (int k = 0; k < 20; ++k) {
+            assert(report.results[k].ok);
+            assert(report.results[k].output == std::to_string(3 * k) + "\n");
+        }
+        assert(!report.results[20].ok);
+        assert(report.results[20].errors.find("Undefined variable 'missing'") != std::string::npos);
+        assert(report.failed() == 1);
+        
+        // Two paths with the same text plus the failing script: two compilations
+        assert(report.programs.compiled + report.programs.reused == 21);
+        assert(report.programs.compiled >= 2 && report.programs.compiled <= 5);
+        
+        std::ostringstream summary;
+        Dakota::print_batch_summary(summary, jobs, report);
+        assert(summary.str().find("21 jobs (1 failed) on 4 threads") != std::string::npos);
+        assert(summary.str().find("FAILED") != std::string::npos);
+        
+        bool rejected = false;
+        try {
+            std::ofstream(dir + "_jobs.txt") << dir << "_fit.dk x\n";
+            Dakota::load_batch(dir + "_jobs.txt");
+        } catch (const std::runtime_error& e) {
+            rejected = std::string(e.what()).find(":1: Expected name=value") != std::string::npos;
+        }
+        assert(rejected);
+        
+        for (const char* suffix : {"_fit.dk", "_copy.dk", "_bad.dk", "_jobs.txt"}) {
+            std::remove((dir + suffix).c_str());
+        }
+        std::cout << "✓ All batch runner tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_modules() {
+    std::cout << "\n=== Modules Test ===\n";
+    
+    try {
+        std::string dir = "/tmp/dakota_modules_" + std::to_string(getpid());
+        mkdir(dir.c_str(), 0755);
+        std::ofstream(dir + "/geom.dk") << "print(\"loading geom\")\nscale = 3\n"
+                                           "function area(w, h):\n    return w * h * scale\n"
+                                           "function apply(f, x):\n    return f(x)\n";
+        std::ofstream(dir + "/broken.dk") << "x = (1 +\n";
+        Dakota::ModuleCache& cache = Dakota::ModuleCache::instance();
+        cache.add_search_directory(dir);
+        assert(cache.resolve("geom") == dir + "/geom.dk");
+        assert(cache.resolve("nothere").empty());
+        
+        Dakota::ProgramCache programs(true);
+        auto run = [&](const std::string& script) {
+            Dakota::JobRequest request;
+            request.script = script;
+            return Dakota::run_job(programs, request);
+        };
+        
+        // The top level runs on first use, not at the import
+        Dakota::ModuleCacheStats before = cache.stats();
+        Dakota::JobResult result = run("import geom\nprint(\"before\")\nprint(geom.scale)\n"
+                                       "print(geom.area(2, 5))\n"
+                                       "function sq(x):\n    return x * x\nprint(geom.apply(sq, 4))\n"
+                                       "a = geom.area\nprint(a(1, 1))");
+        assert(result.ok);
+        assert(result.output == "before\nloading geom\n3\n30\n16\n3\n");
+        
+        // A second importer reuses the compiled module but has its own globals
+        result = run("import geom\ngeom.scale\nprint(geom.area(1, 2))");
+        assert(result.ok && result.output == "loading geom\n6\n");
+        Dakota::ModuleCacheStats after = cache.stats();
+        assert(after.compiled == before.compiled + 1);
+        assert(after.reused == before.reused + 1);
+        
+        // Module functions run in an interpreter sweep() workers cannot share
+        result = run("import geom\nr = sweep(geom.area, [1, 2], [3])");
+        assert(!result.ok && result.errors.find("must be a user function or a builtin") != std::string::npos);
+        
+        // Editing the file recompiles it
+        std::ofstream(dir + "/geom.dk") << "scale = 10\n";
+        result = run("import geom\nprint(geom.scale)");
+        assert(result.ok && result.output == "10\n");
+        assert(cache.stats().compiled == after.compiled + 1);
+        
+        result = run("import nothere");
+        assert(!result.ok && result.errors.find("No module named 'nothere'") != std::string::npos);
+        result = run("import broken\nprint(1)");
+        assert(!result.ok && result.errors.find("Parse error in module 'broken'") != std::string::npos);
+        result = run("import geom\nprint(geom.missing)");
+        assert(!result.ok && result.errors.find("Module 'geom' has no member 'missing'") != std::string::npos);
+        
+        for (const char* name : {"/geom.dk", "/broken.dk"}) {
+            std::remove((dir + name).c_str());
+        }
+        rmdir(dir.c_str());
+        std::cout << "✓ All module tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_embedding() {
+    std::cout << "\n=== Embedding Test ===\n";
+    
+    try {
+        // 3x2 host matrix stored column-major, plus a row-major one never read
+        std::vector<double> host = {1, 2, 3, 10, 20, 30};
+        std::vector<double> unused(1000, 7.0);
+        int released = 0;
+        
+        Dakota::Value result, wrapped, idle;
+        {
+            Dakota::Lexer lexer("B = A * 2\nrow = A[1]\nC = A.T");
+            auto tokens = lexer.tokenize();
+            Dakota::Parser parser(tokens);
+            parser.parse();
+            assert(!parser.has_error());
+            Dakota::Interpreter interpreter(parser);
+            auto env = interpreter.get_global_environment();
+            env->define("A", Dakota::wrap_array(host.data(), Dakota::ArrayLayout::column_major(3, 2),
+                                                [&released]() { ++released; }));
+            env->define("U", Dakota::wrap_array(unused.data(), Dakota::ArrayLayout::row_major(10, 100),
+                                                [&released]() { ++released; }));
+            interpreter.interpret();
+            
+            result = env->get("B");
+            wrapped = env->get("A");
+            idle = env->get("U");
+            Dakota::MatrixView row = Dakota::view(env->get("row"));
+            assert(row.rows() == 1 && row.cols() == 2);
+            assert(row(0, 0) == 2.0 && row(0, 1) == 20.0);
+            Dakota::MatrixView transposed = Dakota::view(env->get("C"));
+            assert(transposed.rows() == 2 && transposed.cols() == 3 && transposed(1, 2) == 30.0);
+        }
+        
+        // The binding stays a view of the host buffer; only the read copied it
+        auto& array = dynamic_cast<Dakota::ExternalArray&>(wrapped.as_object());
+        assert(array.materialized());
+        assert(!dynamic_cast<Dakota::ExternalArray&>(idle.as_object()).materialized());
+        Dakota::MatrixView host_view = Dakota::view(wrapped);
+        assert(host_view.row(0) == host.data() && host_view.col_stride() == 3);
+        assert(host_view(2, 1) == 30.0);
+        
+        // Results outlive the interpreter and are read in place
+        Dakota::MatrixView view = Dakota::view(result);
+        assert(view.rows() == 3 && view.cols() == 2 && view.col_stride() == 1);
+        assert(view.row(0) == result.as_matrix()[0].data());
+        assert(view(0, 0) == 2.0 && view(2, 1) == 60.0);
+        
+        // Release runs once the last reference goes, for each buffer
+        assert(released == 0);
+        idle = Dakota::Value();
+        assert(released == 1);
+        wrapped = Dakota::Value();
+        assert(released == 1);   // host_view still holds it
+        host_view = Dakota::MatrixView();
+        assert(released == 2);
+        
+        bool rejected = false;
+        try {
+            Dakota::view(Dakota::Value(int64_t(3)));
+        } catch (const Dakota::RuntimeError&) {
+            rejected = true;
+        }
+        assert(rejected);
+        std::cout << "✓ All embedding tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_extern_functions() {
+    std::cout << "\n=== Extern Function Test ===\n";
+    
+    // The kernels library is built next to this binary
+    char exe[4096];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    std::string bin = length > 0 ? std::string(exe, static_cast<size_t>(length)) : std::string("bin/test_interpreter");
+    std::string library = bin.substr(0, bin.find_last_of('/') + 1) + "libextern_kernels.so";
+    
+    auto run = [](const std::string& code, std::ostringstream& errors) {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        auto parser = std::make_shared<Dakota::Parser>(tokens);
+        parser->parse();
+        assert(!parser->has_error());
+        std::ostringstream output;
+        auto interpreter = std::make_shared<Dakota::Interpreter>(*parser);
+        interpreter->set_output(output, errors);
+        interpreter->interpret();
+        return output.str();
+    };
+    
+    try {
+        std::string header = "extern \"" + library + "\" function scale(a: matrix, n: int, s: float) -> matrix\n"
+                             "extern \"" + library + "\" function dot(a: matrix, b: matrix, n: int) -> float\n"
+                             "extern \"" + library + "\" function count_above(a: matrix, n: int, t: float) -> int\n";
+        std::ostringstream errors;
+        
+        // Declarations are linked before the program runs, so order does not matter
+        std::string output = run("print(answer())\n" + header +
+                                 "extern \"" + library + "\" function answer() -> float\n"
+                                 "A = [1, 2; 3, 4]\nB = scale(A, 4, 10)\nprint(A)\nprint(B)\n"
+                                 "print(scale([1, 2, 3], 3, 0.5))\n"
+                                 "print(dot([1, 2, 3], [4, 5, 6], 3))\n"
+                                 "print(count_above([1, 5, 7, 2], 4, 3))", errors);
+        assert(errors.str().empty());
+        assert(output == "42\n[1,2;3,4]\n[10,20;30,40]\n[0.5,1,1.5]\n32\n2\n");
+        
+        // Arguments are checked on every call
+        errors.str("");
+        run(header + "scale([1, 2], 2)", errors);
+        assert(errors.str().find("Function 'scale' expects 3 arguments, got 2") != std::string::npos);
+        errors.str("");
+        run(header + "scale([1, 2], 2.5, 1)", errors);
+        assert(errors.str().find("expects an int for argument 2") != std::string::npos);
+        
+        // Linking fails before anything runs
+        errors.str("");
+        output = run("print(1)\nextern \"" + library + "\" function missing(x: int)", errors);
+        assert(output.empty() && errors.str().find("Symbol 'missing' not found") != std::string::npos);
+        errors.str("");
+        run("extern \"/nonexistent/libnothing.so\" function f(x: int)", errors);
+        assert(errors.str().find("Cannot load library") != std::string::npos);
+        
+        Dakota::Lexer lexer("extern \"libm.so.6\" function cos(x: double) -> float");
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        assert(parser.has_error());
+        
+        std::cout << "✓ All extern function tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_plugins() {
+    std::cout << "\n=== Plugin Test ===\n";
+    
+    // Plugins are built next to this binary
+    char exe[4096];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    std::string bin = length > 0 ? std::string(exe, static_cast<size_t>(length)) : std::string("bin/test_interpreter");
+    std::string directory = bin.substr(0, bin.find_last_of('/') + 1);
+    
+    auto run = [](const std::string& code, std::ostringstream& errors) {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        auto parser = std::make_shared<Dakota::Parser>(tokens);
+        parser->parse();
+        assert(!parser->has_error());
+        std::ostringstream output;
+        auto interpreter = std::make_shared<Dakota::Interpreter>(*parser);
+        interpreter->set_output(output, errors);
+        interpreter->interpret();
+        return output.str();
+    };
+    
+    try {
+        auto& registry = Dakota::PluginRegistry::instance();
+        registry.load(directory + "libdakota_example_plugin.so");
+        registry.load(directory + "libdakota_example_plugin.so");
+        assert(registry.plugins().size() == 1 && registry.plugins()[0] == "example");
+        
+        // Plugin functions are builtins in every interpreter created afterwards,
+        // and replace builtins of the same name
+        std::ostringstream errors;
+        std::string output = run("print(norm2([3, 4]))\n"
+                                 "print(axpy(2, [1, 2; 3, 4], [1, 1; 1, 1]))\n"
+                                 "print(axpy(0.5, [2, 4, 6], [1, 1, 1]))\n"
+                                 "print(total(1, 2.5, [1, 2; 3, 4]))\n"
+                                 "print(total())\n"
+                                 "print(abs(-3))\nprint(abs(-2.5))", errors);
+        assert(errors.str().empty());
+        assert(output == "5\n[3,5;7,9]\n[2,3,4]\n13.5\n0\n3\n2.5\n");
+        
+        // Arity and types are checked before the plugin runs
+        errors.str("");
+        run("axpy(1, [1, 2])", errors);
+        assert(errors.str().find("Function 'axpy' expects 3 arguments, got 2") != std::string::npos);
+        errors.str("");
+        run("norm2(3)", errors);
+        assert(errors.str().find("Function 'norm2' expects a matrix for argument 1") != std::string::npos);
+        
+        // Errors the plugin reports become runtime errors
+        errors.str("");
+        run("axpy(1, [1, 2], [1, 2, 3])", errors);
+        assert(errors.str().find("Function 'axpy' failed: x and y must have the same shape") != std::string::npos);
+        errors.str("");
+        run("abs([1, -2])", errors);
+        assert(errors.str().find("matrices are not supported") != std::string::npos);
+        
+        // Host buffers are refused, not wrapped around, for impossible sizes
+        errors.str("");
+        assert(run("print(host_ones(2, 3))", errors) == "[1,1,1;1,1,1]\n");
+        assert(errors.str().empty());
+        run("host_ones(-1, 3)", errors);
+        assert(errors.str().find("Function 'host_ones' failed: no buffer of that size") != std::string::npos);
+        errors.str("");
+        run("host_ones(4611686018427387904, 4)", errors);
+        assert(errors.str().find("Function 'host_ones' failed: no buffer of that size") != std::string::npos);
+        
+        // Libraries that are not plugins are rejected
+        bool rejected = false;
+        try {
+            registry.load(directory + "libextern_kernels.so");
+        } catch (const Dakota::RuntimeError& e) {
+            rejected = std::string(e.what()).find("does not export dakota_plugin_init") != std::string::npos;
+        }
+        assert(rejected);
+        rejected = false;
+        try {
+            registry.load("/nonexistent/libnothing.so");
+        } catch (const Dakota::RuntimeError& e) {
+            rejected = std::string(e.what()).find("Cannot load plugin") != std::string::npos;
+        }
+        assert(rejected);
+        assert(registry.plugins().size() == 1);
+        
+        std::cout << "✓ All plugin tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_checkpoint() {
+    std::cout << "\n=== Checkpoint Test ===\n";
+    
+    std::string path = "/tmp/dakota_test_checkpoint_" + std::to_string(getpid()) + ".snap";
+    std::string code = R"(function make(scale):
+    function apply(x):
+        return x * scale
+    return apply
+history = list()
+info = dict()
+info["history"] = history
+info["grid"] = [1, 2; 3, 4]
+S = sparse([1, 0; 0, 2])
+times = make(10)
+root = sqrt
+state = [0, 0]
+runs = 0
+k = 0
+print("start")
+while k < 6:
+    state = state + [k, 2 * k]
+    append(history, k * 1.5)
+    k = k + 1
+    if k == 3:
+        runs = runs + 1
+        checkpoint(")" + path + R"(")
+print(k, runs)
+print(state)
+print(history)
+print(len(info["history"]))
+print(info["grid"] + dense(S), nnz(S))
+print(times(4), root(16)))";
+    
+    try {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        assert(!parser.has_error());
+        
+        std::string finish = "6 1\n[15,30]\nlist(0, 1.5, 3, 4.5, 6, 7.5)\n6\n[2,2;3,6] 2\n40 4\n";
+        std::ostringstream output, errors;
+        Dakota::Interpreter first(parser);
+        first.set_output(output, errors);
+        first.interpret();
+        assert(errors.str().empty());
+        assert(output.str() == "start\n" + finish);
+        
+        // The restored run carries on with the loop's next iteration, with
+        // aliasing, closures and builtin function values intact
+        output.str("");
+        errors.str("");
+        Dakota::Interpreter resumed(parser);
+        resumed.set_output(output, errors);
+        resumed.restore(path);
+        resumed.interpret();
+        assert(errors.str().empty());
+        assert(output.str() == finish);
+        
+        // A snapshot only restores into the program that took it
+        Dakota::Lexer other_lexer("x = 1\nprint(x)");
+        auto other_tokens = other_lexer.tokenize();
+        Dakota::Parser other(other_tokens);
+        other.parse();
+        Dakota::Interpreter stranger(other);
+        bool rejected = false;
+        try {
+            stranger.restore(path);
+        } catch (const Dakota::RuntimeError& e) {
+            rejected = std::string(e.what()).find("different program") != std::string::npos;
+        }
+        assert(rejected);
+        
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "DKSNAP01 but nothing else";
+        rejected = false;
+        try {
+            Dakota::Interpreter(parser).restore(path);
+        } catch (const Dakota::RuntimeError& e) {
+            rejected = std::string(e.what()).find("is corrupt") != std::string::npos;
+        }
+        assert(rejected);
+        std::remove(path.c_str());
+        
+        // Out-of-range function bodies and malformed sparse structure are
+        // caught before any object is built from them
+        std::string sparse_code = "function twice(x):\n    return 2 * x\nS = sparse([1, 0; 0, 2])\n"
+                                  "checkpoint(\"" + path + "\")\nprint(nnz(S), twice(3))";
+        Dakota::Lexer sparse_lexer(sparse_code);
+        auto sparse_tokens = sparse_lexer.tokenize();
+        Dakota::Parser sparse_parser(sparse_tokens);
+        sparse_parser.parse();
+        assert(!sparse_parser.has_error());
+        output.str("");
+        errors.str("");
+        Dakota::Interpreter sparse_run(sparse_parser);
+        sparse_run.set_output(output, errors);
+        sparse_run.interpret();
+        assert(errors.str().empty() && output.str() == "2 6\n");
+        std::string image;
+        {
+            std::ifstream in(path, std::ios::binary);
+            image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        auto patch = [](std::string& bytes, size_t at, const void* value, size_t size) {
+            assert(at + size <= bytes.size());
+            std::memcpy(&bytes[at], value, size);
+        };
+        auto read_u64 = [&image](size_t at) {
+            uint64_t value;
+            std::memcpy(&value, image.data() + at, sizeof(value));
+            return value;
+        };
+        auto restores_as_corrupt = [&](const std::string& bytes) {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+            try {
+                Dakota::Interpreter(sparse_parser).restore(path);
+            } catch (const Dakota::RuntimeError& e) {
+                return std::string(e.what()).find("is corrupt") != std::string::npos;
+            }
+            return false;
+        };
+        const size_t data_offset = read_u64(40);
+        // The sparse record is rows, cols, nnz, then the col_ptr, row_idx and values offsets
+        const uint64_t shape[3] = {2, 2, 2};
+        const size_t sparse_at = image.find(std::string(reinterpret_cast<const char*>(shape), sizeof(shape)));
+        assert(sparse_at != std::string::npos);
+        const size_t col_ptr_at = data_offset + read_u64(sparse_at + 24);
+        const size_t row_idx_at = data_offset + read_u64(sparse_at + 32);
+        // The function record is its name, one parameter "x", then the body node index
+        const std::string twice_record = std::string("\x05\0\0\0\0\0\0\0twice\x01\0\0\0\0\0\0\0", 21) +
+                                         std::string("\x01\0\0\0\0\0\0\0x", 9);
+        const size_t body_at = image.find(twice_record);
+        assert(body_at != std::string::npos);
+        
+        std::string bad = image;
+        const uint64_t huge = UINT64_MAX;
+        patch(bad, sparse_at + 8, &huge, sizeof(huge));
+        assert(restores_as_corrupt(bad));
+        bad = image;
+        const int32_t past_nnz = 3;
+        patch(bad, col_ptr_at + 2 * sizeof(int32_t), &past_nnz, sizeof(past_nnz));
+        assert(restores_as_corrupt(bad));
+        bad = image;
+        const int32_t backwards[3] = {0, 2, 1};
+        patch(bad, col_ptr_at, backwards, sizeof(backwards));
+        assert(restores_as_corrupt(bad));
+        bad = image;
+        const int32_t outside = 5;
+        patch(bad, row_idx_at + sizeof(int32_t), &outside, sizeof(outside));
+        assert(restores_as_corrupt(bad));
+        bad = image;
+        const uint32_t no_such_node = 0xFFFFFFF0u;
+        patch(bad, body_at + twice_record.size(), &no_such_node, sizeof(no_such_node));
+        assert(restores_as_corrupt(bad));
+        
+        // The untouched image still restores
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << image;
+        output.str("");
+        errors.str("");
+        Dakota::Interpreter sparse_resumed(sparse_parser);
+        sparse_resumed.set_output(output, errors);
+        sparse_resumed.restore(path);
+        sparse_resumed.interpret();
+        assert(errors.str().empty() && output.str() == "2 6\n");
+        std::remove(path.c_str());
+
+        // A snapshot of scalars alone has an empty data section
+        std::string scalars_code = "total = 0\ni = 0\nprint(\"start\")\nwhile i < 5:\n    total = total + i\n"
+                                   "    i = i + 1\n    if i == 3:\n        checkpoint(\"" + path + "\")\nprint(i, total)";
+        Dakota::Lexer scalars_lexer(scalars_code);
+        auto scalars_tokens = scalars_lexer.tokenize();
+        Dakota::Parser scalars(scalars_tokens);
+        scalars.parse();
+        assert(!scalars.has_error());
+        output.str("");
+        errors.str("");
+        Dakota::Interpreter counter(scalars);
+        counter.set_output(output, errors);
+        counter.interpret();
+        assert(errors.str().empty());
+        assert(output.str() == "start\n5 10\n");
+        output.str("");
+        Dakota::Interpreter recounter(scalars);
+        recounter.set_output(output, errors);
+        recounter.restore(path);
+        recounter.interpret();
+        assert(errors.str().empty());
+        assert(output.str() == "5 10\n");
+        std::remove(path.c_str());
+
+        // Values with native state cannot be saved
+        Dakota::Lexer stateful_lexer("acc = stats_accumulator()\ncheckpoint(\"" + path + "\")");
+        auto stateful_tokens = stateful_lexer.tokenize();
+        Dakota::Parser stateful(stateful_tokens);
+        stateful.parse();
+        errors.str("");
+        Dakota::Interpreter saver(stateful);
+        saver.set_output(output, errors);
+        saver.interpret();
+        assert(errors.str().find("cannot save a stats accumulator value") != std::string::npos);
+        std::ifstream missing(path);
+        assert(!missing.good());
+        
+        // Anywhere a restored run could not pick up where the checkpoint was taken
+        auto misplaced = [&](const std::string& code) {
+            Dakota::Lexer misplaced_lexer(code);
+            auto misplaced_tokens = misplaced_lexer.tokenize();
+            Dakota::Parser misplaced_parser(misplaced_tokens);
+            misplaced_parser.parse();
+            assert(!misplaced_parser.has_error());
+            errors.str("");
+            Dakota::Interpreter interpreter(misplaced_parser);
+            interpreter.set_output(output, errors);
+            interpreter.interpret();
+            assert(!std::ifstream(path).good());
+            return errors.str();
+        };
+        std::string call = "checkpoint(\"" + path + "\")";
+        std::string placement = "must be a top-level statement or the last statement of a top-level while loop";
+        assert(misplaced("i = 0\nwhile i < 3:\n    " + call + "\n    i = i + 1").find(placement) != std::string::npos);
+        assert(misplaced("for i in range(3):\n    " + call).find(placement) != std::string::npos);
+        assert(misplaced("i = 0\nif i == 0:\n    " + call).find(placement) != std::string::npos);
+        assert(misplaced("x = " + call).find(placement) != std::string::npos);
+        assert(misplaced("save = checkpoint\nsave(\"" + path + "\")").find(placement) != std::string::npos);
+        assert(misplaced("function step():\n    " + call + "\ni = 0\nwhile i < 3:\n    i = i + 1\n    step()")
+                   .find("cannot be called inside a function") != std::string::npos);
+        
+        std::cout << "✓ All checkpoint tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_budgets() {
+    std::cout << "\n=== Execution Budget Test ===\n";
+    
+    auto run = [](const std::string& code, const Dakota::ExecutionBudget& budget, std::string& errors) {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        assert(!parser.has_error());
+        std::ostringstream output, error_stream;
+        Dakota::Interpreter interpreter(parser);
+        interpreter.set_output(output, error_stream);
+        interpreter.set_budget(budget);
+        interpreter.interpret();
+        errors = error_stream.str();
+        return interpreter.steps();
+    };
+    
+    try {
+        std::string errors;
+        std::string spin = "i = 0\nwhile true:\n    i = i + 1";
+        
+        // Step limits stop loops and runaway recursion
+        Dakota::ExecutionBudget steps;
+        steps.max_steps = 50000;
+        uint64_t used = run(spin, steps, errors);
+        assert(errors.find("Execution budget of 50000 steps exceeded") != std::string::npos);
+        assert(used >= 50000 && used < 50000 + Dakota::BUDGET_SLICE_STEPS);
+        
+        std::string runaway = "function down(n):\n    return down(n + 1)\ndown(0)";
+        steps.max_steps = 2000;
+        run(runaway, steps, errors);
+        assert(errors.find("Execution budget of 2000 steps exceeded") != std::string::npos);
+        
+        // Recursion stops at the call depth limit, budget or not, before the native stack runs out
+        steps.max_steps = 1000000;
+        run(runaway, steps, errors);
+        assert(errors.find("Maximum call depth of 1000 exceeded") != std::string::npos);
+        run(runaway, Dakota::ExecutionBudget(), errors);
+        assert(errors.find("Maximum call depth of 1000 exceeded") != std::string::npos);
+        
+        // Wall time limits
+        Dakota::ExecutionBudget timed;
+        timed.max_seconds = 0.05;
+        run(spin, timed, errors);
+        assert(errors.find("Execution time limit of 0.05 s exceeded") != std::string::npos);
+        
+        // A scheduler sees every slice and may cancel the script
+        Dakota::ExecutionBudget sliced;
+        sliced.slice_steps = 1000;
+        int slices = 0;
+        sliced.on_slice = [&slices] { return ++slices < 3; };
+        used = run(spin, sliced, errors);
+        assert(slices == 3);
+        assert(errors.find("Execution cancelled") != std::string::npos);
+        assert(used >= 3000 && used < 4000);
+        
+        // sweep() workers spend the same budget and see the same cancellation
+        std::string swept = "function work(x):\n    i = 0\n    while true:\n        i = i + 1\n    return i\n"
+                            "r = sweep(work, [1, 2, 3])";
+        steps.max_steps = 100000;
+        used = run(swept, steps, errors);
+        assert(errors.find("Execution budget of 100000 steps exceeded") != std::string::npos);
+        assert(used >= 100000);
+        Dakota::ExecutionBudget stopped;
+        stopped.slice_steps = 1000;
+        std::atomic<int> calls(0);
+        stopped.on_slice = [&calls] { return ++calls < 3; };
+        run(swept, stopped, errors);
+        assert(errors.find("Execution cancelled") != std::string::npos);
+        
+        // So do imported modules, and calls into a module count toward the
+        // importer's call depth
+        std::string dir = "/tmp/dakota_budget_modules_" + std::to_string(getpid());
+        mkdir(dir.c_str(), 0755);
+        std::ofstream(dir + "/spin.dk") << "function spin(n):\n    i = 0\n    while i < n:\n        i = i + 1\n    return i\n";
+        std::ofstream(dir + "/ping.dk") << "function ping(f, n):\n    return f(n + 1)\n";
+        Dakota::ModuleCache::instance().add_search_directory(dir);
+        std::string imported = "import spin\nspin.spin(30000000)";
+        run(imported, steps, errors);
+        assert(errors.find("Execution budget of 100000 steps exceeded") != std::string::npos);
+        run(imported, timed, errors);
+        assert(errors.find("Execution time limit of 0.05 s exceeded") != std::string::npos);
+        run("import ping\nfunction pong(n):\n    return ping.ping(pong, n)\npong(0)", Dakota::ExecutionBudget(), errors);
+        assert(errors.find("Maximum call depth of 1000 exceeded") != std::string::npos);
+        for (const char* name : {"/spin.dk", "/ping.dk"}) {
+            std::remove((dir + name).c_str());
+        }
+        rmdir(dir.c_str());
+        
+        // Unlimited runs still count steps and finish normally
+        used = run("s = 0\nfor i in range(100):\n    s = s + i\nprint(s)", Dakota::ExecutionBudget(), errors);
+        assert(errors.empty());
+        assert(used > 100);
+        
+        // Jobs carry their own budget
+        Dakota::ProgramCache programs;
+        Dakota::JobRequest job;
+        job.script = spin;
+        job.budget.max_steps = 10000;
+        Dakota::JobResult result = Dakota::run_job(programs, job);
+        assert(!result.ok);
+        assert(result.errors.find("Execution budget of 10000 steps exceeded") != std::string::npos);
+        
+        std::cout << "✓ All execution budget tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
+void test_units() {
+    std::cout << "\n=== Units Test ===\n";
+    
+    auto parse_error = [](const std::string& code) {
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        return parser.has_error() ? parser.get_error() : std::string();
+    };
+    
+    try {
+        // Literals are converted to SI base units
+        std::string code = R"(g = 9.81 [m/s**2]
+h = 20 [m]
+t = sqrt(2 * h / g)
+v = g * t
+print(v / 1 [km/h])
+print(5 [m], 250 [g], 2 [h], [1, 2] [cm])
+F = 1200 [kg] * g
+print(F / 1 [kN] > 11.7, sin(90 [deg])))";
+        Dakota::Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Dakota::Parser parser(tokens);
+        parser.parse();
+        assert(!parser.has_error());
+        std::ostringstream output;
+        Dakota::Interpreter interpreter(parser);
+        interpreter.set_output(output, output);
+        interpreter.interpret();
+        assert(output.str() == "71.31272\n5 0.25 7200 [0.01,0.02]\ntrue 1\n");
+        
+        // Annotations leave nothing behind: the tree matches the program written in SI
+        Dakota::Lexer annotated_lexer("d = 3 [km] + 20 [m]\nrate = d / 2 [min]");
+        Dakota::Lexer plain_lexer("d = 3000 + 20\nrate = d / 120");
+        auto annotated_tokens = annotated_lexer.tokenize();
+        auto plain_tokens = plain_lexer.tokenize();
+        Dakota::Parser annotated(annotated_tokens);
+        Dakota::Parser plain(plain_tokens);
+        annotated.parse();
+        plain.parse();
+        assert(!annotated.has_error() && !plain.has_error());
+        assert(annotated.get_nodes().size() == plain.get_nodes().size());
+        for (size_t i = 0; i < plain.get_nodes().size(); ++i) {
+            const Dakota::ASTNode& a = annotated.get_nodes()[i];
+            const Dakota::ASTNode& b = plain.get_nodes()[i];
+            assert(a.type == b.type);
+            if (a.type == Dakota::NodeType::INTEGER_LITERAL) {
+                assert(a.integer_literal.value == b.integer_literal.value);
+            }
+        }
+        
+        // Mismatches are compile-time errors
+        assert(parse_error("x = 5 [m] + 2 [s]").find("Cannot add m and s") != std::string::npos);
+        assert(parse_error("x = 5 [m]\ny = 2 [s]\nx = y").find("'x' holds m, cannot assign s") != std::string::npos);
+        assert(parse_error("v = 3 [m/s]\nif v > 2 [m]:\n    print(v)").find("Cannot compare m/s and m") !=
+               std::string::npos);
+        assert(parse_error("F = 2 [N]\nprint(exp(F))").find("exp expects a dimensionless argument, got kg*m/s**2") !=
+               std::string::npos);
+        assert(parse_error("r = sqrt(2 [m**3])").find("Cannot take the square root of m**3") != std::string::npos);
+        assert(parse_error("x = 1 [parsec]").find("Unknown unit 'parsec'") != std::string::npos);
+        assert(parse_error("x = [10, 20, 30][1]").find("Expected a unit name") != std::string::npos);
+        assert(parse_error("x = 5 [1]").find("Expected a unit name") != std::string::npos);
+        assert(parse_error("x = 5 [m*1/s]").find("Expected a unit name") != std::string::npos);
+        assert(parse_error("f = 50 [1/s]\nw = 3 [(1/s)**2]\nprint(f * 2 [s], w)").empty());
+        
+        // Units are learned from later assignments, and unknown values never fail
+        assert(parse_error("function f(x):\n    return x + 1\nt = 0\nwhile t < 3 [s]:\n    t = t + 1 [s]\n"
+                           "d = f(t) * 2 [m]\ns = [t, 2 [m]]").empty());
+        assert(parse_error("t = 0\nwhile t < 10:\n    t = t + 1 [s]").find("Cannot compare s and dimensionless") !=
+               std::string::npos);
+        
+        std::cout << "✓ All units tests passed!\n";
+        
+    } catch (const std::exception& e) {
+        std::cout << "✗ Exception: " << e.what() << "\n";
+    }
+}
+
 int main() {
     std::cout << "Running Dakota Interpreter Tests...\n";
     std::cout << "====================================\n";
@@ -190,6 +2180,30 @@ int main() {
     test_builtin_functions();
     test_control_flow();
     test_print_function();
+    test_linear_solve();
+    test_sparse_solve();
+    test_matrix_functions();
+    test_integration();
+    test_statistics();
+    test_lists();
+    test_dictionaries();
+    test_string_building();
+    test_buffer_pool();
+    test_closures();
+    test_loop_idioms();
+    test_optimizer();
+    test_range_analysis();
+    test_constant_matrices();
+    test_sweep();
+    test_server();
+    test_batch();
+    test_modules();
+    test_embedding();
+    test_extern_functions();
+    test_checkpoint();
+    test_budgets();
+    test_units();
+    test_plugins();
     
     std::cout << "\n====================================\n";
     std::cout << "All interpreter tests completed!\n";